@@ -73,6 +73,9 @@
  */
 #define KERNEL_INTERRUPT_PRIORITY       (255)
 
+/* Watchdog reset flag (WDTR) of Reset Source Identification register */
+#define RSID_WATCHDOG_RESET_MASK        (1UL << 2)
+
 /***************************** TYPE DEFINITIONS *******************************/
 /*
  * Map for Stack Initialization of a Task Stack
@@ -326,3 +329,44 @@ uint32_t Drv_CPUCore_GetCPUFrequency(void)
 {
 	return SystemCoreClock;
 }
+
+/*
+ * Checks and clears watchdog reset flag of Reset Source Identification
+ * register.
+ */
+bool Drv_CPUCore_IsWatchdogReset(void)
+{
+	bool watchdogReset = (LPC_SC->RSID & RSID_WATCHDOG_RESET_MASK) != 0;
+
+	/* Flag is cleared by writing one */
+	LPC_SC->RSID = RSID_WATCHDOG_RESET_MASK;
+
+	return watchdogReset;
+}
+
+/*
+ * Increments boot counter in a general purpose register of RTC domain.
+ *	It keeps its value while VBAT is supplied.
+ */
+uint32_t Drv_CPUCore_IncrementBootCount(void)
+{
+	return ++LPC_RTC->GPREG0;
+}
+
+/*
+ * Starts DWT cycle counter
+ */
+void Drv_CPUCore_StartCycleCounter(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*
+ * Returns DWT cycle counter
+ */
+uint32_t Drv_CPUCore_GetCycleCount(void)
+{
+	return DWT->CYCCNT;
+}
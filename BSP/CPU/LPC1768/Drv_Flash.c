@@ -61,7 +61,8 @@ typedef enum
 	IAP_CMD_READ_PART_ID,
 	IAP_CMD_READ_BOOTCODE_VERSION,
 	IAP_CMD_COMPARE,
-	IAP_CMD_REINVOKE_ISP
+	IAP_CMD_REINVOKE_ISP,
+	IAP_CMD_READ_SERIAL_NUMBER
 } IAPCommands;
 
 /*
@@ -127,6 +128,13 @@ typedef struct
     unsigned long __reserved2;
 } IAPResult;
 
+/* IAP Result structure of serial number command */
+typedef struct
+{
+    unsigned long result;
+    unsigned long serialNumber[FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT];
+} IAPSerialNumberResult;
+
 /**************************** FUNCTION PROTOTYPES *****************************/
 
 /******************************** VARIABLES ***********************************/
@@ -213,6 +221,48 @@ int32_t Drv_Flash_EraseBlock(uint32_t blockNo)
     return Drv_Flash_EraseBlockRange(blockNo, blockNo);
 }
 
+/**
+ * Checks whether range of blocks is blank.
+ *  Does not require preparation. Much faster than an erase, so blank blocks
+ *  can be skipped before erasing.
+ */
+int32_t Drv_Flash_BlankCheckBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+    IAPFlashBlockStatusParams statusParams;
+    IAPResult iapResult;
+
+    iapResult.result = 0;
+
+    statusParams.iapCommand = IAP_CMD_BLANK_CHECK;
+    statusParams.startSector = (unsigned long)startBlockNo;
+    statusParams.endSector = (unsigned long)endBlockNo;
+
+    /*
+     * Enter critical section.
+     * Need to disable interupts first
+     */
+    Drv_CPUCore_DisableInterrupts();
+
+    runIAPCommand((unsigned long *)&statusParams, (unsigned long *)&iapResult);
+
+    Drv_CPUCore_EnableInterrupts();
+
+    if (iapResult.result == IAP_STATUS_SUCCESS)
+    {
+        return FLASH_STATUS_SUCCESS;
+    }
+    else if (iapResult.result == IAP_STATUS_SECTOR_NOT_BLANK)
+    {
+        return FLASH_STATUS_NOT_BLANK;
+    }
+    else if (iapResult.result == IAP_STATUS_BUSY)
+    {
+        return FLASH_STATUS_BUSY;
+    }
+
+    return FLASH_STATUS_FAILURE;
+}
+
 /**
  * Writes data to flash address
  *  Drv_Flash_PrepareBlock must be called before
@@ -267,6 +317,22 @@ int32_t Drv_Flash_WriteBlock(uint32_t blockNo, uint8_t* data, uint32_t length)
 	return Drv_Flash_Write(blockAddress, data, length);
 }
 
+/**
+ * Reads flash content.
+ *  Flash is memory mapped, so no IAP command is required.
+ */
+int32_t Drv_Flash_Read(uint32_t address, uint8_t* data, uint32_t length)
+{
+    if ((address >= FLASH_LPC17xx_FLASH_SIZE) || (length > FLASH_LPC17xx_FLASH_SIZE - address))
+    {
+        return FLASH_STATUS_FAILURE;
+    }
+
+    memcpy(data, (const void*)address, length);
+
+    return FLASH_STATUS_SUCCESS;
+}
+
 /**
  * Prepares Block for Write/Erase operations
  *
@@ -333,7 +399,44 @@ int32_t Drv_Flash_GetBlockNoOfAddress(uint32_t address)
     return blockNo;
 }
 
+uint32_t Drv_Flash_GetBlockAddress(uint32_t blockNo)
+{
+    return getBlockAddress(blockNo);
+}
+
 uint32_t Drv_Flash_GetSize(void)
 {
 	return FLASH_LPC17xx_FLASH_SIZE;
 }
+
+/**
+ * Reads unique serial number of device using IAP
+ */
+int32_t Drv_Flash_ReadDeviceSerialNumber(uint32_t* serialNumber)
+{
+    IAPFlashBlockStatusParams commandParams;
+    IAPSerialNumberResult iapResult;
+    uint32_t index;
+
+    iapResult.result = 0;
+
+    commandParams.iapCommand = IAP_CMD_READ_SERIAL_NUMBER;
+
+    Drv_CPUCore_DisableInterrupts();
+
+    runIAPCommand((unsigned long *)&commandParams, (unsigned long *)&iapResult);
+
+    Drv_CPUCore_EnableInterrupts();
+
+    if (iapResult.result != IAP_STATUS_SUCCESS)
+    {
+        return FLASH_STATUS_FAILURE;
+    }
+
+    for (index = 0; index < FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT; index++)
+    {
+        serialNumber[index] = (uint32_t)iapResult.serialNumber[index];
+    }
+
+    return FLASH_STATUS_SUCCESS;
+}
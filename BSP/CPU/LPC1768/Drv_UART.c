@@ -1,121 +1,601 @@
+/*******************************************************************************
+*
+* @file Drv_UART.c
+*
+* @author MC
+*
+* @brief UART Driver for LPC17xx
+*
+*		 Received bytes are moved from RX FIFO into a ring buffer by GPDMA
+*		 without CPU. GPDMA keeps receiving even if interrupts are disabled
+*		 (e.g. IAP flash commands disable interrupts for milliseconds while
+*		 RX FIFO overflows in a few microseconds at 3 Mbaud).
+*
+*		 DMA writes ring storage through a circular linked list of segments.
+*		 Written bytes are published to ring by interrupts which are raised
+*		 - by UART when RX FIFO reaches trigger level or character timeout
+*		   occurs (short transfers and idle line)
+*		 - by GPDMA at the end of each segment (long interrupt latencies)
+*
+*		 Both interrupts have same priority, so they never preempt each other
+*		 and are single producer of lock-free SPSC ring. Drv_UART_Receive is
+*		 single consumer, so no locks are required between ISRs and clients.
+*		 Drv_UART_PeekSpan lends ring storage to client, so received bytes
+*		 can be parsed where DMA wrote them.
+*
+*		 DMA never laps unread bytes. Linked list ends before the segment of
+*		 oldest unread byte, so DMA stops when free space is used up and
+*		 further bytes overrun RX FIFO which is reported by line status.
+*		 Stopped DMA is restarted by ISRs once client frees segments. Hence
+*		 DMA position always tells exact number of received bytes.
+*
+*		 Receive errors are reported once by Drv_UART_Receive or
+*		 Drv_UART_PeekSpan, then ring and DMA are restarted from scratch.
+*
+*		 Only UART0 (P0.2 TXD0, P0.3 RXD0) is supported.
+*
+* @see
+*
+*******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+*******************************************************************************/
 
 /********************************* INCLUDES ***********************************/
 #include "Drv_UART.h"
 
-#if !defined(UNIT_TEST)
-#include "TestData.h"
-#endif
+#include "RingBuffer.h"
+
+#include "LPC17xx.h"
+#include "lpc17xx_clkpwr.h"
+
+#include "Debug.h"
+#include "postypes.h"
+
+#include "DRVConfig.h"
 
 /***************************** MACRO DEFINITIONS ******************************/
-#define EXTERNAL_TEST_DATA          1
-#define VALID_DATA                  0
+/* Number of supported HW UARTs. Just UART0 for now */
+#define NUM_OF_HW_UARTS						(1)
 
-#if EXTERNAL_TEST_DATA
-#define LENGTH_OF_REGULAR		sizeof(testImage) / (sizeof(char*))
+/*
+ * Size of receive ring. Must be power of two.
+ *	Ring must keep bytes which are received during longest period that
+ *	client does not call Drv_UART_Receive.
+ */
+#ifndef DRV_CONFIG_UART_RX_RING_SIZE
+#define DRV_CONFIG_UART_RX_RING_SIZE		(2048)
+#endif	/* DRV_CONFIG_UART_RX_RING_SIZE */
 
-#else
-#define LENGTH_OF_REGULAR		sizeof(regularIntelHex) / (sizeof(char*))
+#if !RINGBUFFER_IS_VALID_SIZE(DRV_CONFIG_UART_RX_RING_SIZE)
+#error "UART RX Ring size must be power of two!"
 #endif
 
+/* Ring storage is filled by DMA using that many linked list items */
+#define UART_RX_DMA_SEGMENT_COUNT			(8)
+#define UART_RX_DMA_SEGMENT_LENGTH			(DRV_CONFIG_UART_RX_RING_SIZE / UART_RX_DMA_SEGMENT_COUNT)
+
+/* Maximum accepted baud rate error in per mille (8N1 tolerates ~%4 in total) */
+#define UART_MAX_BAUD_ERROR_PERMILLE		(20)
+
+/*
+ * NVIC priority of UART and DMA interrupts.
+ *	Must be same to keep single producer of receive ring.
+ */
+#define UART_IRQ_PRIORITY					(5)
+
+/* UART FIFO length */
+#define UART_FIFO_LENGTH					(16)
+
+/*
+ * UART Register Bits
+ */
+/* Line Control : 8 data bits, no parity, 1 stop bit */
+#define UART_LCR_8N1						(0x03)
+/* Line Control : Divisor Latch Access */
+#define UART_LCR_DLAB						(1 << 7)
+/* FIFO Control */
+#define UART_FCR_FIFO_ENABLE				(1 << 0)
+#define UART_FCR_RX_FIFO_RESET				(1 << 1)
+#define UART_FCR_TX_FIFO_RESET				(1 << 2)
+#define UART_FCR_DMA_MODE					(1 << 3)
+/* FIFO Control : RX Trigger Level is 8 characters */
+#define UART_FCR_RX_TRIGGER_LEVEL_8			(2 << 6)
+/* Interrupt Enable : RX Data Available and Character Timeout */
+#define UART_IER_RBR						(1 << 0)
+/* Interrupt Enable : RX Line Status */
+#define UART_IER_RLS						(1 << 2)
+/* Interrupt Identification */
+#define UART_IIR_INTID_MASK					(0x0E)
+#define UART_IIR_INTID_RLS					(0x06)
+/* Line Status : Errors of received characters */
+#define UART_LSR_RX_ERRORS					((1 << 1) | (1 << 2) | (1 << 3) | (1 << 7))
+/* Line Status : Transmit Holding Register Empty */
+#define UART_LSR_THRE						(1 << 5)
+/* Transmit Enable */
+#define UART_TER_TXEN						(1 << 7)
+/* Fractional Divider */
+#define UART_FDR(divAddVal, mulVal)			((divAddVal) | ((mulVal) << 4))
+/* Divisor must be at least 3 when fractional divider is used */
+#define UART_MIN_FRACTIONAL_DIVISOR			(3)
+
+/* P0.2 (TXD0) and P0.3 (RXD0) selections in PINSEL0 */
+#define UART0_PINSEL0_MASK					(0x0F << 4)
+#define UART0_PINSEL0_VALUE					(0x05 << 4)
+
+/*
+ * GPDMA Register Bits
+ */
+/* Connection number of UART0 RX DMA request */
+#define GPDMA_CONN_UART0_RX					(9)
+/* DMAREQSEL bit which selects UART0 RX or Timer 0 Match 1 request */
+#define GPDMA_DMAREQSEL_UART0_RX			(1 << (GPDMA_CONN_UART0_RX - 8))
+/* Used DMA Channel and its mask in common registers */
+#define UART_RX_DMA_CHANNEL					LPC_GPDMACH0
+#define UART_RX_DMA_CHANNEL_MASK			(1 << 0)
+/* Controller enable */
+#define GPDMA_CONFIG_ENABLE					(1 << 0)
+/* Channel Control : byte transfers, single burst, destination increment */
+#define GPDMA_CONTROL_TRANSFER_SIZE(size)	((size) & 0x0FFF)
+#define GPDMA_CONTROL_DI					(1 << 27)
+#define GPDMA_CONTROL_TC_INT				(1UL << 31)
+/* Channel Config */
+#define GPDMA_CCONFIG_ENABLE				(1 << 0)
+#define GPDMA_CCONFIG_SRC_PERIPHERAL(conn)	((conn) << 1)
+#define GPDMA_CCONFIG_PERIPHERAL_TO_MEMORY	(2 << 11)
+#define GPDMA_CCONFIG_IE					(1 << 14)
+#define GPDMA_CCONFIG_ITC					(1 << 15)
+
+/* Segment of an offset in ring storage */
+#define UART_RX_DMA_SEGMENT_OF(offset)		((offset) / UART_RX_DMA_SEGMENT_LENGTH)
+
+/* Control value of all receive segments */
+#define UART_RX_DMA_CONTROL \
+			(GPDMA_CONTROL_TRANSFER_SIZE(UART_RX_DMA_SEGMENT_LENGTH) | GPDMA_CONTROL_DI | GPDMA_CONTROL_TC_INT)
+
 /***************************** TYPE DEFINITIONS *******************************/
+/*
+ * GPDMA Linked List Item. Layout is defined by GPDMA.
+ */
+typedef struct
+{
+	uint32_t srcAddr;
+	uint32_t destAddr;
+	uint32_t nextLLI;
+	uint32_t control;
+} GPDMALinkedListItem;
+
+/*
+ * Baud rate divisors of UART
+ */
+typedef struct
+{
+	/* Divisor Latch (DLM:DLL) */
+	uint32_t divisor;
+	/* Fractional Divider values */
+	uint32_t divAddVal;
+	uint32_t mulVal;
+} UARTBaudDivisors;
+
+/*
+ * UART Object
+ */
+typedef struct
+{
+	/* Client callback to inform about received data */
+	UARTDataReceivedEventHandler dataReceivedEventHandler;
+	/* Received bytes, produced by ISRs and consumed by Drv_UART_Receive */
+	RingBuffer rxRing;
+	/* Ring is overrun or a receive error occured, cleared once reported */
+	volatile bool rxError;
+	/* Last segment which DMA may fill, its linked list item ends DMA */
+	uint32_t lastDMASegment;
+} UART;
 
 /**************************** FUNCTION PROTOTYPES *****************************/
 
 /******************************** VARIABLES ***********************************/
 
-#if !EXTERNAL_TEST_DATA
-
-#if VALID_DATA
-PRIVATE char* regularIntelHex[] =
-{
-	":020000040000FA",
-	":0402FC00FFFFFFFF02",
-	":020000040000FA",
-	":10800000600400104D810000558100005781000080",
-	":10801000598100005B8100005D81000000000000CC",
-	":108020000000000000000000000000005F81000070",
-	":108030006181000000000000638100006581000094",
-	":108040006781000067810000678100006781000090",
-	":108050006781000067810000678100006781000080",
-	":1080D00000F02CF80AA090E8000C82448344AAF136",
-	":1080E0000107DA4501D100F021F8AFF2090EBAE834",
-	":10847000C8FEFFF7ECFF0000888400000000001039",
-	":08848000600400000881000007",
-	":04000005000080CDAA",
-	":00000001FF"
-};
-#else
-PRIVATE char* regularIntelHex[] =
-{
-	":020000040000FA",
-	":0402FC00FFFFFFFF02",
-	":0402FC00FFFFFFFF01", // ":0402FC00FFFFFFFF02",
-	":020000040000FA",
-	":10800000:10800000600400104D810000558100005781000080",
-	"1000598100005B8100005D81000000000000CC",     /* Missing line */
-	":10801000598100005B8100005D81000000000000CC",
-	":108020000000000000000000000000005F81000070",
-	":108030006181000000000000",
-	"638100006581000094",
-	":108040006781000067810000678100006781000090",
-	":108050006781000067810000678100006781000080:1080D00000F02CF80AA090E8000C82448344AAF136",
-	":1080E0000107DA4501D100F021F8AFF2090EBAE834",
-	":10847000C8FEFFF7ECFF00008884",
-	"00000000001039:08848000600400000881000007",
-	":04000005000080CDAA",
-	":00000001FF",
-	""
-};
-#endif
+PRIVATE UART uart0;
 
-#endif
+/* Storage of receive ring which is written by DMA */
+PRIVATE uint8_t rxRingStorage[DRV_CONFIG_UART_RX_RING_SIZE];
 
-#if defined(UNIT_TEST)
-    char* testImage[1];
-#endif
-
-UARTDataReceivedEventHandler evHandler;
-PRIVATE uint32_t index = 0;
+/* Circular linked list which maps DMA segments to ring storage */
+PRIVATE GPDMALinkedListItem rxDMALinkedList[UART_RX_DMA_SEGMENT_COUNT];
 
 /**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Calculates divisors for a baud rate.
+ *	baudRate = pclk / (16 * divisor * (1 + divAddVal / mulVal))
+ *
+ * @return true if baud rate can be generated with an acceptable error
+ */
+PRIVATE bool calculateBaudDivisors(uint32_t pclk, uint32_t baudRate, UARTBaudDivisors* divisors)
+{
+	uint32_t mulVal;
+	uint32_t divAddVal;
+	uint64_t divisor;
+	uint64_t generatedRate;
+	uint64_t error;
+	uint64_t bestError = UINT64_MAX;
+
+	for (mulVal = 1; mulVal <= 15; mulVal++)
+	{
+		for (divAddVal = 0; divAddVal < mulVal; divAddVal++)
+		{
+			/* Rounded divisor for this fraction */
+			divisor = (((uint64_t)pclk * mulVal) + ((uint64_t)baudRate * 8 * (mulVal + divAddVal))) /
+					  ((uint64_t)baudRate * 16 * (mulVal + divAddVal));
+
+			if ((divisor == 0) || (divisor > 0xFFFF) ||
+				((divAddVal > 0) && (divisor < UART_MIN_FRACTIONAL_DIVISOR)))
+			{
+				continue;
+			}
+
+			generatedRate = ((uint64_t)pclk * mulVal) / (16 * divisor * (mulVal + divAddVal));
+			error = (generatedRate > baudRate) ? (generatedRate - baudRate) : (baudRate - generatedRate);
+
+			if (error < bestError)
+			{
+				bestError = error;
+				divisors->divisor = (uint32_t)divisor;
+				divisors->divAddVal = divAddVal;
+				divisors->mulVal = mulVal;
+			}
+		}
+	}
+
+	return (bestError * 1000) <= ((uint64_t)baudRate * UART_MAX_BAUD_ERROR_PERMILLE);
+}
+
+/*
+ * Loads a segment into DMA channel and enables it, following segments are
+ * loaded by DMA using linked list.
+ */
+PRIVATE void loadReceiveDMASegment(uint32_t segment)
+{
+	UART_RX_DMA_CHANNEL->DMACCSrcAddr = rxDMALinkedList[segment].srcAddr;
+	UART_RX_DMA_CHANNEL->DMACCDestAddr = rxDMALinkedList[segment].destAddr;
+	UART_RX_DMA_CHANNEL->DMACCLLI = rxDMALinkedList[segment].nextLLI;
+	UART_RX_DMA_CHANNEL->DMACCControl = rxDMALinkedList[segment].control;
+	UART_RX_DMA_CHANNEL->DMACCConfig =
+			GPDMA_CCONFIG_SRC_PERIPHERAL(GPDMA_CONN_UART0_RX) |
+			GPDMA_CCONFIG_PERIPHERAL_TO_MEMORY |
+			GPDMA_CCONFIG_IE |
+			GPDMA_CCONFIG_ITC |
+			GPDMA_CCONFIG_ENABLE;
+}
+
+/*
+ * Starts DMA which fills free space of receive ring storage
+ */
+PRIVATE void startReceiveDMA(void)
+{
+	uint32_t segment;
+
+	for (segment = 0; segment < UART_RX_DMA_SEGMENT_COUNT; segment++)
+	{
+		rxDMALinkedList[segment].srcAddr = (uint32_t)&LPC_UART0->RBR;
+		rxDMALinkedList[segment].destAddr = (uint32_t)&rxRingStorage[segment * UART_RX_DMA_SEGMENT_LENGTH];
+		rxDMALinkedList[segment].nextLLI = (uint32_t)&rxDMALinkedList[(segment + 1) % UART_RX_DMA_SEGMENT_COUNT];
+		rxDMALinkedList[segment].control = UART_RX_DMA_CONTROL;
+	}
+
+	/* Ring is empty, DMA may fill all segments but the one before start */
+	uart0.lastDMASegment = UART_RX_DMA_SEGMENT_COUNT - 2;
+	rxDMALinkedList[uart0.lastDMASegment].nextLLI = 0;
+
+	LPC_SC->PCONP |= CLKPWR_PCONP_PCGPDMA & CLKPWR_PCONP_BITMASK;
+	LPC_GPDMA->DMACConfig = GPDMA_CONFIG_ENABLE;
+
+	/* DMA request line is shared with Timer 0, select UART0 RX */
+	LPC_SC->DMAREQSEL &= ~GPDMA_DMAREQSEL_UART0_RX;
+
+	/* Clear pending interrupts of channel */
+	LPC_GPDMA->DMACIntTCClear = UART_RX_DMA_CHANNEL_MASK;
+	LPC_GPDMA->DMACIntErrClr = UART_RX_DMA_CHANNEL_MASK;
+
+	loadReceiveDMASegment(0);
+}
+
+/*
+ * Moves end of DMA linked list to the segment before oldest unread byte and
+ * restarts DMA if it has stopped before new end.
+ *	Called only from ISRs, after bytes written by DMA are published.
+ */
+PRIVATE void extendReceiveDMA(uint8_t* writePosition)
+{
+	uint32_t writeOffset = (uint32_t)(writePosition - rxRingStorage);
+	uint32_t previousSegment = uart0.lastDMASegment;
+	uint32_t lastSegment;
+	uint32_t lastFreeOffset;
+	uint32_t stoppedSegment;
+
+	/* Free space ends just before oldest unread byte */
+	lastFreeOffset = (writeOffset + RingBuffer_GetFree(&uart0.rxRing) - 1) & (DRV_CONFIG_UART_RX_RING_SIZE - 1);
+
+	/* Segment of last free byte may still hold unread bytes, DMA stops before it */
+	lastSegment = (UART_RX_DMA_SEGMENT_OF(lastFreeOffset) + UART_RX_DMA_SEGMENT_COUNT - 1) % UART_RX_DMA_SEGMENT_COUNT;
+	if (lastSegment != previousSegment)
+	{
+		/* New end is set before old one is linked, so DMA never passes unread bytes */
+		rxDMALinkedList[lastSegment].nextLLI = 0;
+		rxDMALinkedList[previousSegment].nextLLI =
+				(uint32_t)&rxDMALinkedList[(previousSegment + 1) % UART_RX_DMA_SEGMENT_COUNT];
+		uart0.lastDMASegment = lastSegment;
+	}
+
+	/*
+	 * DMA keeps an end which it has already loaded, so it may stop before
+	 * current end. Bytes wait in RX FIFO meanwhile. Stopped DMA has published
+	 * all of its bytes, so write position is end of its last segment.
+	 */
+	if ((LPC_GPDMA->DMACEnbldChns & UART_RX_DMA_CHANNEL_MASK) == 0)
+	{
+		stoppedSegment = (UART_RX_DMA_SEGMENT_OF(writeOffset) + UART_RX_DMA_SEGMENT_COUNT - 1) % UART_RX_DMA_SEGMENT_COUNT;
+		if (stoppedSegment != lastSegment)
+		{
+			loadReceiveDMASegment((stoppedSegment + 1) % UART_RX_DMA_SEGMENT_COUNT);
+		}
+	}
+}
+
+/*
+ * Publishes bytes which are written by DMA since last call.
+ *	Producer side of receive ring, called only from ISRs.
+ */
+PRIVATE void publishReceivedData(void)
+{
+	uint8_t* writePosition;
+	uint32_t dmaOffset;
+	uint32_t receivedLength;
+
+	/* Ring is restarted by client after error is reported */
+	if (uart0.rxError)
+	{
+		uart0.dataReceivedEventHandler();
+		return;
+	}
+
+	/* Next address which will be written by DMA */
+	dmaOffset = (UART_RX_DMA_CHANNEL->DMACCDestAddr - (uint32_t)rxRingStorage) & (DRV_CONFIG_UART_RX_RING_SIZE - 1);
+
+	/*
+	 * Bytes between last published position and DMA position are new.
+	 *	DMA stops at least one byte before unread bytes, so it can not lap ring
+	 *	and distance is the exact number of transferred bytes.
+	 */
+	(void)RingBuffer_GetWriteSpan(&uart0.rxRing, &writePosition);
+	receivedLength = (dmaOffset - (uint32_t)(writePosition - rxRingStorage)) & (DRV_CONFIG_UART_RX_RING_SIZE - 1);
+
+	/* Transferred bytes can not exceed free space unless linked list is broken */
+	if (receivedLength > RingBuffer_GetFree(&uart0.rxRing))
+	{
+		uart0.rxError = true;
+		uart0.dataReceivedEventHandler();
+		return;
+	}
+
+	if (receivedLength > 0)
+	{
+		RingBuffer_CommitWrite(&uart0.rxRing, receivedLength);
+		writePosition = &rxRingStorage[dmaOffset];
+	}
+
+	/* Client may have freed segments since last call */
+	extendReceiveDMA(writePosition);
+
+	if (receivedLength > 0)
+	{
+		uart0.dataReceivedEventHandler();
+	}
+}
+
+/*
+ * Drops all received bytes and restarts reception after a receive error.
+ *	Called by consumer, so ISRs are kept away while ring is reset.
+ */
+PRIVATE void restartReceive(void)
+{
+	NVIC_DisableIRQ(UART0_IRQn);
+	NVIC_DisableIRQ(DMA_IRQn);
+
+	UART_RX_DMA_CHANNEL->DMACCConfig &= ~GPDMA_CCONFIG_ENABLE;
+
+	/* Bytes in FIFO follow lost ones, they are dropped too */
+	LPC_UART0->FCR = UART_FCR_FIFO_ENABLE | UART_FCR_RX_FIFO_RESET | UART_FCR_DMA_MODE | UART_FCR_RX_TRIGGER_LEVEL_8;
+	(void)LPC_UART0->LSR;
+
+	RingBuffer_Init(&uart0.rxRing, rxRingStorage, DRV_CONFIG_UART_RX_RING_SIZE);
+	startReceiveDMA();
+	uart0.rxError = false;
+
+	NVIC_EnableIRQ(UART0_IRQn);
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+/*
+ * ISR Function for UART0 Interrupt
+ */
+INTERNAL void UART0_IRQHandler(void)
+{
+	/* Reading IIR acknowledges interrupt */
+	if ((LPC_UART0->IIR & UART_IIR_INTID_MASK) == UART_IIR_INTID_RLS)
+	{
+		/* Reading LSR clears line status interrupt */
+		if (LPC_UART0->LSR & UART_LSR_RX_ERRORS)
+		{
+			uart0.rxError = true;
+		}
+	}
+
+	/* RX Data Available and Character Timeout are cleared when DMA reads FIFO */
+	publishReceivedData();
+}
+
+/*
+ * ISR Function for GPDMA Interrupt
+ */
+INTERNAL void DMA_IRQHandler(void)
+{
+	if (LPC_GPDMA->DMACIntErrStat & UART_RX_DMA_CHANNEL_MASK)
+	{
+		LPC_GPDMA->DMACIntErrClr = UART_RX_DMA_CHANNEL_MASK;
+		uart0.rxError = true;
+	}
+
+	if (LPC_GPDMA->DMACIntTCStat & UART_RX_DMA_CHANNEL_MASK)
+	{
+		LPC_GPDMA->DMACIntTCClear = UART_RX_DMA_CHANNEL_MASK;
+	}
+
+	publishReceivedData();
+}
 
 /***************************** PUBLIC FUNCTIONS *******************************/
 void Drv_UART_Init(void)
 {
-
+	memset(&uart0, 0, sizeof(uart0));
 }
 
 UartHandle Drv_UART_Get(uint32_t uartNo, uint32_t baudRate, UARTDataReceivedEventHandler dataReceivedEventHandler)
 {
-	evHandler = dataReceivedEventHandler;
+	UARTBaudDivisors divisors;
+
+	DEBUG_ASSERT_MESSAGE(uartNo < NUM_OF_HW_UARTS, "Unsupported UART!");
+
+	if (uartNo >= NUM_OF_HW_UARTS)
+	{
+		return DRV_UART_INVALID_HANDLER;
+	}
+
+	/* Enable Power of UART Block */
+	LPC_SC->PCONP |= CLKPWR_PCONP_PCUART0 & CLKPWR_PCONP_BITMASK;
+
+	/* UART runs at CPU Clock for finest baud rate resolution */
+	LPC_SC->PCLKSEL0 &= ~CLKPWR_PCLKSEL_BITMASK(CLKPWR_PCLKSEL_UART0);
+	LPC_SC->PCLKSEL0 |= CLKPWR_PCLKSEL_SET(CLKPWR_PCLKSEL_UART0, CLKPWR_PCLKSEL_CCLK_DIV_1);
+
+	if (!calculateBaudDivisors(SystemCoreClock, baudRate, &divisors))
+	{
+		return DRV_UART_INVALID_HANDLER;
+	}
+
+	/* Route UART0 to pins */
+	LPC_PINCON->PINSEL0 = (LPC_PINCON->PINSEL0 & ~UART0_PINSEL0_MASK) | UART0_PINSEL0_VALUE;
+
+	/* Set baud rate */
+	LPC_UART0->LCR = UART_LCR_DLAB | UART_LCR_8N1;
+	LPC_UART0->DLL = (uint8_t)divisors.divisor;
+	LPC_UART0->DLM = (uint8_t)(divisors.divisor >> 8);
+	LPC_UART0->FDR = (uint8_t)UART_FDR(divisors.divAddVal, divisors.mulVal);
+	LPC_UART0->LCR = UART_LCR_8N1;
 
-	evHandler();
+	/* FIFOs feed DMA when 8 bytes are received or line is idle */
+	LPC_UART0->FCR = UART_FCR_FIFO_ENABLE | UART_FCR_RX_FIFO_RESET | UART_FCR_TX_FIFO_RESET |
+					 UART_FCR_DMA_MODE | UART_FCR_RX_TRIGGER_LEVEL_8;
+
+	uart0.dataReceivedEventHandler = dataReceivedEventHandler;
+	uart0.rxError = false;
+	RingBuffer_Init(&uart0.rxRing, rxRingStorage, DRV_CONFIG_UART_RX_RING_SIZE);
+
+	startReceiveDMA();
+
+	LPC_UART0->IER = UART_IER_RBR | UART_IER_RLS;
+	LPC_UART0->TER = UART_TER_TXEN;
+
+	NVIC_SetPriority(UART0_IRQn, UART_IRQ_PRIORITY);
+	NVIC_SetPriority(DMA_IRQn, UART_IRQ_PRIORITY);
+	NVIC_EnableIRQ(UART0_IRQn);
+	NVIC_EnableIRQ(DMA_IRQn);
 
 	return (UartHandle)uartNo;
 }
 
 void Drv_UART_Release(UartHandle uart)
 {
+	(void)uart;
+
+	NVIC_DisableIRQ(UART0_IRQn);
+	NVIC_DisableIRQ(DMA_IRQn);
+
+	LPC_UART0->IER = 0;
+	UART_RX_DMA_CHANNEL->DMACCConfig &= ~GPDMA_CCONFIG_ENABLE;
+}
+
+int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength)
+{
+	uint32_t sentLength = 0;
+	uint32_t fifoLength;
+
+	(void)uart;
+
+	/* Responses are short, so TX FIFO is filled by polling */
+	while (sentLength < sendLength)
+	{
+		while ((LPC_UART0->LSR & UART_LSR_THRE) == 0);
+
+		for (fifoLength = MATH_MIN(UART_FIFO_LENGTH, sendLength - sentLength); fifoLength > 0; fifoLength--)
+		{
+			LPC_UART0->THR = sendBuffer[sentLength++];
+		}
+	}
+
+	return (int32_t)sentLength;
 }
 
 int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength)
 {
-    size_t msgLeng;
-    const char* hexLine;
-#if EXTERNAL_TEST_DATA
-    hexLine = testImage[index];
-#else
-	hexLine = regularIntelHex[index];
-#endif
+	uint32_t receivedLength;
+
+	(void)uart;
+
+	if (uart0.rxError)
+	{
+		restartReceive();
+		return -1;
+	}
 
-    msgLeng = strlen(hexLine);
+	receivedLength = RingBuffer_Read(&uart0.rxRing, receiveBuffer, receiveLength);
 
-	memcpy(receiveBuffer, hexLine, msgLeng);
+	/* Inform client about remaining data */
+	if (RingBuffer_GetCount(&uart0.rxRing) > 0)
+	{
+		uart0.dataReceivedEventHandler();
+	}
 
-	if (index++ < LENGTH_OF_REGULAR)
-		evHandler();
-	else
+	return (int32_t)receivedLength;
+}
+
+int32_t Drv_UART_PeekSpan(UartHandle uart, uint8_t** span)
+{
+	(void)uart;
+
+	if (uart0.rxError)
+	{
+		restartReceive();
 		return -1;
+	}
+
+	return (int32_t)RingBuffer_GetReadSpan(&uart0.rxRing, span);
+}
+
+void Drv_UART_Consume(UartHandle uart, uint32_t length)
+{
+	(void)uart;
+
+	RingBuffer_Consume(&uart0.rxRing, length);
 
-	return (int32_t)msgLeng;
+	/* Inform client about remaining data */
+	if (RingBuffer_GetCount(&uart0.rxRing) > 0)
+	{
+		uart0.dataReceivedEventHandler();
+	}
 }
@@ -61,6 +61,9 @@
 #define SCB_ICSR_PENDSVSET_Pos             28U                                            /*!< SCB ICSR: PENDSVSET Position */
 #define SCB_ICSR_PENDSVSET_Msk             (1UL << SCB_ICSR_PENDSVSET_Pos)                /*!< SCB ICSR: PENDSVSET Mask */
 
+#define CoreDebug_DEMCR_TRCENA_Msk         (1UL << 24)                                    /*!< CoreDebug DEMCR: TRCENA Mask */
+#define DWT_CTRL_CYCCNTENA_Msk             (1UL)                                          /*!< DWT CTRL: CYCCNTENA Mask */
+
 /*
  * splint (Static Code Analysis Tool) gives error if a object is not used but
  * we may not need to use some object in scope of Unit Testing.
@@ -257,6 +260,29 @@ typedef struct
        uint32_t CLKOUTCFG;              /* Clock Output Configuration         */
  } LPC_SC_TypeDef;
 
+typedef struct
+{
+	uint32_t DHCSR;                  /*!< Offset: 0x000 (R/W)  Debug Halting Control and Status Register */
+	uint32_t DCRSR;                  /*!< Offset: 0x004 ( /W)  Debug Core Register Selector Register */
+	uint32_t DCRDR;                  /*!< Offset: 0x008 (R/W)  Debug Core Register Data Register */
+	uint32_t DEMCR;                  /*!< Offset: 0x00C (R/W)  Debug Exception and Monitor Control Register */
+} CoreDebug_Type;
+
+typedef struct
+{
+	uint32_t CTRL;                   /*!< Offset: 0x000 (R/W)  Control Register */
+	uint32_t CYCCNT;                 /*!< Offset: 0x004 (R/W)  Cycle Count Register */
+} DWT_Type;
+
+typedef struct
+{
+	uint32_t GPREG0;                 /* General Purpose Registers of RTC domain */
+	uint32_t GPREG1;
+	uint32_t GPREG2;
+	uint32_t GPREG3;
+	uint32_t GPREG4;
+} LPC_RTC_TypeDef;
+
 /*
 * Mock objects and flags
 *
@@ -290,6 +316,9 @@ MOCK_REG_DEF(LPC_TIM_TypeDef, LPC_TIM1);
 MOCK_REG_DEF(LPC_TIM_TypeDef, LPC_TIM2);
 MOCK_REG_DEF(LPC_TIM_TypeDef, LPC_TIM3);
 MOCK_REG_DEF(LPC_SC_TypeDef, LPC_SC);
+MOCK_REG_DEF(CoreDebug_Type, CoreDebug);
+MOCK_REG_DEF(DWT_Type, DWT);
+MOCK_REG_DEF(LPC_RTC_TypeDef, LPC_RTC);
 
 /*
  * System Clock.
@@ -314,6 +343,9 @@ static INLINE void ResetRegistersAndObjects(void)
 	memset(LPC_GPIO0, 0, sizeof(LPC_GPIO_TypeDef));
 	memset(LPC_TIM0, 0, sizeof(LPC_TIM_TypeDef));
 	memset(LPC_SC, 0, sizeof(LPC_SC_TypeDef));
+	memset(CoreDebug, 0, sizeof(CoreDebug_Type));
+	memset(DWT, 0, sizeof(DWT_Type));
+	memset(LPC_RTC, 0, sizeof(LPC_RTC_TypeDef));
 
 	memset(&lpcMockObjects, 0, sizeof(lpcMockObjects));
 }
@@ -249,3 +249,44 @@ void test_CPU_CS_StackAlignmentTest(void)
 		TEST_ASSERT((((uintptr_t)topOfStack) & 0x7) == 0);
 	}
 }
+
+/*
+ * Tests that watchdog reset is reported once
+ */
+void test_CPU_WatchdogReset(void)
+{
+	LPC_SC->RSID = RSID_WATCHDOG_RESET_MASK;
+
+	TEST_ASSERT_TRUE(Drv_CPUCore_IsWatchdogReset());
+
+	/* Flag is cleared by writing one */
+	TEST_ASSERT_EQUAL(RSID_WATCHDOG_RESET_MASK, LPC_SC->RSID);
+
+	LPC_SC->RSID = 0;
+	TEST_ASSERT_FALSE(Drv_CPUCore_IsWatchdogReset());
+}
+
+/*
+ * Tests boot counter in retained register
+ */
+void test_CPU_BootCount(void)
+{
+	LPC_RTC->GPREG0 = 41;
+
+	TEST_ASSERT_EQUAL(42, Drv_CPUCore_IncrementBootCount());
+	TEST_ASSERT_EQUAL(42, LPC_RTC->GPREG0);
+}
+
+/*
+ * Tests that cycle counter is enabled from zero
+ */
+void test_CPU_CycleCounter(void)
+{
+	DWT->CYCCNT = 1234;
+
+	Drv_CPUCore_StartCycleCounter();
+
+	TEST_ASSERT(CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk);
+	TEST_ASSERT(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk);
+	TEST_ASSERT_EQUAL(0, Drv_CPUCore_GetCycleCount());
+}
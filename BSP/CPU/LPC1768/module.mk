@@ -41,3 +41,10 @@ CPU_SRC_FILES := $(CPU_PATH)/internal/startup_ARMCM3.s $(shell /usr/bin/find $(C
 
 MODULE_INC_PATHS += \
 	-I$(CPU_PATH)/internal
+
+#
+# UART Driver receives into a lock-free ring buffer
+#
+include $(ROOT_PATH)/Environment/Lib/RingBuffer/module.mk
+
+CPU_SRC_FILES += $(RINGBUFFER_SRC_FILES)
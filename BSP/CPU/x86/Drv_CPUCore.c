@@ -1,6 +1,91 @@
+/*******************************************************************************
+ *
+ * @file Drv_CPUCore.c
+ *
+ * @author MC
+ *
+ * @brief Simulated CPU Core for x86
+ *
+ *        Host builds (make PROJECT=<Project> ENV=x86) run on simulated CPU.
+ *        SystemInit configures simulation from environment variables:
+ *          - SIM_FLASH_FILE : Flash content is kept in this file, so an
+ *                             image persists between runs (RAM otherwise)
+ *
+ *        Jumping to an image ends execution of simulated CPU.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+#include <stdlib.h>
+
 #include "Drv_CPUCore.h"
 
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Environment variable of flash file */
+#define CPU_SIM_FLASH_FILE_VARIABLE				"SIM_FLASH_FILE"
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/* Simulation only functions of flash driver (see Drv_Flash.c) */
+bool Drv_Flash_SimulateFile(const char* path);
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Initializes simulated CPU, counterpart of CMSIS SystemInit
+ */
+void SystemInit(void)
+{
+	const char* flashFile = getenv(CPU_SIM_FLASH_FILE_VARIABLE);
+
+	if ((flashFile != NULL) && !Drv_Flash_SimulateFile(flashFile))
+	{
+		printf("\nCPU Sim: flash file %s cannot be mapped, RAM is used", flashFile);
+	}
+}
+
+/*
+ * Simulated CPU clock does not change
+ */
+void SystemCoreClockUpdate(void)
+{
+}
+
 void Drv_CPUCore_JumpToImage(reg32_t imageAddress)
 {
-	// Do nothing for now
+	printf("\nCPU Sim: jump to image 0x%08X\n", (uint32_t)imageAddress);
+	fflush(stdout);
+}
+
+bool Drv_CPUCore_IsWatchdogReset(void)
+{
+	return false;
+}
+
+uint32_t Drv_CPUCore_IncrementBootCount(void)
+{
+	static uint32_t bootCount;
+
+	return ++bootCount;
+}
+
+void Drv_CPUCore_StartCycleCounter(void)
+{
+}
+
+uint32_t Drv_CPUCore_GetCycleCount(void)
+{
+	return 0;
 }
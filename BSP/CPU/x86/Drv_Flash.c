@@ -1,87 +1,409 @@
 /*******************************************************************************
-*
-* @file Drv_Flash.h
-*
-* @author MC
-*
-* @brief Flash Driver Interface
-*
-* @see
-*
-******************************************************************************
-*
-*  Copyright (2016), P-OS
-*
-*   This software may be modified and distributed under the terms of the
-*   'MIT License'.
-*
-*   See the LICENSE file for details.
-*
-******************************************************************************/
-
-#ifndef __DRV_FLASH_H
-#define __DRV_FLASH_H
+ *
+ * @file Drv_Flash.c
+ *
+ * @author MC
+ *
+ * @brief Simulated Flash Driver for x86
+ *
+ *        Simulates LPC1768 flash and its IAP commands, so flash users can be
+ *        tested and benchmarked on host:
+ *          - Sector map of LPC1768, 16 x 4K sectors and 14 x 32K sectors
+ *          - Sectors must be prepared before each erase and write command,
+ *            a successful command protects its sectors again
+ *          - Write programs only erased bytes. Destination is 256 byte
+ *            aligned and byte count is 256, 512, 1024 or 4096 like IAP.
+ *          - Erase and program take time of IAP commands on a simulated
+ *            clock. Commands are blocking like IAP by default. Otherwise
+ *            they complete in background and a command which is issued
+ *            before previous one is completed returns FLASH_STATUS_BUSY.
+ *          - Number of erases of each sector (wear)
+ *
+ *        Flash content is kept in RAM or in a memory mapped file, so an
+ *        image persists between runs. Simulation only functions are not
+ *        part of driver interface (Drv_Flash.h).
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/* mmap and ftruncate */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE								200112L
+#endif
 
 /********************************* INCLUDES ***********************************/
 #include "Drv_Flash.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "postypes.h"
 
 /***************************** MACRO DEFINITIONS ******************************/
 
-#define FLASH_LPC17xx_32KPAGES_START_ADDRESS        (0x10000)
+/* LPC1768 has 512K Flash */
 #define FLASH_LPC17xx_FLASH_SIZE                    (0x80000)
+/* 32K Block starts from 0x10000 address */
+#define FLASH_LPC17xx_32KPAGES_START_ADDRESS        (0x10000)
+/* LPC1768 has 16 4K blocks*/
 #define FLASH_LPC17xx_4K_BLOCK_COUNT                (16)
+/* 4K Block size */
 #define FLASH_4K_BLOCK_SIZE                         (4 * 1024)
+/* 32K Block size */
 #define FLASH_32K_BLOCK_SIZE                        (32 * 1024)
 
+/* Number of all blocks */
+#define FLASH_SIM_BLOCK_COUNT						(FLASH_LPC17xx_4K_BLOCK_COUNT + \
+													 ((FLASH_LPC17xx_FLASH_SIZE - FLASH_LPC17xx_32KPAGES_START_ADDRESS) / FLASH_32K_BLOCK_SIZE))
+
+/* Erased flash value */
+#define FLASH_SIM_ERASED_VALUE						(0xFF)
+
+/* Write destination alignment of IAP (Copy RAM to Flash) */
+#define FLASH_SIM_WRITE_ALIGNMENT					(256)
+
+/* Erase time of a sector and program time of 256 bytes (LPC1768 datasheet) */
+#define FLASH_SIM_SECTOR_ERASE_TIME_IN_US			(100 * 1000)
+#define FLASH_SIM_PAGE_PROGRAM_TIME_IN_US			(1000)
 
 /***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Simulated flash
+ */
+typedef struct
+{
+	/* Flash content, RAM or memory mapped file */
+	uint8_t* memory;
+	/* Blocks which are prepared for next erase or write command */
+	bool prepared[FLASH_SIM_BLOCK_COUNT];
+	/* Number of erases of each block */
+	uint32_t eraseCounts[FLASH_SIM_BLOCK_COUNT];
+	/* Simulated clock and completion time of last command */
+	uint64_t timeInUs;
+	uint64_t busyUntilInUs;
+	/* Commands complete in background (non-blocking) */
+	bool background;
+} FlashSim;
 
 /**************************** FUNCTION PROTOTYPES *****************************/
 
 /******************************** VARIABLES ***********************************/
 
+/* Flash content if it is not mapped to a file */
+PRIVATE uint8_t flashRAM[FLASH_LPC17xx_FLASH_SIZE];
+
+PRIVATE FlashSim flashSim;
+
 /**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns flash content, RAM is erased on first use
+ */
+PRIVATE uint8_t* getMemory(void)
+{
+	if (flashSim.memory == NULL)
+	{
+		memset(flashRAM, FLASH_SIM_ERASED_VALUE, sizeof(flashRAM));
+		flashSim.memory = flashRAM;
+	}
+
+	return flashSim.memory;
+}
+
+/**
+ * Returns start address of specified block
+ */
+PRIVATE uint32_t getBlockAddress(uint32_t blockNo)
+{
+	if (blockNo < FLASH_LPC17xx_4K_BLOCK_COUNT)
+	{
+		return blockNo * FLASH_4K_BLOCK_SIZE;
+	}
+
+	return FLASH_LPC17xx_32KPAGES_START_ADDRESS + ((blockNo - FLASH_LPC17xx_4K_BLOCK_COUNT) * FLASH_32K_BLOCK_SIZE);
+}
+
+/*
+ * Checks whether block range is valid like IAP
+ */
+PRIVATE bool isValidBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	return (startBlockNo <= endBlockNo) && (endBlockNo < FLASH_SIM_BLOCK_COUNT);
+}
+
+/*
+ * Checks whether all blocks of range are prepared
+ */
+PRIVATE bool isPrepared(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint32_t blockNo;
+
+	for (blockNo = startBlockNo; blockNo <= endBlockNo; blockNo++)
+	{
+		if (!flashSim.prepared[blockNo])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Protects blocks again after a successful erase or write command
+ */
+PRIVATE void protectBlocks(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint32_t blockNo;
+
+	for (blockNo = startBlockNo; blockNo <= endBlockNo; blockNo++)
+	{
+		flashSim.prepared[blockNo] = false;
+	}
+}
+
+/*
+ * Checks whether flash controller is still running previous command
+ */
+PRIVATE ALWAYS_INLINE bool isBusy(void)
+{
+	return flashSim.timeInUs < flashSim.busyUntilInUs;
+}
+
+/*
+ * Starts a command which takes given time. IAP returns when command is
+ * completed, so clock advances unless commands run in background.
+ */
+PRIVATE void runCommand(uint32_t durationInUs)
+{
+	flashSim.busyUntilInUs = flashSim.timeInUs + durationInUs;
+
+	if (!flashSim.background)
+	{
+		flashSim.timeInUs = flashSim.busyUntilInUs;
+	}
+}
+
+/*
+ * Checks whether a range is erased
+ */
+PRIVATE bool isBlank(uint32_t address, uint32_t length)
+{
+	const uint8_t* memory = getMemory();
+
+	while (length-- > 0)
+	{
+		if (memory[address++] != FLASH_SIM_ERASED_VALUE)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
 
 /***************************** PUBLIC FUNCTIONS *******************************/
+/**
+ * Initializes Flash Driver
+ */
 void Drv_Flash_Init(void)
 {
+	(void)getMemory();
+}
+
+/**
+ * Prepares Block for Write/Erase operations
+ */
+int32_t Drv_Flash_PrepareBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint32_t blockNo;
 
+	if (isBusy())
+	{
+		return FLASH_STATUS_BUSY;
+	}
+
+	if (!isValidBlockRange(startBlockNo, endBlockNo))
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	for (blockNo = startBlockNo; blockNo <= endBlockNo; blockNo++)
+	{
+		flashSim.prepared[blockNo] = true;
+	}
+
+	return FLASH_STATUS_SUCCESS;
 }
 
 int32_t Drv_Flash_PrepareBlock(uint32_t blockNo)
 {
-	return 0;
+	return Drv_Flash_PrepareBlockRange(blockNo, blockNo);
 }
 
-int32_t Drv_Flash_PrepareBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+/**
+ * Erases range of blocks.
+ *  Drv_Flash_PrepareBlock must be called before
+ */
+int32_t Drv_Flash_EraseBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
 {
-	return 0;
+	uint32_t blockNo;
+	uint32_t startAddress;
+	uint32_t endAddress;
+
+	if (isBusy())
+	{
+		return FLASH_STATUS_BUSY;
+	}
+
+	if (!isValidBlockRange(startBlockNo, endBlockNo) || !isPrepared(startBlockNo, endBlockNo))
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	startAddress = getBlockAddress(startBlockNo);
+	endAddress = (endBlockNo + 1 < FLASH_SIM_BLOCK_COUNT) ? getBlockAddress(endBlockNo + 1) : FLASH_LPC17xx_FLASH_SIZE;
+
+	memset(&getMemory()[startAddress], FLASH_SIM_ERASED_VALUE, endAddress - startAddress);
+
+	for (blockNo = startBlockNo; blockNo <= endBlockNo; blockNo++)
+	{
+		flashSim.eraseCounts[blockNo]++;
+	}
+
+	protectBlocks(startBlockNo, endBlockNo);
+	runCommand((endBlockNo - startBlockNo + 1) * FLASH_SIM_SECTOR_ERASE_TIME_IN_US);
+
+	return FLASH_STATUS_SUCCESS;
 }
 
+/**
+ * Erases single block
+ *  Drv_Flash_PrepareBlock must be called before
+ */
 int32_t Drv_Flash_EraseBlock(uint32_t blockNo)
 {
-	return 0;
+	return Drv_Flash_EraseBlockRange(blockNo, blockNo);
 }
-int32_t Drv_Flash_EraseBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+
+/**
+ * Checks whether range of blocks is blank.
+ *  Does not require preparation.
+ */
+int32_t Drv_Flash_BlankCheckBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
 {
-	return 0;
+	uint32_t startAddress;
+	uint32_t endAddress;
+
+	if (isBusy())
+	{
+		return FLASH_STATUS_BUSY;
+	}
+
+	if (!isValidBlockRange(startBlockNo, endBlockNo))
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	startAddress = getBlockAddress(startBlockNo);
+	endAddress = (endBlockNo + 1 < FLASH_SIM_BLOCK_COUNT) ? getBlockAddress(endBlockNo + 1) : FLASH_LPC17xx_FLASH_SIZE;
+
+	return isBlank(startAddress, endAddress - startAddress) ? FLASH_STATUS_SUCCESS : FLASH_STATUS_NOT_BLANK;
 }
 
+/**
+ * Writes data to flash address
+ *  Drv_Flash_PrepareBlock must be called before. Written area must be
+ *  erased, NOR flash cannot program a cell twice.
+ */
 int32_t Drv_Flash_Write(uint32_t address, uint8_t* data, uint32_t length)
 {
-	return 0;
+	int32_t startBlockNo;
+	int32_t endBlockNo;
+
+	if (isBusy())
+	{
+		return FLASH_STATUS_BUSY;
+	}
+
+	if (((length != 256) && (length != 512) && (length != 1024) && (length != 4096)) ||
+		(address % FLASH_SIM_WRITE_ALIGNMENT != 0) ||
+		(address >= FLASH_LPC17xx_FLASH_SIZE) ||
+		(length > FLASH_LPC17xx_FLASH_SIZE - address))
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	startBlockNo = Drv_Flash_GetBlockNoOfAddress(address);
+	endBlockNo = Drv_Flash_GetBlockNoOfAddress(address + length - 1);
+
+	if (!isPrepared((uint32_t)startBlockNo, (uint32_t)endBlockNo) || !isBlank(address, length))
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	memcpy(&getMemory()[address], data, length);
+
+	protectBlocks((uint32_t)startBlockNo, (uint32_t)endBlockNo);
+	runCommand((length / FLASH_SIM_WRITE_ALIGNMENT) * FLASH_SIM_PAGE_PROGRAM_TIME_IN_US);
+
+	return FLASH_STATUS_SUCCESS;
 }
 
+/**
+ * Writes data to block (from start address of block)
+ *  Drv_Flash_PrepareBlock must be called before
+ */
 int32_t Drv_Flash_WriteBlock(uint32_t blockNo, uint8_t* data, uint32_t length)
 {
-	return 0;
+	return Drv_Flash_Write(getBlockAddress(blockNo), data, length);
+}
+
+/**
+ * Reads flash content
+ */
+int32_t Drv_Flash_Read(uint32_t address, uint8_t* data, uint32_t length)
+{
+	if ((address >= FLASH_LPC17xx_FLASH_SIZE) || (length > FLASH_LPC17xx_FLASH_SIZE - address))
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	memcpy(data, &getMemory()[address], length);
+
+	return FLASH_STATUS_SUCCESS;
 }
 
 int32_t Drv_Flash_GetBlockNoOfAddress(uint32_t address)
 {
-	return 0;
+	if (address >= FLASH_LPC17xx_FLASH_SIZE)
+	{
+		return -1;
+	}
+
+	if (address < FLASH_LPC17xx_32KPAGES_START_ADDRESS)
+	{
+		return (int32_t)(address / FLASH_4K_BLOCK_SIZE);
+	}
+
+	return (int32_t)(FLASH_LPC17xx_4K_BLOCK_COUNT + ((address - FLASH_LPC17xx_32KPAGES_START_ADDRESS) / FLASH_32K_BLOCK_SIZE));
+}
+
+uint32_t Drv_Flash_GetBlockAddress(uint32_t blockNo)
+{
+	return getBlockAddress(blockNo);
 }
 
 uint32_t Drv_Flash_GetSize(void)
@@ -89,4 +411,133 @@ uint32_t Drv_Flash_GetSize(void)
 	return FLASH_LPC17xx_FLASH_SIZE;
 }
 
-#endif	/* __DRV_FLASH_H */
+int32_t Drv_Flash_ReadDeviceSerialNumber(uint32_t* serialNumber)
+{
+	memset(serialNumber, 0, FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT * sizeof(uint32_t));
+
+	return FLASH_STATUS_SUCCESS;
+}
+
+/*
+ * Keeps flash content in a file. A new file (or a file of another size) is
+ * erased. NULL path unmaps file, erased RAM is used again. Simulation only
+ * function.
+ *
+ * @return true if file is mapped, RAM is used otherwise
+ */
+bool Drv_Flash_SimulateFile(const char* path)
+{
+#ifdef _WIN32
+	(void)path;
+
+	return false;
+#else
+	struct stat fileStatus;
+	uint8_t* memory;
+	bool created;
+	int file;
+
+	if (path == NULL)
+	{
+		if ((flashSim.memory != NULL) && (flashSim.memory != flashRAM))
+		{
+			munmap(flashSim.memory, FLASH_LPC17xx_FLASH_SIZE);
+		}
+
+		flashSim.memory = NULL;
+
+		return false;
+	}
+
+	file = open(path, O_RDWR | O_CREAT, 0644);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	created = (fstat(file, &fileStatus) != 0) || (fileStatus.st_size != FLASH_LPC17xx_FLASH_SIZE);
+
+	if (created && ((ftruncate(file, 0) != 0) || (ftruncate(file, FLASH_LPC17xx_FLASH_SIZE) != 0)))
+	{
+		close(file);
+		return false;
+	}
+
+	memory = (uint8_t*)mmap(NULL, FLASH_LPC17xx_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+
+	/* Mapping keeps file open */
+	close(file);
+
+	if (memory == (uint8_t*)MAP_FAILED)
+	{
+		return false;
+	}
+
+	if (created)
+	{
+		memset(memory, FLASH_SIM_ERASED_VALUE, FLASH_LPC17xx_FLASH_SIZE);
+	}
+
+	if ((flashSim.memory != NULL) && (flashSim.memory != flashRAM))
+	{
+		munmap(flashSim.memory, FLASH_LPC17xx_FLASH_SIZE);
+	}
+
+	flashSim.memory = memory;
+
+	return true;
+#endif
+}
+
+/*
+ * Resets simulated flash. Content is erased unless it is mapped to a file,
+ * clock, wear counters and preparations are cleared. Simulation only
+ * function.
+ */
+void Drv_Flash_SimulateReset(void)
+{
+	bool mapped = (flashSim.memory != NULL) && (flashSim.memory != flashRAM);
+	uint8_t* memory = flashSim.memory;
+
+	memset(&flashSim, 0, sizeof(flashSim));
+
+	if (mapped)
+	{
+		flashSim.memory = memory;
+	}
+}
+
+/*
+ * Selects whether erase and write commands complete in background. Then
+ * clock advances only by Drv_Flash_SimulateElapsedTime. Simulation only
+ * function.
+ */
+void Drv_Flash_SimulateBackgroundCommands(bool enabled)
+{
+	flashSim.background = enabled;
+}
+
+/*
+ * Advances simulated clock. Simulation only function.
+ */
+void Drv_Flash_SimulateElapsedTime(uint32_t timeInUs)
+{
+	flashSim.timeInUs += timeInUs;
+}
+
+/*
+ * Returns simulated clock, it includes duration of blocking commands.
+ * Simulation only function.
+ */
+uint64_t Drv_Flash_GetSimulatedTimeInUs(void)
+{
+	return flashSim.timeInUs;
+}
+
+/*
+ * Returns number of erases of a block. Simulation only function.
+ */
+uint32_t Drv_Flash_GetEraseCount(uint32_t blockNo)
+{
+	return (blockNo < FLASH_SIM_BLOCK_COUNT) ? flashSim.eraseCounts[blockNo] : 0;
+}
@@ -1,28 +1,134 @@
-#include "Drv_UserTimer.h"
+/*******************************************************************************
+ *
+ * @file Drv_Timer.c
+ *
+ * @author MC
+ *
+ * @brief Simulated Timer Driver for x86
+ *
+ *        Elapsed time is host time plus time of simulated flash commands,
+ *        since simulated flash completes commands without waiting (see
+ *        Drv_Flash.c). So measured durations include erase and program
+ *        times of LPC1768 flash. Timeout callbacks are not raised.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/* clock_gettime */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE								200112L
+#endif
+
+/********************************* INCLUDES ***********************************/
+#include <time.h>
+
 #include "Drv_Timer.h"
 
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of timers, same as LPC1768 */
+#define TIMER_SIM_TIMER_COUNT						(4)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Simulated Timer
+ */
+typedef struct
+{
+	/* Client callback, kept for interface compatibility */
+	DrvTimerCallback timerCallback;
+	/* Time of last start */
+	uint64_t startTimeInUs;
+} SimTimer;
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/* Simulation only function of flash driver (see Drv_Flash.c) */
+uint64_t Drv_Flash_GetSimulatedTimeInUs(void);
+
+/******************************** VARIABLES ***********************************/
+
+PRIVATE SimTimer timers[TIMER_SIM_TIMER_COUNT];
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns simulated time, host time and duration of simulated flash commands
+ */
+PRIVATE uint64_t getTimeInUs(void)
+{
+	uint64_t hostTimeInUs;
+
+#ifdef _WIN32
+	hostTimeInUs = ((uint64_t)clock() * 1000000) / CLOCKS_PER_SEC;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	hostTimeInUs = ((uint64_t)now.tv_sec * 1000000) + ((uint64_t)now.tv_nsec / 1000);
+#endif
+
+	return hostTimeInUs + Drv_Flash_GetSimulatedTimeInUs();
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
 void Drv_Timer_Init(void)
 {
+	memset(timers, 0, sizeof(timers));
 }
 
 TimerHandle Drv_Timer_Create(TimerNo timerNo,
 	DrvTimerPriority priority,
 	DrvTimerCallback timerCallback)
 {
-	return DRV_TIMER_INVALID_HANDLE;
+	(void)priority;
+
+	if ((timerNo >= TIMER_SIM_TIMER_COUNT) || (timerCallback == NULL))
+	{
+		return (TimerHandle)DRV_TIMER_INVALID_HANDLE;
+	}
+
+	timers[timerNo].timerCallback = timerCallback;
+	timers[timerNo].startTimeInUs = getTimeInUs();
+
+	return (TimerHandle)timerNo;
 }
 
 void Drv_Timer_Release(TimerHandle timer)
 {
-
+	if (timer < TIMER_SIM_TIMER_COUNT)
+	{
+		timers[timer].timerCallback = NULL;
+	}
 }
 
 void Drv_Timer_Start(TimerHandle timerHandle, uint32_t timeoutInUs)
 {
+	(void)timeoutInUs;
 
+	if (timerHandle < TIMER_SIM_TIMER_COUNT)
+	{
+		timers[timerHandle].startTimeInUs = getTimeInUs();
+	}
 }
 
 uint32_t Drv_Timer_ReadElapsedTimeInUs(TimerHandle timerHandle)
 {
-	return 0;
+	if (timerHandle >= TIMER_SIM_TIMER_COUNT)
+	{
+		return 0;
+	}
+
+	return (uint32_t)(getTimeInUs() - timers[timerHandle].startTimeInUs);
 }
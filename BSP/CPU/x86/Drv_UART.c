@@ -1,6 +1,56 @@
 
+/*******************************************************************************
+ *
+ * @file Drv_UART.c
+ *
+ * @author MC
+ *
+ * @brief Simulated UART Driver for x86
+ *
+ *        Receives from one of two sources:
+ *          - Test data (TestData.h) which is streamed in chunks with random
+ *            lengths. It is used unless driver is initialized (unit tests).
+ *          - Pseudo terminal which is opened by Drv_UART_Init. Host tools
+ *            (e.g. ImageTool send) open its slave device like a serial port.
+ *            Device name is printed and linked to SIM_UART_LINK environment
+ *            variable if it is set.
+ *
+ *        SIGIO of pseudo terminal is receive interrupt. Its handler reads
+ *        received bytes into a ring buffer and informs client like ISRs of
+ *        LPC17xx driver, so client is single consumer of ring. Bytes which
+ *        do not fit into ring are read when client consumes ring. Baud rate
+ *        is not simulated.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/* Pseudo terminal functions */
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE								600
+#endif
+
 /********************************* INCLUDES ***********************************/
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
 #include "Drv_UART.h"
+#include "RingBuffer.h"
 
 #include "TestData.h"
 
@@ -8,13 +58,57 @@
 #define EXTERNAL_TEST_DATA          1
 #define VALID_DATA                  0
 
+/*
+ * Test data is delivered as a continuous stream in chunks with random
+ * lengths to simulate UART receive timing. So lines are split and glued at
+ * random positions.
+ */
+#define DRV_UART_SIM_DEFAULT_SEED				(1)
+#define DRV_UART_SIM_DEFAULT_MAX_CHUNK_LENGTH	(64)
+
+/* Size of receive ring of pseudo terminal. Must be power of two. */
+#define DRV_UART_SIM_RX_RING_SIZE				(4096)
+
+/* Environment variable of pseudo terminal link */
+#define DRV_UART_SIM_LINK_VARIABLE				"SIM_UART_LINK"
+
 #if EXTERNAL_TEST_DATA
 #define LENGTH_OF_REGULAR		sizeof(testImage) / (sizeof(char*))
-
+#define TEST_DATA				testImage
 #else
 #define LENGTH_OF_REGULAR		sizeof(regularIntelHex) / (sizeof(char*))
+#define TEST_DATA				regularIntelHex
 #endif
 /***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Simulated receive stream
+ */
+typedef struct
+{
+	/* Currently delivered test data entry */
+	uint32_t entryIndex;
+	/* Offset in currently delivered entry */
+	uint32_t entryOffset;
+	/* Random seed for chunk lengths */
+	uint32_t seed;
+	/* Maximum length of a chunk */
+	uint32_t maxChunkLength;
+	/* Unread bytes of last received chunk */
+	uint32_t chunkRemaining;
+} UARTSimStream;
+
+/*
+ * Pseudo terminal
+ */
+typedef struct
+{
+	/* Master side, -1 if test data is streamed */
+	int masterFd;
+	/* Slave side is kept open, so master is not hung up when a tool closes it */
+	int slaveFd;
+	/* Received bytes, produced by SIGIO handler and consumed by client */
+	RingBuffer rxRing;
+} UARTSimTerminal;
 
 /**************************** FUNCTION PROTOTYPES *****************************/
 
@@ -68,48 +162,398 @@ PRIVATE char* regularIntelHex[] =
 
 #endif
 
-UARTDataReceivedEventHandler evHandler;
-PRIVATE uint32_t index = 0;
+PRIVATE UARTDataReceivedEventHandler evHandler;
+
+/* Simulated receive stream */
+PRIVATE UARTSimStream simStream =
+{
+	0, 0, DRV_UART_SIM_DEFAULT_SEED, DRV_UART_SIM_DEFAULT_MAX_CHUNK_LENGTH, 0
+};
+
+/* Pseudo terminal and storage of its receive ring */
+PRIVATE UARTSimTerminal simTerminal = { -1, -1, { NULL, 0, 0, 0 } };
+PRIVATE uint8_t rxRingStorage[DRV_UART_SIM_RX_RING_SIZE];
 
 /**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns next chunk length using a linear congruential generator
+ */
+PRIVATE uint32_t nextChunkLength(void)
+{
+	simStream.seed = (simStream.seed * 1103515245) + 12345;
+
+	return 1 + ((simStream.seed >> 16) % simStream.maxChunkLength);
+}
+
+/*
+ * Checks whether pseudo terminal is used instead of test data
+ */
+PRIVATE ALWAYS_INLINE bool isTerminalUsed(void)
+{
+	return (simTerminal.masterFd >= 0);
+}
+
+#ifndef _WIN32
+/*
+ * Reads bytes which are waiting in pseudo terminal into receive ring.
+ *	Producer side of receive ring, called from SIGIO handler or while SIGIO
+ *	is blocked.
+ */
+PRIVATE void publishReceivedData(void)
+{
+	uint8_t* span;
+	uint32_t freeLength;
+	ssize_t readLength;
+	bool received = false;
+
+	/* Bytes which do not fit into ring are left in pseudo terminal */
+	while ((freeLength = RingBuffer_GetWriteSpan(&simTerminal.rxRing, &span)) > 0)
+	{
+		readLength = read(simTerminal.masterFd, span, freeLength);
+		if (readLength <= 0)
+		{
+			break;
+		}
+
+		RingBuffer_CommitWrite(&simTerminal.rxRing, (uint32_t)readLength);
+		received = true;
+	}
+
+	if (received)
+	{
+		evHandler();
+	}
+}
+
+/*
+ * SIGIO Handler, receive interrupt of pseudo terminal
+ */
+PRIVATE void receiveSignalHandler(int signalNo)
+{
+	int savedErrno = errno;
+
+	(void)signalNo;
+
+	publishReceivedData();
+
+	errno = savedErrno;
+}
+
+/*
+ * Masks receive interrupt (SIGIO)
+ */
+PRIVATE void blockReceiveSignal(bool block)
+{
+	sigset_t signals;
+
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGIO);
+
+	sigprocmask(block ? SIG_BLOCK : SIG_UNBLOCK, &signals, NULL);
+}
+
+/*
+ * Enables or disables receive interrupt (SIGIO) of pseudo terminal
+ */
+PRIVATE void enableReceiveSignal(bool enable)
+{
+	struct sigaction action;
+
+	if (enable)
+	{
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = receiveSignalHandler;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGIO, &action, NULL);
+
+		fcntl(simTerminal.masterFd, F_SETOWN, getpid());
+		fcntl(simTerminal.masterFd, F_SETFL, O_NONBLOCK | O_ASYNC);
+	}
+	else
+	{
+		fcntl(simTerminal.masterFd, F_SETFL, O_NONBLOCK);
+	}
+}
+
+/*
+ * Opens pseudo terminal in raw mode (8N1)
+ *
+ * @param linkPath Path of symbolic link to slave device, NULL if not linked
+ *
+ * @return true if pseudo terminal is opened
+ */
+PRIVATE bool openTerminal(const char* linkPath)
+{
+	struct termios options;
+	const char* slaveName;
+	int masterFd;
+	int slaveFd;
+
+	masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (masterFd < 0)
+	{
+		return false;
+	}
+
+	slaveName = ((grantpt(masterFd) == 0) && (unlockpt(masterFd) == 0)) ? ptsname(masterFd) : NULL;
+	slaveFd = (slaveName != NULL) ? open(slaveName, O_RDWR | O_NOCTTY) : -1;
+
+	if ((slaveFd < 0) || (tcgetattr(slaveFd, &options) != 0))
+	{
+		if (slaveFd >= 0)
+		{
+			close(slaveFd);
+		}
+
+		close(masterFd);
+		return false;
+	}
+
+	/* Bytes are not processed or echoed by line discipline */
+	options.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+	options.c_oflag &= ~OPOST;
+	options.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	options.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+	options.c_cflag |= CS8;
+	tcsetattr(slaveFd, TCSANOW, &options);
+
+	if (linkPath != NULL)
+	{
+		unlink(linkPath);
+
+		if (symlink(slaveName, linkPath) != 0)
+		{
+			printf("\nUART Sim: link %s cannot be created", linkPath);
+		}
+	}
+
+	fcntl(masterFd, F_SETFL, O_NONBLOCK);
+
+	simTerminal.masterFd = masterFd;
+	simTerminal.slaveFd = slaveFd;
+
+	printf("\nUART Sim: %s\n", slaveName);
+	fflush(stdout);
+
+	return true;
+}
+
+/*
+ * Writes bytes into pseudo terminal, waits while terminal is full
+ */
+PRIVATE int32_t sendToTerminal(const uint8_t* sendBuffer, uint32_t sendLength)
+{
+	struct pollfd pollFd = { simTerminal.masterFd, POLLOUT, 0 };
+	uint32_t sentLength = 0;
+	ssize_t written;
+
+	while (sentLength < sendLength)
+	{
+		written = write(simTerminal.masterFd, &sendBuffer[sentLength], sendLength - sentLength);
+		if (written > 0)
+		{
+			sentLength += (uint32_t)written;
+		}
+		else if ((written < 0) && (errno != EAGAIN) && (errno != EINTR))
+		{
+			return -1;
+		}
+		else
+		{
+			(void)poll(&pollFd, 1, -1);
+		}
+	}
+
+	return (int32_t)sentLength;
+}
+#endif
 
 /***************************** PUBLIC FUNCTIONS *******************************/
 void Drv_UART_Init(void)
 {
+#ifndef _WIN32
+	if (!isTerminalUsed() && !openTerminal(getenv(DRV_UART_SIM_LINK_VARIABLE)))
+	{
+		printf("\nUART Sim: pseudo terminal cannot be opened, test data is used\n");
+	}
+#endif
+}
 
+/*
+ * Configures chunk boundaries of simulated receive stream.
+ *	Simulation only function. Stream is restarted from beginning.
+ */
+void Drv_UART_SimulateChunks(uint32_t seed, uint32_t maxChunkLength)
+{
+	simStream.entryIndex = 0;
+	simStream.entryOffset = 0;
+	simStream.seed = seed;
+	simStream.maxChunkLength = MATH_MAX(maxChunkLength, 1);
+	simStream.chunkRemaining = 0;
 }
 
 UartHandle Drv_UART_Get(uint32_t uartNo, uint32_t baudRate, UARTDataReceivedEventHandler dataReceivedEventHandler)
 {
+	(void)baudRate;
+
 	evHandler = dataReceivedEventHandler;
 
+#ifndef _WIN32
+	if (isTerminalUsed())
+	{
+		RingBuffer_Init(&simTerminal.rxRing, rxRingStorage, DRV_UART_SIM_RX_RING_SIZE);
+
+		/* Bytes which are received before are read with interrupt masked */
+		blockReceiveSignal(true);
+		enableReceiveSignal(true);
+		publishReceivedData();
+		blockReceiveSignal(false);
+
+		return (UartHandle)uartNo;
+	}
+#endif
+
 	evHandler();
 
-	return uartNo;
+	return (UartHandle)uartNo;
 }
 
 void Drv_UART_Release(UartHandle uart)
 {
+	(void)uart;
+
+#ifndef _WIN32
+	if (isTerminalUsed())
+	{
+		enableReceiveSignal(false);
+	}
+#endif
 }
 
-int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength)
+int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength)
 {
-	int32_t msgLeng;
-	const char* hexLine;
-#if EXTERNAL_TEST_DATA
-	hexLine = testImage[index];
-#else
-	hexLine = regularIntelHex[index];
+	(void)uart;
+
+#ifndef _WIN32
+	if (isTerminalUsed())
+	{
+		return sendToTerminal(sendBuffer, sendLength);
+	}
 #endif
 
-	msgLeng = strlen(hexLine);
+	(void)sendBuffer;
 
-	memcpy(receiveBuffer, hexLine, msgLeng);
+	/* Simulated host does not process responses, drop them */
+	return (int32_t)sendLength;
+}
 
-	if (index++ < LENGTH_OF_REGULAR)
-		evHandler();
-	else
+int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength)
+{
+	uint8_t* span;
+	int32_t spanLength;
+	uint32_t copyLength;
+	uint32_t receivedLength = 0;
+
+	if (isTerminalUsed())
+	{
+		receivedLength = RingBuffer_Read(&simTerminal.rxRing, receiveBuffer, receiveLength);
+
+		/* Inform client about remaining data */
+		if (RingBuffer_GetCount(&simTerminal.rxRing) > 0)
+		{
+			evHandler();
+		}
+
+		return (int32_t)receivedLength;
+	}
+
+	/* Copy a chunk, chunk can include parts of several entries */
+	do
+	{
+		spanLength = Drv_UART_PeekSpan(uart, &span);
+		if (spanLength < 0)
+		{
+			break;
+		}
+
+		copyLength = MATH_MIN((uint32_t)spanLength, receiveLength - receivedLength);
+
+		memcpy(&receiveBuffer[receivedLength], span, copyLength);
+
+		Drv_UART_Consume(uart, copyLength);
+
+		receivedLength += copyLength;
+	} while ((receivedLength < receiveLength) && (simStream.chunkRemaining > 0));
+
+	return (receivedLength > 0) ? (int32_t)receivedLength : spanLength;
+}
+
+int32_t Drv_UART_PeekSpan(UartHandle uart, uint8_t** span)
+{
+	const char* entry;
+
+	(void)uart;
+
+	if (isTerminalUsed())
+	{
+		return (int32_t)RingBuffer_GetReadSpan(&simTerminal.rxRing, span);
+	}
+
+	if (simStream.entryIndex >= LENGTH_OF_REGULAR)
+	{
 		return -1;
+	}
 
-	return msgLeng;
+	/* Next chunk arrives when previous one is consumed */
+	if (simStream.chunkRemaining == 0)
+	{
+		simStream.chunkRemaining = nextChunkLength();
+	}
+
+	/* Span ends at end of chunk or test data entry */
+	entry = TEST_DATA[simStream.entryIndex];
+	*span = (uint8_t*)&entry[simStream.entryOffset];
+
+	return (int32_t)MATH_MIN(simStream.chunkRemaining, (uint32_t)strlen(entry) - simStream.entryOffset);
+}
+
+void Drv_UART_Consume(UartHandle uart, uint32_t length)
+{
+	(void)uart;
+
+	if (isTerminalUsed())
+	{
+		RingBuffer_Consume(&simTerminal.rxRing, length);
+
+#ifndef _WIN32
+		/* Bytes which did not fit into ring are read with interrupt masked */
+		blockReceiveSignal(true);
+		publishReceivedData();
+		blockReceiveSignal(false);
+#endif
+
+		/* Inform client about remaining data */
+		if (RingBuffer_GetCount(&simTerminal.rxRing) > 0)
+		{
+			evHandler();
+		}
+
+		return;
+	}
+
+	simStream.chunkRemaining -= length;
+	simStream.entryOffset += length;
+
+	if (simStream.entryOffset == strlen(TEST_DATA[simStream.entryIndex]))
+	{
+		simStream.entryIndex++;
+		simStream.entryOffset = 0;
+	}
+
+	/* Inform client about remaining data */
+	if (simStream.entryIndex < LENGTH_OF_REGULAR)
+	{
+		evHandler();
+	}
 }
@@ -0,0 +1,269 @@
+/*******************************************************************************
+ *
+ * @file unittest_Flash.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for simulated Flash Driver of x86
+ *
+ *		  Checks IAP rules (preparation, erase before write, write size and
+ *		  alignment), timing model, busy responses, wear counters and file
+ *		  backed content.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include simulated flash driver for WHITE-BOX unit testing */
+#include "../Drv_Flash.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Flash content of file backed tests, in output folder of unit test */
+#define TEST_FLASH_FILE					"out/UnitTest/Flash/SimulatedFlash.bin"
+
+/* First 32K block */
+#define TEST_32K_BLOCK_NO				(FLASH_LPC17xx_4K_BLOCK_COUNT)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Data which is written by tests */
+PRIVATE uint8_t data[FLASH_4K_BLOCK_SIZE];
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	uint32_t index;
+
+	Drv_Flash_SimulateReset();
+	Drv_Flash_Init();
+
+	for (index = 0; index < sizeof(data); index++)
+	{
+		data[index] = (uint8_t)(index * 7);
+	}
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/*
+ * Prepares and writes data
+ */
+PRIVATE int32_t prepareAndWrite(uint32_t address, uint32_t length)
+{
+	int32_t blockNo = Drv_Flash_GetBlockNoOfAddress(address);
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlock((uint32_t)blockNo));
+
+	return Drv_Flash_Write(address, data, length);
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+/*
+ * Tests sector map of LPC1768
+ */
+void test_Flash_SectorMap(void)
+{
+	TEST_ASSERT_EQUAL_HEX32(0x80000, Drv_Flash_GetSize());
+
+	TEST_ASSERT_EQUAL(0, Drv_Flash_GetBlockNoOfAddress(0));
+	TEST_ASSERT_EQUAL(15, Drv_Flash_GetBlockNoOfAddress(0xFFFF));
+	TEST_ASSERT_EQUAL(16, Drv_Flash_GetBlockNoOfAddress(0x10000));
+	TEST_ASSERT_EQUAL(29, Drv_Flash_GetBlockNoOfAddress(0x7FFFF));
+	TEST_ASSERT_EQUAL(-1, Drv_Flash_GetBlockNoOfAddress(0x80000));
+
+	TEST_ASSERT_EQUAL_HEX32(0xF000, Drv_Flash_GetBlockAddress(15));
+	TEST_ASSERT_EQUAL_HEX32(0x10000, Drv_Flash_GetBlockAddress(16));
+	TEST_ASSERT_EQUAL_HEX32(0x78000, Drv_Flash_GetBlockAddress(29));
+
+	/* Flash is erased initially */
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_BlankCheckBlockRange(0, 29));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, Drv_Flash_BlankCheckBlockRange(0, 30));
+}
+
+/*
+ * Tests that each erase and write command requires preparation
+ */
+void test_Flash_PrepareBeforeEraseAndWrite(void)
+{
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, Drv_Flash_EraseBlock(1));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, Drv_Flash_Write(0x1000, data, 256));
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlockRange(1, 2));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_Write(0x1000, data, 256));
+
+	/* Successful command protects its sector again */
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, Drv_Flash_Write(0x1100, data, 256));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, Drv_Flash_EraseBlockRange(1, 2));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlock(2));
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlock(1));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlock(1));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_BlankCheckBlockRange(1, 1));
+}
+
+/*
+ * Tests that only erased area can be programmed
+ */
+void test_Flash_EraseBeforeWrite(void)
+{
+	uint8_t readData[256];
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x10000, 512));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_NOT_BLANK, Drv_Flash_BlankCheckBlockRange(TEST_32K_BLOCK_NO, TEST_32K_BLOCK_NO));
+
+	/* Written area cannot be programmed again, rest of block can */
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x10100, 256));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_Write(0x10200, &data[512], 256));
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_Read(0x10100, readData, sizeof(readData)));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(&data[256], readData, sizeof(readData));
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlock(TEST_32K_BLOCK_NO));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlock(TEST_32K_BLOCK_NO));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x10100, 256));
+}
+
+/*
+ * Tests write sizes and alignment of IAP
+ */
+void test_Flash_WriteSizeAndAlignment(void)
+{
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x2000, 128));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x2000, 768));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x2080, 256));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x7FF00, 512));
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x2000, 1024));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x3000, 4096));
+
+	/* Write which crosses a sector requires preparation of both sectors */
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x4800, 4096));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlockRange(4, 5));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_Write(0x4800, data, 4096));
+}
+
+/*
+ * Tests duration of blocking erase and write commands
+ */
+void test_Flash_CommandTiming(void)
+{
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlockRange(16, 17));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlockRange(16, 17));
+	TEST_ASSERT_EQUAL(2 * FLASH_SIM_SECTOR_ERASE_TIME_IN_US, Drv_Flash_GetSimulatedTimeInUs());
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x10000, 1024));
+	TEST_ASSERT_EQUAL((2 * FLASH_SIM_SECTOR_ERASE_TIME_IN_US) + (4 * FLASH_SIM_PAGE_PROGRAM_TIME_IN_US),
+					  Drv_Flash_GetSimulatedTimeInUs());
+
+	/* Blank check and read do not take time */
+	Drv_Flash_BlankCheckBlockRange(0, 29);
+	Drv_Flash_Read(0, data, sizeof(data));
+	TEST_ASSERT_EQUAL((2 * FLASH_SIM_SECTOR_ERASE_TIME_IN_US) + (4 * FLASH_SIM_PAGE_PROGRAM_TIME_IN_US),
+					  Drv_Flash_GetSimulatedTimeInUs());
+}
+
+/*
+ * Tests that commands are rejected while a background command is running
+ */
+void test_Flash_BusyDuringBackgroundCommand(void)
+{
+	Drv_Flash_SimulateBackgroundCommands(true);
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlock(3));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlock(3));
+	TEST_ASSERT_EQUAL(0, Drv_Flash_GetSimulatedTimeInUs());
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_BUSY, Drv_Flash_PrepareBlock(3));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_BUSY, Drv_Flash_BlankCheckBlockRange(3, 3));
+
+	Drv_Flash_SimulateElapsedTime(FLASH_SIM_SECTOR_ERASE_TIME_IN_US - 1);
+	TEST_ASSERT_EQUAL(FLASH_STATUS_BUSY, Drv_Flash_Write(0x3000, data, 256));
+
+	Drv_Flash_SimulateElapsedTime(1);
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x3000, 256));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_BUSY, Drv_Flash_PrepareBlock(3));
+}
+
+/*
+ * Tests erase counters of blocks
+ */
+void test_Flash_WearCounters(void)
+{
+	uint32_t index;
+
+	for (index = 0; index < 3; index++)
+	{
+		TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlockRange(20, 21));
+		TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlockRange(20, 21));
+	}
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_PrepareBlock(21));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_EraseBlock(21));
+
+	TEST_ASSERT_EQUAL(0, Drv_Flash_GetEraseCount(19));
+	TEST_ASSERT_EQUAL(3, Drv_Flash_GetEraseCount(20));
+	TEST_ASSERT_EQUAL(4, Drv_Flash_GetEraseCount(21));
+	TEST_ASSERT_EQUAL(0, Drv_Flash_GetEraseCount(30));
+}
+
+/*
+ * Tests that content of file backed flash persists between runs
+ */
+void test_Flash_FileBackedContent(void)
+{
+	uint8_t readData[512];
+
+	remove(TEST_FLASH_FILE);
+
+	/* New file is erased */
+	TEST_ASSERT_TRUE(Drv_Flash_SimulateFile(TEST_FLASH_FILE));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_BlankCheckBlockRange(0, 29));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, prepareAndWrite(0x20000, 512));
+
+	/* Next run */
+	Drv_Flash_SimulateReset();
+	TEST_ASSERT_TRUE(Drv_Flash_SimulateFile(TEST_FLASH_FILE));
+
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_Read(0x20000, readData, sizeof(readData)));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, readData, sizeof(readData));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_FAILURE, prepareAndWrite(0x20000, 256));
+
+	/* RAM is used again */
+	TEST_ASSERT_FALSE(Drv_Flash_SimulateFile(NULL));
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_BlankCheckBlockRange(0, 29));
+
+	TEST_ASSERT_EQUAL(0, remove(TEST_FLASH_FILE));
+	TEST_ASSERT_FALSE(Drv_Flash_SimulateFile("out/UnitTest/Flash/NoFolder/SimulatedFlash.bin"));
+}
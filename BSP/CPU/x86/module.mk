@@ -0,0 +1,37 @@
+################################################################################
+#
+# @file module.mk
+#
+# @author MC
+#
+# @brief x86 (simulated) CPU module make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+#
+# Get all source files (.c files) using 'find' command except UnitTest folder
+#
+CPU_SRC_FILES := $(shell /usr/bin/find $(ROOT_PATH)/BSP/CPU/x86 -mindepth 1 -maxdepth 1 -name "*.c")
+
+#
+# Simulated UART delivers test image of bootloader
+#
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Bootloader/TestData
+
+#
+# UART Driver receives from pseudo terminal into a ring buffer
+#
+include $(ROOT_PATH)/Environment/Lib/RingBuffer/module.mk
+
+CPU_SRC_FILES += $(RINGBUFFER_SRC_FILES)
@@ -0,0 +1,107 @@
+################################################################################
+#
+# @file benchmark.mk
+#
+# @author MC
+#
+# @brief Benchmark make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+# UpgradeLink (default), BootTime, SignatureVerify, HeapAllocator or
+# UpgradeThroughput
+BENCH_TARGET_NAME ?= UpgradeLink
+
+ifeq ($(BENCH_TARGET_NAME),BootTime)
+
+# Real security, verdict and slot modules are included by benchmark file
+BENCH_SRC_FILES = \
+	$(INTELHEX_SRC_FILES) \
+	$(CRC32_SRC_FILES) \
+	$(P256_SRC_FILES) \
+	$(RSA2048_SRC_FILES) \
+	$(ARENA_SRC_FILES) \
+	$(MBEDTLS_SRC_FILES)
+
+else ifeq ($(BENCH_TARGET_NAME),SignatureVerify)
+
+# Real security module, P256 and RSA2048 libraries are included by benchmark file
+BENCH_SRC_FILES = \
+	$(INTELHEX_SRC_FILES) \
+	$(ARENA_SRC_FILES) \
+	$(MBEDTLS_SRC_FILES)
+
+else ifeq ($(BENCH_TARGET_NAME),HeapAllocator)
+
+# Real security module is included by benchmark file
+BENCH_SRC_FILES = \
+	$(INTELHEX_SRC_FILES) \
+	$(P256_SRC_FILES) \
+	$(ARENA_SRC_FILES) \
+	$(MBEDTLS_SRC_FILES)
+
+# Allocators are measured with RSA of mbedTLS, fixed width RSA does not use heap
+BENCH_CFLAGS += \
+	-DBL_SIGNATURE_RSA2048_FIXED_WIDTH=0 \
+	-DMBEDTLS_MEMORY_BUFFER_ALLOC_C
+
+else ifeq ($(BENCH_TARGET_NAME),UpgradeThroughput)
+
+# Upgrade, slot, verdict and security modules are included by benchmark file,
+# flash, timer and CPU are simulated LPC1768 peripherals of x86 BSP
+BENCH_SRC_FILES = \
+	$(ROOT_PATH)/BSP/CPU/x86/Drv_Flash.c \
+	$(ROOT_PATH)/BSP/CPU/x86/Drv_Timer.c \
+	$(ROOT_PATH)/BSP/CPU/x86/Drv_CPUCore.c \
+	$(INTELHEX_SRC_FILES) \
+	$(BINFRAME_SRC_FILES) \
+	$(DELTA_SRC_FILES) \
+	$(LZSS_SRC_FILES) \
+	$(P256_SRC_FILES) \
+	$(RSA2048_SRC_FILES) \
+	$(ARENA_SRC_FILES) \
+	$(MBEDTLS_SRC_FILES)
+
+# Default (A/B slots and journal) or reduced configuration. Reduced one has
+# single image with no journal, so 448K image fits into flash.
+BENCH_CONFIG ?= default
+
+ifeq ($(BENCH_CONFIG),reduced)
+BENCH_CFLAGS += \
+	-DBL_AB_SLOTS_ENABLED=0 \
+	-DBL_UPGRADE_JOURNAL_ENABLED=0
+endif
+
+# Test images and key, report directory and revision of reports
+BENCH_ARGS = \
+	$(ROOT_PATH)/Bootloader/TestData \
+	$(BENCH_OUT_PATH) \
+	$(shell git rev-parse --short HEAD 2> /dev/null)
+
+else
+
+# Host sender is linked, bootloader sources are included by benchmark file
+BENCH_SRC_FILES = \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/ImageSender.c \
+	$(INTELHEX_SRC_FILES) \
+	$(BINFRAME_SRC_FILES) \
+	$(DELTA_SRC_FILES) \
+	$(LZSS_SRC_FILES) \
+	$(ROOT_PATH)/Environment/ExternalLib/mbedTLS/library/sha256.c
+
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Environment/Tools/ImageTool
+
+BENCH_LIBS = -lm
+
+endif
@@ -0,0 +1,203 @@
+/*******************************************************************************
+ *
+ * @file benchmark_BootTime.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for boot time image check.
+ *
+ *        Full validation (SHA-256 of image and RSA-2048 public operation)
+ *        is compared with cached verdict check (SHA-256 of metadata and
+ *        HMAC of record) for several image sizes. Signed test image is
+ *        validated first to check that security module is working, larger
+ *        images reuse its signature so only their timing is meaningful.
+ *
+ *        Target cycles are measured on LPC1768 by BL_BOOT_TIME_MEASUREMENT
+ *        (DWT cycle counter), this benchmark gives host side ratios.
+ *
+ *        [USAGE] : make benchmark BENCH_MODULE=Bootloader BENCH_TARGET_NAME=BootTime
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <time.h>
+
+#include "postypes.h"
+
+/* Flash and CPU core mocks of unit tests are used as device peripherals */
+#include "../UnitTest/Mock/mock_Flash.c"
+#include "../UnitTest/Mock/mock_CPUCore.c"
+
+/* Real security, verdict and slot modules are measured */
+#include "../Bootloader_Security.c"
+#include "../Bootloader_Verdict.c"
+#include "../Bootloader_Slot.c"
+
+#include "IntelHex.h"
+#include "TestData.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of lines in test image */
+#define BENCH_TEST_IMAGE_LINE_COUNT			(sizeof(testImage) / sizeof(char*))
+
+/* Minimum measurement duration of each check */
+#define BENCH_MIN_DURATION_IN_NS			(200000000ULL)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Measured boot check
+ */
+typedef bool(*BenchCheck)(void);
+
+/******************************** VARIABLES ***********************************/
+
+/* Installed firmware in simulated flash */
+PRIVATE FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[FIRMWARE_START_ADDRESS];
+
+/* Digest of last full validation */
+PRIVATE uint8_t imageHash[32];
+
+/* Measured image sizes (excluding metadata) */
+PRIVATE const uint32_t imageSizes[] = { 16 * 1024, 64 * 1024, 256 * 1024, 448 * 1024 - FIRMWARE_METADATA_LENGTH };
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns monotonic time in nanoseconds
+ */
+PRIVATE uint64_t getTimeInNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Writes signed test image into flash
+ */
+PRIVATE bool installTestImage(void)
+{
+	IntelHexLine line;
+	uint32_t parsedLength;
+	uint32_t segmentAddress = 0;
+	uint32_t address;
+	uint32_t index;
+
+	mockFlashReset();
+
+	for (index = 0; index < BENCH_TEST_IMAGE_LINE_COUNT; index++)
+	{
+		if (IntelHex_Parse((uint8_t*)testImage[index], (uint32_t)strlen(testImage[index]), &line, &parsedLength) != IntelHex_Success)
+		{
+			return false;
+		}
+
+		if (line.recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+		{
+			segmentAddress = ((line.data[0] << 8) | line.data[1]) * INTELHEX_SEGMENT_SIZE;
+		}
+		else if (line.recordType == INTELHEX_RECORDTYPE_DATA)
+		{
+			address = segmentAddress + line.address;
+			memcpy(&mockFlash[address], line.data, line.lenght);
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Full validation, result is not checked for resized images
+ */
+PRIVATE bool validateImage(void)
+{
+	return (BL_ValidateImage(firmware, imageHash) == BL_Status_Success);
+}
+
+/*
+ * Runs a check until minimum duration is reached
+ *
+ * @return Time of a check in microseconds
+ */
+PRIVATE double measure(BenchCheck check)
+{
+	uint64_t startTime;
+	uint64_t elapsedTime;
+	uint32_t runCount = 0;
+
+	startTime = getTimeInNs();
+
+	do
+	{
+		(void)check();
+
+		runCount++;
+		elapsedTime = getTimeInNs() - startTime;
+	} while (elapsedTime < BENCH_MIN_DURATION_IN_NS);
+
+	return (double)elapsedTime / (runCount * 1000.0);
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(void)
+{
+	double fullTime;
+	double cachedTime;
+	uint32_t index;
+
+	BL_SecurityInit();
+	mockCPUCoreReset();
+	BL_VerdictInit();
+
+	if (!installTestImage() || !validateImage())
+	{
+		printf("Signed test image could not be validated!\n");
+		return RESULT_FAIL;
+	}
+
+	if ((BL_StoreImageVerdict(imageHash) != BL_Status_Success) || !BL_IsImageVerdictCached())
+	{
+		printf("Verdict of test image could not be cached!\n");
+		return RESULT_FAIL;
+	}
+
+	printf("\nBoot Time Benchmark (full validation vs cached verdict, host)\n");
+	printf("  %12s %14s %14s %10s\n", "image bytes", "full us", "cached us", "speedup");
+
+	for (index = 0; index < sizeof(imageSizes) / sizeof(imageSizes[0]); index++)
+	{
+		/* Verdict is stored for resized image as it would be after an upgrade */
+		firmware->header.imageSize = imageSizes[index];
+		(void)validateImage();
+
+		if ((BL_StoreImageVerdict(imageHash) != BL_Status_Success) || !BL_IsImageVerdictCached())
+		{
+			printf("Verdict could not be cached!\n");
+			return RESULT_FAIL;
+		}
+
+		fullTime = measure(validateImage);
+		cachedTime = measure(BL_IsImageVerdictCached);
+
+		printf("  %12u %14.1f %14.1f %9.1fx\n", imageSizes[index], fullTime, cachedTime, fullTime / cachedTime);
+	}
+
+	return RESULT_SUCCESS;
+}
@@ -0,0 +1,254 @@
+/*******************************************************************************
+ *
+ * @file benchmark_HeapAllocator.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for mbedTLS heap allocators of security module.
+ *
+ *        RSA-2048 signature of test image is verified through
+ *        BL_VerifyImageSignature with first-fit memory_buffer_alloc of
+ *        mbedTLS and with arena of security module on same memory area.
+ *        Number of allocations, cycles spent in allocator, part of memory
+ *        area which is used and verification latency (TSC) are reported.
+ *
+ *        [USAGE] : make benchmark BENCH_MODULE=Bootloader BENCH_TARGET_NAME=HeapAllocator
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <x86intrin.h>
+
+#include "postypes.h"
+
+/* Flash mock holds test image */
+#include "../UnitTest/Mock/mock_Flash.c"
+
+/* Real security module is measured */
+#include "../Bootloader_Security.c"
+
+#include "IntelHex.h"
+#include "TestData.h"
+#include "mbedtls/sha256.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of lines in test image */
+#define BENCH_TEST_IMAGE_LINE_COUNT			(sizeof(testImage) / sizeof(char*))
+
+/* Number of timed verifications */
+#define BENCH_RUN_COUNT						(200)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Measured allocator
+ */
+typedef struct
+{
+	const char* name;
+	/* Installs allocator into mbedTLS on memory area of security module */
+	void (*install)(void);
+} BenchAllocator;
+
+/******************************** VARIABLES ***********************************/
+
+/* Installed firmware in simulated flash and its digest */
+PRIVATE FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[FIRMWARE_START_ADDRESS];
+PRIVATE uint8_t imageHash[32];
+
+/* Measured allocator */
+PRIVATE void* (*allocatorCalloc)(size_t count, size_t size);
+PRIVATE void (*allocatorFree)(void* pointer);
+
+/* Allocator calls of a verification */
+PRIVATE uint32_t allocationCount;
+PRIVATE uint32_t freeCount;
+PRIVATE uint64_t allocatorCycles;
+PRIVATE uint32_t usedLength;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Writes signed test image into flash
+ */
+PRIVATE bool installTestImage(void)
+{
+	IntelHexLine line;
+	uint32_t parsedLength;
+	uint32_t segmentAddress = 0;
+	uint32_t index;
+
+	mockFlashReset();
+
+	for (index = 0; index < BENCH_TEST_IMAGE_LINE_COUNT; index++)
+	{
+		if (IntelHex_Parse((uint8_t*)testImage[index], (uint32_t)strlen(testImage[index]), &line, &parsedLength) != IntelHex_Success)
+		{
+			return false;
+		}
+
+		if (line.recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+		{
+			segmentAddress = ((line.data[0] << 8) | line.data[1]) * INTELHEX_SEGMENT_SIZE;
+		}
+		else if (line.recordType == INTELHEX_RECORDTYPE_DATA)
+		{
+			memcpy(&mockFlash[segmentAddress + line.address], line.data, line.lenght);
+		}
+	}
+
+	mbedtls_sha256((const uint8_t*)firmware->image, firmware->header.imageSize, imageHash, 0);
+
+	return true;
+}
+
+/*
+ * mbedTLS first-fit allocator
+ */
+PRIVATE void installBufferAllocator(void)
+{
+	mbedtls_memory_buffer_alloc_init(mbedTLSDynamicMemory, sizeof(mbedTLSDynamicMemory));
+}
+
+/*
+ * Arena of security module
+ */
+PRIVATE void installArena(void)
+{
+	BL_SecurityInit();
+}
+
+/*
+ * Allocator which counts calls and cycles of measured allocator
+ */
+PRIVATE void* countingCalloc(size_t count, size_t size)
+{
+	uint64_t startCycles = __rdtsc();
+	uint8_t* pointer = allocatorCalloc(count, size);
+
+	allocatorCycles += __rdtsc() - startCycles;
+	allocationCount++;
+
+	if (pointer != NULL)
+	{
+		usedLength = MATH_MAX(usedLength, (uint32_t)(pointer + (count * size) - mbedTLSDynamicMemory));
+	}
+
+	return pointer;
+}
+
+PRIVATE void countingFree(void* pointer)
+{
+	uint64_t startCycles = __rdtsc();
+
+	allocatorFree(pointer);
+
+	allocatorCycles += __rdtsc() - startCycles;
+	freeCount += (pointer != NULL) ? 1 : 0;
+}
+
+/*
+ * Verifies RSA signature of test image
+ */
+PRIVATE bool verify(void)
+{
+	return (BL_VerifyImageSignature(FIRMWARE_SIGNATURE_TYPE_RSA2048, imageHash, firmware->imageSignature) == BL_Status_Success);
+}
+
+/*
+ * Measures an allocator and prints results
+ */
+PRIVATE bool runAllocator(const BenchAllocator* allocator)
+{
+	uint64_t startCycles;
+	uint64_t cycles;
+	uint32_t run;
+
+	allocator->install();
+
+	allocatorCalloc = mbedtls_calloc;
+	allocatorFree = mbedtls_free;
+	allocationCount = 0;
+	freeCount = 0;
+	allocatorCycles = 0;
+	usedLength = 0;
+
+	/* Calls of a verification are counted */
+	mbedtls_platform_set_calloc_free(countingCalloc, countingFree);
+
+	if (!verify() || (allocationCount != freeCount))
+	{
+		return false;
+	}
+
+	/* Latency is measured without counting */
+	mbedtls_platform_set_calloc_free(allocatorCalloc, allocatorFree);
+
+	startCycles = __rdtsc();
+	for (run = 0; run < BENCH_RUN_COUNT; run++)
+	{
+		if (!verify())
+		{
+			return false;
+		}
+	}
+	cycles = (__rdtsc() - startCycles) / BENCH_RUN_COUNT;
+
+	printf("  %-14s %7u %16llu %14.1f %10u %12llu\n",
+		   allocator->name,
+		   allocationCount,
+		   (unsigned long long)allocatorCycles,
+		   (double)allocatorCycles / (allocationCount + freeCount),
+		   usedLength,
+		   (unsigned long long)cycles);
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(void)
+{
+	const BenchAllocator allocators[] =
+	{
+		{ "buffer_alloc", installBufferAllocator },
+		{ "arena", installArena }
+	};
+	uint32_t index;
+
+	if (!installTestImage())
+	{
+		printf("Test image could not be loaded!\n");
+		return RESULT_FAIL;
+	}
+
+	printf("\nmbedTLS Heap Allocator Benchmark (RSA-2048 verification, %u byte memory area)\n", (uint32_t)sizeof(mbedTLSDynamicMemory));
+	printf("  %-14s %7s %16s %14s %10s %12s\n",
+		   "allocator", "allocs", "allocator cycles", "cycles/call", "used bytes", "x86 cycles");
+
+	for (index = 0; index < sizeof(allocators) / sizeof(allocators[0]); index++)
+	{
+		if (!runAllocator(&allocators[index]))
+		{
+			printf("%s : signature of test image could not be verified!\n", allocators[index].name);
+			return RESULT_FAIL;
+		}
+	}
+
+	printf("\n  Arena high water mark : %u bytes (blocks are rounded up to size classes)\n", BL_GetSecurityHeapHighWaterMark());
+
+	return RESULT_SUCCESS;
+}
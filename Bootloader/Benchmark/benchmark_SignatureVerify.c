@@ -0,0 +1,381 @@
+/*******************************************************************************
+ *
+ * @file benchmark_SignatureVerify.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for image signature schemes.
+ *
+ *        Signed test image is verified by each signature scheme through
+ *        BL_VerifyImageSignature. Host cycles (TSC), stack depth (painted
+ *        stack) and peak mbedTLS heap of a verification are reported.
+ *
+ *        Cortex-M3 cycles are estimated from the number of 32 x 32 bit
+ *        multiply-accumulates, which dominate both schemes:
+ *          - RSA-2048 (e = 65537) : Montgomery multiplications (2 n^2) and
+ *            squarings (1.5 n^2) of 64 words of RSA2048 library, counted
+ *            while verifying. With RSA of mbedTLS
+ *            (BL_SIGNATURE_RSA2048_FIXED_WIDTH=0) 17 Montgomery squarings
+ *            (1.5 n^2 on Thumb-2), 3 multiplications (2 n^2) and 2
+ *            reductions (n^2) of mbedtls_mpi_exp_mod, R^2 mod N is
+ *            precomputed
+ *          - ECDSA P-256 : Montgomery multiplications of 8 words, counted
+ *            while verifying
+ *
+ *        [USAGE] : make benchmark BENCH_MODULE=Bootloader BENCH_TARGET_NAME=SignatureVerify
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <ucontext.h>
+#include <x86intrin.h>
+
+#include "postypes.h"
+
+/* Flash mock holds test image */
+#include "../UnitTest/Mock/mock_Flash.c"
+
+/* Montgomery multiplications of P256 and RSA2048 libraries are counted */
+PRIVATE uint32_t montMulCount;
+PRIVATE uint32_t rsaMontMulCount;
+PRIVATE uint32_t rsaMontSqrCount;
+
+#define P256_MONT_MUL_HOOK()				(montMulCount++)
+#define RSA2048_MONT_MUL_HOOK()				(rsaMontMulCount++)
+#define RSA2048_MONT_SQR_HOOK()				(rsaMontSqrCount++)
+
+#include "P256.c"
+
+/* Private helpers of RSA2048 library have same names as P256 helpers */
+#define readWords							rsaReadWords
+#define compare								rsaCompare
+#define subWords							rsaSubWords
+#define montMul								rsaMontMul
+
+#include "RSA2048.c"
+
+#undef readWords
+#undef compare
+#undef subWords
+#undef montMul
+
+/* Real security module is measured */
+#include "../Bootloader_Security.c"
+
+#include "IntelHex.h"
+#include "TestData.h"
+#include "mbedtls/sha256.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of lines in test image */
+#define BENCH_TEST_IMAGE_LINE_COUNT			(sizeof(testImage) / sizeof(char*))
+
+/* Stack of a verification, painted before run */
+#define BENCH_STACK_SIZE					(64 * 1024)
+#define BENCH_STACK_PAINT					(0xA5)
+
+/* Maximum number of live heap allocations which are tracked */
+#define BENCH_MAX_ALLOCATION_COUNT			(256)
+
+/* Number of timed verifications */
+#define BENCH_RUN_COUNT						(200)
+
+/* Cortex-M3 cycles of a 32 x 32 + 64 bit multiply-accumulate with loads, stores and carries */
+#define BENCH_CM3_CYCLES_PER_MAC			(8)
+
+/* Multiply-accumulates of a Montgomery multiplication of n words (2 * n^2) */
+#define BENCH_MONT_MUL_MACS(words)			(2 * (words) * (words))
+
+/* RSA-2048 of mbedTLS : 64 words, R^2 mod N of key is precomputed */
+#define BENCH_RSA_WORD_COUNT				(64)
+#define BENCH_RSA_MONT_SQR_COUNT			(17)
+#define BENCH_RSA_MONT_MUL_COUNT			(3)
+#define BENCH_RSA_MONT_RED_COUNT			(2)
+#define BENCH_RSA_MAC_COUNT					(((BENCH_RSA_MONT_SQR_COUNT * 3 * BENCH_RSA_WORD_COUNT * BENCH_RSA_WORD_COUNT) / 2) + \
+											 (BENCH_RSA_MONT_MUL_COUNT * BENCH_MONT_MUL_MACS(BENCH_RSA_WORD_COUNT)) + \
+											 (BENCH_RSA_MONT_RED_COUNT * BENCH_RSA_WORD_COUNT * BENCH_RSA_WORD_COUNT))
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Measured signature scheme
+ */
+typedef struct
+{
+	const char* name;
+	uint32_t signatureType;
+	const uint8_t* signature;
+	uint32_t signatureLength;
+} BenchScheme;
+
+/*
+ * Live heap allocation
+ */
+typedef struct
+{
+	void* pointer;
+	size_t size;
+} BenchAllocation;
+
+/******************************** VARIABLES ***********************************/
+
+/* ECDSA signature of test image */
+PRIVATE const uint8_t ecdsaSignature[P256_SIGNATURE_LENGTH] = TEST_ECDSA_IMAGE_SIGNATURE;
+
+/* Installed firmware in simulated flash and its digest */
+PRIVATE FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[FIRMWARE_START_ADDRESS];
+PRIVATE uint8_t imageHash[32];
+
+/* Scheme which is verified on painted stack and its result */
+PRIVATE const BenchScheme* currentScheme;
+PRIVATE BLStatusCode verifyStatus;
+
+PRIVATE ucontext_t mainContext;
+PRIVATE ucontext_t verifyContext;
+PRIVATE uint8_t verifyStack[BENCH_STACK_SIZE] __attribute__((aligned(16)));
+
+/* Allocator of security module and heap usage */
+PRIVATE void* (*bufferCalloc)(size_t count, size_t size);
+PRIVATE void (*bufferFree)(void* pointer);
+PRIVATE BenchAllocation allocations[BENCH_MAX_ALLOCATION_COUNT];
+PRIVATE size_t heapUsage;
+PRIVATE size_t peakHeapUsage;
+PRIVATE uint32_t allocationCount;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Writes signed test image into flash
+ */
+PRIVATE bool installTestImage(void)
+{
+	IntelHexLine line;
+	uint32_t parsedLength;
+	uint32_t segmentAddress = 0;
+	uint32_t index;
+
+	mockFlashReset();
+
+	for (index = 0; index < BENCH_TEST_IMAGE_LINE_COUNT; index++)
+	{
+		if (IntelHex_Parse((uint8_t*)testImage[index], (uint32_t)strlen(testImage[index]), &line, &parsedLength) != IntelHex_Success)
+		{
+			return false;
+		}
+
+		if (line.recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+		{
+			segmentAddress = ((line.data[0] << 8) | line.data[1]) * INTELHEX_SEGMENT_SIZE;
+		}
+		else if (line.recordType == INTELHEX_RECORDTYPE_DATA)
+		{
+			memcpy(&mockFlash[segmentAddress + line.address], line.data, line.lenght);
+		}
+	}
+
+	mbedtls_sha256((const uint8_t*)firmware->image, firmware->header.imageSize, imageHash, 0);
+
+	return true;
+}
+
+/*
+ * Allocator which records heap usage of security module
+ */
+PRIVATE void* countingCalloc(size_t count, size_t size)
+{
+	void* pointer = bufferCalloc(count, size);
+	uint32_t index;
+
+	for (index = 0; (pointer != NULL) && (index < BENCH_MAX_ALLOCATION_COUNT); index++)
+	{
+		if (allocations[index].pointer == NULL)
+		{
+			allocations[index].pointer = pointer;
+			allocations[index].size = count * size;
+			heapUsage += count * size;
+			peakHeapUsage = MATH_MAX(peakHeapUsage, heapUsage);
+			allocationCount++;
+			break;
+		}
+	}
+
+	return pointer;
+}
+
+PRIVATE void countingFree(void* pointer)
+{
+	uint32_t index;
+
+	for (index = 0; (pointer != NULL) && (index < BENCH_MAX_ALLOCATION_COUNT); index++)
+	{
+		if (allocations[index].pointer == pointer)
+		{
+			heapUsage -= allocations[index].size;
+			allocations[index].pointer = NULL;
+			break;
+		}
+	}
+
+	bufferFree(pointer);
+}
+
+/*
+ * Verifies signature of test image with current scheme
+ */
+PRIVATE void verify(void)
+{
+	verifyStatus = BL_VerifyImageSignature(currentScheme->signatureType, imageHash, currentScheme->signature);
+}
+
+/*
+ * Verifies once on a painted stack and returns used stack depth
+ */
+PRIVATE uint32_t measureStackDepth(void)
+{
+	uint32_t index;
+
+	memset(verifyStack, BENCH_STACK_PAINT, sizeof(verifyStack));
+
+	getcontext(&verifyContext);
+	verifyContext.uc_stack.ss_sp = verifyStack;
+	verifyContext.uc_stack.ss_size = sizeof(verifyStack);
+	verifyContext.uc_link = &mainContext;
+	makecontext(&verifyContext, verify, 0);
+	swapcontext(&mainContext, &verifyContext);
+
+	/* Stack grows down */
+	for (index = 0; (index < sizeof(verifyStack)) && (verifyStack[index] == BENCH_STACK_PAINT); index++);
+
+	return sizeof(verifyStack) - index;
+}
+
+/*
+ * Measures a scheme and prints results
+ */
+PRIVATE bool runScheme(const BenchScheme* scheme)
+{
+	uint64_t startCycles;
+	uint64_t cycles;
+	uint32_t stackDepth;
+	uint32_t verifyAllocationCount;
+	uint32_t macCount;
+	uint32_t run;
+
+	currentScheme = scheme;
+
+	/* Signature is placed into metadata as an image of this scheme */
+	firmware->header.signatureType = scheme->signatureType;
+	memset(firmware->imageSignature, 0xFF, FIRMWARE_SIGNATURE_LENGTH);
+	memcpy(firmware->imageSignature, scheme->signature, scheme->signatureLength);
+
+	if (BL_ValidateImage(firmware, imageHash) != BL_Status_Success)
+	{
+		return false;
+	}
+
+	heapUsage = 0;
+	peakHeapUsage = 0;
+	allocationCount = 0;
+	montMulCount = 0;
+	rsaMontMulCount = 0;
+	rsaMontSqrCount = 0;
+
+	stackDepth = measureStackDepth();
+	if (verifyStatus != BL_Status_Success)
+	{
+		return false;
+	}
+
+	/* Allocations of a single verification, timed runs are counted too */
+	verifyAllocationCount = allocationCount;
+
+	if (montMulCount > 0)
+	{
+		macCount = montMulCount * BENCH_MONT_MUL_MACS(P256_WORD_COUNT);
+	}
+	else if (rsaMontMulCount > 0)
+	{
+		macCount = (rsaMontMulCount * BENCH_MONT_MUL_MACS(RSA2048_WORD_COUNT)) +
+				   ((rsaMontSqrCount * 3 * RSA2048_WORD_COUNT * RSA2048_WORD_COUNT) / 2);
+	}
+	else
+	{
+		macCount = BENCH_RSA_MAC_COUNT;
+	}
+
+	startCycles = __rdtsc();
+	for (run = 0; run < BENCH_RUN_COUNT; run++)
+	{
+		verify();
+	}
+	cycles = (__rdtsc() - startCycles) / BENCH_RUN_COUNT;
+
+	printf("  %-12s %9u %12llu %8u %8u %7u %10u %12u\n",
+		   scheme->name,
+		   scheme->signatureLength,
+		   (unsigned long long)cycles,
+		   stackDepth,
+		   (uint32_t)peakHeapUsage,
+		   verifyAllocationCount,
+		   macCount,
+		   macCount * BENCH_CM3_CYCLES_PER_MAC);
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(void)
+{
+	uint8_t rsaSignature[FIRMWARE_SIGNATURE_LENGTH];
+	BenchScheme schemes[] =
+	{
+		{ "RSA-2048", FIRMWARE_SIGNATURE_TYPE_RSA2048, rsaSignature, FIRMWARE_SIGNATURE_LENGTH },
+		{ "ECDSA P-256", FIRMWARE_SIGNATURE_TYPE_ECDSA_P256, ecdsaSignature, P256_SIGNATURE_LENGTH }
+	};
+	uint32_t index;
+
+	BL_SecurityInit();
+
+	bufferCalloc = mbedtls_calloc;
+	bufferFree = mbedtls_free;
+	mbedtls_platform_set_calloc_free(countingCalloc, countingFree);
+
+	if (!installTestImage())
+	{
+		printf("Test image could not be loaded!\n");
+		return RESULT_FAIL;
+	}
+
+	memcpy(rsaSignature, firmware->imageSignature, sizeof(rsaSignature));
+
+	printf("\nSignature Verification Benchmark (%u byte test image)\n", firmware->header.imageSize);
+	printf("  %-12s %9s %12s %8s %8s %7s %10s %12s\n",
+		   "scheme", "sig bytes", "x86 cycles", "stack", "heap", "allocs", "MACs", "CM3 cycles");
+
+	for (index = 0; index < sizeof(schemes) / sizeof(schemes[0]); index++)
+	{
+		if (!runScheme(&schemes[index]))
+		{
+			printf("%s signature of test image could not be verified!\n", schemes[index].name);
+			return RESULT_FAIL;
+		}
+	}
+
+	printf("\n  Stack is host (x86-64) depth. CM3 cycles assume %u cycles per multiply-accumulate.\n", BENCH_CM3_CYCLES_PER_MAC);
+
+	return RESULT_SUCCESS;
+}
@@ -0,0 +1,506 @@
+/*******************************************************************************
+ *
+ * @file benchmark_UpgradeLink.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for sequenced upgrade transfers over a lossy UART link.
+ *
+ *        Host sender (ImageSender) and bootloader upgrade module are
+ *        connected through a simulated full duplex UART which flips bits
+ *        with given bit error rate (BER) and delivers bytes after their wire
+ *        time and link latency (e.g. USB serial adapter). Goodput is reported
+ *        for different BER and window sizes and compared with unacknowledged
+ *        transfers which must be restarted after any error.
+ *
+ *        [USAGE] : benchmark_UpgradeLink
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdlib.h>
+
+#include "postypes.h"
+
+/* Flash, timer and CPU mocks of unit tests are used as device peripherals */
+#include "../UnitTest/Mock/mock_Flash.c"
+#include "../UnitTest/Mock/mock_Timer.c"
+#include "../UnitTest/Mock/mock_CPUCore.c"
+
+/* Link is measured, signature of benchmark image is not checked */
+#include "../UnitTest/Mock/mock_Security.c"
+
+/* Include Upgrade source file to run bootloader side of link */
+#include "../Bootloader_Upgrade.c"
+#include "../Bootloader_Slot.c"
+#include "../Bootloader_Journal.c"
+#include "../Bootloader_Verdict.c"
+
+#include "ImageSender.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Simulated link */
+#define BENCH_BAUD_RATE						(115200)
+#define BENCH_UART_BITS_PER_BYTE			(10)
+#define BENCH_BYTE_TIME						((double)BENCH_UART_BITS_PER_BYTE / BENCH_BAUD_RATE)
+
+/* Latency of each direction in addition to wire time */
+#define BENCH_LINK_LATENCY					(0.002)
+
+/* Host waits wire time of a window in both directions and processing time */
+#define BENCH_PROCESSING_TIME				(0.050)
+
+/* Size of uploaded image including metadata */
+#define BENCH_IMAGE_LENGTH					(64 * 1024)
+
+/* Size of each link direction buffer */
+#define BENCH_CHANNEL_SIZE					(64 * 1024)
+
+/* Size of device receive buffer which lends spans to upgrade module */
+#define BENCH_DEVICE_RX_BUFFER_SIZE			(256)
+
+/* Maximum number of writes (frames) waiting in a link direction */
+#define BENCH_CHANNEL_SEGMENT_COUNT			(8 * 1024)
+
+/* Runs with different seeds for each configuration */
+#define BENCH_RUN_COUNT						(4)
+
+/* Sender gives up after long error bursts only */
+#define BENCH_MAX_RETRY_COUNT				(100)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * A direction of simulated UART link
+ */
+typedef struct
+{
+	uint8_t data[BENCH_CHANNEL_SIZE];
+	uint32_t length;
+	uint32_t offset;
+	/* End offset and arrival time of each write */
+	uint32_t segmentEnd[BENCH_CHANNEL_SEGMENT_COUNT];
+	double segmentTime[BENCH_CHANNEL_SEGMENT_COUNT];
+	uint32_t segmentCount;
+	uint32_t segmentIndex;
+	/* Number of error free bits before next bit error */
+	double bitsToNextError;
+} BenchChannel;
+
+/*
+ * Result of a configuration
+ */
+typedef struct
+{
+	double time;
+	uint32_t retransmittedFrameCount;
+	uint32_t nakCount;
+	uint32_t timeoutCount;
+	uint32_t failedRunCount;
+} BenchResult;
+
+/******************************** VARIABLES ***********************************/
+
+/* Host to device and device to host directions */
+PRIVATE BenchChannel hostToDevice;
+PRIVATE BenchChannel deviceToHost;
+
+PRIVATE ImageSender sender;
+PRIVATE double bitErrorRate;
+/* Time of host and time of data which is processed by device */
+PRIVATE double simulatedTime;
+PRIVATE double deviceTime;
+PRIVATE double responseTimeout;
+PRIVATE uint64_t randomState;
+
+PRIVATE UARTDataReceivedEventHandler uartHandler;
+
+/* Receive buffer of device, filled from link like DMA of UART driver */
+PRIVATE uint8_t deviceRxData[BENCH_DEVICE_RX_BUFFER_SIZE];
+PRIVATE uint32_t deviceRxLength;
+PRIVATE uint32_t deviceRxOffset;
+
+/* Returns from bootloader if sender gives up */
+PRIVATE jmp_buf senderFailedJump;
+
+PRIVATE uint8_t benchImage[BENCH_IMAGE_LENGTH];
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+
+/*
+ * xorshift64 random number in (0, 1)
+ */
+PRIVATE double getRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+
+	return ((double)(randomState >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/*
+ * Bit errors have geometric distance for a binary symmetric channel
+ */
+PRIVATE double getBitsToNextError(void)
+{
+	if (bitErrorRate <= 0)
+	{
+		return HUGE_VAL;
+	}
+
+	return floor(log(getRandom()) / log(1.0 - bitErrorRate));
+}
+
+/*
+ * Writes bytes into a channel and flips bits of data.
+ *	Bytes arrive to other side after their wire time and link latency.
+ */
+PRIVATE void channelWrite(BenchChannel* channel, const uint8_t* data, uint32_t length, double sendTime)
+{
+	uint32_t bitIndex;
+
+	/* Fully read channels are rewound */
+	if (channel->offset == channel->length)
+	{
+		channel->offset = 0;
+		channel->length = 0;
+		channel->segmentCount = 0;
+		channel->segmentIndex = 0;
+	}
+
+	length = MATH_MIN(length, BENCH_CHANNEL_SIZE - channel->length);
+	if ((length == 0) || (channel->segmentCount == BENCH_CHANNEL_SEGMENT_COUNT))
+	{
+		return;
+	}
+
+	memcpy(&channel->data[channel->length], data, length);
+
+	while (channel->bitsToNextError < (double)length * 8)
+	{
+		bitIndex = (uint32_t)channel->bitsToNextError;
+		channel->data[channel->length + (bitIndex / 8)] ^= (uint8_t)(1 << (bitIndex % 8));
+
+		channel->bitsToNextError += 1 + getBitsToNextError();
+	}
+
+	channel->bitsToNextError -= (double)length * 8;
+	channel->length += length;
+
+	channel->segmentEnd[channel->segmentCount] = channel->length;
+	channel->segmentTime[channel->segmentCount] = sendTime + (length * BENCH_BYTE_TIME) + BENCH_LINK_LATENCY;
+	channel->segmentCount++;
+}
+
+/*
+ * Reads bytes which arrive until given time from a channel
+ *
+ * @return Number of read bytes
+ */
+PRIVATE uint32_t channelRead(BenchChannel* channel, uint8_t* data, uint32_t length, double time, double* arrivalTime)
+{
+	uint32_t readLength = 0;
+	uint32_t copyLength;
+
+	while ((readLength < length) &&
+		   (channel->segmentIndex < channel->segmentCount) &&
+		   (channel->segmentTime[channel->segmentIndex] <= time))
+	{
+		copyLength = MATH_MIN(length - readLength, channel->segmentEnd[channel->segmentIndex] - channel->offset);
+
+		memcpy(&data[readLength], &channel->data[channel->offset], copyLength);
+		readLength += copyLength;
+		channel->offset += copyLength;
+
+		*arrivalTime = MATH_MAX(*arrivalTime, channel->segmentTime[channel->segmentIndex]);
+
+		if (channel->offset == channel->segmentEnd[channel->segmentIndex])
+		{
+			channel->segmentIndex++;
+		}
+	}
+
+	return readLength;
+}
+
+/*
+ * Sends host frames, only host to device direction consumes wire time
+ */
+PRIVATE void hostSend(void* arg, const uint8_t* data, uint32_t length)
+{
+	(void)arg;
+
+	channelWrite(&hostToDevice, data, length, simulatedTime);
+
+	simulatedTime += length * BENCH_BYTE_TIME;
+}
+
+/*
+ * Runs host until it sends data to device
+ */
+PRIVATE void hostStep(void)
+{
+	uint8_t buffer[256];
+	uint32_t length;
+	double arrivalTime = 0;
+
+	do
+	{
+		/* Feed responses which arrived until now */
+		while ((length = channelRead(&deviceToHost, buffer, sizeof(buffer), simulatedTime, &arrivalTime)) > 0)
+		{
+			ImageSender_Feed(&sender, buffer, length);
+		}
+
+		if (ImageSender_Transmit(&sender))
+		{
+			return;
+		}
+
+		if (deviceToHost.segmentIndex < deviceToHost.segmentCount)
+		{
+			/* Wait for next response */
+			simulatedTime = MATH_MAX(simulatedTime, deviceToHost.segmentTime[deviceToHost.segmentIndex]);
+		}
+		else
+		{
+			/* No response is on the way */
+			simulatedTime += responseTimeout;
+			ImageSender_Timeout(&sender);
+		}
+	} while (ImageSender_GetState(&sender) == ImageSender_InProgress);
+
+	longjmp(senderFailedJump, 1);
+}
+
+/*
+ * Creates an image with valid metadata and random content
+ */
+PRIVATE void createImage(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)benchImage;
+	uint32_t index;
+
+	randomState = 0x9E3779B97F4A7C15ULL;
+
+	for (index = 0; index < BENCH_IMAGE_LENGTH; index++)
+	{
+		benchImage[index] = (uint8_t)(getRandom() * 256);
+	}
+
+	memset(benchImage, 0, FIRMWARE_METADATA_LENGTH);
+	firmware->header.imageOffset = FIRMWARE_START_ADDRESS + FIRMWARE_METADATA_LENGTH;
+	firmware->header.imageSize = BENCH_IMAGE_LENGTH - FIRMWARE_METADATA_LENGTH;
+}
+
+/*
+ * Uploads image through simulated link
+ *
+ * @return true if image is written into flash
+ */
+PRIVATE bool runUpload(uint32_t windowSize, uint64_t seed, BenchResult* result)
+{
+	const ImageSenderStats* stats;
+	volatile BLStatusCode status = BL_StatusUpgrade_MissingMetaData;
+
+	memset(&hostToDevice, 0, sizeof(hostToDevice));
+	memset(&deviceToHost, 0, sizeof(deviceToHost));
+	deviceRxLength = 0;
+	deviceRxOffset = 0;
+	mockFlashReset();
+	mockSecurityReset();
+	mockTimerReset();
+	mockCPUCoreReset();
+
+	/* Consecutive seeds are scrambled, xorshift outputs of them correlate */
+	randomState = seed * 0x9E3779B97F4A7C15ULL;
+	simulatedTime = 0;
+	deviceTime = 0;
+	hostToDevice.bitsToNextError = getBitsToNextError();
+	deviceToHost.bitsToNextError = getBitsToNextError();
+
+	responseTimeout = (2.0 * windowSize * BINFRAME_FRAME_LENGTH(BINFRAME_SEQ_PAYLOAD_LENGTH) * BENCH_BYTE_TIME) + BENCH_PROCESSING_TIME;
+
+	ImageSender_Init(&sender, benchImage, BENCH_IMAGE_LENGTH, windowSize, hostSend, NULL);
+	ImageSender_SetMaxRetryCount(&sender, BENCH_MAX_RETRY_COUNT);
+
+	if (setjmp(senderFailedJump) == 0)
+	{
+		status = BL_UpgradeFirmware();
+	}
+
+	stats = ImageSender_GetStats(&sender);
+
+	/* Image is completed when device processes last frame */
+	result->time += MATH_MAX(deviceTime, simulatedTime);
+	result->retransmittedFrameCount += stats->retransmittedFrameCount;
+	result->nakCount += stats->nakCount;
+	result->timeoutCount += stats->timeoutCount;
+
+	ImageSender_Release(&sender);
+
+	return (status == BL_Status_Success) &&
+		   (memcmp(&mockFlash[FIRMWARE_START_ADDRESS], benchImage, BENCH_IMAGE_LENGTH) == 0);
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+
+/*
+ * Simulated UART of device. Host runs whenever device waits for data.
+ */
+void Drv_UART_Init(void)
+{
+}
+
+UartHandle Drv_UART_Get(uint32_t uartNo, uint32_t baudRate, UARTDataReceivedEventHandler dataReceivedEventHandler)
+{
+	(void)baudRate;
+
+	uartHandler = dataReceivedEventHandler;
+	uartHandler();
+
+	return (UartHandle)uartNo;
+}
+
+void Drv_UART_Release(UartHandle uart)
+{
+	(void)uart;
+}
+
+int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength)
+{
+	(void)uart;
+
+	channelWrite(&deviceToHost, sendBuffer, sendLength, deviceTime);
+
+	return (int32_t)sendLength;
+}
+
+int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength)
+{
+	uint32_t length;
+
+	(void)uart;
+
+	if (hostToDevice.segmentIndex == hostToDevice.segmentCount)
+	{
+		hostStep();
+	}
+
+	/* Device processes data when it arrives */
+	length = channelRead(&hostToDevice, receiveBuffer, receiveLength, HUGE_VAL, &deviceTime);
+
+	/* Device always has data since host retransmits after timeouts */
+	uartHandler();
+
+	return (int32_t)length;
+}
+
+int32_t Drv_UART_PeekSpan(UartHandle uart, uint8_t** span)
+{
+	(void)uart;
+
+	if (deviceRxOffset == deviceRxLength)
+	{
+		if (hostToDevice.segmentIndex == hostToDevice.segmentCount)
+		{
+			hostStep();
+		}
+
+		deviceRxLength = channelRead(&hostToDevice, deviceRxData, sizeof(deviceRxData), HUGE_VAL, &deviceTime);
+		deviceRxOffset = 0;
+	}
+
+	*span = &deviceRxData[deviceRxOffset];
+
+	return (int32_t)(deviceRxLength - deviceRxOffset);
+}
+
+void Drv_UART_Consume(UartHandle uart, uint32_t length)
+{
+	(void)uart;
+
+	deviceRxOffset += length;
+
+	/* Device always has data since host retransmits after timeouts */
+	uartHandler();
+}
+
+/*
+ * Benchmark entry point
+ */
+int main(void)
+{
+	const double bitErrorRates[] = { 0, 1e-6, 1e-5, 3e-5, 1e-4, 3e-4 };
+	const uint32_t windowSizes[] = { 1, 4, 8, 16 };
+	BenchResult result;
+	uint32_t wireLength;
+	double lineRate = 1.0 / BENCH_BYTE_TIME;
+	double restartGoodput;
+	double goodput;
+	uint32_t berIndex;
+	uint32_t windowIndex;
+	uint32_t run;
+
+	createImage();
+
+	/* Unacknowledged stream of 4K data frames and END frame */
+	wireLength = BENCH_IMAGE_LENGTH + ((BENCH_IMAGE_LENGTH / BINFRAME_MAX_PAYLOAD_LENGTH) + 1) * BINFRAME_OVERHEAD_LENGTH;
+
+	printf("\nUpgrade Link Benchmark (%u byte image, %u baud, %u runs)\n", BENCH_IMAGE_LENGTH, BENCH_BAUD_RATE, BENCH_RUN_COUNT);
+	printf("  %-8s %-6s %12s %10s %10s %8s %8s %16s\n",
+		   "BER", "window", "goodput B/s", "efficiency", "retransmit", "NAK", "timeout", "restart B/s");
+
+	for (berIndex = 0; berIndex < sizeof(bitErrorRates) / sizeof(bitErrorRates[0]); berIndex++)
+	{
+		bitErrorRate = bitErrorRates[berIndex];
+
+		/* Whole stream must be error free, expected number of attempts is 1/P */
+		restartGoodput = (BENCH_IMAGE_LENGTH / (wireLength * BENCH_BYTE_TIME)) * pow(1.0 - bitErrorRate, 8.0 * wireLength);
+
+		for (windowIndex = 0; windowIndex < sizeof(windowSizes) / sizeof(windowSizes[0]); windowIndex++)
+		{
+			memset(&result, 0, sizeof(result));
+
+			for (run = 0; run < BENCH_RUN_COUNT; run++)
+			{
+				if (!runUpload(windowSizes[windowIndex], run + 1, &result))
+				{
+					result.failedRunCount++;
+				}
+			}
+
+			goodput = (BENCH_RUN_COUNT * (double)BENCH_IMAGE_LENGTH) / result.time;
+
+			printf("  %-8.0e %-6u %12.0f %9.1f%% %10.1f %8.1f %8.1f %16.0f%s\n",
+				   bitErrorRate, windowSizes[windowIndex], goodput, 100.0 * goodput / lineRate,
+				   (double)result.retransmittedFrameCount / BENCH_RUN_COUNT,
+				   (double)result.nakCount / BENCH_RUN_COUNT,
+				   (double)result.timeoutCount / BENCH_RUN_COUNT,
+				   restartGoodput,
+				   (result.failedRunCount > 0) ? "  FAILED" : "");
+
+			if (result.failedRunCount > 0)
+			{
+				return RESULT_FAIL;
+			}
+		}
+	}
+
+	return RESULT_SUCCESS;
+}
@@ -0,0 +1,881 @@
+/*******************************************************************************
+ *
+ * @file benchmark_UpgradeThroughput.c
+ *
+ * @author MC
+ *
+ * @brief End-to-end throughput benchmark of firmware upgrade.
+ *
+ *        Real upgrade, slot and security modules (BL_UpgradeFirmware) run
+ *        on simulated LPC1768 flash and timer of x86 BSP. Host sends upload
+ *        stream through a paced UART which delivers it in chunks after their
+ *        wire time. Device clock is host time plus time of simulated flash
+ *        commands (see Drv_Timer.c of x86), idle time of device is skipped
+ *        by advancing simulated clock to arrival of next chunk.
+ *
+ *        Images are test images (App.hex, ER_IROM1.signed) and synthetic
+ *        images of 64K up to image area of configuration (including
+ *        metadata). Images without metadata are signed with test RSA key
+ *        (rsa_priv.txt). Each image is uploaded as Intel HEX, BinFrame data
+ *        frames and sequenced frames for each baud rate and chunk size over
+ *        a slot which keeps an older image, so its sectors are erased.
+ *        Sequenced frames are sent in order without waiting for ACKs since
+ *        simulated link does not lose frames.
+ *
+ *        Upload time is split into
+ *          - receive : Waiting for UART data
+ *          - parse   : Transport parsing and buffering (host CPU)
+ *          - program : Flash writes
+ *          - journal : Checkpoint writes of upgrade journal (sequenced frames)
+ *          - erase   : Erase of image area
+ *          - verify  : Read back, digest and signature check
+ *        Results are written into UpgradeThroughput.csv and
+ *        UpgradeThroughput.json with given revision, so runs of different
+ *        commits can be compared.
+ *
+ *        Default configuration uploads images of up to a slot (64K and
+ *        192K) into slot A, sequenced uploads write journal checkpoints. Reduced configuration
+ *        (BENCH_CONFIG=reduced) disables A/B slots and journal, so 256K and
+ *        448K images fit into flash. Its results are labelled "reduced" and
+ *        written into UpgradeThroughput_reduced.csv and .json.
+ *
+ *        [USAGE] : make bench
+ *                  make benchmark BENCH_MODULE=Bootloader BENCH_TARGET_NAME=UpgradeThroughput [BENCH_CONFIG=reduced]
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <setjmp.h>
+#include <stdlib.h>
+
+#include "postypes.h"
+
+/* Real upgrade, slot, verdict and security modules are measured */
+#include "../Bootloader_Upgrade.c"
+#include "../Bootloader_Slot.c"
+#include "../Bootloader_Journal.c"
+#include "../Bootloader_Verdict.c"
+#include "../Bootloader_Security.c"
+
+#include "mbedtls/sha256.h"
+
+#include "Drv_Timer.h"
+#include "IntelHex.h"
+#include "BinFrame.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/*
+ * Image area (metadata and image) which is uploaded and name of configuration
+ *	in reports. A slot is the image area unless A/B slots and journal are
+ *	disabled, then whole flash after firmware start is used.
+ */
+#if BL_AB_SLOTS_ENABLED && BL_UPGRADE_JOURNAL_ENABLED
+#define BENCH_MAX_IMAGE_LENGTH				(FIRMWARE_SLOT_SIZE)
+#define BENCH_CONFIG_NAME					"default"
+#define BENCH_REPORT_NAME					"UpgradeThroughput"
+#elif !BL_AB_SLOTS_ENABLED && !BL_UPGRADE_JOURNAL_ENABLED
+#define BENCH_MAX_IMAGE_LENGTH				(448 * 1024)
+#define BENCH_CONFIG_NAME					"reduced"
+#define BENCH_REPORT_NAME					"UpgradeThroughput_reduced"
+#else
+#error "Benchmark supports default and reduced (no A/B slots and journal) configurations"
+#endif
+
+/* Intel HEX stream is ~2.75 times of image, frames are a bit longer than it */
+#define BENCH_MAX_STREAM_LENGTH				(3 * BENCH_MAX_IMAGE_LENGTH)
+
+/* Start, 8 data bits and stop */
+#define BENCH_UART_BITS_PER_BYTE			(10)
+
+/* Data length of generated Intel HEX records */
+#define BENCH_HEX_RECORD_LENGTH				(16)
+
+/* Timer of device clock, upgrade module uses BL_FW_UPGRADE_TIMEOUT_TIMER_NO */
+#define BENCH_DEVICE_TIMER_NO				(1)
+
+/* Content of older image which is in slot before upgrade */
+#define BENCH_OLD_IMAGE_VALUE				(0x00)
+
+/* Maximum length of a line of test data files (e.g. a key of rsa_priv.txt) */
+#define BENCH_MAX_LINE_LENGTH				(1024)
+
+/* Maximum length of a path of test data and report files */
+#define BENCH_MAX_PATH_LENGTH				(512)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Upload stream formats
+ */
+typedef enum
+{
+	BenchTransport_IntelHex,
+	BenchTransport_BinFrame,
+	BenchTransport_BinFrameSeq,
+	BenchTransport_Count
+} BenchTransport;
+
+/*
+ * Paced UART from host to device
+ */
+typedef struct
+{
+	const uint8_t* stream;
+	uint32_t length;
+	uint32_t consumedLength;
+	uint32_t chunkLength;
+	uint32_t baudRate;
+	/* Maximum number of received but not processed bytes */
+	uint32_t maxBacklog;
+	/* Device time and upgrade statistics when last span is lent */
+	uint32_t spanStartTime;
+	BLUpgradeStats spanStartStats;
+	/* Device time which is spent on spans excluding flash and verification */
+	uint32_t parseTimeInUs;
+} BenchLink;
+
+/*
+ * Result of an upload
+ */
+typedef struct
+{
+	BLStatusCode status;
+	uint32_t streamLength;
+	uint32_t totalTimeInUs;
+	uint32_t wireTimeInUs;
+	uint32_t receiveTimeInUs;
+	uint32_t parseTimeInUs;
+	uint32_t programTimeInUs;
+	uint32_t journalTimeInUs;
+	uint32_t journalRecordCount;
+	uint32_t eraseTimeInUs;
+	uint32_t verifyTimeInUs;
+	uint32_t maxBacklog;
+} BenchResult;
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/* Simulation only functions of flash driver (see Drv_Flash.c) */
+void Drv_Flash_SimulateReset(void);
+void Drv_Flash_SimulateElapsedTime(uint32_t timeInUs);
+
+/******************************** VARIABLES ***********************************/
+
+PRIVATE const char* transportNames[BenchTransport_Count] = { "IntelHex", "BinFrame", "BinFrameSeq" };
+
+PRIVATE const uint32_t baudRates[] = { 115200, 460800, 921600 };
+PRIVATE const uint32_t chunkLengths[] = { 16, 256, 4096 };
+
+/* Synthetic image lengths including metadata */
+#if BL_AB_SLOTS_ENABLED
+PRIVATE const uint32_t syntheticImageLengths[] = { 64 * 1024, BENCH_MAX_IMAGE_LENGTH };
+#else
+PRIVATE const uint32_t syntheticImageLengths[] = { 64 * 1024, 256 * 1024, BENCH_MAX_IMAGE_LENGTH };
+#endif
+
+PRIVATE BenchLink link;
+PRIVATE TimerHandle deviceTimer;
+PRIVATE UARTDataReceivedEventHandler uartHandler;
+
+/* Returns from bootloader if stream ends before upgrade completes */
+PRIVATE jmp_buf streamEndedJump;
+
+PRIVATE mbedtls_rsa_context signingKey;
+
+/* Uploaded image (metadata and image) and its upload stream */
+PRIVATE uint8_t benchImage[BENCH_MAX_IMAGE_LENGTH];
+PRIVATE uint32_t benchImageLength;
+PRIVATE uint8_t benchStream[BENCH_MAX_STREAM_LENGTH];
+
+PRIVATE uint64_t randomState;
+
+/* Reports */
+PRIVATE FILE* csvFile;
+PRIVATE FILE* jsonFile;
+PRIVATE const char* revision = "unknown";
+PRIVATE uint32_t reportedResultCount;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+
+/*
+ * Unused timer callback, simulated timers do not raise callbacks
+ */
+PRIVATE void deviceTimerCallback(void)
+{
+}
+
+/*
+ * Returns time of device since upload stream started
+ */
+PRIVATE ALWAYS_INLINE uint32_t getDeviceTime(void)
+{
+	return Drv_Timer_ReadElapsedTimeInUs(deviceTimer);
+}
+
+/*
+ * Returns time when given number of bytes are on wire
+ */
+PRIVATE uint32_t getWireTime(uint32_t length)
+{
+	return (uint32_t)((((uint64_t)length * BENCH_UART_BITS_PER_BYTE * 1000000) + link.baudRate - 1) / link.baudRate);
+}
+
+/*
+ * Returns number of bytes which are received by device until given time.
+ *	Bytes of a chunk are received when its last byte is on wire.
+ */
+PRIVATE uint32_t getArrivedLength(uint32_t time)
+{
+	uint64_t wireLength = ((uint64_t)time * link.baudRate) / (BENCH_UART_BITS_PER_BYTE * 1000000);
+
+	if (wireLength >= link.length)
+	{
+		return link.length;
+	}
+
+	return (uint32_t)((wireLength / link.chunkLength) * link.chunkLength);
+}
+
+/*
+ * Returns time when chunk of next unprocessed byte is received
+ */
+PRIVATE uint32_t getNextArrivalTime(void)
+{
+	uint32_t chunkEnd = ((link.consumedLength / link.chunkLength) + 1) * link.chunkLength;
+
+	return getWireTime(MATH_MIN(chunkEnd, link.length));
+}
+
+/*
+ * xorshift64 random number
+ */
+PRIVATE uint32_t getRandom(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+
+	return (uint32_t)(randomState >> 32);
+}
+
+/*
+ * Opens a file of test data directory
+ */
+PRIVATE FILE* openFile(const char* directory, const char* fileName, const char* mode)
+{
+	char path[BENCH_MAX_PATH_LENGTH];
+
+	snprintf(path, sizeof(path), "%s/%s", directory, fileName);
+
+	return fopen(path, mode);
+}
+
+/*
+ * Loads RSA private key of test images (rsa_priv.txt, "<NAME> = <HEX>" lines)
+ */
+PRIVATE bool loadSigningKey(const char* testDataPath)
+{
+	struct
+	{
+		const char* name;
+		mbedtls_mpi* number;
+	} const fields[] =
+	{
+		{ "N", &signingKey.N }, { "E", &signingKey.E }, { "D", &signingKey.D },
+		{ "P", &signingKey.P }, { "Q", &signingKey.Q }, { "DP", &signingKey.DP },
+		{ "DQ", &signingKey.DQ }, { "QP", &signingKey.QP }
+	};
+	char line[BENCH_MAX_LINE_LENGTH];
+	char name[8];
+	char value[BENCH_MAX_LINE_LENGTH];
+	uint32_t loadedFieldCount = 0;
+	uint32_t index;
+	FILE* file;
+
+	file = openFile(testDataPath, "rsa_priv.txt", "r");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	/* Benchmark signs images on host, bootloader does not use mbedTLS heap */
+	mbedtls_platform_set_calloc_free(calloc, free);
+	mbedtls_rsa_init(&signingKey, MBEDTLS_RSA_PKCS_V15, 0);
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		if (sscanf(line, "%7s = %1023s", name, value) != 2)
+		{
+			continue;
+		}
+
+		for (index = 0; index < sizeof(fields) / sizeof(fields[0]); index++)
+		{
+			if ((strcmp(name, fields[index].name) == 0) &&
+				(mbedtls_mpi_read_string(fields[index].number, 16, value) == 0))
+			{
+				loadedFieldCount++;
+			}
+		}
+	}
+
+	fclose(file);
+
+	signingKey.len = mbedtls_mpi_size(&signingKey.N);
+
+	return (loadedFieldCount == sizeof(fields) / sizeof(fields[0])) && (signingKey.len == FIRMWARE_SIGNATURE_LENGTH);
+}
+
+/*
+ * Fills metadata of image and signs it with test key
+ */
+PRIVATE bool signImage(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)benchImage;
+	uint8_t hash[32];
+
+	memset(benchImage, 0xFF, FIRMWARE_METADATA_LENGTH);
+	firmware->header.imageOffset = FIRMWARE_START_ADDRESS + FIRMWARE_METADATA_LENGTH;
+	firmware->header.imageSize = benchImageLength - FIRMWARE_METADATA_LENGTH;
+	firmware->header.signatureType = FIRMWARE_SIGNATURE_TYPE_RSA2048;
+
+	mbedtls_sha256(&benchImage[FIRMWARE_METADATA_LENGTH], firmware->header.imageSize, hash, 0);
+
+	return mbedtls_rsa_pkcs1_sign(&signingKey, NULL, NULL, MBEDTLS_RSA_PRIVATE,
+								  MBEDTLS_MD_SHA256, sizeof(hash), hash,
+								  firmware->imageSignature) == 0;
+}
+
+/*
+ * Loads an Intel HEX image of test data. Image is signed if it does not have
+ * metadata (e.g. App.hex).
+ */
+PRIVATE bool loadHexImage(const char* testDataPath, const char* fileName)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)benchImage;
+	char text[BENCH_MAX_LINE_LENGTH];
+	IntelHexLine line;
+	uint32_t parsedLength;
+	uint32_t segmentAddress = 0;
+	uint32_t address;
+	FILE* file;
+
+	file = openFile(testDataPath, fileName, "r");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	memset(benchImage, 0xFF, sizeof(benchImage));
+	benchImageLength = FIRMWARE_METADATA_LENGTH;
+
+	while (fgets(text, sizeof(text), file) != NULL)
+	{
+		if ((text[0] != INTELHEX_PREFIX) ||
+			(IntelHex_Parse((uint8_t*)text, (uint32_t)strlen(text), &line, &parsedLength) != IntelHex_Success))
+		{
+			continue;
+		}
+
+		if (line.recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+		{
+			segmentAddress = ((line.data[0] << 8) | line.data[1]) * INTELHEX_SEGMENT_SIZE;
+		}
+		else if (line.recordType == INTELHEX_RECORDTYPE_DATA)
+		{
+			address = segmentAddress + line.address;
+
+			/* Records outside of image (e.g. default CRP word) are not uploaded */
+			if ((address >= FIRMWARE_START_ADDRESS) && (address + line.lenght <= FIRMWARE_START_ADDRESS + BENCH_MAX_IMAGE_LENGTH))
+			{
+				memcpy(&benchImage[address - FIRMWARE_START_ADDRESS], line.data, line.lenght);
+				benchImageLength = MATH_MAX(benchImageLength, address + line.lenght - FIRMWARE_START_ADDRESS);
+			}
+		}
+	}
+
+	fclose(file);
+
+	if (firmware->header.imageOffset == 0xFFFFFFFF)
+	{
+		return signImage();
+	}
+
+	return true;
+}
+
+/*
+ * Creates a signed image with random content
+ */
+PRIVATE bool createImage(uint32_t length)
+{
+	uint32_t index;
+
+	randomState = 0x9E3779B97F4A7C15ULL;
+
+	for (index = FIRMWARE_METADATA_LENGTH; index < length; index++)
+	{
+		benchImage[index] = (uint8_t)getRandom();
+	}
+
+	benchImageLength = length;
+
+	return signImage();
+}
+
+/*
+ * Appends an Intel HEX record into stream
+ */
+PRIVATE uint32_t encodeHexRecord(uint8_t* stream, uint32_t type, uint32_t address, const uint8_t* data, uint32_t length)
+{
+	uint32_t streamLength;
+	uint32_t index;
+	uint8_t crc;
+
+	crc = (uint8_t)(length + (address >> 8) + address + type);
+	streamLength = (uint32_t)sprintf((char*)stream, ":%02X%04X%02X", length, address & 0xFFFF, type);
+
+	for (index = 0; index < length; index++)
+	{
+		crc += data[index];
+		streamLength += (uint32_t)sprintf((char*)&stream[streamLength], "%02X", data[index]);
+	}
+
+	streamLength += (uint32_t)sprintf((char*)&stream[streamLength], "%02X\n", (uint8_t)(0x100 - crc));
+
+	return streamLength;
+}
+
+/*
+ * Creates upload stream of image
+ *
+ * @return Length of stream
+ */
+PRIVATE uint32_t createStream(BenchTransport transport)
+{
+	uint32_t address = FIRMWARE_START_ADDRESS;
+	uint32_t length = 0;
+	uint32_t offset;
+	uint32_t recordLength;
+	uint8_t segment[2];
+
+	if (transport == BenchTransport_IntelHex)
+	{
+		for (offset = 0; offset < benchImageLength; offset += recordLength)
+		{
+			if ((offset == 0) || ((address + offset) % INTELHEX_SEGMENT_SIZE == 0))
+			{
+				segment[0] = (uint8_t)((address + offset) >> 24);
+				segment[1] = (uint8_t)((address + offset) >> 16);
+				length += encodeHexRecord(&benchStream[length], INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS, 0, segment, sizeof(segment));
+			}
+
+			recordLength = MATH_MIN(BENCH_HEX_RECORD_LENGTH, benchImageLength - offset);
+			length += encodeHexRecord(&benchStream[length], INTELHEX_RECORDTYPE_DATA, address + offset, &benchImage[offset], recordLength);
+		}
+
+		length += encodeHexRecord(&benchStream[length], INTELHEX_RECORDTYPE_EOF, 0, NULL, 0);
+	}
+	else if (transport == BenchTransport_BinFrame)
+	{
+		for (offset = 0; offset < benchImageLength; offset += recordLength)
+		{
+			recordLength = MATH_MIN(BINFRAME_MAX_PAYLOAD_LENGTH, benchImageLength - offset);
+			length += BinFrame_Encode(BINFRAME_TYPE_DATA, address + offset, &benchImage[offset], recordLength, &benchStream[length]);
+		}
+
+		length += BinFrame_Encode(BINFRAME_TYPE_END, 0, NULL, 0, &benchStream[length]);
+	}
+	else
+	{
+		for (offset = 0; offset < benchImageLength; offset += recordLength)
+		{
+			recordLength = MATH_MIN(BINFRAME_SEQ_PAYLOAD_LENGTH, benchImageLength - offset);
+			length += BinFrame_Encode(BINFRAME_TYPE_SEQ_DATA, offset / BINFRAME_SEQ_PAYLOAD_LENGTH, &benchImage[offset], recordLength, &benchStream[length]);
+		}
+
+		/* END frame keeps number of sequenced frames */
+		length += BinFrame_Encode(BINFRAME_TYPE_END, (benchImageLength + BINFRAME_SEQ_PAYLOAD_LENGTH - 1) / BINFRAME_SEQ_PAYLOAD_LENGTH,
+								  NULL, 0, &benchStream[length]);
+	}
+
+	return length;
+}
+
+/*
+ * Resets flash and writes an older image into whole image area, so upgrade
+ * erases sectors of new image
+ */
+PRIVATE void installOldImage(void)
+{
+	static uint8_t oldImageData[BINFRAME_MAX_PAYLOAD_LENGTH];
+	uint32_t address;
+	uint32_t blockNo;
+
+	Drv_Flash_SimulateReset();
+
+	memset(oldImageData, BENCH_OLD_IMAGE_VALUE, sizeof(oldImageData));
+
+	for (address = FIRMWARE_START_ADDRESS; address < FIRMWARE_START_ADDRESS + BENCH_MAX_IMAGE_LENGTH; address += sizeof(oldImageData))
+	{
+		blockNo = (uint32_t)Drv_Flash_GetBlockNoOfAddress(address);
+
+		Drv_Flash_PrepareBlock(blockNo);
+		Drv_Flash_Write(address, oldImageData, sizeof(oldImageData));
+	}
+}
+
+/*
+ * Checks that image is written into flash
+ */
+PRIVATE bool isImageInstalled(void)
+{
+	static uint8_t flashData[BENCH_MAX_IMAGE_LENGTH];
+
+	Drv_Flash_Read(FIRMWARE_START_ADDRESS, flashData, benchImageLength);
+
+	return memcmp(flashData, benchImage, benchImageLength) == 0;
+}
+
+/*
+ * Uploads image through paced UART
+ */
+PRIVATE void runUpload(const uint8_t* stream, uint32_t streamLength, uint32_t baudRate, uint32_t chunkLength, BenchResult* result)
+{
+	const BLUpgradeStats* stats;
+	volatile BLStatusCode status = BL_StatusUpgrade_MissingMetaData;
+	uint32_t measuredTime;
+
+	installOldImage();
+
+	memset(&link, 0, sizeof(link));
+	link.stream = stream;
+	link.length = streamLength;
+	link.chunkLength = chunkLength;
+	link.baudRate = baudRate;
+
+	if (setjmp(streamEndedJump) == 0)
+	{
+		status = BL_UpgradeFirmware();
+	}
+
+	stats = BL_GetUpgradeStats();
+
+	memset(result, 0, sizeof(*result));
+	result->status = status;
+	result->streamLength = streamLength;
+	result->totalTimeInUs = getDeviceTime();
+	result->wireTimeInUs = getWireTime(streamLength);
+	result->parseTimeInUs = link.parseTimeInUs;
+	result->programTimeInUs = stats->flashWriteTimeInUs;
+	result->journalTimeInUs = stats->journalTimeInUs;
+	result->journalRecordCount = stats->journalRecordCount;
+	result->eraseTimeInUs = stats->eraseTimeInUs;
+	result->verifyTimeInUs = stats->verifyTimeInUs;
+	result->maxBacklog = link.maxBacklog;
+
+	/* Rest of upload time is spent waiting for UART data */
+	measuredTime = result->parseTimeInUs + result->programTimeInUs + result->journalTimeInUs +
+				   result->eraseTimeInUs + result->verifyTimeInUs;
+	result->receiveTimeInUs = (result->totalTimeInUs > measuredTime) ? result->totalTimeInUs - measuredTime : 0;
+
+	if ((result->status == BL_Status_Success) && !isImageInstalled())
+	{
+		result->status = BL_StatusUpgrade_FlashVerifyFailure;
+	}
+}
+
+/*
+ * Opens CSV and JSON reports
+ */
+PRIVATE bool openReports(const char* outPath)
+{
+	csvFile = openFile(outPath, BENCH_REPORT_NAME ".csv", "w");
+	jsonFile = openFile(outPath, BENCH_REPORT_NAME ".json", "w");
+
+	if ((csvFile == NULL) || (jsonFile == NULL))
+	{
+		return false;
+	}
+
+	fprintf(csvFile, "revision,config,image,transport,baud,chunk,image_bytes,stream_bytes,"
+					 "total_us,wire_us,receive_us,parse_us,program_us,journal_us,journal_records,erase_us,verify_us,"
+					 "throughput_Bps,max_backlog,status\n");
+
+	fprintf(jsonFile, "{\n  \"benchmark\": \"UpgradeThroughput\",\n  \"revision\": \"%s\",\n  \"config\": \"%s\",\n  \"results\": [",
+			revision, BENCH_CONFIG_NAME);
+
+	return true;
+}
+
+/*
+ * Writes result of an upload into reports
+ */
+PRIVATE void reportResult(const char* imageName, BenchTransport transport, uint32_t baudRate, uint32_t chunkLength, const BenchResult* result)
+{
+	double throughput = (1000000.0 * benchImageLength) / result->totalTimeInUs;
+
+	fprintf(csvFile, "%s,%s,%s,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%.0f,%u,%d\n",
+			revision, BENCH_CONFIG_NAME, imageName, transportNames[transport], baudRate, chunkLength,
+			benchImageLength, result->streamLength,
+			result->totalTimeInUs, result->wireTimeInUs, result->receiveTimeInUs, result->parseTimeInUs,
+			result->programTimeInUs, result->journalTimeInUs, result->journalRecordCount,
+			result->eraseTimeInUs, result->verifyTimeInUs,
+			throughput, result->maxBacklog, result->status);
+
+	fprintf(jsonFile, "%s\n    { \"config\": \"%s\", \"image\": \"%s\", \"transport\": \"%s\", \"baud\": %u, \"chunk\": %u, "
+					  "\"image_bytes\": %u, \"stream_bytes\": %u, "
+					  "\"total_us\": %u, \"wire_us\": %u, \"receive_us\": %u, \"parse_us\": %u, "
+					  "\"program_us\": %u, \"journal_us\": %u, \"journal_records\": %u, \"erase_us\": %u, \"verify_us\": %u, "
+					  "\"throughput_Bps\": %.0f, \"max_backlog\": %u, \"status\": %d }",
+			(reportedResultCount > 0) ? "," : "",
+			BENCH_CONFIG_NAME, imageName, transportNames[transport], baudRate, chunkLength,
+			benchImageLength, result->streamLength,
+			result->totalTimeInUs, result->wireTimeInUs, result->receiveTimeInUs, result->parseTimeInUs,
+			result->programTimeInUs, result->journalTimeInUs, result->journalRecordCount,
+			result->eraseTimeInUs, result->verifyTimeInUs,
+			throughput, result->maxBacklog, result->status);
+
+	reportedResultCount++;
+
+	printf("  %-15s %-11s %7u %5u %10.1f %10.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %9.0f %8u%s\n",
+		   imageName, transportNames[transport], baudRate, chunkLength,
+		   result->totalTimeInUs / 1000.0, result->wireTimeInUs / 1000.0, result->receiveTimeInUs / 1000.0,
+		   result->parseTimeInUs / 1000.0, result->programTimeInUs / 1000.0, result->journalTimeInUs / 1000.0,
+		   result->eraseTimeInUs / 1000.0, result->verifyTimeInUs / 1000.0,
+		   throughput, result->maxBacklog,
+		   (result->status != BL_Status_Success) ? "  FAILED" : "");
+}
+
+/*
+ * Closes reports
+ */
+PRIVATE void closeReports(void)
+{
+	fprintf(jsonFile, "\n  ]\n}\n");
+
+	fclose(csvFile);
+	fclose(jsonFile);
+}
+
+/*
+ * Uploads current image with all transports, baud rates and chunk sizes
+ *
+ * @return Number of failed uploads
+ */
+PRIVATE uint32_t benchmarkImage(const char* imageName)
+{
+	BenchResult result;
+	BenchTransport transport;
+	uint32_t streamLength;
+	uint32_t failedRunCount = 0;
+	uint32_t baudIndex;
+	uint32_t chunkIndex;
+
+	for (transport = BenchTransport_IntelHex; transport < BenchTransport_Count; transport++)
+	{
+		streamLength = createStream(transport);
+
+		for (baudIndex = 0; baudIndex < sizeof(baudRates) / sizeof(baudRates[0]); baudIndex++)
+		{
+			for (chunkIndex = 0; chunkIndex < sizeof(chunkLengths) / sizeof(chunkLengths[0]); chunkIndex++)
+			{
+				runUpload(benchStream, streamLength, baudRates[baudIndex], chunkLengths[chunkIndex], &result);
+
+				reportResult(imageName, transport, baudRates[baudIndex], chunkLengths[chunkIndex], &result);
+
+				if (result.status != BL_Status_Success)
+				{
+					failedRunCount++;
+				}
+			}
+		}
+	}
+
+	return failedRunCount;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+
+/*
+ * Paced UART of device. Stream is received in chunks after their wire time,
+ * device waits for next chunk when all received bytes are processed.
+ */
+void Drv_UART_Init(void)
+{
+}
+
+UartHandle Drv_UART_Get(uint32_t uartNo, uint32_t baudRate, UARTDataReceivedEventHandler dataReceivedEventHandler)
+{
+	(void)baudRate;
+
+	/* Host starts sending when upgrade starts */
+	Drv_Timer_Start(deviceTimer, 0);
+
+	uartHandler = dataReceivedEventHandler;
+	uartHandler();
+
+	return (UartHandle)uartNo;
+}
+
+void Drv_UART_Release(UartHandle uart)
+{
+	(void)uart;
+}
+
+int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength)
+{
+	(void)uart;
+	(void)sendBuffer;
+
+	/* Responses of sequenced transfers are not used */
+	return (int32_t)sendLength;
+}
+
+int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength)
+{
+	uint8_t* span;
+	int32_t length;
+
+	length = MATH_MIN(Drv_UART_PeekSpan(uart, &span), (int32_t)receiveLength);
+	memcpy(receiveBuffer, span, (uint32_t)length);
+	Drv_UART_Consume(uart, (uint32_t)length);
+
+	return length;
+}
+
+int32_t Drv_UART_PeekSpan(UartHandle uart, uint8_t** span)
+{
+	uint32_t now = getDeviceTime();
+	uint32_t arrivedLength;
+
+	(void)uart;
+
+	if (link.consumedLength == link.length)
+	{
+		/* Upgrade waits for data after whole stream */
+		longjmp(streamEndedJump, 1);
+	}
+
+	arrivedLength = getArrivedLength(now);
+
+	if (arrivedLength == link.consumedLength)
+	{
+		/* Device is idle until next chunk arrives */
+		Drv_Flash_SimulateElapsedTime(getNextArrivalTime() - now);
+		arrivedLength = getArrivedLength(getDeviceTime());
+	}
+
+	link.maxBacklog = MATH_MAX(link.maxBacklog, arrivedLength - link.consumedLength);
+
+	link.spanStartTime = getDeviceTime();
+	link.spanStartStats = *BL_GetUpgradeStats();
+
+	*span = (uint8_t*)&link.stream[link.consumedLength];
+
+	return (int32_t)(arrivedLength - link.consumedLength);
+}
+
+void Drv_UART_Consume(UartHandle uart, uint32_t length)
+{
+	const BLUpgradeStats* stats = BL_GetUpgradeStats();
+	uint32_t spanTime = getDeviceTime() - link.spanStartTime;
+	uint32_t flashTime;
+
+	(void)uart;
+
+	/* Erase, writes of full buffers, journal checkpoints and signature check may run in span */
+	flashTime = (stats->eraseTimeInUs - link.spanStartStats.eraseTimeInUs) +
+				(stats->flashWriteTimeInUs - link.spanStartStats.flashWriteTimeInUs) +
+				(stats->journalTimeInUs - link.spanStartStats.journalTimeInUs) +
+				(stats->verifyTimeInUs - link.spanStartStats.verifyTimeInUs);
+
+	link.parseTimeInUs += (spanTime > flashTime) ? spanTime - flashTime : 0;
+	link.consumedLength += length;
+
+	/* Next span is waited in Drv_UART_PeekSpan */
+	uartHandler();
+}
+
+/*
+ * Benchmark entry point
+ *
+ *	argv[1] : Test data directory (images and rsa_priv.txt)
+ *	argv[2] : Output directory of reports
+ *	argv[3] : Revision which is written into reports (optional)
+ */
+int main(int argc, char* argv[])
+{
+	const char* hexImages[] = { "App.hex", "ER_IROM1.signed" };
+	char imageName[16];
+	uint32_t failedRunCount = 0;
+	uint32_t index;
+
+	if (argc < 3)
+	{
+		printf("\nUsage: %s <TestDataPath> <OutPath> [Revision]\n", argv[0]);
+		return RESULT_FAIL;
+	}
+
+	if (argc > 3)
+	{
+		revision = argv[3];
+	}
+
+	if (!loadSigningKey(argv[1]) || !openReports(argv[2]))
+	{
+		printf("\nTest key or report files cannot be opened\n");
+		return RESULT_FAIL;
+	}
+
+	Drv_Timer_Init();
+	deviceTimer = Drv_Timer_Create(BENCH_DEVICE_TIMER_NO, DRV_TIMER_PRI_LOW, deviceTimerCallback);
+
+	printf("\nUpgrade Throughput Benchmark (revision %s, %s configuration, times in ms)\n", revision, BENCH_CONFIG_NAME);
+	printf("  %-15s %-11s %7s %5s %10s %10s %8s %8s %8s %8s %8s %8s %9s %8s\n",
+		   "image", "stream", "baud", "chunk", "total", "wire", "receive", "parse", "program", "journal", "erase", "verify", "B/s", "backlog");
+
+	for (index = 0; index < sizeof(hexImages) / sizeof(hexImages[0]); index++)
+	{
+		if (!loadHexImage(argv[1], hexImages[index]))
+		{
+			printf("\n%s cannot be loaded\n", hexImages[index]);
+			return RESULT_FAIL;
+		}
+
+		failedRunCount += benchmarkImage(hexImages[index]);
+	}
+
+	for (index = 0; index < sizeof(syntheticImageLengths) / sizeof(syntheticImageLengths[0]); index++)
+	{
+		snprintf(imageName, sizeof(imageName), "%uK", syntheticImageLengths[index] / 1024);
+
+		if (!createImage(syntheticImageLengths[index]))
+		{
+			printf("\n%s image cannot be signed\n", imageName);
+			return RESULT_FAIL;
+		}
+
+		failedRunCount += benchmarkImage(imageName);
+	}
+
+	closeReports();
+
+	printf("\nReports : %s/" BENCH_REPORT_NAME ".csv, %s/" BENCH_REPORT_NAME ".json\n", argv[2], argv[2]);
+
+	mbedtls_rsa_free(&signingKey);
+
+	return (failedRunCount == 0) ? RESULT_SUCCESS : RESULT_FAIL;
+}
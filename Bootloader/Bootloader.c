@@ -8,7 +8,8 @@
  *          - Listens for upgrade attempt
  *              - Upgrades Firmware
  *          - Validates Firmware Image
- *              - Jumps to Firmware if Firmware has a valid signature
+ *              - Selects newest slot whose image has a valid signature
+ *              - Jumps to Firmware of selected slot
  *
  * @see
  *
@@ -28,6 +29,7 @@
 #include "Drv_UserTimer.h"
 #include "Drv_Timer.h"
 #include "Drv_CPUCore.h"
+#include "Drv_Flash.h"
 
 #include "Bootloader_Internal.h"
 #include "Bootloader_Config.h"
@@ -37,6 +39,9 @@
 
 /***************************** MACRO DEFINITIONS ******************************/
 
+/* RAM copy of a firmware slot in simulation mode, size of whole flash is enough */
+#define BL_SIMULATION_SLOT_BUFFER_SIZE			(512 * 1024)
+
 /***************************** TYPE DEFINITIONS *******************************/
 
 /*
@@ -52,19 +57,36 @@ typedef struct
 
 /******************************** VARIABLES ***********************************/
 /* Bootloader internal settings */
-PRIVATE BootloaderSettings settings = { { 0 } };
+PRIVATE BootloaderSettings settings = { NULL };
+
+#if SIMULATION_MODE
+/* Flash of simulated CPU is not memory mapped, so slot is read into RAM */
+PRIVATE uint32_t simulatedSlot[BL_SIMULATION_SLOT_BUFFER_SIZE / sizeof(uint32_t)];
+#endif
 
 /**************************** PRIVATE FUNCTIONS ******************************/
 /*
- * Reads Firmware Area and returns Meta Data of Firmware
+ * Reads Firmware Slot and returns Meta Data of Firmware
  * 
  */
-PRIVATE ALWAYS_INLINE void GetMetaData(FirmwareInfo** metaData)
+PRIVATE ALWAYS_INLINE void GetMetaData(uint32_t slotAddress, FirmwareInfo** metaData)
 {
 #if !SIMULATION_MODE
-	*metaData = (FirmwareInfo*)FIRMWARE_START_ADDRESS;
+	*metaData = (FirmwareInfo*)slotAddress;
 #else
-	/* Should be implemented */
+	FirmwareInfo* firmwareInfo = (FirmwareInfo*)simulatedSlot;
+	uint32_t length;
+
+	/* Image is read after metadata, an erased header is bounded by slot */
+	Drv_Flash_Read(slotAddress, (uint8_t*)simulatedSlot, FIRMWARE_METADATA_LENGTH);
+
+	length = MATH_MIN(BL_GetSlotEndAddress(slotAddress) - slotAddress, sizeof(simulatedSlot)) - FIRMWARE_METADATA_LENGTH;
+	length = MATH_MIN(firmwareInfo->header.imageSize, length);
+	firmwareInfo->header.imageSize = length;
+
+	Drv_Flash_Read(slotAddress + FIRMWARE_METADATA_LENGTH, (uint8_t*)firmwareInfo->image, length);
+
+	*metaData = firmwareInfo;
 #endif
 }
 
@@ -82,19 +104,49 @@ PRIVATE ALWAYS_INLINE bool CheckAndWaitForUpgradeAttemmp(void)
 }
 
 /*
- * Checks whether image (firmware) is valid. 
+ * Checks whether image (firmware) of a slot is valid.
  *  Valid image is an image which signed with valid signature. 
  *
  */
-PRIVATE ALWAYS_INLINE bool IsValidImage(void)
+PRIVATE BLStatusCode ValidateSlotImage(uint32_t slotAddress, uint8_t* imageHash)
 {
 	BLStatusCode statusCode;
 
 	/* Get Meta Data of Firmware */
-	GetMetaData(&settings.firmwareInfo);
+	GetMetaData(slotAddress, &settings.firmwareInfo);
 
 	/* Check whether image is valid */
-	statusCode = BL_ValidateImage(settings.firmwareInfo);
+	statusCode = BL_ValidateImage(settings.firmwareInfo, imageHash);
+
+	if (BL_Status_Success != statusCode)
+	{
+        DEBUG_PRINT(DEBUG_LEVEL_ERROR, "\nBL Err:%d", statusCode);
+	}
+
+	return statusCode;
+}
+
+/*
+ * Checks whether there is a valid image to boot.
+ *  Image of active slot is checked first, image of other slot boots if it
+ *  is not valid.
+ *
+ */
+PRIVATE ALWAYS_INLINE bool IsValidImage(void)
+{
+	BLStatusCode statusCode;
+	uint32_t slotAddress;
+	uint8_t imageHash[32];
+
+#if BL_VERDICT_RECORD_ENABLED
+	/* Image which is verified on a previous boot is not verified again */
+	if (BL_IsImageVerdictCached())
+	{
+		return true;
+	}
+#endif
+
+	statusCode = BL_SelectBootSlot(ValidateSlotImage, &slotAddress, imageHash);
 
 	if (BL_Status_Success != statusCode)
 	{
@@ -102,6 +154,10 @@ PRIVATE ALWAYS_INLINE bool IsValidImage(void)
         return false;
 	}
 
+#if BL_VERDICT_RECORD_ENABLED
+	BL_StoreImageVerdict(imageHash);
+#endif
+
 	return true;
 }
 
@@ -135,12 +191,23 @@ int main(void)
 {
 	bool upgradeFW = false;
 	bool validImage = false;
+	uint32_t upgradeSlotAddress;
+	BLStatusCode upgradeStatus;
     
     /* Initialize HW First */
     InitializeHW();
 
+#if BL_BOOT_TIME_MEASUREMENT
+    Drv_CPUCore_StartCycleCounter();
+#endif
+
     /* Initialize Bootloader Security */
     BL_SecurityInit();
+
+#if BL_VERDICT_RECORD_ENABLED
+	/* Policy counts boots, so it is not applied by retries of boot loop */
+	BL_VerdictInit();
+#endif
     
     do
     {
@@ -148,11 +215,36 @@ int main(void)
         upgradeFW = CheckAndWaitForUpgradeAttemmp();
         if (true == upgradeFW)
         {
-			//BL_UpgradeFirmware();
+			/* Upgrade hashes image while writing it and verifies its signature */
+			upgradeSlotAddress = BL_GetUpgradeSlotAddress();
+			upgradeStatus = BL_UpgradeFirmware();
+			validImage = (upgradeStatus == BL_Status_Success);
+
+			DEBUG_PRINT(DEBUG_LEVEL_INFO, "\nBL Upgrade:%d, erase %u us, write %u us, verify %u us",
+						upgradeStatus,
+						BL_GetUpgradeStats()->eraseTimeInUs,
+						BL_GetUpgradeStats()->flashWriteTimeInUs,
+						BL_GetUpgradeStats()->verifyTimeInUs);
+
+			/* New image is selected by a single record write */
+			if (true == validImage)
+			{
+				validImage = (BL_ActivateSlot(upgradeSlotAddress) == BL_Status_Success);
+			}
+
+#if BL_VERDICT_RECORD_ENABLED
+			if (true == validImage)
+			{
+				BL_StoreImageVerdict(BL_GetUpgradeImageHash());
+			}
+#endif
         }
         
-        /* Check Whether Firmware is valid (signed) */
-        validImage = IsValidImage();
+        /* Check Whether Firmware is valid (signed) unless it is just verified */
+        if (false == validImage)
+        {
+            validImage = IsValidImage();
+        }
 
 		/* TODO Sleep in case of fail */
         
@@ -162,7 +254,22 @@ int main(void)
     /*
      * Firmware is a validated image so just jump to firmware. 
      */
+    GetMetaData(BL_GetActiveSlotAddress(), &settings.firmwareInfo);
+
+#if BL_BOOT_TIME_MEASUREMENT
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "\nBL Boot:%u cycles", Drv_CPUCore_GetCycleCount());
+#endif
+
+#if BL_SECURITY_HEAP_ENABLED && BL_SECURITY_ARENA_ENABLED && BL_SECURITY_HEAP_REPORT
+    DEBUG_PRINT(DEBUG_LEVEL_INFO, "\nBL Heap:%u bytes", BL_GetSecurityHeapHighWaterMark());
+#endif
+
+#if !SIMULATION_MODE
     BL_JumpToFirmware((uint32_t)settings.firmwareInfo->image);
+#else
+    /* Image runs from simulated flash, not from RAM copy of slot */
+    BL_JumpToFirmware(BL_GetActiveSlotAddress() + FIRMWARE_METADATA_LENGTH);
+#endif
     
     return 0;
 }
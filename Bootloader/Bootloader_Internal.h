@@ -1,7 +1,12 @@
+#ifndef __BOOTLOADER_INTERNAL_H
+#define __BOOTLOADER_INTERNAL_H
+
 /********************************* INCLUDES ***********************************/
 
 #include "Bootloader_Config.h"
 
+#include "mbedtls/sha256.h"
+
 #include "Debug.h"
 #include "postypes.h"
 
@@ -9,6 +14,22 @@
 
 #define BL_JumpToFirmware                   Drv_CPUCore_JumpToImage
 
+/*
+ * Sector manifest of image which is placed into unused part of metadata.
+ *	Hashes are first bytes of SHA-256 of each flash sector of image area
+ *	(in image order, starting from start address of its slot).
+ */
+#define FIRMWARE_SECTOR_MANIFEST_MAGIC		(0x4E414D53)	/* "SMAN" */
+#define FIRMWARE_SECTOR_HASH_LENGTH			(16)
+#define FIRMWARE_MAX_MANIFEST_SECTOR_COUNT	(14)
+
+/*
+ * Signature schemes of images. Signature is placed at start of signature
+ * area of metadata. Images without a type field (erased) are RSA signed.
+ */
+#define FIRMWARE_SIGNATURE_TYPE_RSA2048		(0xFFFFFFFF)	/* PKCS#1 v1.5, 256 bytes */
+#define FIRMWARE_SIGNATURE_TYPE_ECDSA_P256	(0x00000001)	/* R | S, 64 bytes */
+
 /***************************** TYPE DEFINITIONS *******************************/
 /*
  * Bootlaoder Status Codes
@@ -21,6 +42,8 @@ typedef enum
 	BL_StatusSecurity_InvalidRSASignFormat = 11,
 	BL_StatusSecurity_MDVerFail = 12,
 	BL_StatusSecurity_RSAVerFail = 13,
+	BL_StatusSecurity_UnsupportedSignatureType = 14,
+	BL_StatusSecurity_ECDSAVerFail = 15,
 
 	BL_StatusDev_UartPortCannotBeOpened = 30,
 	BL_StatusDev_TimerCannotBeCreated,
@@ -28,6 +51,22 @@ typedef enum
 	BL_StatusUpgrade_InCompatibleFWOffset = 50,
 	BL_StatusUpgrade_FWExceedsFlash,
 	BL_StatusUpgrade_Timeout,
+	BL_StatusUpgrade_InvalidAddress,
+	BL_StatusUpgrade_OutOfOrderData,
+	BL_StatusUpgrade_MissingMetaData,
+	BL_StatusUpgrade_FlashWriteFailure,
+	BL_StatusUpgrade_FlashEraseFailure,
+	BL_StatusUpgrade_DeltaSourceMismatch,
+	BL_StatusUpgrade_InvalidDelta,
+	BL_StatusUpgrade_InvalidCompressedData,
+	BL_StatusUpgrade_FlashVerifyFailure,
+	BL_StatusUpgrade_ReceiveFailure,
+	BL_StatusUpgrade_CorruptedData,
+
+	BL_StatusVerdict_FlashFailure = 70,
+
+	BL_StatusSlot_FlashFailure = 80,
+	BL_StatusSlot_InvalidMetaData,
 
 
 
@@ -38,16 +77,91 @@ typedef struct
 {
 	uint32_t imageSize;
 	uint32_t imageOffset;
+	/* One of FIRMWARE_SIGNATURE_TYPE_X */
+	uint32_t signatureType;
 } FirmwareMetaDataHeader;
 
+typedef struct
+{
+	/* FIRMWARE_SECTOR_MANIFEST_MAGIC if manifest is available */
+	uint32_t magic;
+	/* Number of sectors which have a hash */
+	uint32_t sectorCount;
+	uint8_t sectorHashes[FIRMWARE_MAX_MANIFEST_SECTOR_COUNT][FIRMWARE_SECTOR_HASH_LENGTH];
+} FirmwareSectorManifest;
+
 typedef struct
 {
     FirmwareMetaDataHeader header;
-    uint32_t padding[(FIRMWARE_SIGNATURE_LENGTH - sizeof(FirmwareMetaDataHeader)) / sizeof(uint32_t)];
+    FirmwareSectorManifest sectorManifest;
+    uint32_t padding[(FIRMWARE_SIGNATURE_LENGTH - sizeof(FirmwareMetaDataHeader) - sizeof(FirmwareSectorManifest)) / sizeof(uint32_t)];
     uint8_t imageSignature[FIRMWARE_SIGNATURE_LENGTH];
     uint32_t image[1];
 } FirmwareInfo;
 
+/*
+ * Statistics of firmware upgrade
+ */
+typedef struct
+{
+	/* Number of flash write buffers which are written into flash */
+	uint32_t writtenBlockCount;
+	/* Number of times parser waited for a free flash write buffer */
+	uint32_t bufferStallCount;
+	/* Maximum number of filled buffers which waited for flash */
+	uint32_t maxPendingBufferCount;
+	/* Time spent in flash writes */
+	uint32_t flashWriteTimeInUs;
+	/* Time parser waited for flash writes */
+	uint32_t flashWaitTimeInUs;
+	/* Number of erase commands and erased blocks of image area */
+	uint32_t eraseCallCount;
+	uint32_t erasedBlockCount;
+	/* Number of blank blocks which are not erased */
+	uint32_t skippedBlankBlockCount;
+	/* Time spent in blank checks and erases */
+	uint32_t eraseTimeInUs;
+	/* Estimated erase time which is saved by skipping blank and unchanged blocks */
+	uint32_t savedEraseTimeInUs;
+	/* Number of blocks whose content matches sector manifest */
+	uint32_t unchangedBlockCount;
+	/* Time spent in hashing flash content */
+	uint32_t hashTimeInUs;
+	/* Estimated program time which is saved by skipping unchanged blocks */
+	uint32_t savedWriteTimeInUs;
+	/* Number of received delta bytes and source blocks which are backed up */
+	uint32_t deltaLength;
+	uint32_t deltaBackupBlockCount;
+	/* Number of received compressed bytes */
+	uint32_t compressedLength;
+	/* Time spent in decompression, including staging of decompressed data */
+	uint32_t decompressTimeInUs;
+	/* Time spent in read-back of written chunks, image hash and signature check */
+	uint32_t verifyTimeInUs;
+	/* Length of image which is not received again since it was written before an interruption */
+	uint32_t resumedLength;
+	/* Number of journal checkpoints which are written and time spent in them */
+	uint32_t journalRecordCount;
+	uint32_t journalTimeInUs;
+} BLUpgradeStats;
+
+/*
+ * Checkpoint of an upload which is recorded in upgrade journal
+ */
+typedef struct
+{
+	/* Length of image which is written and verified, from start of slot */
+	uint32_t committedLength;
+	/* Next image address to be hashed and digest state of image area before it */
+	uint32_t hashedAddress;
+	mbedtls_sha256_context hashContext;
+} BLUpgradeCheckpoint;
+
+/*
+ * Validates image of a slot and calculates its digest (see BL_SelectBootSlot)
+ */
+typedef BLStatusCode (*BLSlotImageValidator)(uint32_t slotAddress, uint8_t* imageHash);
+
 /**************************** FUNCTION PROTOTYPES *****************************/
 
 /******************************** VARIABLES ***********************************/
@@ -75,15 +189,172 @@ void BL_SecurityInit(void);
  *  
  *
  * @param fwMetaData Meta Data of Firmware. Includes image and signature info
- * @param rsaPublicKey RSA keys to validate image
+ * @param imageHash [out] SHA256 digest of image
  *
  * @retval BL_Status_Success Image has a valid signature and validation is OK
  * @retval BL_StatusSecurity_BadInput Invalid parameters
  * @retval BL_StatusSecuirty_InvalidRSASignFormat Invalid signature format
  * @retval BL_StatusSecurity_MDVerFail MD (Integrity) verification failure
  * @retval BL_StatusSecurity_RSAVerFail RSA validation failure
+ * @retval BL_StatusSecurity_ECDSAVerFail ECDSA validation failure
+ * @retval BL_StatusSecurity_UnsupportedSignatureType Scheme is not enabled
+ *
+ */
+BLStatusCode BL_ValidateImage(FirmwareInfo* fwMetaData, uint8_t* imageHash);
+
+/*
+ * Verifies signature of an image whose SHA256 digest is already
+ * calculated (e.g. while image is written during upgrade).
+ *
+ * @param signatureType Signature scheme in metadata header
+ * @param hash SHA256 digest of image
+ * @param signature Signature of image in metadata
+ *
+ * @retval BL_Status_Success Signature is valid
+ * @retval BL_StatusSecurity_BadInput Invalid public key
+ * @retval BL_StatusSecuirty_InvalidRSASignFormat Invalid signature format
+ * @retval BL_StatusSecurity_RSAVerFail RSA validation failure
+ * @retval BL_StatusSecurity_ECDSAVerFail ECDSA validation failure
+ * @retval BL_StatusSecurity_UnsupportedSignatureType Scheme is not enabled
+ */
+BLStatusCode BL_VerifyImageSignature(uint32_t signatureType, const uint8_t* hash, const uint8_t* signature);
+
+/*
+ * Returns highest number of used bytes of mbedTLS heap (arena) since
+ * BL_SecurityInit. Heap can be sized using this value.
+ */
+uint32_t BL_GetSecurityHeapHighWaterMark(void);
+
+/*
+ * Applies verification policy (e.g. watchdog reset, boot interval) of this
+ * boot. Must be called once per boot, before BL_IsImageVerdictCached.
+ */
+void BL_VerdictInit(void);
+
+/*
+ * Checks whether image of active slot can boot using cached verdict of its last
+ * verification (see Bootloader_Verdict.c).
  *
+ * @return true if signature check of image can be skipped
  */
-BLStatusCode BL_ValidateImage(FirmwareInfo* fwMetaData);
+bool BL_IsImageVerdictCached(void);
+
+/*
+ * Records verdict of image of active slot after its signature is verified
+ *
+ * @param imageHash SHA256 digest of verified image
+ *
+ * @retval BL_Status_Success Record is stored
+ * @retval BL_StatusVerdict_FlashFailure Record could not be written
+ */
+BLStatusCode BL_StoreImageVerdict(const uint8_t* imageHash);
+
+/*
+ * Invalidates cached verdict of image of a slot before slot is written
+ *
+ * @param slotAddress Start address of slot which is upgraded
+ *
+ * @retval BL_Status_Success Slot has no cached verdict
+ * @retval BL_StatusVerdict_FlashFailure Record could not be written
+ */
+BLStatusCode BL_InvalidateImageVerdict(uint32_t slotAddress);
+
+/*
+ * Returns start address of active slot. Slot A is active until a boot
+ * control record is stored (e.g. image is programmed by ISP).
+ */
+uint32_t BL_GetActiveSlotAddress(void);
+
+/*
+ * Returns start address of slot which is written by upgrades. It is the
+ * inactive slot, or slot A until a boot control record is stored.
+ */
+uint32_t BL_GetUpgradeSlotAddress(void);
+
+/*
+ * Returns end address (exclusive) of a slot
+ */
+uint32_t BL_GetSlotEndAddress(uint32_t slotAddress);
+
+/*
+ * Makes a slot active using a single record write. Nothing is written if
+ * slot is already active.
+ *
+ * @param slotAddress Start address of slot
+ *
+ * @retval BL_Status_Success Slot is active
+ * @retval BL_StatusSlot_FlashFailure Record could not be written
+ */
+BLStatusCode BL_ActivateSlot(uint32_t slotAddress);
+
+/*
+ * Selects slot to boot. Active slot is tried first, other slot boots if its
+ * image is valid and becomes active (rollback). Metadata is checked against
+ * slot before validator hashes image.
+ *
+ * @param validator Validates image of a slot
+ * @param slotAddress [out] Start address of selected slot
+ * @param imageHash [out] Digest of image which is calculated by validator
+ *
+ * @retval BL_Status_Success A valid image is selected
+ * @retval BL_StatusSlot_InvalidMetaData Metadata does not fit into its slot
+ * @retval BL_StatusSlot_FlashFailure Selected slot could not be activated
+ * @return Status of validator otherwise
+ */
+BLStatusCode BL_SelectBootSlot(BLSlotImageValidator validator, uint32_t* slotAddress, uint8_t* imageHash);
+
+/*
+ * Starts journal of a new upload. Records of previous uploads are erased.
+ *
+ * @param slotAddress Start address of upgraded slot
+ * @param metaData Received metadata of image
+ *
+ * @retval BL_Status_Success Journal is started
+ * @retval BL_StatusUpgrade_FlashEraseFailure Journal could not be erased
+ */
+BLStatusCode BL_StartUpgradeJournal(uint32_t slotAddress, const uint8_t* metaData);
+
+/*
+ * Finds latest checkpoint of an interrupted upload of same image into same
+ * slot. Journal of that upload is continued if a checkpoint is found.
+ *	Flash after checkpoint up to end of its sector must be blank, otherwise
+ *	an earlier checkpoint at start of sector is used.
+ *
+ * @param slotAddress Start address of upgraded slot
+ * @param metaData Received metadata of image
+ * @param checkpoint [out] Latest usable checkpoint
+ *
+ * @return true if upload can be resumed from checkpoint
+ */
+bool BL_ResumeUpgradeJournal(uint32_t slotAddress, const uint8_t* metaData, BLUpgradeCheckpoint* checkpoint);
+
+/*
+ * Records a checkpoint of started or resumed upload. Nothing is recorded
+ * when journal is full, upload is resumed from last recorded one then.
+ *
+ * @retval BL_Status_Success Checkpoint is recorded
+ * @retval BL_StatusUpgrade_FlashWriteFailure Record could not be written
+ */
+BLStatusCode BL_AppendUpgradeJournal(const BLUpgradeCheckpoint* checkpoint);
+
+/*
+ * Ends journal of upload, nothing is resumed afterwards
+ *
+ * @retval BL_Status_Success Journal is ended
+ * @retval BL_StatusUpgrade_FlashWriteFailure Record could not be written
+ */
+BLStatusCode BL_EndUpgradeJournal(void);
 
 BLStatusCode BL_UpgradeFirmware(void);
+
+/*
+ * Returns statistics of last firmware upgrade
+ */
+const BLUpgradeStats* BL_GetUpgradeStats(void);
+
+/*
+ * Returns SHA256 digest of image which is verified by last successful upgrade
+ */
+const uint8_t* BL_GetUpgradeImageHash(void);
+
+#endif	/* __BOOTLOADER_INTERNAL_H */
@@ -0,0 +1,388 @@
+/*******************************************************************************
+ *
+ * @file Bootloader_Journal.c
+ *
+ * @author MC
+ *
+ * @brief Upgrade journal of resumable uploads.
+ *
+ *		  A checkpoint is recorded after each block of an upload is written
+ *		  and verified. It keeps written length and running digest state of
+ *		  image area, so an upload which is interrupted by a power cut or a
+ *		  broken link continues after its last written block. Host is told
+ *		  first missing frame, only rest of image is sent again.
+ *
+ *		  Records are appended into 256 byte entries (IAP write size) and
+ *		  bound to slot and metadata digest of image, so another image
+ *		  starts from its first block. CRC covers whole entry, so an
+ *		  interrupted write is skipped and previous checkpoint is used.
+ *		  Journal is erased when a new upload starts, its sector has more
+ *		  entries than blocks of a slot.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_Flash.h"
+
+#include "Bootloader_Internal.h"
+#include "Bootloader_Config.h"
+
+#include "CRC32.h"
+
+#include "mbedtls/sha256.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+#if BL_UPGRADE_JOURNAL_ENABLED
+
+/* Magic of a journal record */
+#define BL_JOURNAL_RECORD_MAGIC					(0x4C524E4A)	/* "JNRL" */
+
+/* Records are written in entries of minimum IAP write size */
+#define BL_JOURNAL_ENTRY_SIZE					(256)
+
+/* Length of metadata digest */
+#define BL_JOURNAL_HASH_LENGTH					(32)
+
+/* Erased flash value */
+#define BL_JOURNAL_ERASED_FLASH_VALUE			(0xFF)
+
+/* Flash is read in pieces of this size */
+#define BL_JOURNAL_READ_LENGTH					(256)
+
+#endif
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+#if BL_UPGRADE_JOURNAL_ENABLED
+/*
+ * Journal record, fills an entry. CRC covers all fields before it.
+ *	A record without written length ends its upload.
+ */
+typedef struct
+{
+	uint32_t magic;
+	/* Upgraded slot */
+	uint32_t slotAddress;
+	/* Digest of metadata, binds record to image */
+	uint8_t metaDataHash[BL_JOURNAL_HASH_LENGTH];
+	BLUpgradeCheckpoint checkpoint;
+	uint8_t reserved[BL_JOURNAL_ENTRY_SIZE - (2 * sizeof(uint32_t)) - BL_JOURNAL_HASH_LENGTH - sizeof(BLUpgradeCheckpoint) - sizeof(uint32_t)];
+	uint32_t crc;
+} BLJournalRecord;
+#endif
+
+/******************************** VARIABLES ***********************************/
+
+#if BL_UPGRADE_JOURNAL_ENABLED
+/* Upload whose checkpoints are recorded */
+PRIVATE uint32_t journalSlotAddress;
+PRIVATE uint8_t journalMetaDataHash[BL_JOURNAL_HASH_LENGTH];
+
+/* Entry of next record */
+PRIVATE uint32_t journalNextEntryNo;
+#endif
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+
+#if BL_UPGRADE_JOURNAL_ENABLED
+/*
+ * Returns number of record entries in journal sector
+ */
+PRIVATE uint32_t getJournalEntryCount(void)
+{
+	return (Drv_Flash_GetBlockAddress(BL_UPGRADE_JOURNAL_BLOCK_NO + 1) - Drv_Flash_GetBlockAddress(BL_UPGRADE_JOURNAL_BLOCK_NO)) / BL_JOURNAL_ENTRY_SIZE;
+}
+
+/*
+ * Returns flash address of a record entry
+ */
+PRIVATE uint32_t getJournalEntryAddress(uint32_t entryNo)
+{
+	return Drv_Flash_GetBlockAddress(BL_UPGRADE_JOURNAL_BLOCK_NO) + (entryNo * BL_JOURNAL_ENTRY_SIZE);
+}
+
+/*
+ * Calculates CRC of record
+ */
+PRIVATE uint32_t calculateJournalCrc(const BLJournalRecord* record)
+{
+	return CRC32_Update(CRC32_INITIAL_VALUE, (const uint8_t*)record, sizeof(BLJournalRecord) - sizeof(record->crc));
+}
+
+/*
+ * Checks whether all bytes have erased flash value
+ */
+PRIVATE bool isBlankData(const uint8_t* data, uint32_t length)
+{
+	while (length-- > 0)
+	{
+		if (*data++ != BL_JOURNAL_ERASED_FLASH_VALUE)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Checks whether a checkpoint is at start of a flash sector
+ */
+PRIVATE bool isSectorStartCheckpoint(uint32_t slotAddress, const BLUpgradeCheckpoint* checkpoint)
+{
+	uint32_t address = slotAddress + checkpoint->committedLength;
+
+	return (Drv_Flash_GetBlockAddress((uint32_t)Drv_Flash_GetBlockNoOfAddress(address)) == address);
+}
+
+/*
+ * Checks whether upload can continue from a checkpoint.
+ *	Chunks after checkpoint may be programmed partially before interruption.
+ *	A sector is only erased as a whole, so rest of sector must be blank
+ *	unless checkpoint is at start of a sector.
+ */
+PRIVATE bool isResumableCheckpoint(uint32_t slotAddress, const BLUpgradeCheckpoint* checkpoint)
+{
+	uint8_t data[BL_JOURNAL_READ_LENGTH];
+	uint32_t address = slotAddress + checkpoint->committedLength;
+	uint32_t endAddress = Drv_Flash_GetBlockAddress((uint32_t)Drv_Flash_GetBlockNoOfAddress(address) + 1);
+	uint32_t length;
+
+	if (isSectorStartCheckpoint(slotAddress, checkpoint))
+	{
+		return true;
+	}
+
+	for (; address < endAddress; address += length)
+	{
+		length = MATH_MIN(sizeof(data), endAddress - address);
+
+		if ((Drv_Flash_Read(address, data, length) != FLASH_STATUS_SUCCESS) || !isBlankData(data, length))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Erases journal sector unless it is blank
+ */
+PRIVATE BLStatusCode eraseJournal(void)
+{
+	int32_t flashStatus = FLASH_STATUS_SUCCESS;
+
+	journalNextEntryNo = 0;
+
+	if (Drv_Flash_BlankCheckBlockRange(BL_UPGRADE_JOURNAL_BLOCK_NO, BL_UPGRADE_JOURNAL_BLOCK_NO) != FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_PrepareBlockRange(BL_UPGRADE_JOURNAL_BLOCK_NO, BL_UPGRADE_JOURNAL_BLOCK_NO);
+		if (flashStatus == FLASH_STATUS_SUCCESS)
+		{
+			flashStatus = Drv_Flash_EraseBlockRange(BL_UPGRADE_JOURNAL_BLOCK_NO, BL_UPGRADE_JOURNAL_BLOCK_NO);
+		}
+	}
+
+	return (flashStatus == FLASH_STATUS_SUCCESS) ? BL_Status_Success : BL_StatusUpgrade_FlashEraseFailure;
+}
+
+/*
+ * Writes a record of current upload into next entry
+ */
+PRIVATE BLStatusCode writeJournalRecord(const BLUpgradeCheckpoint* checkpoint)
+{
+	BLJournalRecord record;
+	BLJournalRecord readBack;
+	uint32_t address = getJournalEntryAddress(journalNextEntryNo);
+	int32_t flashStatus;
+
+	memset(&record, BL_JOURNAL_ERASED_FLASH_VALUE, sizeof(record));
+
+	record.magic = BL_JOURNAL_RECORD_MAGIC;
+	record.slotAddress = journalSlotAddress;
+	memcpy(record.metaDataHash, journalMetaDataHash, sizeof(record.metaDataHash));
+	record.checkpoint = *checkpoint;
+	record.crc = calculateJournalCrc(&record);
+
+	flashStatus = Drv_Flash_PrepareBlockRange(BL_UPGRADE_JOURNAL_BLOCK_NO, BL_UPGRADE_JOURNAL_BLOCK_NO);
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Write(address, (uint8_t*)&record, sizeof(record));
+	}
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Read(address, (uint8_t*)&readBack, sizeof(readBack));
+	}
+
+	/* Entry is used even if write fails, it is skipped by its CRC */
+	journalNextEntryNo++;
+
+	if ((flashStatus != FLASH_STATUS_SUCCESS) || (memcmp(&record, &readBack, sizeof(record)) != 0))
+	{
+		return BL_StatusUpgrade_FlashWriteFailure;
+	}
+
+	return BL_Status_Success;
+}
+#endif
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+
+#if BL_UPGRADE_JOURNAL_ENABLED
+/*
+ * Erases records of previous uploads and binds journal to new upload
+ */
+INTERNAL BLStatusCode BL_StartUpgradeJournal(uint32_t slotAddress, const uint8_t* metaData)
+{
+	journalSlotAddress = slotAddress;
+	mbedtls_sha256(metaData, FIRMWARE_METADATA_LENGTH, journalMetaDataHash, 0);
+
+	return eraseJournal();
+}
+
+/*
+ * Scans records in write order, latest checkpoint of upload is used unless
+ * rest of its sector is written partially
+ */
+INTERNAL bool BL_ResumeUpgradeJournal(uint32_t slotAddress, const uint8_t* metaData, BLUpgradeCheckpoint* checkpoint)
+{
+	BLJournalRecord record;
+	BLUpgradeCheckpoint sectorStartCheckpoint;
+	uint32_t entryCount = getJournalEntryCount();
+	uint32_t entryNo;
+	bool found = false;
+	bool sectorStartFound = false;
+
+	mbedtls_sha256(metaData, FIRMWARE_METADATA_LENGTH, journalMetaDataHash, 0);
+
+	for (entryNo = 0; entryNo < entryCount; entryNo++)
+	{
+		Drv_Flash_Read(getJournalEntryAddress(entryNo), (uint8_t*)&record, sizeof(record));
+
+		if (isBlankData((const uint8_t*)&record, sizeof(record)))
+		{
+			/* Entries are written in order, rest of journal is blank */
+			break;
+		}
+
+		if ((record.magic != BL_JOURNAL_RECORD_MAGIC) || (record.crc != calculateJournalCrc(&record)))
+		{
+			/* Interrupted write */
+			continue;
+		}
+
+		if ((record.slotAddress != slotAddress) ||
+			(memcmp(record.metaDataHash, journalMetaDataHash, sizeof(record.metaDataHash)) != 0) ||
+			(record.checkpoint.committedLength == 0))
+		{
+			/* Another upload or end of upload */
+			found = false;
+			sectorStartFound = false;
+			continue;
+		}
+
+		*checkpoint = record.checkpoint;
+		found = true;
+
+		if (isSectorStartCheckpoint(slotAddress, &record.checkpoint))
+		{
+			sectorStartCheckpoint = record.checkpoint;
+			sectorStartFound = true;
+		}
+	}
+
+	if (found && !isResumableCheckpoint(slotAddress, checkpoint))
+	{
+		/* Sector is erased again */
+		*checkpoint = sectorStartCheckpoint;
+		found = sectorStartFound;
+	}
+
+	if (found)
+	{
+		/* Continue journal of interrupted upload */
+		journalSlotAddress = slotAddress;
+		journalNextEntryNo = entryNo;
+	}
+
+	return found;
+}
+
+/*
+ * Appends a checkpoint record
+ */
+INTERNAL BLStatusCode BL_AppendUpgradeJournal(const BLUpgradeCheckpoint* checkpoint)
+{
+	if (journalNextEntryNo == getJournalEntryCount())
+	{
+		return BL_Status_Success;
+	}
+
+	return writeJournalRecord(checkpoint);
+}
+
+/*
+ * Appends a record without written length
+ */
+INTERNAL BLStatusCode BL_EndUpgradeJournal(void)
+{
+	BLUpgradeCheckpoint checkpoint;
+
+	memset(&checkpoint, 0, sizeof(checkpoint));
+
+	if (journalNextEntryNo == getJournalEntryCount())
+	{
+		/* There is no entry for end record */
+		return eraseJournal();
+	}
+
+	return writeJournalRecord(&checkpoint);
+}
+#else
+/*
+ * Uploads are not journaled, they start from first block
+ */
+INTERNAL BLStatusCode BL_StartUpgradeJournal(uint32_t slotAddress, const uint8_t* metaData)
+{
+	(void)slotAddress;
+	(void)metaData;
+
+	return BL_Status_Success;
+}
+
+INTERNAL bool BL_ResumeUpgradeJournal(uint32_t slotAddress, const uint8_t* metaData, BLUpgradeCheckpoint* checkpoint)
+{
+	(void)slotAddress;
+	(void)metaData;
+	(void)checkpoint;
+
+	return false;
+}
+
+INTERNAL BLStatusCode BL_AppendUpgradeJournal(const BLUpgradeCheckpoint* checkpoint)
+{
+	(void)checkpoint;
+
+	return BL_Status_Success;
+}
+
+INTERNAL BLStatusCode BL_EndUpgradeJournal(void)
+{
+	return BL_Status_Success;
+}
+#endif
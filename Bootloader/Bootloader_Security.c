@@ -18,6 +18,15 @@
  *          - In first phase, we do not support dynamic memory so we need to 
  *          provide a memory area for mbedTLS. See 'mbedTLSDynamicMemory' 
  *          variable
+ *          - RSA-2048 is verified by fixed width RSA2048 library, so
+ *          verification does not use heap and its stack is bounded. RSA of
+ *          mbedTLS can be selected by BL_SIGNATURE_RSA2048_FIXED_WIDTH.
+ *          - mbedTLS heap (only RSA of mbedTLS uses it) is an arena of size
+ *          class free lists (see Arena.h) which is reset after each signature
+ *          verification, unless BL_SECURITY_ARENA_ENABLED is disabled to use
+ *          memory_buffer_alloc of mbedTLS.
+ *          - Signature scheme is selected by metadata header. ECDSA P-256
+ *          is verified by P256 library which does not use mbedTLS heap.
  *          
  *          ROAD MAP
  *          1 - MBEDTLS_PKCS1_V15 is used but MBEDTLS_PKCS1_V21 should be 
@@ -48,138 +57,355 @@
 #include "mbedtls/md.h"
 #include "mbedtls/memory_buffer_alloc.h"
 
+#include "P256.h"
+#include "RSA2048.h"
+#include "Arena.h"
+
+#if BL_TEST_MODE
+/* TODO Remove Test Mode */
+#include "TestRSAKey.h"
+#include "TestECDSAKey.h"
+#endif
+
 #include "postypes.h"
 
 /***************************** MACRO DEFINITIONS ******************************/
 
-#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
+/* mbedTLS modules of security module (see verify-only mbedTLS configuration) */
+#if !defined(MBEDTLS_MD_C) || !defined(MBEDTLS_SHA256_C)
+#error "Image digest needs MBEDTLS_MD_C and MBEDTLS_SHA256_C"
+#endif
+
+#if BL_SIGNATURE_RSA2048_ENABLED && !BL_SIGNATURE_RSA2048_FIXED_WIDTH && \
+	(!defined(MBEDTLS_RSA_C) || !defined(MBEDTLS_PKCS1_V15))
+#error "RSA of mbedTLS needs MBEDTLS_RSA_C and MBEDTLS_PKCS1_V15"
+#endif
+
+#if BL_SECURITY_HEAP_ENABLED
 /*
  * Dynamic Memory Size for mbedTLS
  *  TODO This size is enough for RSA 2048 + SHA256.
  *  Shouls be evaluated when a feature is added or used.
  */
 #define BL_SECURITY_MBEDTLS_DYN_MEM_SIZE            (8 * 1024)
-#endif /* #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) */
+#endif /* #if BL_SECURITY_HEAP_ENABLED */
+
+/* mbedTLS heap is an arena */
+#define BL_SECURITY_MBEDTLS_ARENA					(BL_SECURITY_HEAP_ENABLED && BL_SECURITY_ARENA_ENABLED)
+
+/*
+ * Pair of 32 bit words of generated RSA key (see KeyGenerator.h) as words
+ * of RSA2048 library or as mbedTLS limbs
+ */
+#if BL_SIGNATURE_RSA2048_FIXED_WIDTH
+#define RSA_KEY_WORDS(low, high)					(low), (high)
+#elif defined(MBEDTLS_HAVE_INT64)
+#define RSA_KEY_WORDS(low, high)					(((mbedtls_mpi_uint)(high) << 32) | (low))
+#else
+#define RSA_KEY_WORDS(low, high)					(low), (high)
+#endif
+
+/* Number of limbs of a key array */
+#define RSA_KEY_LIMB_COUNT(limbs)					(sizeof(limbs) / sizeof(mbedtls_mpi_uint))
 
 /***************************** TYPE DEFINITIONS *******************************/
 
 /*
- * RSA Public Keys
+ * Verifier of a signature scheme
+ */
+typedef BLStatusCode (*BLSignatureVerifier)(const uint8_t* hash, const uint8_t* signature);
+
+/*
+ * Signature scheme which can be selected by metadata header
  */
 typedef struct
 {
-	char* publicKeyN;   /* N Part of RSA Key */
-	char* publicKeyE;   /* E Part of RSA Key */
-} RSAPublicKey;
+	uint32_t signatureType;
+	BLSignatureVerifier verify;
+} BLSignatureScheme;
 
 /**************************** FUNCTION PROTOTYPES *****************************/
 
+#if BL_SIGNATURE_RSA2048_ENABLED
+PRIVATE BLStatusCode VerifyRSASignature(const uint8_t* hash, const uint8_t* signature);
+#endif
+
+#if BL_SIGNATURE_ECDSA_P256_ENABLED
+PRIVATE BLStatusCode VerifyECDSASignature(const uint8_t* hash, const uint8_t* signature);
+#endif
+
 /******************************** VARIABLES ***********************************/
 /*
  * If Dynamic Memory (heap) is not supported, a memory area must be provided to
  * mbedTLS library. 
  * mbedTLS library uses
  */
-#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
+#if BL_SECURITY_HEAP_ENABLED
 PRIVATE uint8_t mbedTLSDynamicMemory[BL_SECURITY_MBEDTLS_DYN_MEM_SIZE];
-#endif  /* #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) */
+#endif  /* #if BL_SECURITY_HEAP_ENABLED */
+
+#if BL_SECURITY_MBEDTLS_ARENA
+PRIVATE Arena mbedTLSArena;
+#endif
+
+/*
+ * Enabled signature schemes
+ */
+PRIVATE const BLSignatureScheme signatureSchemes[] =
+{
+#if BL_SIGNATURE_RSA2048_ENABLED
+	{ FIRMWARE_SIGNATURE_TYPE_RSA2048, VerifyRSASignature },
+#endif
+#if BL_SIGNATURE_ECDSA_P256_ENABLED
+	{ FIRMWARE_SIGNATURE_TYPE_ECDSA_P256, VerifyECDSASignature },
+#endif
+};
 
 /**************************** PRIVATE FUNCTIONS ******************************/
 
+#if BL_SECURITY_MBEDTLS_ARENA
 /*
- * Reads RSA Keys and Returns
+ * calloc and free of mbedTLS on arena
  *
  */
-PRIVATE ALWAYS_INLINE void GetRSAKey(RSAPublicKey* key)
+PRIVATE void* ArenaCalloc(size_t count, size_t size)
+{
+	void* block;
+
+	if ((size != 0) && (count > (ARENA_MAX_BLOCK_LENGTH / size)))
+	{
+		return NULL;
+	}
+
+	block = Arena_Alloc(&mbedTLSArena, (uint32_t)(count * size));
+	if (block != NULL)
+	{
+		memset(block, 0, count * size);
+	}
+
+	return block;
+}
+
+PRIVATE void ArenaFree(void* block)
+{
+	Arena_Free(&mbedTLSArena, block);
+}
+#endif	/* #if BL_SECURITY_MBEDTLS_ARENA */
+
+#if BL_SIGNATURE_RSA2048_ENABLED && BL_SIGNATURE_RSA2048_FIXED_WIDTH
+/*
+ * Returns RSA-2048 public key and its R^2 mod N
+ *
+ */
+PRIVATE ALWAYS_INLINE const RSA2048PublicKey* GetRSAKey(void)
 {
     /* TODO Remove Test Mode */
 #if BL_TEST_MODE
-	key->publicKeyN = (char*)TEST_PUBLIC_KEY_N;
-	key->publicKeyE = (char*)TEST_PUBLIC_KEY_E;
+	static const RSA2048PublicKey publicKey = { TEST_RSA_KEY_N, TEST_RSA_KEY_RN };
+
+	return &publicKey;
 #else   /* #if BL_TEST_MODE */
 #error "Not defined yet!"
 #endif  /* #if BL_TEST_MODE */
 }
 
-/***************************** PUBLIC FUNCTIONS *******************************/
 /*
- * Initializes Security Module
+ * Verifies RSA2048 PKCS#1 v1.5 Signature of an Image using its SHA256 digest
+ *
+ *	Public exponent is 65537 and numbers are fixed size words on stack,
+ *	mbedTLS heap is not used.
+ *
  */
-INTERNAL void BL_SecurityInit(void)
+PRIVATE BLStatusCode VerifyRSASignature(const uint8_t* hash, const uint8_t* signature)
 {
-#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
-    mbedtls_memory_buffer_alloc_init(mbedTLSDynamicMemory, sizeof(mbedTLSDynamicMemory));
-#else   /* #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)*/
-    #error "You need to initialize Heap for dynamic memory allocations (e.g. calloc, free)"
-#endif  /* #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) */
+	switch (RSA2048_VerifySignature(GetRSAKey(), hash, signature))
+	{
+		case RSA2048_Success:
+			return BL_Status_Success;
+		case RSA2048_Err_InvalidPublicKey:
+			return BL_StatusSecurity_BadInput;
+		default:
+			return BL_StatusSecurity_RSAVerFail;
+	}
+}
+#elif BL_SIGNATURE_RSA2048_ENABLED
+/*
+ * Points a number to constant limbs. Number is only read by mbedTLS so it
+ * must not be freed.
+ *
+ */
+PRIVATE ALWAYS_INLINE void SetConstantMPI(mbedtls_mpi* number, const mbedtls_mpi_uint* limbs, size_t limbCount)
+{
+	number->s = 1;
+	number->n = limbCount;
+	number->p = (mbedtls_mpi_uint*)limbs;
 }
 
 /*
- * Validates Image using its Signature with RSA Keys
- * 
- *	Uses RSA2048 and SHA256 to verify and validate images. 
+ * Sets RSA public key and its R^2 mod N into context
+ *
+ *	Key is generated at build time as binary limbs, so it is not parsed and
+ *	mbedtls_mpi_exp_mod does not compute R^2 mod N.
+ *
+ */
+PRIVATE ALWAYS_INLINE void GetRSAKey(mbedtls_rsa_context* rsa)
+{
+    /* TODO Remove Test Mode */
+#if BL_TEST_MODE
+	static const mbedtls_mpi_uint publicKeyN[] = TEST_RSA_KEY_N;
+	static const mbedtls_mpi_uint publicKeyE[] = TEST_RSA_KEY_E;
+	static const mbedtls_mpi_uint publicKeyRN[] = TEST_RSA_KEY_RN;
+
+	SetConstantMPI(&rsa->N, publicKeyN, RSA_KEY_LIMB_COUNT(publicKeyN));
+	SetConstantMPI(&rsa->E, publicKeyE, RSA_KEY_LIMB_COUNT(publicKeyE));
+	SetConstantMPI(&rsa->RN, publicKeyRN, RSA_KEY_LIMB_COUNT(publicKeyRN));
+	rsa->len = sizeof(publicKeyN);
+#else   /* #if BL_TEST_MODE */
+#error "Not defined yet!"
+#endif  /* #if BL_TEST_MODE */
+}
+
+/*
+ * Verifies RSA2048 PKCS#1 v1.5 Signature of an Image using its SHA256 digest
  *
  */
-INTERNAL BLStatusCode BL_ValidateImage(FirmwareInfo* fwMetaData)
+PRIVATE BLStatusCode VerifyRSASignature(const uint8_t* hash, const uint8_t* signature)
 {
-    RSAPublicKey rsaPublicKey;
-	BLStatusCode status = BL_Status_Success;
-	int32_t retVal = false;
+	int32_t retVal;
 	mbedtls_rsa_context rsa;
-	unsigned char hash[32];
-    
-    /* Get RSA Keys first */
-    GetRSAKey(&rsaPublicKey);
 
 	/* Initialize RSA object */
 	mbedtls_rsa_init(&rsa, MBEDTLS_RSA_PKCS_V15, 0);
 
-	/* Read public key */
-	if ((retVal = mbedtls_mpi_read_string(&rsa.N, 16, rsaPublicKey.publicKeyN)) != 0 ||
-		(retVal = mbedtls_mpi_read_string(&rsa.E, 16, rsaPublicKey.publicKeyE)) != 0)
-	{
-		status = BL_StatusSecurity_BadInput;
-		
-		goto exit;
-	}
+	/* Get RSA Key */
+	GetRSAKey(&rsa);
 
-	/* TODO What do '+7' and '>>3 mean?'*/
-	rsa.len = (mbedtls_mpi_bitlen(&rsa.N) + 7) >> 3;
-	
 	if (rsa.len != FIRMWARE_SIGNATURE_LENGTH)
 	{
-		status = BL_StatusSecurity_InvalidRSASignFormat;
-
-		goto exit;
-	}
-
-    /* Check Data Integrity according to SHA */
-	retVal = mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
-						(unsigned char*)fwMetaData->image, fwMetaData->header.imageSize, hash);
-
-	if (retVal != 0)
-	{
-		status = BL_StatusSecurity_MDVerFail;
-
-		goto exit;
+		return BL_StatusSecurity_InvalidRSASignFormat;
 	}
 
     /* Check RSA Signature */
 	retVal = mbedtls_rsa_pkcs1_verify(&rsa, NULL, NULL, MBEDTLS_RSA_PUBLIC,
 									  MBEDTLS_MD_SHA256, 20, hash, 
-									  fwMetaData->imageSignature);
-	if (retVal != 0)
-	{
-		status = BL_StatusSecurity_RSAVerFail;
+									  signature);
 
-		goto exit;
+	/* Context only refers to constant key, so it is not freed */
+
+	return (retVal == 0) ? BL_Status_Success : BL_StatusSecurity_RSAVerFail;
+}
+#endif	/* #if BL_SIGNATURE_RSA2048_ENABLED && BL_SIGNATURE_RSA2048_FIXED_WIDTH */
+
+#if BL_SIGNATURE_ECDSA_P256_ENABLED
+/*
+ * Returns ECDSA P-256 public key (X | Y)
+ *
+ */
+PRIVATE ALWAYS_INLINE const uint8_t* GetECDSAKey(void)
+{
+    /* TODO Remove Test Mode */
+#if BL_TEST_MODE
+	static const uint8_t publicKey[P256_PUBLIC_KEY_LENGTH] = TEST_ECDSA_PUBLIC_KEY;
+
+	return publicKey;
+#else   /* #if BL_TEST_MODE */
+#error "Not defined yet!"
+#endif  /* #if BL_TEST_MODE */
+}
+
+/*
+ * Verifies ECDSA P-256 Signature of an Image using its SHA256 digest
+ *
+ *	Verifier works on fixed size words, mbedTLS heap is not used.
+ *
+ */
+PRIVATE BLStatusCode VerifyECDSASignature(const uint8_t* hash, const uint8_t* signature)
+{
+	switch (P256_VerifySignature(GetECDSAKey(), hash, signature))
+	{
+		case P256_Success:
+			return BL_Status_Success;
+		case P256_Err_InvalidPublicKey:
+			return BL_StatusSecurity_BadInput;
+		default:
+			return BL_StatusSecurity_ECDSAVerFail;
 	}
+}
+#endif	/* #if BL_SIGNATURE_ECDSA_P256_ENABLED */
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Initializes Security Module
+ */
+INTERNAL void BL_SecurityInit(void)
+{
+#if !BL_SECURITY_HEAP_ENABLED
+	/* Verifiers do not allocate memory */
+#elif BL_SECURITY_ARENA_ENABLED
+	Arena_Init(&mbedTLSArena, mbedTLSDynamicMemory, sizeof(mbedTLSDynamicMemory));
+	mbedtls_platform_set_calloc_free(ArenaCalloc, ArenaFree);
+#elif defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
+    mbedtls_memory_buffer_alloc_init(mbedTLSDynamicMemory, sizeof(mbedTLSDynamicMemory));
+#else   /* #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)*/
+    #error "You need to initialize Heap for dynamic memory allocations (e.g. calloc, free)"
+#endif  /* #if !BL_SECURITY_HEAP_ENABLED */
+}
 
-	status = BL_Status_Success;	
+#if BL_SECURITY_MBEDTLS_ARENA
+/*
+ * Returns highest usage of mbedTLS heap since initialization
+ */
+INTERNAL uint32_t BL_GetSecurityHeapHighWaterMark(void)
+{
+	return Arena_GetHighWaterMark(&mbedTLSArena);
+}
+#endif	/* #if BL_SECURITY_MBEDTLS_ARENA */
 
-exit:
-	/* Free RSA Resources */
-	mbedtls_rsa_free(&rsa);
+/*
+ * Verifies Signature of an Image using its SHA256 digest
+ *
+ *	Upgrade module calculates digest while image is written, so signature
+ *	check of a new image does not read image again. mbedTLS heap is reset
+ *	after verification.
+ *
+ */
+INTERNAL BLStatusCode BL_VerifyImageSignature(uint32_t signatureType, const uint8_t* hash, const uint8_t* signature)
+{
+	BLStatusCode status = BL_StatusSecurity_UnsupportedSignatureType;
+	uint32_t index;
+
+	for (index = 0; index < sizeof(signatureSchemes) / sizeof(signatureSchemes[0]); index++)
+	{
+		if (signatureSchemes[index].signatureType == signatureType)
+		{
+			status = signatureSchemes[index].verify(hash, signature);
+			break;
+		}
+	}
+
+#if BL_SECURITY_MBEDTLS_ARENA
+	/* Verifiers release their numbers, so heap is empty and its free lists are dropped */
+	Arena_Reset(&mbedTLSArena);
+#endif
 
 	return status;
 }
+
+/*
+ * Validates Image using its Signature
+ * 
+ *	Uses SHA256 and signature scheme of metadata header to verify and
+ *	validate images.
+ *
+ */
+INTERNAL BLStatusCode BL_ValidateImage(FirmwareInfo* fwMetaData, uint8_t* imageHash)
+{
+    /* Check Data Integrity according to SHA */
+	if (mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+				   (unsigned char*)fwMetaData->image, fwMetaData->header.imageSize, imageHash) != 0)
+	{
+		return BL_StatusSecurity_MDVerFail;
+	}
+
+	return BL_VerifyImageSignature(fwMetaData->header.signatureType, imageHash, fwMetaData->imageSignature);
+}
@@ -0,0 +1,442 @@
+/*******************************************************************************
+ *
+ * @file Bootloader_Slot.c
+ *
+ * @author MC
+ *
+ * @brief A/B firmware slots and boot control record.
+ *
+ *		  Upgrades are written into inactive slot while active slot keeps its
+ *		  image. After new image is verified, a boot control record which
+ *		  selects its slot is written. It is a single flash write, so a power
+ *		  cut leaves either old or new slot active and images are never
+ *		  copied between slots. If image of active slot is not valid, image
+ *		  of other slot boots and its slot becomes active (rollback).
+ *
+ *		  Records are appended into 256 byte entries (IAP write size) of two
+ *		  sectors. A monotonic counter orders records and CRC covers whole
+ *		  entry, so an interrupted write is skipped and previous record is
+ *		  used. When sector of latest record is full, other sector is erased
+ *		  and used, so latest record is never erased.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_Flash.h"
+
+#include "Bootloader_Internal.h"
+#include "Bootloader_Config.h"
+
+#include "CRC32.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+#if BL_AB_SLOTS_ENABLED
+
+/* Number of firmware slots */
+#define BL_SLOT_COUNT							(2)
+
+/* Magic of a boot control record */
+#define BL_BOOT_CONTROL_RECORD_MAGIC			(0x4C544342)	/* "BCTL" */
+
+/* Records are written in entries of minimum IAP write size */
+#define BL_BOOT_CONTROL_ENTRY_SIZE				(256)
+
+/* Erased flash value */
+#define BL_SLOT_ERASED_FLASH_VALUE				(0xFF)
+#define BL_SLOT_ERASED_FLASH_WORD				(0xFFFFFFFF)
+
+#else
+
+/* Single image at FIRMWARE_START_ADDRESS */
+#define BL_SLOT_COUNT							(1)
+
+#endif
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+#if BL_AB_SLOTS_ENABLED
+/*
+ * Boot control record, fills an entry. CRC covers all fields before it.
+ */
+typedef struct
+{
+	uint32_t magic;
+	/* Incremented for each record, latest record has highest one */
+	uint32_t counter;
+	/* Active slot, 0 for slot A and 1 for slot B */
+	uint32_t slotNo;
+	uint32_t reserved[(BL_BOOT_CONTROL_ENTRY_SIZE / sizeof(uint32_t)) - 4];
+	uint32_t crc;
+} BLBootControlRecord;
+#endif
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+
+#if BL_AB_SLOTS_ENABLED
+/*
+ * Returns start address of a slot
+ */
+PRIVATE uint32_t getFirmwareSlotAddress(uint32_t slotNo)
+{
+	return (slotNo == 0) ? FIRMWARE_START_ADDRESS : FIRMWARE_SLOT_B_ADDRESS;
+}
+
+/*
+ * Returns slot number of a slot address
+ */
+PRIVATE uint32_t getFirmwareSlotNo(uint32_t slotAddress)
+{
+	return (slotAddress == FIRMWARE_SLOT_B_ADDRESS) ? 1 : 0;
+}
+
+/*
+ * Returns number of record entries in a boot control sector
+ */
+PRIVATE uint32_t getEntryCount(void)
+{
+	return (Drv_Flash_GetBlockAddress(BL_BOOT_CONTROL_BLOCK_NO + 1) - Drv_Flash_GetBlockAddress(BL_BOOT_CONTROL_BLOCK_NO)) / BL_BOOT_CONTROL_ENTRY_SIZE;
+}
+
+/*
+ * Returns flash address of a record entry
+ */
+PRIVATE uint32_t getEntryAddress(uint32_t sectorNo, uint32_t entryNo)
+{
+	return Drv_Flash_GetBlockAddress(BL_BOOT_CONTROL_BLOCK_NO + sectorNo) + (entryNo * BL_BOOT_CONTROL_ENTRY_SIZE);
+}
+
+/*
+ * Calculates CRC of record
+ */
+PRIVATE uint32_t calculateBootControlCrc(const BLBootControlRecord* record)
+{
+	return CRC32_Update(CRC32_INITIAL_VALUE, (const uint8_t*)record, sizeof(BLBootControlRecord) - sizeof(record->crc));
+}
+
+/*
+ * Checks whether an entry is erased
+ */
+PRIVATE bool isErasedEntry(const BLBootControlRecord* record)
+{
+	const uint32_t* words = (const uint32_t*)record;
+	uint32_t index;
+
+	for (index = 0; index < sizeof(BLBootControlRecord) / sizeof(uint32_t); index++)
+	{
+		if (words[index] != BL_SLOT_ERASED_FLASH_WORD)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Checks whether an entry keeps a completely written record
+ */
+PRIVATE bool isValidBootControlRecord(const BLBootControlRecord* record)
+{
+	return (record->magic == BL_BOOT_CONTROL_RECORD_MAGIC) &&
+		   (record->slotNo < BL_SLOT_COUNT) &&
+		   (record->crc == calculateBootControlCrc(record));
+}
+
+/*
+ * Reads latest valid record and finds entry of next record.
+ *	Entries of a sector are written in order, so next entry follows last
+ *	written one, even if it is an interrupted record. If sector of latest
+ *	record is full, next record is written into first entry of other sector.
+ *
+ * @return true if a valid record exists
+ */
+PRIVATE bool readLatestBootControlRecord(BLBootControlRecord* latestRecord, uint32_t* nextSectorNo, uint32_t* nextEntryNo)
+{
+	BLBootControlRecord record;
+	uint32_t freeEntryNos[BL_BOOT_CONTROL_BLOCK_COUNT];
+	uint32_t entryCount = getEntryCount();
+	uint32_t latestSectorNo = 0;
+	uint32_t sectorNo;
+	uint32_t entryNo;
+	bool found = false;
+
+	for (sectorNo = 0; sectorNo < BL_BOOT_CONTROL_BLOCK_COUNT; sectorNo++)
+	{
+		freeEntryNos[sectorNo] = 0;
+
+		for (entryNo = 0; entryNo < entryCount; entryNo++)
+		{
+			Drv_Flash_Read(getEntryAddress(sectorNo, entryNo), (uint8_t*)&record, sizeof(record));
+
+			if (isErasedEntry(&record))
+			{
+				continue;
+			}
+
+			freeEntryNos[sectorNo] = entryNo + 1;
+
+			if (isValidBootControlRecord(&record) && (!found || (record.counter > latestRecord->counter)))
+			{
+				*latestRecord = record;
+				latestSectorNo = sectorNo;
+				found = true;
+			}
+		}
+	}
+
+	*nextSectorNo = latestSectorNo;
+	*nextEntryNo = freeEntryNos[latestSectorNo];
+
+	if (*nextEntryNo == entryCount)
+	{
+		*nextSectorNo = (latestSectorNo + 1) % BL_BOOT_CONTROL_BLOCK_COUNT;
+		*nextEntryNo = 0;
+	}
+
+	return found;
+}
+
+/*
+ * Writes a record into an entry. First entry of a sector is written after
+ * sector is erased, sector keeps only older records then.
+ */
+PRIVATE BLStatusCode writeBootControlRecord(uint32_t slotNo, uint32_t counter, uint32_t sectorNo, uint32_t entryNo)
+{
+	BLBootControlRecord record;
+	BLBootControlRecord readBack;
+	uint32_t blockNo = BL_BOOT_CONTROL_BLOCK_NO + sectorNo;
+	int32_t flashStatus = FLASH_STATUS_SUCCESS;
+
+	memset(&record, BL_SLOT_ERASED_FLASH_VALUE, sizeof(record));
+
+	record.magic = BL_BOOT_CONTROL_RECORD_MAGIC;
+	record.counter = counter;
+	record.slotNo = slotNo;
+	record.crc = calculateBootControlCrc(&record);
+
+	if ((entryNo == 0) && (Drv_Flash_BlankCheckBlockRange(blockNo, blockNo) != FLASH_STATUS_SUCCESS))
+	{
+		flashStatus = Drv_Flash_PrepareBlockRange(blockNo, blockNo);
+		if (flashStatus == FLASH_STATUS_SUCCESS)
+		{
+			flashStatus = Drv_Flash_EraseBlockRange(blockNo, blockNo);
+		}
+	}
+
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_PrepareBlockRange(blockNo, blockNo);
+	}
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Write(getEntryAddress(sectorNo, entryNo), (uint8_t*)&record, sizeof(record));
+	}
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Read(getEntryAddress(sectorNo, entryNo), (uint8_t*)&readBack, sizeof(readBack));
+	}
+
+	if ((flashStatus != FLASH_STATUS_SUCCESS) || (memcmp(&record, &readBack, sizeof(record)) != 0))
+	{
+		return BL_StatusSlot_FlashFailure;
+	}
+
+	return BL_Status_Success;
+}
+#else
+/*
+ * Returns start address of the only slot
+ */
+PRIVATE uint32_t getFirmwareSlotAddress(uint32_t slotNo)
+{
+	(void)slotNo;
+
+	return FIRMWARE_START_ADDRESS;
+}
+
+/*
+ * Returns slot number of the only slot
+ */
+PRIVATE uint32_t getFirmwareSlotNo(uint32_t slotAddress)
+{
+	(void)slotAddress;
+
+	return 0;
+}
+#endif
+
+/*
+ * Checks whether metadata of a slot describes an image inside slot, so
+ * image can be hashed. Erased and partially written metadata is rejected.
+ */
+PRIVATE bool isMetaDataOfSlot(uint32_t slotAddress)
+{
+	FirmwareMetaDataHeader header;
+	uint32_t maxImageSize = BL_GetSlotEndAddress(slotAddress) - slotAddress - FIRMWARE_METADATA_LENGTH;
+
+	if (Drv_Flash_Read(slotAddress, (uint8_t*)&header, sizeof(header)) != FLASH_STATUS_SUCCESS)
+	{
+		return false;
+	}
+
+	return (header.imageOffset == slotAddress + FIRMWARE_METADATA_LENGTH) && (header.imageSize <= maxImageSize);
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+
+#if BL_AB_SLOTS_ENABLED
+/*
+ * Returns start address of slot of latest record
+ */
+INTERNAL uint32_t BL_GetActiveSlotAddress(void)
+{
+	BLBootControlRecord record;
+	uint32_t sectorNo;
+	uint32_t entryNo;
+
+	if (!readLatestBootControlRecord(&record, &sectorNo, &entryNo))
+	{
+		return FIRMWARE_START_ADDRESS;
+	}
+
+	return getFirmwareSlotAddress(record.slotNo);
+}
+
+/*
+ * Returns start address of inactive slot
+ */
+INTERNAL uint32_t BL_GetUpgradeSlotAddress(void)
+{
+	BLBootControlRecord record;
+	uint32_t sectorNo;
+	uint32_t entryNo;
+
+	/*
+	 * Slot A is active until first record is written. Its image (e.g. a
+	 * factory image) runs, so it is kept and slot B is upgraded.
+	 */
+	if (!readLatestBootControlRecord(&record, &sectorNo, &entryNo))
+	{
+		return isMetaDataOfSlot(FIRMWARE_START_ADDRESS) ? getFirmwareSlotAddress(1) : FIRMWARE_START_ADDRESS;
+	}
+
+	return getFirmwareSlotAddress((record.slotNo + 1) % BL_SLOT_COUNT);
+}
+
+/*
+ * Returns end address of a slot
+ */
+INTERNAL uint32_t BL_GetSlotEndAddress(uint32_t slotAddress)
+{
+	return slotAddress + FIRMWARE_SLOT_SIZE;
+}
+
+/*
+ * Appends a record which selects slot
+ */
+INTERNAL BLStatusCode BL_ActivateSlot(uint32_t slotAddress)
+{
+	BLBootControlRecord record;
+	uint32_t sectorNo;
+	uint32_t entryNo;
+	uint32_t counter = 0;
+
+	if (readLatestBootControlRecord(&record, &sectorNo, &entryNo))
+	{
+		if (record.slotNo == getFirmwareSlotNo(slotAddress))
+		{
+			return BL_Status_Success;
+		}
+
+		counter = record.counter + 1;
+	}
+
+	return writeBootControlRecord(getFirmwareSlotNo(slotAddress), counter, sectorNo, entryNo);
+}
+#else
+/*
+ * Single image is always active and upgraded in place
+ */
+INTERNAL uint32_t BL_GetActiveSlotAddress(void)
+{
+	return FIRMWARE_START_ADDRESS;
+}
+
+INTERNAL uint32_t BL_GetUpgradeSlotAddress(void)
+{
+	return FIRMWARE_START_ADDRESS;
+}
+
+INTERNAL uint32_t BL_GetSlotEndAddress(uint32_t slotAddress)
+{
+	(void)slotAddress;
+
+#if BL_UPGRADE_JOURNAL_ENABLED
+	/* Image must not overwrite upgrade journal */
+	return Drv_Flash_GetBlockAddress(BL_UPGRADE_JOURNAL_BLOCK_NO);
+#else
+	return Drv_Flash_GetSize();
+#endif
+}
+
+INTERNAL BLStatusCode BL_ActivateSlot(uint32_t slotAddress)
+{
+	(void)slotAddress;
+
+	return BL_Status_Success;
+}
+#endif
+
+/*
+ * Selects active slot, or other slot if image of active slot is not valid
+ */
+INTERNAL BLStatusCode BL_SelectBootSlot(BLSlotImageValidator validator, uint32_t* slotAddress, uint8_t* imageHash)
+{
+	BLStatusCode status = BL_StatusSlot_InvalidMetaData;
+	uint32_t activeSlotNo = getFirmwareSlotNo(BL_GetActiveSlotAddress());
+	uint32_t index;
+
+	for (index = 0; index < BL_SLOT_COUNT; index++)
+	{
+		*slotAddress = getFirmwareSlotAddress((activeSlotNo + index) % BL_SLOT_COUNT);
+
+		if (!isMetaDataOfSlot(*slotAddress))
+		{
+			status = BL_StatusSlot_InvalidMetaData;
+			continue;
+		}
+
+		status = validator(*slotAddress, imageHash);
+		if (status == BL_Status_Success)
+		{
+			break;
+		}
+	}
+
+	if (status != BL_Status_Success)
+	{
+		return status;
+	}
+
+	/*
+	 * Record is written on first boot and after a rollback. Verdict of image
+	 * is stored for active slot, so image does not boot unless it is active.
+	 */
+	return BL_ActivateSlot(*slotAddress);
+}
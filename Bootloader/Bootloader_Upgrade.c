@@ -28,100 +28,1460 @@
 #include "Bootloader_Config.h"
 
 #include "IntelHex.h"
+#include "BinFrame.h"
+#include "Delta.h"
+#include "LZSS.h"
+#include "CRC32.h"
+
+#include "mbedtls/sha256.h"
 
 #include "postypes.h"
 
-/***************************** MACRO DEFINITIONS ******************************/
+/***************************** MACRO DEFINITIONS ******************************/
+/*
+ * Compiler switch to request missing parts of image.
+ *	Sequenced binary frames are acknowledged and missing or corrupted frames
+ *	are requested again (NAK) so host retransmits only them.
+ */
+#define BL_UPGRADE_REQUEST_MISSING_PARTS			(1)
+
+/*
+ * Timeout for Bootloader Upgrade
+ */
+#define BL_UPGRADE_TIMEOUT_IN_US					(1000 * 1000)
+
+/* Buffer size for flash writes */
+#define BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE          (4 * 1024)
+
+/*
+ * Number of flash write buffers. Parser fills a buffer while previous ones
+ * are written into flash.
+ */
+#define BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT			(2)
+
+/*
+ * Flash write buffers are programmed in chunks between UART receptions.
+ *	Interrupts are disabled during IAP commands, so a chunk keeps this window
+ *	short enough for UART RX FIFO. IAP accepts 256, 512, 1024 or 4096 bytes.
+ */
+#define BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE			(256)
+
+/*
+ * Maximum length of a received span which is parsed at once. Flash write
+ * chunks are programmed between spans, so it bounds the time between them.
+ */
+#define BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH			(256)
+
+/*
+ * Typical sector erase time of LPC17xx, same for 4K and 32K sectors.
+ *	Used to estimate erase time which is saved by skipping blank sectors.
+ */
+#define BL_UPGRADE_SECTOR_ERASE_TIME_IN_US			(100 * 1000)
+
+/*
+ * Typical program time of a flash write chunk.
+ *	Used to estimate program time which is saved by skipping unchanged sectors.
+ */
+#define BL_UPGRADE_CHUNK_PROGRAM_TIME_IN_US			(1000)
+
+/* Flash preparation is retried while IAP is busy */
+#define BL_UPGRADE_FLASH_BUSY_RETRY_COUNT			(1000)
+
+/* Erased flash value. Used to fill gaps in flash write buffer */
+#define BL_UPGRADE_ERASED_FLASH_VALUE				(0xFF)
+
+/*
+ * Sequenced frames which fill flash write buffer. Receive window is the
+ * block in flash write buffer, so it is tracked in a 32 bit bitmap.
+ */
+#define BL_UPGRADE_FRAMES_PER_BLOCK					(BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE / BINFRAME_SEQ_PAYLOAD_LENGTH)
+
+#if (BL_UPGRADE_FRAMES_PER_BLOCK > 32)
+#error "Sequenced frames of a block must fit into 32 bit bitmap"
+#endif
+
+/* No block is being written by delta update */
+#define BL_UPGRADE_DELTA_NO_BLOCK					(0xFFFFFFFF)
+
+/* Frame count is not known until END frame is received */
+#define BL_UPGRADE_UNKNOWN_FRAME_COUNT				(0xFFFFFFFF)
+
+/* Final ACK is repeated since there is no retransmission after upgrade */
+#define BL_UPGRADE_FINAL_ACK_REPEAT_COUNT			(3)
+
+/* Convert Big-Endian Array to Integer Value */
+#define CONVERT_BE_ARRAY_TO_INT(arr) \
+			((arr)[0] << 24) | ((arr)[1] << 16) | ((arr)[2] << 8) | ((arr)[3])
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Flash write buffer which waits to be written into flash
+ */
+typedef struct
+{
+	/* Flash write buffer */
+	uint8_t* data;
+	/* Flash address of buffer */
+	uint32_t address;
+	/* Length to be written, multiple of flash write chunk */
+	uint32_t length;
+	/* Already written part of buffer */
+	uint32_t writtenLength;
+} BLFlashWriteJob;
+
+/*
+ * Transport of firmware image. Detected using first byte of upgrade stream.
+ */
+typedef enum
+{
+	/* No data is received yet */
+	BL_UpgradeTransport_Unknown = 0,
+	/* ASCII Intel HEX lines, starts with ':' */
+	BL_UpgradeTransport_IntelHex,
+	/* Binary frames, starts with BINFRAME_START_OF_FRAME */
+	BL_UpgradeTransport_BinFrame
+} BLUpgradeTransport;
+
+/*
+ * Flash upgrade module internal settings
+ */
+typedef struct
+{
+	struct
+	{
+		uint32_t initialized : 1;			/* Upgrade Module initialized */
+		uint32_t dataReceived : 1;			/* Data received */
+		uint32_t upgradeTimeout : 1;		/* Image Upgrade timeout */
+		uint32_t metaDataCompleted : 1;		/* All Meta data received */
+		uint32_t eofReceived : 1;			/* End of image received */
+		uint32_t deltaUpgrade : 1;			/* Image is received as delta */
+		uint32_t journaled : 1;				/* Written blocks are recorded in upgrade journal */
+	} flags;
+	/* Status of upgrade, updated for each processed line */
+	BLStatusCode upgradeStatus;
+	/* Transport which is used by host */
+	BLUpgradeTransport transport;
+	/* Handle for UART which used for data upgrade */
+	UartHandle uartHandle;
+	/* Upgrade Timeout Handle */
+	TimerHandle timeoutTimerHandle;
+	/* Currently upgraded segment address */
+	uint32_t upgradeSegmentAddress;
+	/* Slot which is written by upgrade and its end address */
+	uint32_t slotAddress;
+	uint32_t slotEndAddress;
+	/* Offset of block in flash write buffer (from start of slot) */
+	uint32_t upgradeBlockOffset;
+	/* Length of filled part of flash write buffer */
+    uint32_t receivedDataLength;
+	/* Streaming Intel HEX parser */
+	IntelHexContext intelHexContext;
+	/* Data of current Intel HEX line in flash write buffer, NULL if not located */
+	uint8_t* intelHexLineData;
+	/* Streaming Binary Frame parser */
+	BinFrameContext binFrameContext;
+	/* Received sequenced frames of block in flash write buffer */
+	uint32_t receivedFrameBitmap;
+	/* Missing frames which are already requested from host */
+	uint32_t requestedFrameBitmap;
+	/* Number of sequenced frames, known after END frame */
+	uint32_t totalFrameCount;
+	/* Blocks (bit per block number) whose content already matches new image */
+	uint32_t unchangedBlockBitmap;
+	/* Streaming delta decoder */
+	DeltaContext deltaContext;
+	/* Received length of delta */
+	uint32_t deltaReceivedLength;
+	/* Installed image which is source of delta, in active slot */
+	uint32_t deltaSourceAddress;
+	uint32_t deltaSourceLength;
+	/* Block which is written by delta, its source content is in scratch block */
+	uint32_t deltaBlockNo;
+	/* Error of delta callbacks which stopped decoder */
+	BLStatusCode deltaStatus;
+	/* Streaming decompressor, its window is the only buffer of compressed upgrades */
+	LZSSContext lzssContext;
+	/* Received length of compressed stream */
+	uint32_t compressedReceivedLength;
+	/* Error of decompressed data which stopped decompressor */
+	BLStatusCode lzssStatus;
+	/* Digest of image area, fed in address order as chunks are written */
+	mbedtls_sha256_context imageHashContext;
+	/* Next image address to be hashed and end of image area */
+	uint32_t hashedAddress;
+	uint32_t imageEndAddress;
+	/* Digest of image, valid after image is verified */
+	uint8_t imageHash[32];
+	/* Filled flash write buffers in write order */
+	BLFlashWriteJob flashWriteQueue[BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT];
+	uint32_t flashWriteQueueHead;
+	uint32_t flashWriteQueueCount;
+	/* Statistics of upgrade */
+	BLUpgradeStats stats;
+} FWUpgradeSettings;
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+PRIVATE bool deltaHeaderHandler(const DeltaHeader* header);
+PRIVATE bool deltaSourceReader(uint32_t offset, uint8_t* data, uint32_t length);
+PRIVATE bool deltaOutputHandler(uint32_t offset, const uint8_t* data, uint32_t length);
+PRIVATE bool lzssOutputHandler(uint32_t offset, const uint8_t* data, uint32_t length);
+
+/******************************** VARIABLES ***********************************/
+/* Upgrade module internal settings */
+PRIVATE FWUpgradeSettings upgradeSettings;
+
+/* Flash write buffers. IAP requires word aligned source. */
+PRIVATE uint32_t flashWriteBuffers[BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT][BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE / sizeof(uint32_t)];
+
+/* Flash write buffer which is filled by parser */
+PRIVATE uint8_t* blockData = (uint8_t*)flashWriteBuffers[0];
+
+/* Payload buffer for binary frames */
+PRIVATE uint8_t framePayload[BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE];
+
+/* Delta decoder callbacks */
+PRIVATE const DeltaHandlers deltaHandlers = { deltaHeaderHandler, deltaSourceReader, deltaOutputHandler };
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/**
+ * Upgrade Timeout Event Handler
+ *
+ */
+PRIVATE void UpgradeTimeoutEventHandler(void)
+{
+	upgradeSettings.flags.upgradeTimeout = true;
+}
+
+/*
+ * Restarts upgrade timeout when host is known to be alive
+ */
+PRIVATE void restartUpgradeTimeout(void)
+{
+	upgradeSettings.flags.upgradeTimeout = false;
+	Drv_Timer_Start(upgradeSettings.timeoutTimerHandle, BL_UPGRADE_TIMEOUT_IN_US);
+}
+
+/**
+ * UART Data Received Event Handler
+ *
+ */
+PRIVATE void DataReceivedEventHandler(void)
+{
+	upgradeSettings.flags.dataReceived = true;
+}
+
+/*
+ * Prepares blocks for an erase or write command.
+ *	IAP clears preparation after each erase and write command.
+ */
+PRIVATE int32_t prepareBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint32_t retryCount = 0;
+	int32_t flashStatus;
+
+	do
+	{
+		flashStatus = Drv_Flash_PrepareBlockRange(startBlockNo, endBlockNo);
+
+		/* Try until it is ready */
+	} while ((flashStatus == FLASH_STATUS_BUSY) && (++retryCount < BL_UPGRADE_FLASH_BUSY_RETRY_COUNT));
+
+	return flashStatus;
+}
+
+/*
+ * Erases consecutive blocks using a single erase command
+ */
+PRIVATE BLStatusCode eraseBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	int32_t flashStatus;
+
+	flashStatus = prepareBlockRange(startBlockNo, endBlockNo);
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_EraseBlockRange(startBlockNo, endBlockNo);
+	}
+
+	upgradeSettings.stats.eraseCallCount++;
+	upgradeSettings.stats.erasedBlockCount += endBlockNo - startBlockNo + 1;
+
+	return (flashStatus == FLASH_STATUS_SUCCESS) ? BL_Status_Success : BL_StatusUpgrade_FlashEraseFailure;
+}
+
+/*
+ * Checks whether content of block already matches new image
+ */
+PRIVATE bool isBlockUnchanged(uint32_t blockNo)
+{
+	return (blockNo < 32) && ((upgradeSettings.unchangedBlockBitmap & (1UL << blockNo)) != 0);
+}
+
+/*
+ * Calculates hash of block content as it is stored in sector manifest
+ */
+PRIVATE void hashFlashBlock(uint32_t blockNo, uint8_t* hash)
+{
+	mbedtls_sha256_context sha256Context;
+	uint8_t data[BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE];
+	uint8_t digest[32];
+	uint32_t address;
+	uint32_t endAddress;
+
+	address = Drv_Flash_GetBlockAddress(blockNo);
+	endAddress = Drv_Flash_GetBlockAddress(blockNo + 1);
+
+	mbedtls_sha256_init(&sha256Context);
+	mbedtls_sha256_starts(&sha256Context, 0);
+
+	for (; address < endAddress; address += sizeof(data))
+	{
+		Drv_Flash_Read(address, data, sizeof(data));
+		mbedtls_sha256_update(&sha256Context, data, sizeof(data));
+	}
+
+	mbedtls_sha256_finish(&sha256Context, digest);
+	mbedtls_sha256_free(&sha256Context);
+
+	memcpy(hash, digest, FIRMWARE_SECTOR_HASH_LENGTH);
+}
+
+/*
+ * Finds blocks whose content already matches new image using sector manifest.
+ *
+ *	Hashing a sector takes a fraction of its erase and program time, so a new
+ *	image which changes only a few functions writes only a few sectors. First
+ *	block holds metadata (including manifest itself) and is always written.
+ *	Manifest is not signed but flash content is validated against signature
+ *	of image after upgrade, so a wrong manifest cannot produce a valid image.
+ */
+PRIVATE void findUnchangedBlocks(const FirmwareSectorManifest* manifest, uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint8_t hash[FIRMWARE_SECTOR_HASH_LENGTH];
+	uint32_t sectorCount;
+	uint32_t sectorNo;
+	uint32_t startTime;
+
+	upgradeSettings.unchangedBlockBitmap = 0;
+
+	if (manifest->magic != FIRMWARE_SECTOR_MANIFEST_MAGIC)
+	{
+		/* Image is not prepared for differential upgrade */
+		return;
+	}
+
+	sectorCount = MATH_MIN(manifest->sectorCount, FIRMWARE_MAX_MANIFEST_SECTOR_COUNT);
+	sectorCount = MATH_MIN(sectorCount, endBlockNo - startBlockNo + 1);
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	for (sectorNo = 1; sectorNo < sectorCount; sectorNo++)
+	{
+		hashFlashBlock(startBlockNo + sectorNo, hash);
+
+		if ((startBlockNo + sectorNo < 32) &&
+			(memcmp(hash, manifest->sectorHashes[sectorNo], FIRMWARE_SECTOR_HASH_LENGTH) == 0))
+		{
+			upgradeSettings.unchangedBlockBitmap |= 1UL << (startBlockNo + sectorNo);
+			upgradeSettings.stats.unchangedBlockCount++;
+		}
+	}
+
+	upgradeSettings.stats.hashTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+}
+
+/*
+ * Erases blocks of image area once before image is written.
+ *
+ *	Erase takes ~100ms per sector with interrupts disabled while blank check
+ *	only reads the sector. So blank blocks (e.g. on a new device or after an
+ *	interrupted upgrade) and unchanged blocks are skipped and each run of
+ *	consecutive blocks to be erased is erased with a single command.
+ */
+PRIVATE BLStatusCode eraseImageArea(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	BLStatusCode status = BL_Status_Success;
+	uint32_t eraseStartBlockNo = startBlockNo;
+	uint32_t blockNo;
+	uint32_t startTime;
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	/* Check whole area at once first, it is blank on a new device */
+	if ((upgradeSettings.unchangedBlockBitmap == 0) &&
+		(Drv_Flash_BlankCheckBlockRange(startBlockNo, endBlockNo) == FLASH_STATUS_SUCCESS))
+	{
+		upgradeSettings.stats.skippedBlankBlockCount += endBlockNo - startBlockNo + 1;
+		eraseStartBlockNo = endBlockNo + 1;
+	}
+	else
+	{
+		for (blockNo = startBlockNo; blockNo <= endBlockNo; blockNo++)
+		{
+			/* Block is erased unless it is known to be unchanged or blank */
+			if (isBlockUnchanged(blockNo))
+			{
+				/* Counted by findUnchangedBlocks */
+			}
+			else if (Drv_Flash_BlankCheckBlockRange(blockNo, blockNo) == FLASH_STATUS_SUCCESS)
+			{
+				upgradeSettings.stats.skippedBlankBlockCount++;
+			}
+			else
+			{
+				continue;
+			}
+
+			/* Skipped block ends a run of blocks to be erased */
+			if (eraseStartBlockNo < blockNo)
+			{
+				status = eraseBlockRange(eraseStartBlockNo, blockNo - 1);
+				if (status != BL_Status_Success)
+				{
+					break;
+				}
+			}
+
+			eraseStartBlockNo = blockNo + 1;
+		}
+	}
+
+	if ((status == BL_Status_Success) && (eraseStartBlockNo <= endBlockNo))
+	{
+		status = eraseBlockRange(eraseStartBlockNo, endBlockNo);
+	}
+
+	upgradeSettings.stats.eraseTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+	upgradeSettings.stats.savedEraseTimeInUs = (upgradeSettings.stats.skippedBlankBlockCount + upgradeSettings.stats.unchangedBlockCount) * BL_UPGRADE_SECTOR_ERASE_TIME_IN_US;
+
+	/* Host is not late, erase took the time */
+	restartUpgradeTimeout();
+
+	return status;
+}
+
+/*
+ * Continues an interrupted upload of same image after its last written block.
+ *	Blocks before checkpoint are not written again, image digest continues
+ *	from its state at checkpoint. Rest of sector of checkpoint is blank, so
+ *	only following sectors are erased.
+ */
+PRIVATE BLStatusCode resumeUpgrade(const BLUpgradeCheckpoint* checkpoint, uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)blockData;
+	uint32_t resumeAddress = upgradeSettings.slotAddress + checkpoint->committedLength;
+	uint32_t resumeBlockNo = (uint32_t)Drv_Flash_GetBlockNoOfAddress(resumeAddress);
+	BLStatusCode status = BL_Status_Success;
+
+	upgradeSettings.hashedAddress = checkpoint->hashedAddress;
+	upgradeSettings.imageHashContext = checkpoint->hashContext;
+
+	findUnchangedBlocks(&firmware->sectorManifest, startBlockNo, endBlockNo);
+
+	if (Drv_Flash_GetBlockAddress(resumeBlockNo) != resumeAddress)
+	{
+		resumeBlockNo++;
+	}
+
+	if (resumeBlockNo <= endBlockNo)
+	{
+		status = eraseImageArea(resumeBlockNo, endBlockNo);
+	}
+
+	/* First block is discarded, host continues from checkpoint */
+	upgradeSettings.upgradeBlockOffset = checkpoint->committedLength;
+	upgradeSettings.receivedDataLength = 0;
+	upgradeSettings.stats.resumedLength = checkpoint->committedLength;
+
+	return status;
+}
+
+/*
+ * Checks metadata of firmware and erases flash upgrade area.
+ *	Resumable uploads continue from checkpoint of an interrupted upload of
+ *	same image, otherwise a new journal is started.
+ */
+PRIVATE BLStatusCode processMetaData(bool resumable)
+{
+	/* Firmware object including header, metadata and image */
+	FirmwareInfo* firmware = (FirmwareInfo*)blockData;
+	BLUpgradeCheckpoint checkpoint;
+	BLStatusCode status;
+	uint32_t firstBlockAddress;
+	uint32_t startBlockNo;
+	uint32_t endBlockNo;
+
+	firstBlockAddress = firmware->header.imageOffset - FIRMWARE_METADATA_LENGTH;
+
+	if (firstBlockAddress != upgradeSettings.slotAddress)
+	{
+		/* UPS FW is not linked for slot which is upgraded, nothing is erased */
+		return BL_StatusUpgrade_InCompatibleFWOffset;
+	}
+
+	if (firmware->header.imageOffset + firmware->header.imageSize > upgradeSettings.slotEndAddress)
+	{
+		/* UPS Firmware exceeds slot */
+		return BL_StatusUpgrade_FWExceedsFlash;
+	}
+
+	/* Find range of FW Image blocks */
+	startBlockNo = Drv_Flash_GetBlockNoOfAddress(firstBlockAddress);
+	endBlockNo = Drv_Flash_GetBlockNoOfAddress(firmware->header.imageOffset + firmware->header.imageSize - 1);
+
+	/* Image area is hashed while it is written, see hashImageData */
+	upgradeSettings.hashedAddress = firmware->header.imageOffset;
+	upgradeSettings.imageEndAddress = firmware->header.imageOffset + firmware->header.imageSize;
+	mbedtls_sha256_init(&upgradeSettings.imageHashContext);
+	mbedtls_sha256_starts(&upgradeSettings.imageHashContext, 0);
+
+	upgradeSettings.flags.metaDataCompleted = 1;
+	upgradeSettings.flags.journaled = resumable;
+
+#if BL_VERDICT_RECORD_ENABLED
+	/* Slot is rewritten, a partially written image must be verified on boot */
+	status = BL_InvalidateImageVerdict(upgradeSettings.slotAddress);
+	if (status != BL_Status_Success)
+	{
+		return status;
+	}
+#endif
+
+	if (resumable &&
+		BL_ResumeUpgradeJournal(upgradeSettings.slotAddress, blockData, &checkpoint) &&
+		(upgradeSettings.slotAddress + checkpoint.committedLength < upgradeSettings.imageEndAddress))
+	{
+		return resumeUpgrade(&checkpoint, startBlockNo, endBlockNo);
+	}
+
+	/* Stale journal must not resume after this upload writes the slot */
+	status = BL_StartUpgradeJournal(upgradeSettings.slotAddress, blockData);
+	if (status != BL_Status_Success)
+	{
+		return status;
+	}
+
+	/* Delta updates erase each block just before it is written */
+	if (upgradeSettings.flags.deltaUpgrade == 0)
+	{
+		findUnchangedBlocks(&firmware->sectorManifest, startBlockNo, endBlockNo);
+
+		status = eraseImageArea(startBlockNo, endBlockNo);
+	}
+
+	return status;
+}
+
+/*
+ * Hashes flash content of image area up to given address.
+ *	Used for parts which are not written by upgrade (unchanged and skipped
+ *	blocks), their content is already final.
+ */
+PRIVATE void hashFlashContent(uint32_t endAddress)
+{
+	uint8_t data[BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE];
+	uint32_t length;
+
+	endAddress = MATH_MIN(endAddress, upgradeSettings.imageEndAddress);
+
+	while (upgradeSettings.hashedAddress < endAddress)
+	{
+		length = MATH_MIN(sizeof(data), endAddress - upgradeSettings.hashedAddress);
+
+		Drv_Flash_Read(upgradeSettings.hashedAddress, data, length);
+		mbedtls_sha256_update(&upgradeSettings.imageHashContext, data, length);
+
+		upgradeSettings.hashedAddress += length;
+	}
+}
+
+/*
+ * Feeds written data into image digest. Chunks are written in ascending
+ * address order, so digest is completed with last chunk.
+ */
+PRIVATE void hashImageData(uint32_t address, const uint8_t* data, uint32_t length)
+{
+	uint32_t endAddress = MATH_MIN(address + length, upgradeSettings.imageEndAddress);
+
+	/* Gap before data is not written by upgrade */
+	hashFlashContent(address);
+
+	/* Skip metadata which is before image */
+	if (upgradeSettings.hashedAddress > address)
+	{
+		data += upgradeSettings.hashedAddress - address;
+		address = upgradeSettings.hashedAddress;
+	}
+
+	if (address < endAddress)
+	{
+		mbedtls_sha256_update(&upgradeSettings.imageHashContext, data, endAddress - address);
+		upgradeSettings.hashedAddress = endAddress;
+	}
+}
+
+/*
+ * Reads back a written chunk and compares it with flash write buffer.
+ *	Image is hashed from RAM, so digest is valid for flash content only if
+ *	each chunk is programmed correctly.
+ */
+PRIVATE BLStatusCode verifyFlashChunk(uint32_t address, const uint8_t* data)
+{
+	uint32_t flashData[BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE / sizeof(uint32_t)];
+	uint32_t startTime;
+	BLStatusCode status = BL_Status_Success;
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	if ((Drv_Flash_Read(address, (uint8_t*)flashData, sizeof(flashData)) != FLASH_STATUS_SUCCESS) ||
+		(memcmp(flashData, data, sizeof(flashData)) != 0))
+	{
+		status = BL_StatusUpgrade_FlashVerifyFailure;
+	}
+	else
+	{
+		hashImageData(address, data, sizeof(flashData));
+	}
+
+	upgradeSettings.stats.verifyTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+
+	return status;
+}
+
+/*
+ * Completes image digest and verifies signature of written image
+ */
+PRIVATE BLStatusCode verifyImage(void)
+{
+	FirmwareMetaDataHeader header;
+	uint8_t signature[FIRMWARE_SIGNATURE_LENGTH];
+	uint32_t startTime;
+	BLStatusCode status;
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	/* Rest of image area is not written by upgrade */
+	hashFlashContent(upgradeSettings.imageEndAddress);
+
+	mbedtls_sha256_finish(&upgradeSettings.imageHashContext, upgradeSettings.imageHash);
+	mbedtls_sha256_free(&upgradeSettings.imageHashContext);
+
+	/* Signature ends metadata, it is checked as it is stored in flash */
+	Drv_Flash_Read(upgradeSettings.slotAddress, (uint8_t*)&header, sizeof(header));
+	Drv_Flash_Read(upgradeSettings.slotAddress + FIRMWARE_METADATA_LENGTH - FIRMWARE_SIGNATURE_LENGTH, signature, sizeof(signature));
+
+	status = BL_VerifyImageSignature(header.signatureType, upgradeSettings.imageHash, signature);
+
+	upgradeSettings.stats.verifyTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+
+	return status;
+}
+
+/*
+ * Writes next chunk of oldest filled flash write buffer into flash
+ */
+PRIVATE BLStatusCode writeFlashChunk(void)
+{
+	BLFlashWriteJob* job = &upgradeSettings.flashWriteQueue[upgradeSettings.flashWriteQueueHead];
+	BLUpgradeCheckpoint checkpoint;
+	uint32_t address = job->address + job->writtenLength;
+	uint32_t startTime;
+	int32_t blockNo;
+	int32_t flashStatus;
+	BLStatusCode status;
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	blockNo = Drv_Flash_GetBlockNoOfAddress(address);
+
+	/* Block is already erased, only preparation is required for write */
+	flashStatus = prepareBlockRange((uint32_t)blockNo, (uint32_t)blockNo);
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Write(address, &job->data[job->writtenLength], BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE);
+	}
+
+	upgradeSettings.stats.flashWriteTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+
+	if (flashStatus != FLASH_STATUS_SUCCESS)
+	{
+		return BL_StatusUpgrade_FlashWriteFailure;
+	}
+
+	status = verifyFlashChunk(address, &job->data[job->writtenLength]);
+	if (status != BL_Status_Success)
+	{
+		return status;
+	}
+
+	job->writtenLength += BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE;
+
+	if (job->writtenLength == job->length)
+	{
+		/* Buffer can be filled again */
+		upgradeSettings.flashWriteQueueHead = (upgradeSettings.flashWriteQueueHead + 1) % BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT;
+		upgradeSettings.flashWriteQueueCount--;
+		upgradeSettings.stats.writtenBlockCount++;
+
+		/* Block is written and hashed, upload can be resumed after it (last block completes image) */
+		if (upgradeSettings.flags.journaled && (job->address + job->length < upgradeSettings.imageEndAddress))
+		{
+			checkpoint.committedLength = job->address + job->length - upgradeSettings.slotAddress;
+			checkpoint.hashedAddress = upgradeSettings.hashedAddress;
+			checkpoint.hashContext = upgradeSettings.imageHashContext;
+
+			startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+			status = BL_AppendUpgradeJournal(&checkpoint);
+			upgradeSettings.stats.journalRecordCount++;
+			upgradeSettings.stats.journalTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+
+			return status;
+		}
+	}
+
+	return BL_Status_Success;
+}
+
+/*
+ * Writes filled flash write buffers until given number of them are left
+ */
+PRIVATE BLStatusCode waitForFlashWrites(uint32_t pendingBufferCount)
+{
+	BLStatusCode status = BL_Status_Success;
+	uint32_t startTime;
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	while ((upgradeSettings.flashWriteQueueCount > pendingBufferCount) && (status == BL_Status_Success))
+	{
+		status = writeFlashChunk();
+	}
+
+	upgradeSettings.stats.flashWaitTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+
+	return status;
+}
+
+/*
+ * Queues flash write buffer to be written into flash and moves to next block.
+ *	Buffer is written in chunks between UART receptions (see
+ *	ProcessMessageImageUpload), parser continues with next buffer.
+ */
+PRIVATE BLStatusCode commitBlock(void)
+{
+	BLStatusCode status;
+	BLFlashWriteJob* job;
+	uint32_t length;
+	uint32_t bufferIndex;
+
+	/* Image must start with metadata, flash area is not prepared otherwise */
+	if (upgradeSettings.flags.metaDataCompleted == 0)
+	{
+		return BL_StatusUpgrade_MissingMetaData;
+	}
+
+	/* Rest of block is already erased, fill only last chunk with 0xFF */
+	length = upgradeSettings.receivedDataLength + BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE - 1;
+	length -= length % BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE;
+
+	memset(&blockData[upgradeSettings.receivedDataLength],
+		   BL_UPGRADE_ERASED_FLASH_VALUE,
+		   length - upgradeSettings.receivedDataLength);
+
+	if (isBlockUnchanged((uint32_t)Drv_Flash_GetBlockNoOfAddress(upgradeSettings.slotAddress + upgradeSettings.upgradeBlockOffset)))
+	{
+		/* Flash already has same content, buffer is reused for next block */
+		upgradeSettings.stats.savedWriteTimeInUs += (length / BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE) * BL_UPGRADE_CHUNK_PROGRAM_TIME_IN_US;
+		upgradeSettings.upgradeBlockOffset += BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE;
+		upgradeSettings.receivedDataLength = 0;
+
+		return BL_Status_Success;
+	}
+
+	bufferIndex = (upgradeSettings.flashWriteQueueHead + upgradeSettings.flashWriteQueueCount) % BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT;
+
+	job = &upgradeSettings.flashWriteQueue[bufferIndex];
+	job->data = blockData;
+	job->address = upgradeSettings.slotAddress + upgradeSettings.upgradeBlockOffset;
+	job->length = length;
+	job->writtenLength = 0;
+
+	upgradeSettings.flashWriteQueueCount++;
+	upgradeSettings.stats.maxPendingBufferCount = MATH_MAX(upgradeSettings.stats.maxPendingBufferCount, upgradeSettings.flashWriteQueueCount);
+
+	upgradeSettings.upgradeBlockOffset += BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE;
+	upgradeSettings.receivedDataLength = 0;
+
+	/* Parser needs a free buffer for next block */
+	if (upgradeSettings.flashWriteQueueCount == BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT)
+	{
+		upgradeSettings.stats.bufferStallCount++;
+
+		status = waitForFlashWrites(BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT - 1);
+		if (status != BL_Status_Success)
+		{
+			return status;
+		}
+	}
+
+	bufferIndex = (upgradeSettings.flashWriteQueueHead + upgradeSettings.flashWriteQueueCount) % BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT;
+	blockData = (uint8_t*)flashWriteBuffers[bufferIndex];
+
+	return BL_Status_Success;
+}
+
+/*
+ * Checks whether all bytes have erased flash value
+ */
+PRIVATE bool isErasedData(uint8_t* data, uint32_t length)
+{
+	while (length-- > 0)
+	{
+		if (*data++ != BL_UPGRADE_ERASED_FLASH_VALUE)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Stores image data into flash write buffer and writes completed blocks.
+ *
+ *	Transport independent, each transport provides absolute flash address of
+ *	data. Data must be received in ascending block order but can be in any
+ *	order inside a block.
+ */
+PRIVATE BLStatusCode storeImageData(uint32_t address, uint8_t* data, uint32_t length)
+{
+	BLStatusCode status;
+	uint32_t offset;
+	uint32_t blockPosition;
+	uint32_t copyLength;
+
+	if ((address < upgradeSettings.slotAddress) || (address + length > upgradeSettings.slotEndAddress))
+	{
+		/*
+		 * Data outside of upgraded slot is accepted only if it keeps erased
+		 * value (e.g. default Code Read Protection word which is emitted by
+		 * linker). Otherwise it would overwrite bootloader or active slot.
+		 */
+		return isErasedData(data, length) ? BL_Status_Success : BL_StatusUpgrade_InvalidAddress;
+	}
+
+	offset = address - upgradeSettings.slotAddress;
+
+	if (offset < upgradeSettings.upgradeBlockOffset)
+	{
+		/* Block is already written into flash */
+		return BL_StatusUpgrade_OutOfOrderData;
+	}
+
+	while (length > 0)
+	{
+		/* Data belongs to a next block, write current one first */
+		if (offset >= upgradeSettings.upgradeBlockOffset + BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE)
+		{
+			if (upgradeSettings.receivedDataLength > 0)
+			{
+				status = commitBlock();
+				if (status != BL_Status_Success)
+				{
+					return status;
+				}
+			}
+
+			/* Skip blocks which are not included in image */
+			upgradeSettings.upgradeBlockOffset = offset - (offset % BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE);
+		}
+
+		blockPosition = offset - upgradeSettings.upgradeBlockOffset;
+
+		/* Fill gap between previous and current data */
+		if (blockPosition > upgradeSettings.receivedDataLength)
+		{
+			memset(&blockData[upgradeSettings.receivedDataLength],
+				   BL_UPGRADE_ERASED_FLASH_VALUE,
+				   blockPosition - upgradeSettings.receivedDataLength);
+		}
+
+		copyLength = MATH_MIN(length, BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE - blockPosition);
+
+		/* Collect received data into block buffer unless it is decoded in place */
+		if (data != &blockData[blockPosition])
+		{
+			memcpy(&blockData[blockPosition], data, copyLength);
+		}
+
+		upgradeSettings.receivedDataLength = MATH_MAX(upgradeSettings.receivedDataLength, blockPosition + copyLength);
+
+		offset += copyLength;
+		data += copyLength;
+		length -= copyLength;
+
+		/* We received all metadata of firmware, we can prepare flash upgrade area now */
+		if ((upgradeSettings.flags.metaDataCompleted == 0) &&
+			(upgradeSettings.upgradeBlockOffset == 0) &&
+			(upgradeSettings.receivedDataLength >= FIRMWARE_METADATA_LENGTH))
+		{
+			status = processMetaData(false);
+			if (status != BL_Status_Success)
+			{
+				return status;
+			}
+		}
+
+		if (upgradeSettings.receivedDataLength == BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE)
+		{
+			/*
+			 * We collected a page data, we can write to flash now
+			 */
+			status = commitBlock();
+			if (status != BL_Status_Success)
+			{
+				return status;
+			}
+		}
+	}
+
+	return BL_Status_Success;
+}
+
+/*
+ * Locates image data in flash write buffer so parsers can decode it in place.
+ *	Data is decoded before its CRC is checked, so only unfilled part of
+ *	current block is lent. A corrupted data remains after received data and
+ *	it is overwritten or padded before block is written.
+ *
+ * @return Location of data in flash write buffer or NULL if data is not in
+ *		   unfilled part of current block
+ */
+PRIVATE uint8_t* locateImageData(uint32_t address, uint32_t length)
+{
+	uint32_t offset;
+
+	if (address < upgradeSettings.slotAddress)
+	{
+		return NULL;
+	}
+
+	offset = address - upgradeSettings.slotAddress;
+
+	if ((offset < upgradeSettings.upgradeBlockOffset + upgradeSettings.receivedDataLength) ||
+		(offset + length > upgradeSettings.upgradeBlockOffset + BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE))
+	{
+		return NULL;
+	}
+
+	return &blockData[offset - upgradeSettings.upgradeBlockOffset];
+}
+
+/*
+ * Returns block which keeps source content of block written by delta update.
+ *	Last flash block is used, images must end before it.
+ */
+PRIVATE uint32_t getDeltaScratchBlockNo(void)
+{
+	return (uint32_t)Drv_Flash_GetBlockNoOfAddress(Drv_Flash_GetSize() - 1);
+}
+
+/*
+ * Checks whether delta overwrites its source. Source is in another slot
+ * unless slot is upgraded in place (single image or empty slot A).
+ */
+PRIVATE bool isDeltaInPlace(void)
+{
+	return (upgradeSettings.deltaSourceAddress == upgradeSettings.slotAddress);
+}
+
+/*
+ * Prepares a block before target data of delta is written into it.
+ *	For in place updates, source content of block is backed up into scratch
+ *	block first, so COPY instructions of block can still read it after block
+ *	is erased.
+ */
+PRIVATE BLStatusCode prepareDeltaBlock(uint32_t blockNo)
+{
+	uint32_t data[BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE / sizeof(uint32_t)];
+	uint32_t scratchBlockNo = getDeltaScratchBlockNo();
+	uint32_t blockAddress = Drv_Flash_GetBlockAddress(blockNo);
+	uint32_t scratchAddress = Drv_Flash_GetBlockAddress(scratchBlockNo);
+	uint32_t sourceEnd = upgradeSettings.deltaSourceAddress + upgradeSettings.deltaSourceLength;
+	uint32_t backupLength = 0;
+	uint32_t offset;
+	int32_t flashStatus = FLASH_STATUS_SUCCESS;
+	BLStatusCode status;
+
+	if (isDeltaInPlace() && (blockAddress < sourceEnd))
+	{
+		backupLength = MATH_MIN(sourceEnd, Drv_Flash_GetBlockAddress(blockNo + 1)) - blockAddress;
+
+		status = eraseImageArea(scratchBlockNo, scratchBlockNo);
+		if (status != BL_Status_Success)
+		{
+			return status;
+		}
+
+		upgradeSettings.stats.deltaBackupBlockCount++;
+	}
+
+	for (offset = 0; (offset < backupLength) && (flashStatus == FLASH_STATUS_SUCCESS); offset += sizeof(data))
+	{
+		flashStatus = Drv_Flash_Read(blockAddress + offset, (uint8_t*)data, sizeof(data));
+		if (flashStatus == FLASH_STATUS_SUCCESS)
+		{
+			flashStatus = prepareBlockRange(scratchBlockNo, scratchBlockNo);
+		}
+		if (flashStatus == FLASH_STATUS_SUCCESS)
+		{
+			flashStatus = Drv_Flash_Write(scratchAddress + offset, (uint8_t*)data, sizeof(data));
+		}
+	}
+
+	if (flashStatus != FLASH_STATUS_SUCCESS)
+	{
+		return BL_StatusUpgrade_FlashWriteFailure;
+	}
+
+	upgradeSettings.deltaBlockNo = blockNo;
+
+	return eraseImageArea(blockNo, blockNo);
+}
+
+/*
+ * Checks delta header against installed image before anything is erased
+ */
+PRIVATE bool deltaHeaderHandler(const DeltaHeader* header)
+{
+	uint8_t data[BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE];
+	uint32_t maxImageLength = MATH_MIN(upgradeSettings.slotEndAddress, Drv_Flash_GetBlockAddress(getDeltaScratchBlockNo())) - upgradeSettings.slotAddress;
+	uint32_t crc = CRC32_INITIAL_VALUE;
+	uint32_t offset;
+	uint32_t length;
+
+	if ((header->sourceLength > maxImageLength) ||
+		(header->targetLength > maxImageLength) ||
+		(header->targetLength < FIRMWARE_METADATA_LENGTH))
+	{
+		upgradeSettings.deltaStatus = BL_StatusUpgrade_FWExceedsFlash;
+		return false;
+	}
+
+	for (offset = 0; offset < header->sourceLength; offset += length)
+	{
+		length = MATH_MIN(sizeof(data), header->sourceLength - offset);
+
+		Drv_Flash_Read(upgradeSettings.deltaSourceAddress + offset, data, length);
+		crc = CRC32_Update(crc, data, length);
+	}
+
+	if (crc != header->sourceCRC)
+	{
+		/* Delta is generated for another image, nothing is erased yet */
+		upgradeSettings.deltaStatus = BL_StatusUpgrade_DeltaSourceMismatch;
+		return false;
+	}
+
+	upgradeSettings.flags.deltaUpgrade = 1;
+	upgradeSettings.deltaSourceLength = header->sourceLength;
+
+	return true;
+}
+
+/*
+ * Reads installed image for COPY instructions of delta
+ */
+PRIVATE bool deltaSourceReader(uint32_t offset, uint8_t* data, uint32_t length)
+{
+	uint32_t address = upgradeSettings.deltaSourceAddress + offset;
+	uint32_t blockNo;
+	uint32_t blockAddress;
+	uint32_t readAddress;
+	uint32_t readLength;
+
+	while (length > 0)
+	{
+		blockNo = (uint32_t)Drv_Flash_GetBlockNoOfAddress(address);
+		blockAddress = Drv_Flash_GetBlockAddress(blockNo);
+		readLength = MATH_MIN(length, Drv_Flash_GetBlockAddress(blockNo + 1) - address);
+		readAddress = address;
+
+		if (isDeltaInPlace() && (upgradeSettings.deltaBlockNo != BL_UPGRADE_DELTA_NO_BLOCK))
+		{
+			if (blockNo < upgradeSettings.deltaBlockNo)
+			{
+				/* Source is already overwritten, delta is not generated for in place update */
+				upgradeSettings.deltaStatus = BL_StatusUpgrade_InvalidDelta;
+				return false;
+			}
+
+			if (blockNo == upgradeSettings.deltaBlockNo)
+			{
+				readAddress = Drv_Flash_GetBlockAddress(getDeltaScratchBlockNo()) + (address - blockAddress);
+			}
+		}
+
+		if (Drv_Flash_Read(readAddress, data, readLength) != FLASH_STATUS_SUCCESS)
+		{
+			return false;
+		}
+
+		address += readLength;
+		data += readLength;
+		length -= readLength;
+	}
+
+	return true;
+}
+
+/*
+ * Writes target image which is produced by delta
+ */
+PRIVATE bool deltaOutputHandler(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	uint32_t address = upgradeSettings.slotAddress + offset;
+	uint32_t blockNo;
+	uint32_t storeLength;
+	BLStatusCode status = BL_Status_Success;
+
+	while ((length > 0) && (status == BL_Status_Success))
+	{
+		blockNo = (uint32_t)Drv_Flash_GetBlockNoOfAddress(address);
+		storeLength = MATH_MIN(length, Drv_Flash_GetBlockAddress(blockNo + 1) - address);
+
+		if (blockNo != upgradeSettings.deltaBlockNo)
+		{
+			status = prepareDeltaBlock(blockNo);
+		}
+
+		if (status == BL_Status_Success)
+		{
+			status = storeImageData(address, (uint8_t*)data, storeLength);
+		}
+
+		address += storeLength;
+		data += storeLength;
+		length -= storeLength;
+	}
+
+	upgradeSettings.deltaStatus = status;
+
+	return (status == BL_Status_Success);
+}
+
+/*
+ * Feeds a part of delta into decoder. Delta must be received in order.
+ */
+PRIVATE BLStatusCode processPatchData(uint32_t offset, uint8_t* data, uint32_t length)
+{
+	if (offset + length <= upgradeSettings.deltaReceivedLength)
+	{
+		/* Already processed */
+		return BL_Status_Success;
+	}
+
+	if (offset != upgradeSettings.deltaReceivedLength)
+	{
+		return BL_StatusUpgrade_OutOfOrderData;
+	}
+
+	upgradeSettings.deltaReceivedLength += length;
+	upgradeSettings.stats.deltaLength = upgradeSettings.deltaReceivedLength;
+
+	if (Delta_Feed(&upgradeSettings.deltaContext, data, length) != Delta_Success)
+	{
+		return (upgradeSettings.deltaStatus != BL_Status_Success) ? upgradeSettings.deltaStatus : BL_StatusUpgrade_InvalidDelta;
+	}
+
+	return BL_Status_Success;
+}
+
+/*
+ * Stages decompressed image data, image starts at start of upgraded slot
+ */
+PRIVATE bool lzssOutputHandler(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	upgradeSettings.lzssStatus = storeImageData(upgradeSettings.slotAddress + offset, (uint8_t*)data, length);
+
+	return (upgradeSettings.lzssStatus == BL_Status_Success);
+}
+
+/*
+ * Feeds a part of compressed stream into decompressor. Stream must be
+ * received in order.
+ */
+PRIVATE BLStatusCode processCompressedData(uint32_t offset, uint8_t* data, uint32_t length)
+{
+	uint32_t startTime;
+	LZSSStatusCode status;
+
+	if (offset + length <= upgradeSettings.compressedReceivedLength)
+	{
+		/* Already processed */
+		return BL_Status_Success;
+	}
+
+	if (offset != upgradeSettings.compressedReceivedLength)
+	{
+		return BL_StatusUpgrade_OutOfOrderData;
+	}
+
+	upgradeSettings.compressedReceivedLength += length;
+	upgradeSettings.stats.compressedLength = upgradeSettings.compressedReceivedLength;
+
+	startTime = Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle);
+
+	status = LZSS_Feed(&upgradeSettings.lzssContext, data, length);
+
+	upgradeSettings.stats.decompressTimeInUs += Drv_Timer_ReadElapsedTimeInUs(upgradeSettings.timeoutTimerHandle) - startTime;
+
+	if (status != LZSS_Success)
+	{
+		return (upgradeSettings.lzssStatus != BL_Status_Success) ? upgradeSettings.lzssStatus : BL_StatusUpgrade_InvalidCompressedData;
+	}
+
+	return BL_Status_Success;
+}
+
+/*
+ * Writes all buffered data into flash at the end of image
+ */
+PRIVATE BLStatusCode finalizeImage(void)
+{
+	BLStatusCode status;
+	BLStatusCode journalStatus;
+
+	upgradeSettings.flags.eofReceived = true;
+
+	if (upgradeSettings.receivedDataLength > 0)
+	{
+		/* Write last portion now */
+		status = commitBlock();
+		if (status != BL_Status_Success)
+		{
+			return status;
+		}
+	}
+
+	if (upgradeSettings.flags.metaDataCompleted == 0)
+	{
+		return BL_StatusUpgrade_MissingMetaData;
+	}
+
+	/* Image is completed when all buffers are written */
+	status = waitForFlashWrites(0);
+	if (status != BL_Status_Success)
+	{
+		return status;
+	}
+
+	/* Digest is ready, only signature is checked */
+	status = verifyImage();
+
+	if (upgradeSettings.flags.journaled)
+	{
+		/* Upload is completed, a new upload of same image starts from first block */
+		journalStatus = BL_EndUpgradeJournal();
+		if (status == BL_Status_Success)
+		{
+			status = journalStatus;
+		}
+	}
+
+	return status;
+}
+
+#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 1)
 /*
- * Compiler switch to request missing parts of image
+ * Sends ACK or NAK of sequenced frames to host.
+ *	Frames before flash write buffer are completed, bitmap shows received
+ *	frames of flash write buffer.
  */
-#define BL_UPGRADE_REQUEST_MISSING_PARTS			(0)
+PRIVATE void sendFrameStatus(uint32_t type)
+{
+	uint8_t response[BINFRAME_FRAME_LENGTH(BINFRAME_ACK_PAYLOAD_LENGTH)];
+	uint8_t payload[BINFRAME_ACK_PAYLOAD_LENGTH];
+	uint32_t length;
+
+	/* Bitmap of received frames */
+	payload[0] = (uint8_t)upgradeSettings.receivedFrameBitmap;
+	payload[1] = (uint8_t)(upgradeSettings.receivedFrameBitmap >> 8);
+	payload[2] = (uint8_t)(upgradeSettings.receivedFrameBitmap >> 16);
+	payload[3] = (uint8_t)(upgradeSettings.receivedFrameBitmap >> 24);
+
+	/* Receive window is flash write buffer */
+	payload[4] = (uint8_t)BL_UPGRADE_FRAMES_PER_BLOCK;
+	payload[5] = 0;
+	payload[6] = 0;
+	payload[7] = 0;
+
+	length = BinFrame_Encode(type,
+							 upgradeSettings.upgradeBlockOffset / BINFRAME_SEQ_PAYLOAD_LENGTH,
+							 payload,
+							 sizeof(payload),
+							 response);
+
+	Drv_UART_Send(upgradeSettings.uartHandle, response, length);
+}
 
 /*
- * Timeout for Bootloader Upgrade
+ * Returns bitmap of frames which are required to complete flash write buffer
  */
-#define BL_UPGRADE_TIMEOUT_IN_MS					(1000)
+PRIVATE uint32_t getRequiredFrameBitmap(void)
+{
+	uint32_t firstSeqNo = upgradeSettings.upgradeBlockOffset / BINFRAME_SEQ_PAYLOAD_LENGTH;
+	uint32_t frameCount = BL_UPGRADE_FRAMES_PER_BLOCK;
 
-/* Buffer size for flash writes */
-#define BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE          (4 * 1024)
+	/* Last block may be filled partially */
+	if (upgradeSettings.totalFrameCount != BL_UPGRADE_UNKNOWN_FRAME_COUNT)
+	{
+		frameCount = (upgradeSettings.totalFrameCount > firstSeqNo) ? (upgradeSettings.totalFrameCount - firstSeqNo) : 0;
+		frameCount = MATH_MIN(frameCount, BL_UPGRADE_FRAMES_PER_BLOCK);
+	}
 
-/* Convert Big-Endian Array to Integer Value */
-#define CONVERT_BE_ARRAY_TO_INT(arr) \
-			((arr)[0] << 24) | ((arr)[1] << 16) | ((arr)[2] << 8) | ((arr)[3])
+	return (frameCount == 32) ? 0xFFFFFFFF : ((1UL << frameCount) - 1);
+}
 
-/***************************** TYPE DEFINITIONS *******************************/
 /*
- * Flash upgrade module internal settings
+ * Writes flash write buffer if all of its frames are received.
+ *	Image is finalized with last block.
  */
-typedef struct
+PRIVATE BLStatusCode completeSequencedBlock(void)
 {
-	struct
+	BLStatusCode status;
+	uint32_t requiredFrameBitmap = getRequiredFrameBitmap();
+	uint32_t firstSeqNo = upgradeSettings.upgradeBlockOffset / BINFRAME_SEQ_PAYLOAD_LENGTH;
+	uint32_t index;
+	bool lastBlock;
+
+	if ((upgradeSettings.receivedFrameBitmap & requiredFrameBitmap) != requiredFrameBitmap)
 	{
-		uint32_t initialized : 1;			/* Upgrade Module initialized */
-		uint32_t dataReceived : 1;			/* Data received */
-		uint32_t upgradeTimeout : 1;		/* Image Upgrade timeout */
-		uint32_t metaDataCompleted : 1;		/* All Meta data received */
-	} flags;
-	/* Handle for UART which used for data upgrade */
-	UartHandle uartHandle;
-	/* Upgrade Timeout Handle */
-	TimerHandle timeoutTimerHandle;
-	/* Currently upgraded segment address */
-	uint32_t upgradeSegmentAddress;
-	/* Currently upgraded offset */
-	uint32_t upgradeBlockOffset;
-	/* Received data length from UART */
-    uint32_t receivedDataLength;
-} FWUpgradeSettings;
-/**************************** FUNCTION PROTOTYPES *****************************/
+		/* Wait for missing frames */
+		return BL_Status_Success;
+	}
 
-/******************************** VARIABLES ***********************************/
-/* Upgrade module internal settings */
-PRIVATE FWUpgradeSettings upgradeSettings;
+	/* Metadata is in first block, prepare flash upgrade area before first write */
+	if ((upgradeSettings.flags.metaDataCompleted == 0) &&
+		(upgradeSettings.upgradeBlockOffset == 0) &&
+		(upgradeSettings.receivedDataLength >= FIRMWARE_METADATA_LENGTH))
+	{
+		status = processMetaData(true);
+		if (status != BL_Status_Success)
+		{
+			return status;
+		}
 
-/* Block data buffer for flash writes */
-PRIVATE uint8_t blockData[BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE] = { 0 };
+		if (upgradeSettings.upgradeBlockOffset != firstSeqNo * BINFRAME_SEQ_PAYLOAD_LENGTH)
+		{
+			/* Upload is resumed, ACK moves window of host to checkpoint */
+			upgradeSettings.receivedFrameBitmap = 0;
+			upgradeSettings.requestedFrameBitmap = 0;
+			sendFrameStatus(BINFRAME_TYPE_ACK);
 
-/**************************** PRIVATE FUNCTIONS ******************************/
-/**
- * Upgrade Timeout Event Handler
- *
- */
-PRIVATE void UpgradeTimeoutEventHandler(void)
-{
-	upgradeSettings.flags.upgradeTimeout = true;
+			return BL_Status_Success;
+		}
+	}
+
+	lastBlock = (upgradeSettings.totalFrameCount != BL_UPGRADE_UNKNOWN_FRAME_COUNT) &&
+				(firstSeqNo + BL_UPGRADE_FRAMES_PER_BLOCK >= upgradeSettings.totalFrameCount);
+
+	status = lastBlock ? finalizeImage() : commitBlock();
+	if (status != BL_Status_Success)
+	{
+		return status;
+	}
+
+	upgradeSettings.receivedFrameBitmap = 0;
+	upgradeSettings.requestedFrameBitmap = 0;
+
+	/* Block is queued for flash write, host can move its window now */
+	for (index = 0; index < (lastBlock ? BL_UPGRADE_FINAL_ACK_REPEAT_COUNT : 1); index++)
+	{
+		sendFrameStatus(BINFRAME_TYPE_ACK);
+	}
+
+	return BL_Status_Success;
 }
 
-/**
- * UART Data Received Event Handler
- *
+/*
+ * Stores a sequenced frame into flash write buffer.
+ *	Frames of flash write buffer can be received in any order, frames of
+ *	next blocks are discarded and retransmitted by host after ACK.
+ *	Each stored frame is acknowledged, skipped frames are requested once.
  */
-PRIVATE void DataReceivedEventHandler(void)
+PRIVATE BLStatusCode processSequencedData(uint32_t seqNo, uint8_t* data, uint32_t length)
 {
-	upgradeSettings.flags.dataReceived = true;
+	BLStatusCode status;
+	uint32_t firstSeqNo = upgradeSettings.upgradeBlockOffset / BINFRAME_SEQ_PAYLOAD_LENGTH;
+	uint32_t frameIndex;
+	uint32_t missingFrameBitmap;
+	uint32_t responseType = BINFRAME_TYPE_ACK;
+
+	if (seqNo < firstSeqNo)
+	{
+		/* Already written, host did not receive our ACK */
+		sendFrameStatus(BINFRAME_TYPE_ACK);
+		return BL_Status_Success;
+	}
+
+	frameIndex = seqNo - firstSeqNo;
+
+	if ((frameIndex >= BL_UPGRADE_FRAMES_PER_BLOCK) ||
+		(seqNo >= upgradeSettings.totalFrameCount) ||
+		(length > BINFRAME_SEQ_PAYLOAD_LENGTH))
+	{
+		/* Out of receive window */
+		return BL_Status_Success;
+	}
+
+	/* Payload is usually decoded in place (see locateFramePayload) */
+	if (data != &blockData[frameIndex * BINFRAME_SEQ_PAYLOAD_LENGTH])
+	{
+		memcpy(&blockData[frameIndex * BINFRAME_SEQ_PAYLOAD_LENGTH], data, length);
+	}
+
+	upgradeSettings.receivedDataLength = MATH_MAX(upgradeSettings.receivedDataLength, (frameIndex * BINFRAME_SEQ_PAYLOAD_LENGTH) + length);
+	upgradeSettings.receivedFrameBitmap |= (1UL << frameIndex);
+
+	/* Request frames which are skipped by this frame, once */
+	missingFrameBitmap = ~upgradeSettings.receivedFrameBitmap & ((1UL << frameIndex) - 1);
+	if (missingFrameBitmap & ~upgradeSettings.requestedFrameBitmap)
+	{
+		upgradeSettings.requestedFrameBitmap |= missingFrameBitmap;
+		responseType = BINFRAME_TYPE_NAK;
+	}
+
+	status = completeSequencedBlock();
+
+	/* Completed blocks are acknowledged by completeSequencedBlock */
+	if ((status == BL_Status_Success) && (upgradeSettings.receivedFrameBitmap != 0))
+	{
+		sendFrameStatus(responseType);
+	}
+
+	return status;
 }
 
 /*
- * Shifts a buffer to left direction
- *
+ * Processes END frame of sequenced frames
  */
-PRIVATE void shiftBufferLeft(uint8_t* buffer, uint32_t bufferLength, uint32_t amount)
+PRIVATE BLStatusCode processSequencedEnd(uint32_t frameCount)
 {
-	uint8_t* alignedBuffer = buffer;
-	uint8_t* validDataPtr = &buffer[amount];
+	BLStatusCode status;
 
-	/* Ship amount */
-	int remainingDataLen = bufferLength - amount;
+	upgradeSettings.totalFrameCount = frameCount;
 
-	/* Shift buffer */
-	while (remainingDataLen-- > 0)
-	{
-		*alignedBuffer = *validDataPtr;
+	status = completeSequencedBlock();
 
-		alignedBuffer++;
-		validDataPtr++;
+	if ((status == BL_Status_Success) && (upgradeSettings.flags.eofReceived == 0))
+	{
+		/* Some frames are still missing */
+		sendFrameStatus(BINFRAME_TYPE_NAK);
 	}
+
+	return status;
 }
+#endif /* #if (BL_UPGRADE_REQUEST_MISSING_PARTS == 1) */
 
 /*
  * Processes an intel hex line executes required jobs
@@ -129,35 +1489,18 @@ PRIVATE void shiftBufferLeft(uint8_t* buffer, uint32_t bufferLength, uint32_t am
 PRIVATE BLStatusCode processIntelHexLine(IntelHexLine* intelHexLine)
 {
 	BLStatusCode retVal = BL_Status_Success;
-	int32_t flashStatus;
 
     switch(intelHexLine->recordType)
     {
 		case INTELHEX_RECORDTYPE_EOF:
-			{
-				/*
-				 * We have reached to end of file. Write all buffered data into flash
-				 */
-				/* Calculate flash offset to write remaining data */
-				uint32_t address = upgradeSettings.upgradeSegmentAddress + upgradeSettings.upgradeBlockOffset;
-				uint32_t blockNo;
-
-				/* We need write 4K buffer, so fill remaining area with 0xFF */
-				memset(&blockData[upgradeSettings.receivedDataLength], 0xFF, BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE - upgradeSettings.receivedDataLength);
-
-				blockNo = Drv_Flash_GetBlockNoOfAddress(address);
-
-				do
-				{
-					/* Prepare flash block for write operation */
-					flashStatus = Drv_Flash_PrepareBlock(blockNo);
-
-					/* Try until it is ready */
-				} while (flashStatus == FLASH_STATUS_BUSY);
-
-				/* Write last portion now */
-				Drv_Flash_Write(address, blockData, BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE);
-			}
+			/*
+			 * We have reached to end of file. Write all buffered data into flash
+			 */
+			retVal = finalizeImage();
+			break;
+		case INTELHEX_RECORDTYPE_EXTENDED_SEGMENT_ADDRESS:
+			/* Segment base address is paragraph (16 bytes) aligned */
+			upgradeSettings.upgradeSegmentAddress = (intelHexLine->data[0] << 8 | intelHexLine->data[1]) << 4;
 			break;
 		case INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS:
 			/* Previous segment is completed, get next segment to upgrade */
@@ -165,75 +1508,199 @@ PRIVATE BLStatusCode processIntelHexLine(IntelHexLine* intelHexLine)
 			upgradeSettings.upgradeSegmentAddress *= INTELHEX_SEGMENT_SIZE;
 			break;
         case INTELHEX_RECORDTYPE_DATA:
-			/* Collect received data into block buffer */
-            memcpy(&blockData[intelHexLine->address], intelHexLine->data, intelHexLine->lenght);
-
-			upgradeSettings.receivedDataLength += intelHexLine->lenght;
+			retVal = storeImageData(upgradeSettings.upgradeSegmentAddress + intelHexLine->address,
+									(upgradeSettings.intelHexLineData != NULL) ? upgradeSettings.intelHexLineData : intelHexLine->data,
+									intelHexLine->lenght);
+            break;
+		default:
+			/* Start address records are not required for upgrade */
+			break;
+    }
 
-			/* We received all metadata of firmware, we can prepare flash upgrade area now */
-			if ((upgradeSettings.flags.metaDataCompleted == 0) &&
-				(upgradeSettings.receivedDataLength == FIRMWARE_METADATA_LENGTH))
-			{
+	return retVal;
+}
 
-				/* Firmware object including header, metadata and image */
-				PRIVATE FirmwareInfo* firmware = (FirmwareInfo*)blockData;
-				uint32_t firstBlockAddress;
-				uint32_t startBlockNo;
-				uint32_t endBlockNo;
+/*
+ * Locates data of Intel HEX data records in flash write buffer
+ */
+PRIVATE uint8_t* locateIntelHexData(const IntelHexLine* intelHexLine)
+{
+	upgradeSettings.intelHexLineData = NULL;
 
-				firstBlockAddress = firmware->header.imageOffset - FIRMWARE_METADATA_LENGTH;
+	if (intelHexLine->recordType == INTELHEX_RECORDTYPE_DATA)
+	{
+		upgradeSettings.intelHexLineData = locateImageData(upgradeSettings.upgradeSegmentAddress + intelHexLine->address,
+														   intelHexLine->lenght);
+	}
 
-				if (firstBlockAddress != FIRMWARE_START_ADDRESS)
-				{
-					/* UPS FW offset is not compatible with current version of bootloader */
-					retVal = BL_StatusUpgrade_InCompatibleFWOffset;
-					goto intelhex_process_err;
-				}
+	return upgradeSettings.intelHexLineData;
+}
 
-				if (firmware->header.imageOffset + firmware->header.imageSize > Drv_Flash_GetSize())
-				{
-					/* UPS Firmware exceeds flash size */
-					retVal = BL_StatusUpgrade_FWExceedsFlash;
-					goto intelhex_process_err;
-				}
+/*
+ * Handles lines which are parsed by streaming Intel HEX parser
+ */
+PRIVATE bool IntelHexLineReceivedHandler(IntelHexStatusCode status, IntelHexLine* intelHexLine)
+{
+	/*
+	 * Intel HEX has no way to request a line again, host sends text without
+	 * waiting for a response. A discarded line leaves a gap in image.
+	 */
+	if (status != IntelHex_Success)
+	{
+		upgradeSettings.upgradeStatus = BL_StatusUpgrade_CorruptedData;
+		return false;
+	}
 
-				/* Find range of FW Image blocks */
-				startBlockNo = Drv_Flash_GetBlockNoOfAddress(firstBlockAddress);
-				endBlockNo = Drv_Flash_GetBlockNoOfAddress(firmware->header.imageOffset + firmware->header.imageSize - 1);
+	upgradeSettings.upgradeStatus = processIntelHexLine(intelHexLine);
+	if (upgradeSettings.upgradeStatus != BL_Status_Success)
+	{
+		/* Stop parsing, upgrade cannot be continued */
+		return false;
+	}
 
-				do
-				{
-					flashStatus = Drv_Flash_PrepareBlockRange(startBlockNo, endBlockNo);
+	/* Stop parsing when image is completed */
+	return (upgradeSettings.flags.eofReceived == 0);
+}
 
-				} while (flashStatus == FLASH_STATUS_BUSY);
+/*
+ * Locates payload of data frames in flash write buffer
+ */
+PRIVATE uint8_t* locateFramePayload(const BinFrame* frame)
+{
+#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 1)
+	uint32_t firstSeqNo = upgradeSettings.upgradeBlockOffset / BINFRAME_SEQ_PAYLOAD_LENGTH;
+	uint32_t frameIndex;
 
-				flashStatus = Drv_Flash_EraseBlockRange(startBlockNo, startBlockNo);
+	if (frame->type == BINFRAME_TYPE_SEQ_DATA)
+	{
+		/* Only missing frames of receive window, a received frame keeps valid data */
+		frameIndex = frame->address - firstSeqNo;
+		if ((frame->address < firstSeqNo) ||
+			(frameIndex >= BL_UPGRADE_FRAMES_PER_BLOCK) ||
+			(frame->address >= upgradeSettings.totalFrameCount) ||
+			(frame->length > BINFRAME_SEQ_PAYLOAD_LENGTH) ||
+			(upgradeSettings.receivedFrameBitmap & (1UL << frameIndex)))
+		{
+			return NULL;
+		}
 
-				upgradeSettings.flags.metaDataCompleted = 1;
-			}
-			else if (upgradeSettings.receivedDataLength == BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE)
-			{
-				/*
-				 * We collected a page data, we can write to flash now
-				 */
+		return &blockData[frameIndex * BINFRAME_SEQ_PAYLOAD_LENGTH];
+	}
+#endif
 
-				uint32_t address = upgradeSettings.upgradeSegmentAddress + upgradeSettings.upgradeBlockOffset;
+	if (frame->type == BINFRAME_TYPE_DATA)
+	{
+		return locateImageData(frame->address, frame->length);
+	}
 
-				Drv_Flash_WriteBlock(address, blockData, BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE);
+	return NULL;
+}
 
-				upgradeSettings.upgradeBlockOffset += BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE;
+/*
+ * Handles frames which are parsed by streaming Binary Frame parser
+ */
+PRIVATE bool BinFrameReceivedHandler(BinFrameStatusCode status, BinFrame* frame)
+{
+	if (status != BinFrame_Success)
+	{
+#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 1)
+		/* Frame is corrupted, request missing frames from host */
+		sendFrameStatus(BINFRAME_TYPE_NAK);
+#endif
+		return true;
+	}
 
-				upgradeSettings.receivedDataLength = 0;
+	switch (frame->type)
+	{
+		case BINFRAME_TYPE_DATA:
+			upgradeSettings.upgradeStatus = storeImageData(frame->address, frame->payload, frame->length);
+			break;
+		case BINFRAME_TYPE_END:
+			if (upgradeSettings.flags.deltaUpgrade && !Delta_IsCompleted(&upgradeSettings.deltaContext))
+			{
+				/* Part of delta is missing */
+				upgradeSettings.upgradeStatus = BL_StatusUpgrade_InvalidDelta;
+				break;
+			}
+			if ((upgradeSettings.compressedReceivedLength > 0) && !LZSS_IsCompleted(&upgradeSettings.lzssContext))
+			{
+				/* Part of compressed stream is missing */
+				upgradeSettings.upgradeStatus = BL_StatusUpgrade_InvalidCompressedData;
+				break;
 			}
+#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 1)
+			/* Sequenced transfers provide number of frames */
+			if (frame->address > 0)
+			{
+				upgradeSettings.upgradeStatus = processSequencedEnd(frame->address);
+				break;
+			}
+#endif
+			upgradeSettings.upgradeStatus = finalizeImage();
+			break;
+		case BINFRAME_TYPE_PATCH:
+			upgradeSettings.upgradeStatus = processPatchData(frame->address, frame->payload, frame->length);
+			break;
+		case BINFRAME_TYPE_COMPRESSED:
+			upgradeSettings.upgradeStatus = processCompressedData(frame->address, frame->payload, frame->length);
+			break;
+#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 1)
+		case BINFRAME_TYPE_SEQ_DATA:
+			upgradeSettings.upgradeStatus = processSequencedData(frame->address, frame->payload, frame->length);
+			break;
+#endif
+		default:
+			/* Unknown frames are ignored for forward compatibility */
+			break;
+	}
 
-            break;
-    }
+	if (upgradeSettings.upgradeStatus != BL_Status_Success)
+	{
+		/* Stop parsing, upgrade cannot be continued */
+		return false;
+	}
 
-	return BL_Status_Success;
+	/* Stop parsing when image is completed */
+	return (upgradeSettings.flags.eofReceived == 0);
+}
 
-intelhex_process_err:
+/*
+ * Feeds received data into parser of used transport.
+ *	Transport is detected using first meaningful byte of upgrade stream.
+ */
+PRIVATE void processReceivedData(uint8_t* data, uint32_t length)
+{
+	uint32_t index = 0;
 
-	return retVal;
+	while ((upgradeSettings.transport == BL_UpgradeTransport_Unknown) && (index < length))
+	{
+		if (data[index] == INTELHEX_PREFIX)
+		{
+			upgradeSettings.transport = BL_UpgradeTransport_IntelHex;
+		}
+		else if (data[index] == BINFRAME_START_OF_FRAME)
+		{
+			upgradeSettings.transport = BL_UpgradeTransport_BinFrame;
+		}
+		else
+		{
+			/* Skip noise (e.g. line endings) before stream starts */
+			index++;
+		}
+	}
+
+	switch (upgradeSettings.transport)
+	{
+		case BL_UpgradeTransport_IntelHex:
+			IntelHex_Feed(&upgradeSettings.intelHexContext, &data[index], length - index, IntelHexLineReceivedHandler);
+			break;
+		case BL_UpgradeTransport_BinFrame:
+			BinFrame_Feed(&upgradeSettings.binFrameContext, &data[index], length - index, BinFrameReceivedHandler);
+			break;
+		default:
+			/* Transport is not detected yet */
+			break;
+	}
 }
 
 /**
@@ -245,20 +1712,43 @@ intelhex_process_err:
 PRIVATE BLStatusCode ProcessMessageImageUpload(void)
 {
 	BLStatusCode status;
-	uint8_t recvBuffer[256];
-	IntelHexLine intelHexLine;
-	int32_t recvDataLen = 0;
-	int32_t dataLength = 0;
-	IntelHexStatusCode ihRetVal;
-	uint32_t parsedLineLength;
-	int32_t offset = 0;
-	bool eof = false;
+	uint8_t* recvSpan;
+	int32_t recvDataLen;
 
 	/* Initialize flags at the beginning of upgrade transaction */
     upgradeSettings.flags.metaDataCompleted = 0;
+	upgradeSettings.flags.eofReceived = 0;
+	upgradeSettings.flags.deltaUpgrade = 0;
+	upgradeSettings.flags.journaled = 0;
+	upgradeSettings.upgradeStatus = BL_Status_Success;
+	upgradeSettings.transport = BL_UpgradeTransport_Unknown;
+	upgradeSettings.slotAddress = BL_GetUpgradeSlotAddress();
+	upgradeSettings.slotEndAddress = BL_GetSlotEndAddress(upgradeSettings.slotAddress);
     upgradeSettings.receivedDataLength = 0;
     upgradeSettings.upgradeSegmentAddress = 0;
 	upgradeSettings.upgradeBlockOffset = 0;
+	upgradeSettings.receivedFrameBitmap = 0;
+	upgradeSettings.requestedFrameBitmap = 0;
+	upgradeSettings.totalFrameCount = BL_UPGRADE_UNKNOWN_FRAME_COUNT;
+	upgradeSettings.unchangedBlockBitmap = 0;
+	upgradeSettings.deltaReceivedLength = 0;
+	upgradeSettings.deltaSourceAddress = BL_GetActiveSlotAddress();
+	upgradeSettings.deltaSourceLength = 0;
+	upgradeSettings.deltaBlockNo = BL_UPGRADE_DELTA_NO_BLOCK;
+	upgradeSettings.deltaStatus = BL_Status_Success;
+	upgradeSettings.compressedReceivedLength = 0;
+	upgradeSettings.lzssStatus = BL_Status_Success;
+	upgradeSettings.flashWriteQueueHead = 0;
+	upgradeSettings.flashWriteQueueCount = 0;
+	memset(&upgradeSettings.stats, 0, sizeof(upgradeSettings.stats));
+	blockData = (uint8_t*)flashWriteBuffers[0];
+
+	IntelHex_InitContext(&upgradeSettings.intelHexContext);
+	IntelHex_SetDataLocator(&upgradeSettings.intelHexContext, locateIntelHexData);
+	BinFrame_InitContext(&upgradeSettings.binFrameContext, framePayload, sizeof(framePayload));
+	BinFrame_SetPayloadLocator(&upgradeSettings.binFrameContext, locateFramePayload);
+	Delta_InitContext(&upgradeSettings.deltaContext, &deltaHandlers);
+	LZSS_InitContext(&upgradeSettings.lzssContext, lzssOutputHandler);
 
 	do
 	{
@@ -269,133 +1759,59 @@ PRIVATE BLStatusCode ProcessMessageImageUpload(void)
 			upgradeSettings.flags.dataReceived = false;
 
 			/* Reset Timeout timer first */
-			Drv_Timer_Start(upgradeSettings.timeoutTimerHandle, BL_UPGRADE_TIMEOUT_IN_MS);
+			restartUpgradeTimeout();
 
 			/*
-			 * Get UART Data
-			 * Concatanate received data using offset to continue incomplete
-			 * intel HEX data.
+			 * Feed received bytes into streaming parser from receive buffer of
+			 * driver. Parser keeps incomplete lines in its context and decodes
+			 * image data into flash write buffer directly, so there is no
+			 * intermediate copy. Driver raises event again if more data is
+			 * waiting.
 			 */
-			recvDataLen = Drv_UART_Receive(upgradeSettings.uartHandle, &recvBuffer[offset], sizeof(recvBuffer) - offset);
-			if (recvDataLen < 0) continue;
-
-			/* Increase total dta size */
-			dataLength += recvDataLen;
-		}
-
-		/*
-		 * This block aligns intel hex string to start of buffer.
-		 * If there exist meaningless data at the beginning, shifts
-		 * buffer until align Intel HEX Prefix (':') to start of buffer.
-		 *
-		 */
-		if (dataLength > 0)
-		{
-			char* prefixPtr;
-
-			/* Just add terminator char to guarantee string boundary */
-			recvBuffer[dataLength] = '\0';
+			recvDataLen = Drv_UART_PeekSpan(upgradeSettings.uartHandle, &recvSpan);
+			if (recvDataLen > 0)
+			{
+				recvDataLen = MATH_MIN(recvDataLen, BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
 
-			/* Find Intel HEX Prefix character */
-			prefixPtr = strchr((char*)recvBuffer, INTELHEX_PREFIX);
+				processReceivedData(recvSpan, (uint32_t)recvDataLen);
 
-			if (prefixPtr == NULL)
-			{
-				/* There is no IntelHex Prefix, Discard All Data */
-				dataLength = 0;
+				Drv_UART_Consume(upgradeSettings.uartHandle, (uint32_t)recvDataLen);
 			}
-			else
+			else if (recvDataLen < 0)
 			{
-				/* Offset of Intel HEX prefix in buffer */
-				int offsetOfPrefix = prefixPtr - (char*)recvBuffer;
-
-				if (offsetOfPrefix > 0)
-				{
-					/*
-					 * If Intel HEX prefix is not first character, shift it
-					 * until done.
-					 */
-					shiftBufferLeft(recvBuffer, dataLength, offsetOfPrefix);
-				}
-
-				/* Update data length after shift */
-				dataLength -= offsetOfPrefix;
+				/* Received bytes are lost, image can not be completed */
+				upgradeSettings.upgradeStatus = BL_StatusUpgrade_ReceiveFailure;
 			}
 		}
 
-		/*
-		 * This block parses aligned intel HEX string.
-		 * It contains a loop to parse intel HEX strings if exist more than one
-		 */
+		/* Program a chunk of filled buffers between UART receptions */
+		if ((upgradeSettings.flashWriteQueueCount > 0) && (upgradeSettings.upgradeStatus == BL_Status_Success))
 		{
-			/*
-			 * Buffer could be shifted for each valid intel hex line string
-			 * but instead, a parse offset is used to walk on buffer for better
-			 * performance.
-			 */
-			int parseOffset = 0;
-
-			while (dataLength > 0)
-			{
-				/* Parse aligned string first */
-				ihRetVal = IntelHex_Parse(&recvBuffer[parseOffset], dataLength, &intelHexLine, &parsedLineLength);
-
-				if (ihRetVal == IntelHex_Success)
-				{
-					/* In case of success parse, process intel hex item */
-					processIntelHexLine(&intelHexLine);
-
-#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 0)
-					if (intelHexLine.recordType == INTELHEX_RECORDTYPE_EOF)
-					{
-						eof = true;
-						break;
-					}
-#endif
-				}
-				else if (ihRetVal == IntelHex_Err_MissingLine)
-				{
-					/* Exit loop if line is missing to wait remaining part of line */
-					break;
-				}
-
-				/* Increase parsing offset to avoid shifting */
-				parseOffset += parsedLineLength;
-
-				/* Decrease data length as parsed line */
-				dataLength -= parsedLineLength;
-			}
+			upgradeSettings.upgradeStatus = writeFlashChunk();
 		}
 
-		/*
-		 * Set offset using data length to continue to receive new Intel HEX data
-		 * in Append Mode
-		 */
-		offset = dataLength;
+		if (upgradeSettings.upgradeStatus != BL_Status_Success)
+		{
+			status = upgradeSettings.upgradeStatus;
+			break;
+		}
 
-		/* TODO handle if intel hex is corrupted. Request it from host again */
 		/*
-		 * TODO decide when will exit. We should not exit when EOF received because
-		 * some parts may still missing and should wait them also.
+		 * EOF is set when all parts of image are written. Sequenced transfers
+		 * wait for missing frames even if END is received.
 		 */
-
-#if (BL_UPGRADE_REQUEST_MISSING_PARTS == 0)
-		if (eof == true)
+		if (upgradeSettings.flags.eofReceived)
 		{
 			status = BL_Status_Success;
 			break;
 		}
-#endif
 
-        /* TODO Open here */
-//		if (upgradeSettings.flags.upgradeTimeout)
-//		{
-//			/*
-//			 * Timmeout occured during upgrade break execution
-//			 */
-//			status = BL_StatusComm_UpgradeTimeout;
-//			break;
-//		}
+		/* Host stopped sending before image is completed */
+		if (upgradeSettings.flags.upgradeTimeout)
+		{
+			status = BL_StatusUpgrade_Timeout;
+			break;
+		}
 	} while (true);
 
 	return status;
@@ -425,8 +1841,7 @@ PRIVATE ALWAYS_INLINE BLStatusCode InitializeBLUpgradeModule(void)
 	}
 #endif /* #if BL_DEBUG_MODE */
 
-	/* TODO Get configuration from project config */
-	upgradeSettings.uartHandle = Drv_UART_Get(BL_FW_UPGRADE_UART_NO, 115200, DataReceivedEventHandler);
+	upgradeSettings.uartHandle = Drv_UART_Get(BL_FW_UPGRADE_UART_NO, BL_FW_UPGRADE_UART_BAUD_RATE, DataReceivedEventHandler);
 
 #if BL_DEBUG_MODE
 	if (DRV_UART_INVALID_HANDLER == upgradeSettings.uartHandle)
@@ -483,7 +1898,7 @@ BLStatusCode BL_UpgradeFirmware(void)
 #endif
 
 	/* Start Timeout Timer First */
-	Drv_Timer_Start(upgradeSettings.timeoutTimerHandle, BL_UPGRADE_TIMEOUT_IN_MS);
+	restartUpgradeTimeout();
 
 	/* TODO Move to suitable area */
 	status = ProcessMessageImageUpload();
@@ -493,3 +1908,19 @@ BLStatusCode BL_UpgradeFirmware(void)
 	return status;
 
 }
+
+/*
+ * Returns statistics of last firmware upgrade
+ */
+const BLUpgradeStats* BL_GetUpgradeStats(void)
+{
+	return &upgradeSettings.stats;
+}
+
+/*
+ * Returns SHA256 digest of image which is verified by last successful upgrade
+ */
+const uint8_t* BL_GetUpgradeImageHash(void)
+{
+	return upgradeSettings.imageHash;
+}
@@ -0,0 +1,427 @@
+/*******************************************************************************
+ *
+ * @file Bootloader_Verdict.c
+ *
+ * @author MC
+ *
+ * @brief Cached boot verdict of installed image.
+ *
+ *		  Full validation hashes whole image and runs an RSA-2048 public
+ *		  operation on every boot. After an image is verified, a record of
+ *		  its metadata digest, image digest and size is stored in a reserved
+ *		  flash sector. Next boots only hash metadata (which includes image
+ *		  signature) and check MAC of record.
+ *
+ *		  Records are appended into 256 byte slots (IAP write size), sector
+ *		  is erased only when all slots are used. A monotonic counter orders
+ *		  records. Before an upgrade writes slot of latest record, record
+ *		  is superseded by one which matches no slot. MAC is HMAC-SHA256
+ *		  with a key which is derived from bootloader secret and device
+ *		  serial number, so a record cannot be copied into another device.
+ *		  Secret must not be readable by firmware, otherwise firmware could
+ *		  forge records.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_Flash.h"
+#include "Drv_CPUCore.h"
+
+#include "Bootloader_Internal.h"
+#include "Bootloader_Config.h"
+
+#include "mbedtls/sha256.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Magic of a written record slot */
+#define BL_VERDICT_RECORD_MAGIC					(0x54445256)	/* "VRDT" */
+
+/* Records are written in slots of minimum IAP write size */
+#define BL_VERDICT_SLOT_SIZE					(256)
+
+/* Length of SHA-256 digest and its block */
+#define BL_VERDICT_HASH_LENGTH					(32)
+#define BL_VERDICT_HASH_BLOCK_SIZE				(64)
+
+/* HMAC paddings */
+#define BL_VERDICT_HMAC_INNER_PAD				(0x36)
+#define BL_VERDICT_HMAC_OUTER_PAD				(0x5C)
+
+/* Erased flash value */
+#define BL_VERDICT_ERASED_FLASH_VALUE			(0xFF)
+
+/* Slot address of a record which invalidates previous ones, matches no slot */
+#define BL_VERDICT_NO_SLOT_ADDRESS				(0xFFFFFFFF)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Verified image record. MAC covers all fields before it.
+ */
+typedef struct
+{
+	uint32_t magic;
+	/* Incremented for each record, latest record has highest one */
+	uint32_t counter;
+	/* Size of verified image */
+	uint32_t imageSize;
+	/* Start address of slot of verified image */
+	uint32_t slotAddress;
+	/* Digest of metadata, binds record to image signature */
+	uint8_t metadataHash[BL_VERDICT_HASH_LENGTH];
+	/* Digest of verified image */
+	uint8_t imageHash[BL_VERDICT_HASH_LENGTH];
+	uint8_t mac[BL_VERDICT_HASH_LENGTH];
+} BLVerdictRecord;
+
+/******************************** VARIABLES ***********************************/
+
+/* Verification policy of this boot, see BL_VerdictInit */
+PRIVATE bool reverificationRequired;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Reads secret of record key and returns
+ */
+PRIVATE ALWAYS_INLINE const char* getVerdictSecret(void)
+{
+	/* TODO Remove Test Mode */
+#if BL_TEST_MODE
+	static const char secret[] = "SPBootloader Test Verdict Secret";
+
+	return secret;
+#else   /* #if BL_TEST_MODE */
+#error "Not defined yet!"
+#endif  /* #if BL_TEST_MODE */
+}
+
+/*
+ * Returns flash address of a record slot
+ */
+PRIVATE uint32_t getSlotAddress(uint32_t slotNo)
+{
+	return Drv_Flash_GetBlockAddress(BL_VERDICT_RECORD_BLOCK_NO) + (slotNo * BL_VERDICT_SLOT_SIZE);
+}
+
+/*
+ * Returns number of record slots in reserved sector
+ */
+PRIVATE uint32_t getSlotCount(void)
+{
+	return (Drv_Flash_GetBlockAddress(BL_VERDICT_RECORD_BLOCK_NO + 1) - Drv_Flash_GetBlockAddress(BL_VERDICT_RECORD_BLOCK_NO)) / BL_VERDICT_SLOT_SIZE;
+}
+
+/*
+ * Calculates MAC of record (HMAC-SHA256) using a device bound key
+ */
+PRIVATE void calculateRecordMac(const BLVerdictRecord* record, uint8_t* mac)
+{
+	mbedtls_sha256_context context;
+	uint32_t serialNumber[FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT];
+	uint8_t key[BL_VERDICT_HASH_BLOCK_SIZE];
+	uint8_t pad[BL_VERDICT_HASH_BLOCK_SIZE];
+	uint8_t innerHash[BL_VERDICT_HASH_LENGTH];
+	const char* secret = getVerdictSecret();
+	uint32_t index;
+
+	memset(serialNumber, 0, sizeof(serialNumber));
+	(void)Drv_Flash_ReadDeviceSerialNumber(serialNumber);
+
+	/* Key is digest of secret and serial number, zero padded to block size */
+	memset(key, 0, sizeof(key));
+
+	mbedtls_sha256_init(&context);
+	mbedtls_sha256_starts(&context, 0);
+	mbedtls_sha256_update(&context, (const uint8_t*)secret, strlen(secret));
+	mbedtls_sha256_update(&context, (const uint8_t*)serialNumber, sizeof(serialNumber));
+	mbedtls_sha256_finish(&context, key);
+
+	for (index = 0; index < sizeof(pad); index++)
+	{
+		pad[index] = key[index] ^ BL_VERDICT_HMAC_INNER_PAD;
+	}
+
+	mbedtls_sha256_starts(&context, 0);
+	mbedtls_sha256_update(&context, pad, sizeof(pad));
+	mbedtls_sha256_update(&context, (const uint8_t*)record, sizeof(BLVerdictRecord) - sizeof(record->mac));
+	mbedtls_sha256_finish(&context, innerHash);
+
+	for (index = 0; index < sizeof(pad); index++)
+	{
+		pad[index] = key[index] ^ BL_VERDICT_HMAC_OUTER_PAD;
+	}
+
+	mbedtls_sha256_starts(&context, 0);
+	mbedtls_sha256_update(&context, pad, sizeof(pad));
+	mbedtls_sha256_update(&context, innerHash, sizeof(innerHash));
+	mbedtls_sha256_finish(&context, mac);
+	mbedtls_sha256_free(&context);
+
+	memset(key, 0, sizeof(key));
+	memset(pad, 0, sizeof(pad));
+}
+
+/*
+ * Compares digests in constant time
+ */
+PRIVATE bool isSameHash(const uint8_t* hash1, const uint8_t* hash2)
+{
+	uint8_t difference = 0;
+	uint32_t index;
+
+	for (index = 0; index < BL_VERDICT_HASH_LENGTH; index++)
+	{
+		difference |= hash1[index] ^ hash2[index];
+	}
+
+	return (difference == 0);
+}
+
+/*
+ * Calculates digest of metadata in active slot and reads image size
+ */
+PRIVATE void hashMetaData(uint8_t* hash, uint32_t* imageSize)
+{
+	uint32_t metaData[FIRMWARE_METADATA_LENGTH / sizeof(uint32_t)];
+
+	Drv_Flash_Read(BL_GetActiveSlotAddress(), (uint8_t*)metaData, sizeof(metaData));
+
+	*imageSize = ((FirmwareMetaDataHeader*)metaData)->imageSize;
+
+	mbedtls_sha256((const uint8_t*)metaData, sizeof(metaData), hash, 0);
+}
+
+/*
+ * Reads latest record and finds first free slot.
+ *	Slots are written in order, so latest record is before first free slot.
+ *
+ * @return true if a record exists
+ */
+PRIVATE bool readLatestRecord(BLVerdictRecord* record, uint32_t* freeSlotNo)
+{
+	uint32_t slotCount = getSlotCount();
+	uint32_t slotNo;
+	uint32_t magic;
+
+	for (slotNo = 0; slotNo < slotCount; slotNo++)
+	{
+		Drv_Flash_Read(getSlotAddress(slotNo), (uint8_t*)&magic, sizeof(magic));
+		if (magic != BL_VERDICT_RECORD_MAGIC)
+		{
+			break;
+		}
+	}
+
+	*freeSlotNo = slotNo;
+
+	if (slotNo == 0)
+	{
+		return false;
+	}
+
+	Drv_Flash_Read(getSlotAddress(slotNo - 1), (uint8_t*)record, sizeof(BLVerdictRecord));
+
+	return true;
+}
+
+/*
+ * Checks whether record is valid for installed image
+ */
+PRIVATE bool isRecordOfInstalledImage(const BLVerdictRecord* record)
+{
+	uint8_t metaDataHash[BL_VERDICT_HASH_LENGTH];
+	uint8_t mac[BL_VERDICT_HASH_LENGTH];
+	uint32_t imageSize;
+
+	hashMetaData(metaDataHash, &imageSize);
+
+	/* Same image in other slot is not verified, e.g. after a rollback */
+	if ((record->slotAddress != BL_GetActiveSlotAddress()) ||
+		(record->imageSize != imageSize) || !isSameHash(record->metadataHash, metaDataHash))
+	{
+		return false;
+	}
+
+	calculateRecordMac(record, mac);
+
+	return isSameHash(record->mac, mac);
+}
+
+/*
+ * Checks whether verification policy requires a full verification on this
+ * boot. Boot count is incremented, so it is called once per boot.
+ */
+PRIVATE bool isReverificationRequired(void)
+{
+	bool required = false;
+	uint32_t bootCount;
+
+#if BL_VERDICT_REVERIFY_ON_WATCHDOG_RESET
+	/* Reset source is read on each boot, it is cleared by driver */
+	if (Drv_CPUCore_IsWatchdogReset())
+	{
+		required = true;
+	}
+#endif
+
+	bootCount = Drv_CPUCore_IncrementBootCount();
+
+	if ((BL_VERDICT_REVERIFY_BOOT_INTERVAL > 0) && ((bootCount % BL_VERDICT_REVERIFY_BOOT_INTERVAL) == 0))
+	{
+		required = true;
+	}
+
+	return required;
+}
+
+/*
+ * Prepares record sector and runs an erase or write command
+ */
+PRIVATE int32_t prepareRecordBlock(void)
+{
+	return Drv_Flash_PrepareBlockRange(BL_VERDICT_RECORD_BLOCK_NO, BL_VERDICT_RECORD_BLOCK_NO);
+}
+
+/*
+ * Writes record slot into first free slot, sector is erased when it is full
+ */
+PRIVATE BLStatusCode appendRecord(const uint32_t* slot, uint32_t freeSlotNo)
+{
+	uint32_t readBack[BL_VERDICT_SLOT_SIZE / sizeof(uint32_t)];
+	int32_t flashStatus = FLASH_STATUS_SUCCESS;
+
+	if (freeSlotNo == getSlotCount())
+	{
+		flashStatus = prepareRecordBlock();
+		if (flashStatus == FLASH_STATUS_SUCCESS)
+		{
+			flashStatus = Drv_Flash_EraseBlockRange(BL_VERDICT_RECORD_BLOCK_NO, BL_VERDICT_RECORD_BLOCK_NO);
+		}
+
+		freeSlotNo = 0;
+	}
+
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = prepareRecordBlock();
+	}
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Write(getSlotAddress(freeSlotNo), (uint8_t*)slot, BL_VERDICT_SLOT_SIZE);
+	}
+	if (flashStatus == FLASH_STATUS_SUCCESS)
+	{
+		flashStatus = Drv_Flash_Read(getSlotAddress(freeSlotNo), (uint8_t*)readBack, sizeof(readBack));
+	}
+
+	if ((flashStatus != FLASH_STATUS_SUCCESS) || (memcmp(slot, readBack, sizeof(readBack)) != 0))
+	{
+		return BL_StatusVerdict_FlashFailure;
+	}
+
+	return BL_Status_Success;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Applies verification policy of this boot
+ */
+INTERNAL void BL_VerdictInit(void)
+{
+	reverificationRequired = isReverificationRequired();
+}
+
+/*
+ * Checks cached verdict of installed image
+ */
+INTERNAL bool BL_IsImageVerdictCached(void)
+{
+	BLVerdictRecord record;
+	uint32_t freeSlotNo;
+
+	if (reverificationRequired)
+	{
+		return false;
+	}
+
+	if (!readLatestRecord(&record, &freeSlotNo))
+	{
+		return false;
+	}
+
+	return isRecordOfInstalledImage(&record);
+}
+
+/*
+ * Appends a record of verified image, sector is erased when it is full
+ */
+INTERNAL BLStatusCode BL_StoreImageVerdict(const uint8_t* imageHash)
+{
+	uint32_t slot[BL_VERDICT_SLOT_SIZE / sizeof(uint32_t)];
+	BLVerdictRecord* record = (BLVerdictRecord*)slot;
+	BLVerdictRecord latestRecord;
+	uint32_t freeSlotNo;
+	uint32_t counter = 0;
+
+	memset(slot, BL_VERDICT_ERASED_FLASH_VALUE, sizeof(slot));
+
+	if (readLatestRecord(&latestRecord, &freeSlotNo))
+	{
+		/* Same image is verified again (e.g. periodic verification), avoid flash wear */
+		if (isRecordOfInstalledImage(&latestRecord) && isSameHash(latestRecord.imageHash, imageHash))
+		{
+			return BL_Status_Success;
+		}
+
+		counter = latestRecord.counter + 1;
+	}
+
+	record->magic = BL_VERDICT_RECORD_MAGIC;
+	record->counter = counter;
+	record->slotAddress = BL_GetActiveSlotAddress();
+	hashMetaData(record->metadataHash, &record->imageSize);
+	memcpy(record->imageHash, imageHash, BL_VERDICT_HASH_LENGTH);
+	calculateRecordMac(record, record->mac);
+
+	return appendRecord(slot, freeSlotNo);
+}
+
+/*
+ * Invalidates verdict of a slot before it is upgraded. Latest record is
+ * superseded by a record which matches no slot, so an interrupted upgrade
+ * of same image does not boot using verdict of previous image.
+ */
+INTERNAL BLStatusCode BL_InvalidateImageVerdict(uint32_t slotAddress)
+{
+	uint32_t slot[BL_VERDICT_SLOT_SIZE / sizeof(uint32_t)];
+	BLVerdictRecord* record = (BLVerdictRecord*)slot;
+	BLVerdictRecord latestRecord;
+	uint32_t freeSlotNo;
+
+	if (!readLatestRecord(&latestRecord, &freeSlotNo) || (latestRecord.slotAddress != slotAddress))
+	{
+		/* Record of another slot stays valid */
+		return BL_Status_Success;
+	}
+
+	memset(slot, BL_VERDICT_ERASED_FLASH_VALUE, sizeof(slot));
+
+	record->magic = BL_VERDICT_RECORD_MAGIC;
+	record->counter = latestRecord.counter + 1;
+	record->slotAddress = BL_VERDICT_NO_SLOT_ADDRESS;
+
+	return appendRecord(slot, freeSlotNo);
+}
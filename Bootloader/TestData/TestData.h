@@ -2,7 +2,7 @@
 #ifndef __TEST_DATA
 #define __TEST_DATA
 
-static const char* testImage[] =
+static const char* const testImage[] =
 {
     ":020000040001F9",
     ":10000000A804000000020100FFFFFFFFFFFFFFFF49",
@@ -115,16 +115,13 @@ static const char* testImage[] =
     ":00000001FF"
 };
 
-static const char* TEST_PUBLIC_KEY_N =
-	"BF525DABD4F0B2B9A7E4B0D1441E1B0B145EDFBCD4C06FAFF340F5824357D9C5"
-	"E01A2FB6AB3152A1E9976BE9D3A88B09EA5017298F11108FEF478291A06EF1DC"
-	"040C00BC0384E0E1079728994FA1384FCD0F67CF075BBD932EE1B6D547A1C1BB"
-	"FAAA2BDD45BA7722E58C0208B3888F8760DDF1167E44DEF5B34FE8BE9215203E"
-	"FDD0AA0FD1986944AA73D561A0D760D6756A9B63037B96D68F1C9A8E7599D44D"
-	"0B9085788D8B1AD73600566F67E33E5EE26AF03E74993E27ACB45B1D420D415A"
-	"5E266B52F6E916DC49406D745FE58D389E959C852BA4E6A7E1904D11E89BEEBD"
-	"3662DF0F5784949F02E7A35B5C86664E10E666F3AE001579028349191EF1EA53";
+/*
+ * RSA-2048 public key of rsa_pub.txt with precomputed R^2 mod N, generated by
+ *	make tool TOOL=Environment/Tools/ImageTool TOOL_ARGS="key Bootloader/TestData/rsa_pub.txt Bootloader/TestData/TestRSAKey.h"
+ */
+#include "TestRSAKey.h"
 
-static const char* TEST_PUBLIC_KEY_E = "010001";
+/* ECDSA P-256 public key and signature of test image */
+#include "TestECDSAKey.h"
 
 #endif /* __TEST_DATA */
@@ -0,0 +1,44 @@
+/*******************************************************************************
+ *
+ * @file TestECDSAKey.h
+ *
+ * @author MC
+ *
+ * @brief ECDSA P-256 public key of bootloader and signature of test image.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __TEST_ECDSA_KEY_H
+#define __TEST_ECDSA_KEY_H
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* ECDSA P-256 public key (X | Y) */
+#define TEST_ECDSA_PUBLIC_KEY \
+{ \
+	0xFD, 0x8A, 0xF6, 0x7E, 0x36, 0x95, 0xF0, 0x39, 0xD4, 0xB7, 0xAE, 0xF7, 0x66, 0x5D, 0x4F, 0xF4, \
+	0x29, 0x17, 0x42, 0x6F, 0x39, 0x13, 0x12, 0x26, 0x61, 0xF6, 0xFD, 0x6D, 0xE5, 0x52, 0x4A, 0xBE, \
+	0x90, 0x5A, 0xDB, 0x39, 0x1A, 0xCF, 0x00, 0x8B, 0xA6, 0x59, 0xEE, 0xC0, 0xDA, 0x0C, 0x17, 0x70, \
+	0xB4, 0xD0, 0x20, 0x95, 0x09, 0x6A, 0x74, 0x2D, 0x4C, 0x20, 0x30, 0x09, 0x00, 0x89, 0xC1, 0x51  \
+}
+
+/* ECDSA P-256 signature (R | S) of test image (same image data as RSA signed one) */
+#define TEST_ECDSA_IMAGE_SIGNATURE \
+{ \
+	0x1C, 0xC9, 0x24, 0x6F, 0xA7, 0x56, 0x47, 0xDE, 0x92, 0x92, 0x32, 0x47, 0x0D, 0x0E, 0x5B, 0x84, \
+	0xA9, 0xDA, 0xDF, 0xD4, 0xF4, 0x9B, 0xAA, 0x41, 0x47, 0x32, 0xDD, 0xDF, 0x53, 0x68, 0xB4, 0x20, \
+	0x3E, 0x63, 0x45, 0x16, 0x24, 0xFA, 0xD0, 0x3A, 0x6D, 0x3C, 0x37, 0xFB, 0xCE, 0xE5, 0x4A, 0xFE, \
+	0x02, 0xA2, 0xCF, 0x50, 0x5E, 0x02, 0x06, 0x9C, 0x62, 0x39, 0xE2, 0x40, 0x99, 0xDC, 0x02, 0xF2  \
+}
+
+#endif	/* __TEST_ECDSA_KEY_H */
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *
+ * @file TestRSAKey.h
+ *
+ * @author MC
+ *
+ * @brief RSA-2048 public key of bootloader.
+ *
+ *		  Generated by ImageTool (see KeyGenerator.h), do not edit.
+ *		  Words are little endian, RSA_KEY_WORDS is provided by user.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __TEST_RSA_KEY_H
+#define __TEST_RSA_KEY_H
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Modulus */
+#define TEST_RSA_KEY_N \
+	{ \
+		RSA_KEY_WORDS(0x1EF1EA53, 0x02834919), RSA_KEY_WORDS(0xAE001579, 0x10E666F3), \
+		RSA_KEY_WORDS(0x5C86664E, 0x02E7A35B), RSA_KEY_WORDS(0x5784949F, 0x3662DF0F), \
+		RSA_KEY_WORDS(0xE89BEEBD, 0xE1904D11), RSA_KEY_WORDS(0x2BA4E6A7, 0x9E959C85), \
+		RSA_KEY_WORDS(0x5FE58D38, 0x49406D74), RSA_KEY_WORDS(0xF6E916DC, 0x5E266B52), \
+		RSA_KEY_WORDS(0x420D415A, 0xACB45B1D), RSA_KEY_WORDS(0x74993E27, 0xE26AF03E), \
+		RSA_KEY_WORDS(0x67E33E5E, 0x3600566F), RSA_KEY_WORDS(0x8D8B1AD7, 0x0B908578), \
+		RSA_KEY_WORDS(0x7599D44D, 0x8F1C9A8E), RSA_KEY_WORDS(0x037B96D6, 0x756A9B63), \
+		RSA_KEY_WORDS(0xA0D760D6, 0xAA73D561), RSA_KEY_WORDS(0xD1986944, 0xFDD0AA0F), \
+		RSA_KEY_WORDS(0x9215203E, 0xB34FE8BE), RSA_KEY_WORDS(0x7E44DEF5, 0x60DDF116), \
+		RSA_KEY_WORDS(0xB3888F87, 0xE58C0208), RSA_KEY_WORDS(0x45BA7722, 0xFAAA2BDD), \
+		RSA_KEY_WORDS(0x47A1C1BB, 0x2EE1B6D5), RSA_KEY_WORDS(0x075BBD93, 0xCD0F67CF), \
+		RSA_KEY_WORDS(0x4FA1384F, 0x07972899), RSA_KEY_WORDS(0x0384E0E1, 0x040C00BC), \
+		RSA_KEY_WORDS(0xA06EF1DC, 0xEF478291), RSA_KEY_WORDS(0x8F11108F, 0xEA501729), \
+		RSA_KEY_WORDS(0xD3A88B09, 0xE9976BE9), RSA_KEY_WORDS(0xAB3152A1, 0xE01A2FB6), \
+		RSA_KEY_WORDS(0x4357D9C5, 0xF340F582), RSA_KEY_WORDS(0xD4C06FAF, 0x145EDFBC), \
+		RSA_KEY_WORDS(0x441E1B0B, 0xA7E4B0D1), RSA_KEY_WORDS(0xD4F0B2B9, 0xBF525DAB) \
+	}
+
+/* Public exponent */
+#define TEST_RSA_KEY_E \
+	{ \
+		RSA_KEY_WORDS(0x00010001, 0x00000000) \
+	}
+
+/* Montgomery constant R^2 mod N (R = 2^2048) */
+#define TEST_RSA_KEY_RN \
+	{ \
+		RSA_KEY_WORDS(0xF56EBDED, 0xB258F186), RSA_KEY_WORDS(0x27A19E88, 0x13FEFF51), \
+		RSA_KEY_WORDS(0x2F7F306D, 0x6BBF5D43), RSA_KEY_WORDS(0x7B11687A, 0x9360F2DC), \
+		RSA_KEY_WORDS(0x00D9DB91, 0x2EA15E3B), RSA_KEY_WORDS(0x5785FD35, 0xC1953DDE), \
+		RSA_KEY_WORDS(0x9111C4DA, 0xE73FBE76), RSA_KEY_WORDS(0xE8C2AAB6, 0xBBDF0B2A), \
+		RSA_KEY_WORDS(0x977660CD, 0x4E3E6010), RSA_KEY_WORDS(0xA842E571, 0x9B37F6A7), \
+		RSA_KEY_WORDS(0xD34072D9, 0x16C48505), RSA_KEY_WORDS(0x8D161116, 0x780132E4), \
+		RSA_KEY_WORDS(0x9F071B77, 0x84061F75), RSA_KEY_WORDS(0x4DE8FE6C, 0x69FB0E89), \
+		RSA_KEY_WORDS(0x0ECA3AD4, 0x1803C5EE), RSA_KEY_WORDS(0xA24B8846, 0xE9875AB1), \
+		RSA_KEY_WORDS(0x0E52B3C9, 0x0AF41519), RSA_KEY_WORDS(0xE5949886, 0xE1D0359E), \
+		RSA_KEY_WORDS(0x857FE809, 0x8470016E), RSA_KEY_WORDS(0xD5D4A966, 0x4E0BBC8C), \
+		RSA_KEY_WORDS(0x869629EC, 0x9279C665), RSA_KEY_WORDS(0xCEFB4461, 0x4BE9B907), \
+		RSA_KEY_WORDS(0xD410FE06, 0x4F238B4C), RSA_KEY_WORDS(0xA056BB9D, 0x5D7B789E), \
+		RSA_KEY_WORDS(0x9EA64590, 0x63A10CF6), RSA_KEY_WORDS(0xEA15B885, 0x8F714AAA), \
+		RSA_KEY_WORDS(0x035BC320, 0x49F87378), RSA_KEY_WORDS(0xD46BD8AB, 0x3AC3E919), \
+		RSA_KEY_WORDS(0x14CEC81D, 0xA22FF2A4), RSA_KEY_WORDS(0xCFD6546D, 0xEACC54F4), \
+		RSA_KEY_WORDS(0x95EAED17, 0xC5A1D339), RSA_KEY_WORDS(0xB21EED3E, 0x23BC9B6B) \
+	}
+
+#endif	/* __TEST_RSA_KEY_H */
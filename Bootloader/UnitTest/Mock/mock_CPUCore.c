@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *
+ * @file mock_CPUCore.c
+ *
+ * @author MC
+ *
+ * @brief CPU Core Driver mock for unit tests.
+ *
+ *		  Simulates reset source and boot counter which survives resets.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_CPUCore.h"
+
+#include "postypes.h"
+
+/******************************** VARIABLES ***********************************/
+
+/* Whether last reset is caused by watchdog */
+PRIVATE bool mockCPUCoreWatchdogReset;
+
+/* Boot counter which is kept over resets */
+PRIVATE uint32_t mockCPUCoreBootCount;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Simulates a power-on reset
+ */
+PRIVATE void mockCPUCoreReset(void)
+{
+	mockCPUCoreWatchdogReset = false;
+	mockCPUCoreBootCount = 0;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+bool Drv_CPUCore_IsWatchdogReset(void)
+{
+	bool watchdogReset = mockCPUCoreWatchdogReset;
+
+	/* Reset source is cleared when it is read */
+	mockCPUCoreWatchdogReset = false;
+
+	return watchdogReset;
+}
+
+uint32_t Drv_CPUCore_IncrementBootCount(void)
+{
+	return ++mockCPUCoreBootCount;
+}
+
+void Drv_CPUCore_StartCycleCounter(void)
+{
+}
+
+uint32_t Drv_CPUCore_GetCycleCount(void)
+{
+	return 0;
+}
@@ -0,0 +1,271 @@
+/*******************************************************************************
+ *
+ * @file mock_Flash.c
+ *
+ * @author MC
+ *
+ * @brief RAM based Flash Driver mock for unit tests.
+ *
+ *		  Simulates LPC1768 flash (16 x 4K + 14 x 32K blocks). Writes can
+ *		  only clear bits like NOR flash, so missing erases are detected.
+ *		  A power cut can be simulated during any write or erase operation,
+ *		  interrupted operation is half done and next ones fail until power
+ *		  is restored.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_Flash.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+#define MOCK_FLASH_SIZE								(0x80000)
+#define MOCK_FLASH_32K_BLOCKS_START_ADDRESS			(0x10000)
+#define MOCK_FLASH_4K_BLOCK_COUNT					(16)
+#define MOCK_FLASH_4K_BLOCK_SIZE					(4 * 1024)
+#define MOCK_FLASH_32K_BLOCK_SIZE					(32 * 1024)
+
+/******************************** VARIABLES ***********************************/
+
+/* Flash content */
+PRIVATE uint8_t mockFlash[MOCK_FLASH_SIZE];
+
+/* Number of flash write operations */
+PRIVATE uint32_t mockFlashWriteCount;
+
+/* Number of erase operations and erased blocks */
+PRIVATE uint32_t mockFlashEraseCount;
+PRIVATE uint32_t mockFlashErasedBlockCount;
+
+/* Unique serial number of simulated device */
+PRIVATE uint32_t mockFlashSerialNumber[FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT] = { 0x1768, 0x0001, 0x0002, 0x0003 };
+
+/* Address whose programming fails silently (e.g. a worn cell), 0 if none */
+PRIVATE uint32_t mockFlashFaultAddress;
+
+/* Number of write and erase operations */
+PRIVATE uint32_t mockFlashOperationCount;
+
+/* Write or erase operation (1 based) which is interrupted by a power cut, 0 if none */
+PRIVATE uint32_t mockFlashPowerCutOperationNo;
+
+/* Power is cut, flash is not changed until power is restored */
+PRIVATE bool mockFlashPowerLost;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+
+PRIVATE uint32_t mockFlashBlockAddress(uint32_t blockNo)
+{
+	if (blockNo < MOCK_FLASH_4K_BLOCK_COUNT)
+	{
+		return blockNo * MOCK_FLASH_4K_BLOCK_SIZE;
+	}
+
+	return MOCK_FLASH_32K_BLOCKS_START_ADDRESS + ((blockNo - MOCK_FLASH_4K_BLOCK_COUNT) * MOCK_FLASH_32K_BLOCK_SIZE);
+}
+
+/*
+ * Resets flash into erased state
+ */
+PRIVATE void mockFlashReset(void)
+{
+	memset(mockFlash, 0xFF, sizeof(mockFlash));
+	mockFlashWriteCount = 0;
+	mockFlashEraseCount = 0;
+	mockFlashErasedBlockCount = 0;
+	mockFlashFaultAddress = 0;
+	mockFlashOperationCount = 0;
+	mockFlashPowerCutOperationNo = 0;
+	mockFlashPowerLost = false;
+}
+
+/*
+ * Restores power after a simulated power cut, flash content is kept
+ */
+PRIVATE void mockFlashRestorePower(void)
+{
+	mockFlashOperationCount = 0;
+	mockFlashPowerCutOperationNo = 0;
+	mockFlashPowerLost = false;
+}
+
+/*
+ * Counts a write or erase operation and checks whether it is interrupted
+ * by power cut
+ */
+PRIVATE bool mockFlashIsPowerCut(void)
+{
+	mockFlashOperationCount++;
+
+	if (mockFlashOperationCount == mockFlashPowerCutOperationNo)
+	{
+		mockFlashPowerLost = true;
+		return true;
+	}
+
+	return false;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+void Drv_Flash_Init(void)
+{
+	/* Device boots again */
+	mockFlashRestorePower();
+}
+
+int32_t Drv_Flash_PrepareBlock(uint32_t blockNo)
+{
+	(void)blockNo;
+
+	return FLASH_STATUS_SUCCESS;
+}
+
+int32_t Drv_Flash_PrepareBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	(void)startBlockNo;
+	(void)endBlockNo;
+
+	return FLASH_STATUS_SUCCESS;
+}
+
+int32_t Drv_Flash_EraseBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint32_t startAddress = mockFlashBlockAddress(startBlockNo);
+	uint32_t endAddress = mockFlashBlockAddress(endBlockNo + 1);
+
+	if (mockFlashPowerLost)
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	if (mockFlashIsPowerCut())
+	{
+		/* Interrupted erase leaves a partially erased range */
+		memset(&mockFlash[startAddress], 0xFF, (endAddress - startAddress) / 2);
+		return FLASH_STATUS_FAILURE;
+	}
+
+	memset(&mockFlash[startAddress], 0xFF, endAddress - startAddress);
+	mockFlashEraseCount++;
+	mockFlashErasedBlockCount += endBlockNo - startBlockNo + 1;
+
+	return FLASH_STATUS_SUCCESS;
+}
+
+int32_t Drv_Flash_BlankCheckBlockRange(uint32_t startBlockNo, uint32_t endBlockNo)
+{
+	uint32_t address;
+
+	for (address = mockFlashBlockAddress(startBlockNo); address < mockFlashBlockAddress(endBlockNo + 1); address++)
+	{
+		if (mockFlash[address] != 0xFF)
+		{
+			return FLASH_STATUS_NOT_BLANK;
+		}
+	}
+
+	return FLASH_STATUS_SUCCESS;
+}
+
+int32_t Drv_Flash_EraseBlock(uint32_t blockNo)
+{
+	return Drv_Flash_EraseBlockRange(blockNo, blockNo);
+}
+
+int32_t Drv_Flash_Write(uint32_t address, uint8_t* data, uint32_t length)
+{
+	uint32_t index;
+
+	if ((address + length > MOCK_FLASH_SIZE) || mockFlashPowerLost)
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	if (mockFlashIsPowerCut())
+	{
+		/* Interrupted write programs only first half of data */
+		length /= 2;
+	}
+
+	/* Programming clears bits only */
+	for (index = 0; index < length; index++)
+	{
+		mockFlash[address + index] &= data[index];
+	}
+
+	/* Faulty cell keeps its erased value */
+	if ((mockFlashFaultAddress >= address) && (mockFlashFaultAddress < address + length))
+	{
+		mockFlash[mockFlashFaultAddress] = 0xFF;
+	}
+	mockFlashWriteCount++;
+
+	return mockFlashPowerLost ? FLASH_STATUS_FAILURE : FLASH_STATUS_SUCCESS;
+}
+
+int32_t Drv_Flash_WriteBlock(uint32_t blockNo, uint8_t* data, uint32_t length)
+{
+	return Drv_Flash_Write(mockFlashBlockAddress(blockNo), data, length);
+}
+
+int32_t Drv_Flash_Read(uint32_t address, uint8_t* data, uint32_t length)
+{
+	if (address + length > MOCK_FLASH_SIZE)
+	{
+		return FLASH_STATUS_FAILURE;
+	}
+
+	memcpy(data, &mockFlash[address], length);
+
+	return FLASH_STATUS_SUCCESS;
+}
+
+int32_t Drv_Flash_GetBlockNoOfAddress(uint32_t address)
+{
+	if (address >= MOCK_FLASH_SIZE)
+	{
+		return -1;
+	}
+
+	if (address < MOCK_FLASH_32K_BLOCKS_START_ADDRESS)
+	{
+		return (int32_t)(address / MOCK_FLASH_4K_BLOCK_SIZE);
+	}
+
+	return (int32_t)(MOCK_FLASH_4K_BLOCK_COUNT + ((address - MOCK_FLASH_32K_BLOCKS_START_ADDRESS) / MOCK_FLASH_32K_BLOCK_SIZE));
+}
+
+uint32_t Drv_Flash_GetBlockAddress(uint32_t blockNo)
+{
+	return mockFlashBlockAddress(blockNo);
+}
+
+uint32_t Drv_Flash_GetSize(void)
+{
+	return MOCK_FLASH_SIZE;
+}
+
+int32_t Drv_Flash_ReadDeviceSerialNumber(uint32_t* serialNumber)
+{
+	uint32_t index;
+
+	for (index = 0; index < FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT; index++)
+	{
+		serialNumber[index] = mockFlashSerialNumber[index];
+	}
+
+	return FLASH_STATUS_SUCCESS;
+}
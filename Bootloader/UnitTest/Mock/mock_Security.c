@@ -0,0 +1,66 @@
+/*******************************************************************************
+ *
+ * @file mock_Security.c
+ *
+ * @author MC
+ *
+ * @brief Bootloader Security mock for unit tests.
+ *
+ *		  Records digest and signature which are passed for verification,
+ *		  RSA keys of test data are not used by upgrade tests.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Bootloader_Internal.h"
+#include "Bootloader_Config.h"
+
+#include "postypes.h"
+
+/******************************** VARIABLES ***********************************/
+
+/* Scheme, digest and signature of last verification */
+PRIVATE uint32_t mockSecuritySignatureType;
+PRIVATE uint8_t mockSecurityHash[32];
+PRIVATE uint8_t mockSecuritySignature[FIRMWARE_SIGNATURE_LENGTH];
+
+/* Number of signature verifications */
+PRIVATE uint32_t mockSecurityVerifyCount;
+
+/* Result of signature verification */
+PRIVATE BLStatusCode mockSecurityVerifyStatus;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Resets recorded verifications, signatures are accepted
+ */
+PRIVATE void mockSecurityReset(void)
+{
+	mockSecuritySignatureType = 0;
+	memset(mockSecurityHash, 0, sizeof(mockSecurityHash));
+	memset(mockSecuritySignature, 0, sizeof(mockSecuritySignature));
+	mockSecurityVerifyCount = 0;
+	mockSecurityVerifyStatus = BL_Status_Success;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+BLStatusCode BL_VerifyImageSignature(uint32_t signatureType, const uint8_t* hash, const uint8_t* signature)
+{
+	mockSecuritySignatureType = signatureType;
+	memcpy(mockSecurityHash, hash, sizeof(mockSecurityHash));
+	memcpy(mockSecuritySignature, signature, sizeof(mockSecuritySignature));
+	mockSecurityVerifyCount++;
+
+	return mockSecurityVerifyStatus;
+}
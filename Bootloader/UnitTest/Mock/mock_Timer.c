@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *
+ * @file mock_Timer.c
+ *
+ * @author MC
+ *
+ * @brief Timer Driver mock for unit tests.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_Timer.h"
+
+#include "postypes.h"
+
+/******************************** VARIABLES ***********************************/
+
+/* Elapsed time which is reported by all timers */
+PRIVATE uint32_t mockTimerElapsedTimeInUs;
+
+/* Timers expire as soon as they are started (e.g. host never sends) */
+PRIVATE bool mockTimerExpired;
+PRIVATE DrvTimerCallback mockTimerCallback;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Resets timer behaviour
+ */
+PRIVATE void mockTimerReset(void)
+{
+	mockTimerExpired = false;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+void Drv_Timer_Init(void)
+{
+}
+
+TimerHandle Drv_Timer_Create(TimerNo timerNo, DrvTimerPriority priority, DrvTimerCallback timerCallback)
+{
+	(void)priority;
+
+	mockTimerCallback = timerCallback;
+
+	return (TimerHandle)timerNo;
+}
+
+void Drv_Timer_Release(TimerHandle timer)
+{
+	(void)timer;
+}
+
+void Drv_Timer_Start(TimerHandle timerHandle, uint32_t timeoutInUs)
+{
+	(void)timerHandle;
+	(void)timeoutInUs;
+
+	if (mockTimerExpired && (mockTimerCallback != NULL))
+	{
+		mockTimerCallback();
+	}
+}
+
+uint32_t Drv_Timer_ReadElapsedTimeInUs(TimerHandle timerHandle)
+{
+	(void)timerHandle;
+
+	return mockTimerElapsedTimeInUs;
+}
@@ -0,0 +1,171 @@
+/*******************************************************************************
+ *
+ * @file mock_UART.c
+ *
+ * @author MC
+ *
+ * @brief UART Driver mock for unit tests.
+ *
+ *		  Delivers a test stream in fixed length chunks and records sent data.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Drv_UART.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Maximum length of test stream */
+#define MOCK_UART_STREAM_SIZE			(160 * 1024)
+
+/* Maximum length of sent data */
+#define MOCK_UART_SENT_SIZE				(4 * 1024)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/* Receives data which is sent by Drv_UART_Send, e.g. to simulate host */
+typedef void (*MockUARTSendHandler)(const uint8_t* data, uint32_t length);
+
+/******************************** VARIABLES ***********************************/
+
+/* Stream which is delivered by Drv_UART_Receive and Drv_UART_PeekSpan */
+PRIVATE uint8_t mockUARTStream[MOCK_UART_STREAM_SIZE];
+PRIVATE uint32_t mockUARTStreamLength;
+PRIVATE uint32_t mockUARTStreamOffset;
+
+/* Maximum number of bytes delivered by a Drv_UART_Receive or Drv_UART_PeekSpan call */
+PRIVATE uint32_t mockUARTChunkLength;
+
+/* Receive error is reported when stream reaches this offset */
+PRIVATE uint32_t mockUARTErrorOffset;
+
+/* Data which is sent by Drv_UART_Send */
+PRIVATE uint8_t mockUARTSent[MOCK_UART_SENT_SIZE];
+PRIVATE uint32_t mockUARTSentLength;
+PRIVATE MockUARTSendHandler mockUARTSendHandler;
+
+PRIVATE UARTDataReceivedEventHandler mockUARTHandler;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Resets test stream
+ */
+PRIVATE void mockUARTReset(uint32_t chunkLength)
+{
+	mockUARTStreamLength = 0;
+	mockUARTStreamOffset = 0;
+	mockUARTChunkLength = chunkLength;
+	mockUARTErrorOffset = UINT32_MAX;
+	mockUARTSentLength = 0;
+	mockUARTSendHandler = NULL;
+}
+
+/*
+ * Appends data to test stream
+ */
+PRIVATE void mockUARTAppend(const void* data, uint32_t length)
+{
+	memcpy(&mockUARTStream[mockUARTStreamLength], data, length);
+	mockUARTStreamLength += length;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+void Drv_UART_Init(void)
+{
+}
+
+UartHandle Drv_UART_Get(uint32_t uartNo, uint32_t baudRate, UARTDataReceivedEventHandler dataReceivedEventHandler)
+{
+	(void)baudRate;
+
+	mockUARTHandler = dataReceivedEventHandler;
+
+	if (mockUARTStreamLength > 0)
+	{
+		mockUARTHandler();
+	}
+
+	return (UartHandle)uartNo;
+}
+
+void Drv_UART_Release(UartHandle uart)
+{
+	(void)uart;
+}
+
+int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength)
+{
+	(void)uart;
+
+	if (mockUARTSendHandler != NULL)
+	{
+		mockUARTSendHandler(sendBuffer, sendLength);
+	}
+
+	sendLength = MATH_MIN(sendLength, MOCK_UART_SENT_SIZE - mockUARTSentLength);
+
+	memcpy(&mockUARTSent[mockUARTSentLength], sendBuffer, sendLength);
+	mockUARTSentLength += sendLength;
+
+	return (int32_t)sendLength;
+}
+
+int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength)
+{
+	uint32_t length;
+
+	(void)uart;
+
+	length = MATH_MIN(MATH_MIN(receiveLength, mockUARTChunkLength), mockUARTStreamLength - mockUARTStreamOffset);
+
+	memcpy(receiveBuffer, &mockUARTStream[mockUARTStreamOffset], length);
+	mockUARTStreamOffset += length;
+
+	/* Inform client about remaining data */
+	if (mockUARTStreamOffset < mockUARTStreamLength)
+	{
+		mockUARTHandler();
+	}
+
+	return (int32_t)length;
+}
+
+int32_t Drv_UART_PeekSpan(UartHandle uart, uint8_t** span)
+{
+	(void)uart;
+
+	if (mockUARTStreamOffset >= mockUARTErrorOffset)
+	{
+		return -1;
+	}
+
+	*span = &mockUARTStream[mockUARTStreamOffset];
+
+	return (int32_t)MATH_MIN(mockUARTChunkLength, mockUARTStreamLength - mockUARTStreamOffset);
+}
+
+void Drv_UART_Consume(UartHandle uart, uint32_t length)
+{
+	(void)uart;
+
+	mockUARTStreamOffset += length;
+
+	/* Inform client about remaining data */
+	if (mockUARTStreamOffset < mockUARTStreamLength)
+	{
+		mockUARTHandler();
+	}
+}
@@ -0,0 +1,1747 @@
+/*******************************************************************************
+ *
+ * @file unittest_BootloaderUpgrade.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Bootloader Upgrade, Verdict and Slot Modules
+ *
+ *		  Uploads test image through Intel HEX and binary frame transports
+ *		  and checks flash content. memcpy of modules under test is counted
+ *		  to check zero-copy receive path. Cached verdicts of installed
+ *		  images are checked against boot policies. A/B slot switching is
+ *		  checked against a power cut at each flash operation. Uploads of
+ *		  host sender are resumed after power cuts at random operations.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Let's include mock source files to simulate external module behaviours */
+#include "Mock/mock_Flash.c"
+#include "Mock/mock_UART.c"
+#include "Mock/mock_Timer.c"
+#include "Mock/mock_Security.c"
+#include "Mock/mock_CPUCore.c"
+#include "../../Environment/ExternalLib/mbedTLS/library/sha256.c"
+
+/* Host side delta generator builds deltas of test images */
+#include "../../Environment/Tools/ImageTool/DeltaGenerator.c"
+#include "../../Environment/Tools/ImageTool/Compressor.c"
+#include "../../Environment/Tools/ImageTool/ImageSender.c"
+
+/* Upgrade journal is not on receive path, its records are not counted */
+#include "../Bootloader_Journal.c"
+
+/*
+ * Bytes which are copied by transport libraries and upgrade module are
+ * counted to check that received data is decoded in place
+ */
+PRIVATE uint32_t copiedByteCount;
+
+PRIVATE void* countingMemcpy(void* destination, const void* source, size_t length)
+{
+	copiedByteCount += (uint32_t)length;
+
+	return memcpy(destination, source, length);
+}
+
+#define memcpy(destination, source, length)		countingMemcpy(destination, source, length)
+
+/* Transport libraries */
+#include "../../Environment/Lib/IntelHex/IntelHex.c"
+#include "../../Environment/Lib/CRC32/CRC32.c"
+#include "../../Environment/Lib/BinFrame/BinFrame.c"
+#include "../../Environment/Lib/Delta/Delta.c"
+#include "../../Environment/Lib/LZSS/LZSS.c"
+
+/* Include Upgrade source file for WHITE-BOX unit testing */
+#include "../Bootloader_Upgrade.c"
+#include "../Bootloader_Verdict.c"
+#include "../Bootloader_Slot.c"
+
+/* Intel HEX lines of test image */
+#include "TestData.h"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of lines in test image */
+#define TEST_IMAGE_LINE_COUNT			(sizeof(testImage) / sizeof(char*))
+
+/* Maximum length of test image */
+#define TEST_IMAGE_MAX_LENGTH			(128 * 1024)
+
+/* Maximum number of responses which can be collected */
+#define TEST_MAX_RESPONSE_COUNT			(32)
+
+/* Length of images of slot tests, spans two 32K blocks */
+#define TEST_SLOT_IMAGE_LENGTH			(MOCK_FLASH_32K_BLOCK_SIZE + 5000)
+
+/* Number of power cuts of resume tests */
+#define TEST_RESUME_POWER_CUT_COUNT		(12)
+
+/* Number of sequenced frames of test image */
+#define TEST_SEQ_FRAME_COUNT			((expectedImageLength + BINFRAME_SEQ_PAYLOAD_LENGTH - 1) / BINFRAME_SEQ_PAYLOAD_LENGTH)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Test image which is decoded from Intel HEX lines (from FIRMWARE_START_ADDRESS) */
+PRIVATE uint8_t expectedImage[TEST_IMAGE_MAX_LENGTH];
+PRIVATE uint32_t expectedImageLength;
+
+/* Encoded frame */
+PRIVATE uint8_t frame[BINFRAME_FRAME_LENGTH(BINFRAME_MAX_PAYLOAD_LENGTH)];
+
+/* Responses (ACK/NAK) which are sent by upgrade module */
+PRIVATE BinFrame responses[TEST_MAX_RESPONSE_COUNT];
+PRIVATE uint32_t responseBitmaps[TEST_MAX_RESPONSE_COUNT];
+PRIVATE uint32_t responseCount;
+
+/* Flash content which is restored before each power cut */
+PRIVATE uint8_t flashSnapshot[MOCK_FLASH_SIZE];
+
+/* Installed image and delta of delta update tests, compressed image */
+PRIVATE uint8_t sourceImage[TEST_IMAGE_MAX_LENGTH];
+PRIVATE uint32_t sourceImageLength;
+PRIVATE uint8_t delta[TEST_IMAGE_MAX_LENGTH];
+PRIVATE uint32_t deltaLength;
+
+/* Host side sender of resume tests */
+PRIVATE ImageSender sender;
+PRIVATE ImageSenderStats senderStats;
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/*
+ * Decodes test image into expected flash content
+ */
+PRIVATE void buildExpectedImage(void)
+{
+	IntelHexLine line;
+	uint32_t parsedLength;
+	uint32_t segmentAddress = 0;
+	uint32_t offset;
+	uint32_t index;
+
+	memset(expectedImage, 0xFF, sizeof(expectedImage));
+	expectedImageLength = 0;
+
+	for (index = 0; index < TEST_IMAGE_LINE_COUNT; index++)
+	{
+		TEST_ASSERT_EQUAL(IntelHex_Success,
+			IntelHex_Parse((uint8_t*)testImage[index], (uint32_t)strlen(testImage[index]), &line, &parsedLength));
+
+		if (line.recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+		{
+			segmentAddress = ((line.data[0] << 8) | line.data[1]) * INTELHEX_SEGMENT_SIZE;
+		}
+		else if (line.recordType == INTELHEX_RECORDTYPE_DATA)
+		{
+			offset = segmentAddress + line.address - FIRMWARE_START_ADDRESS;
+			memcpy(&expectedImage[offset], line.data, line.lenght);
+			expectedImageLength = MATH_MAX(expectedImageLength, offset + line.lenght);
+		}
+	}
+}
+
+/*
+ * Extends expected image to given length with a pattern after metadata of
+ * test image, so image spans multiple flash write buffers
+ */
+PRIVATE void buildLargeImage(uint32_t length)
+{
+	uint32_t index;
+
+	for (index = FIRMWARE_METADATA_LENGTH; index < length; index++)
+	{
+		expectedImage[index] = (uint8_t)(index * 7);
+	}
+
+	expectedImageLength = length;
+}
+
+/*
+ * Appends test image as Intel HEX lines to UART stream
+ */
+PRIVATE void appendIntelHexStream(void)
+{
+	uint32_t index;
+
+	for (index = 0; index < TEST_IMAGE_LINE_COUNT; index++)
+	{
+		mockUARTAppend(testImage[index], (uint32_t)strlen(testImage[index]));
+		mockUARTAppend("\r\n", 2);
+	}
+}
+
+/*
+ * Appends a frame to UART stream
+ */
+PRIVATE void appendFrame(uint32_t type, uint32_t address, const uint8_t* payload, uint32_t length)
+{
+	mockUARTAppend(frame, BinFrame_Encode(type, address, payload, length, frame));
+}
+
+/*
+ * Appends expected image as binary frames to UART stream
+ */
+PRIVATE void appendBinFrameStream(uint32_t payloadLength, bool appendEnd)
+{
+	uint32_t offset;
+	uint32_t length;
+
+	for (offset = 0; offset < expectedImageLength; offset += length)
+	{
+		length = MATH_MIN(payloadLength, expectedImageLength - offset);
+
+		appendFrame(BINFRAME_TYPE_DATA, FIRMWARE_START_ADDRESS + offset, &expectedImage[offset], length);
+	}
+
+	if (appendEnd)
+	{
+		appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+	}
+}
+
+/*
+ * Builds a delta update: installed image (in slot A) is expected image
+ * without a few inserted bytes and with a modified function. Expected image
+ * is linked for given slot. Delta is appended to UART stream as patch frames.
+ */
+PRIVATE void appendDeltaStream(uint32_t slotAddress)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+	uint32_t seed = 12345;
+	uint32_t index;
+	uint32_t offset;
+	uint32_t length;
+
+	/* Code like content, no pattern repeats */
+	for (index = FIRMWARE_METADATA_LENGTH; index < 3 * MOCK_FLASH_32K_BLOCK_SIZE; index++)
+	{
+		seed = (seed * 1103515245) + 12345;
+		expectedImage[index] = (uint8_t)(seed >> 16);
+	}
+
+	expectedImageLength = 3 * MOCK_FLASH_32K_BLOCK_SIZE;
+	firmware->header.imageSize = expectedImageLength - FIRMWARE_METADATA_LENGTH;
+	firmware->header.imageOffset = slotAddress + FIRMWARE_METADATA_LENGTH;
+
+	/* 64 bytes are inserted into second sector of new image */
+	memcpy(sourceImage, expectedImage, 40000);
+	memcpy(&sourceImage[40000], &expectedImage[40064], expectedImageLength - 40064);
+	sourceImageLength = expectedImageLength - 64;
+
+	/* A function of third sector is changed, metadata differs */
+	memset(&sourceImage[70000], 0x00, 32);
+	((FirmwareInfo*)sourceImage)->header.imageSize = sourceImageLength - FIRMWARE_METADATA_LENGTH;
+
+	/* Source is installed into slot A */
+	((FirmwareInfo*)sourceImage)->header.imageOffset = FIRMWARE_START_ADDRESS + FIRMWARE_METADATA_LENGTH;
+
+	memcpy(&mockFlash[FIRMWARE_START_ADDRESS], sourceImage, sourceImageLength);
+
+	deltaLength = DeltaGenerator_Generate(sourceImage, sourceImageLength, expectedImage, expectedImageLength,
+										  MOCK_FLASH_32K_BLOCK_SIZE, delta, sizeof(delta));
+	TEST_ASSERT(deltaLength > 0);
+
+	for (offset = 0; offset < deltaLength; offset += length)
+	{
+		length = MATH_MIN(BINFRAME_MAX_PAYLOAD_LENGTH, deltaLength - offset);
+
+		appendFrame(BINFRAME_TYPE_PATCH, offset, &delta[offset], length);
+	}
+
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+}
+
+/*
+ * Appends expected image as compressed frames to UART stream
+ */
+PRIVATE void appendCompressedStream(uint32_t payloadLength)
+{
+	uint32_t offset;
+	uint32_t length;
+
+	deltaLength = Compressor_Compress(expectedImage, expectedImageLength, COMPRESSOR_DEFAULT_WINDOW_BITS,
+									  COMPRESSOR_DEFAULT_LENGTH_BITS, delta, sizeof(delta));
+	TEST_ASSERT(deltaLength > 0);
+
+	for (offset = 0; offset < deltaLength; offset += length)
+	{
+		length = MATH_MIN(payloadLength, deltaLength - offset);
+
+		appendFrame(BINFRAME_TYPE_COMPRESSED, offset, &delta[offset], length);
+	}
+}
+
+/*
+ * Appends a sequenced frame of expected image to UART stream
+ */
+PRIVATE void appendSeqFrame(uint32_t seqNo, bool corrupted)
+{
+	uint32_t offset = seqNo * BINFRAME_SEQ_PAYLOAD_LENGTH;
+	uint32_t length = MATH_MIN(BINFRAME_SEQ_PAYLOAD_LENGTH, expectedImageLength - offset);
+	uint32_t frameLength;
+
+	frameLength = BinFrame_Encode(BINFRAME_TYPE_SEQ_DATA, seqNo, &expectedImage[offset], length, frame);
+
+	if (corrupted)
+	{
+		frame[frameLength - 1] ^= 0x10;
+	}
+
+	mockUARTAppend(frame, frameLength);
+}
+
+/*
+ * Collects responses of upgrade module
+ */
+PRIVATE bool collectResponse(BinFrameStatusCode status, BinFrame* response)
+{
+	TEST_ASSERT_EQUAL(BinFrame_Success, status);
+	TEST_ASSERT_EQUAL(BINFRAME_ACK_PAYLOAD_LENGTH, response->length);
+
+	if (responseCount < TEST_MAX_RESPONSE_COUNT)
+	{
+		responses[responseCount] = *response;
+		responseBitmaps[responseCount] = response->payload[0] | (response->payload[1] << 8) |
+										 (response->payload[2] << 16) | ((uint32_t)response->payload[3] << 24);
+		responseCount++;
+	}
+
+	return true;
+}
+
+/*
+ * Parses data which is sent by upgrade module
+ */
+PRIVATE void parseResponses(void)
+{
+	BinFrameContext context;
+	uint8_t payload[BINFRAME_ACK_PAYLOAD_LENGTH];
+
+	responseCount = 0;
+
+	BinFrame_InitContext(&context, payload, sizeof(payload));
+	BinFrame_Feed(&context, mockUARTSent, mockUARTSentLength, collectResponse);
+}
+
+/*
+ * Counts responses of a type
+ */
+PRIVATE uint32_t countResponses(uint32_t type)
+{
+	uint32_t index;
+	uint32_t count = 0;
+
+	for (index = 0; index < responseCount; index++)
+	{
+		count += (responses[index].type == type);
+	}
+
+	return count;
+}
+
+/*
+ * Checks whether flash includes expected image
+ */
+PRIVATE void checkFlashContent(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[FIRMWARE_START_ADDRESS];
+	uint8_t digest[32];
+
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], expectedImage, expectedImageLength) == 0);
+
+	/* Remaining part of last block is erased */
+	TEST_ASSERT_EQUAL_HEX8(0xFF, mockFlash[FIRMWARE_START_ADDRESS + expectedImageLength]);
+
+	/* Signature is verified once using digest of image area in flash */
+	mbedtls_sha256(&mockFlash[firmware->header.imageOffset], firmware->header.imageSize, digest, 0);
+
+	TEST_ASSERT_EQUAL(1, mockSecurityVerifyCount);
+	TEST_ASSERT_EQUAL_HEX32(firmware->header.signatureType, mockSecuritySignatureType);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(digest, mockSecurityHash, sizeof(digest));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(firmware->imageSignature, mockSecuritySignature, FIRMWARE_SIGNATURE_LENGTH);
+}
+
+/*
+ * Installs expected image into flash and returns its digest
+ */
+PRIVATE void installImage(uint8_t* imageHash)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+
+	memcpy(&mockFlash[FIRMWARE_START_ADDRESS], expectedImage, expectedImageLength);
+	mbedtls_sha256(&expectedImage[FIRMWARE_METADATA_LENGTH], firmware->header.imageSize, imageHash, 0);
+}
+
+/*
+ * Links expected image for a slot. Content depends on version and mock
+ * signature of image is its digest (see validateSlotImage).
+ */
+PRIVATE void buildSlotImage(uint32_t slotAddress, uint8_t version)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+	uint32_t index;
+
+	for (index = FIRMWARE_METADATA_LENGTH; index < TEST_SLOT_IMAGE_LENGTH; index++)
+	{
+		expectedImage[index] = (uint8_t)((index * 7) + version);
+	}
+
+	expectedImageLength = TEST_SLOT_IMAGE_LENGTH;
+	firmware->header.imageOffset = slotAddress + FIRMWARE_METADATA_LENGTH;
+	firmware->header.imageSize = expectedImageLength - FIRMWARE_METADATA_LENGTH;
+	firmware->sectorManifest.magic = 0;
+
+	mbedtls_sha256(&expectedImage[FIRMWARE_METADATA_LENGTH], firmware->header.imageSize, firmware->imageSignature, 0);
+}
+
+/*
+ * Installs an image which is linked for a slot into slot
+ */
+PRIVATE void installSlotImage(uint32_t slotAddress, uint8_t version)
+{
+	buildSlotImage(slotAddress, version);
+	memcpy(&mockFlash[slotAddress], expectedImage, expectedImageLength);
+}
+
+/*
+ * Appends expected image as binary frames of a slot to UART stream
+ */
+PRIVATE void appendSlotImageStream(uint32_t slotAddress)
+{
+	uint32_t offset;
+	uint32_t length;
+
+	for (offset = 0; offset < expectedImageLength; offset += length)
+	{
+		length = MATH_MIN(BINFRAME_MAX_PAYLOAD_LENGTH, expectedImageLength - offset);
+
+		appendFrame(BINFRAME_TYPE_DATA, slotAddress + offset, &expectedImage[offset], length);
+	}
+
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+}
+
+/*
+ * Validates image of a slot like bootloader, signature of image is its digest
+ */
+PRIVATE BLStatusCode validateSlotImage(uint32_t slotAddress, uint8_t* imageHash)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[slotAddress];
+
+	mbedtls_sha256(&mockFlash[firmware->header.imageOffset], firmware->header.imageSize, imageHash, 0);
+
+	return (memcmp(imageHash, firmware->imageSignature, 32) == 0) ? BL_Status_Success : BL_StatusSecurity_RSAVerFail;
+}
+
+/*
+ * Upgrades inactive slot with expected image and activates it like
+ * bootloader does. Power is cut at given flash operation (0 for none).
+ *
+ * @return true if new image is activated
+ */
+PRIVATE bool upgradeSlotWithPowerCut(uint32_t powerCutOperationNo)
+{
+	uint32_t slotAddress = BL_GetUpgradeSlotAddress();
+
+	mockUARTReset(BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
+	appendSlotImageStream(slotAddress);
+
+	mockFlashOperationCount = 0;
+	mockFlashPowerCutOperationNo = powerCutOperationNo;
+
+	return (BL_UpgradeFirmware() == BL_Status_Success) && (BL_ActivateSlot(slotAddress) == BL_Status_Success);
+}
+
+/*
+ * Sends data of host sender to bootloader
+ */
+PRIVATE void hostSend(void* arg, const uint8_t* data, uint32_t length)
+{
+	(void)arg;
+
+	mockUARTAppend(data, length);
+}
+
+/*
+ * Feeds responses of bootloader to host sender, which sends next frames
+ */
+PRIVATE void hostReceive(const uint8_t* data, uint32_t length)
+{
+	ImageSender_Feed(&sender, data, length);
+	ImageSender_Transmit(&sender);
+}
+
+/*
+ * Uploads expected image through host sender. Power is cut at given flash
+ * operation (0 for none). Statistics of sender are kept in senderStats.
+ */
+PRIVATE BLStatusCode upgradeWithSender(uint32_t powerCutOperationNo)
+{
+	BLStatusCode status;
+
+	mockUARTReset(BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
+	mockUARTSendHandler = hostReceive;
+	mockSecurityReset();
+
+	TEST_ASSERT_TRUE(ImageSender_Init(&sender, expectedImage, expectedImageLength, IMAGESENDER_DEFAULT_WINDOW_SIZE, hostSend, NULL));
+	ImageSender_Transmit(&sender);
+
+	mockFlashOperationCount = 0;
+	mockFlashPowerCutOperationNo = powerCutOperationNo;
+
+	status = BL_UpgradeFirmware();
+
+	senderStats = *ImageSender_GetStats(&sender);
+	ImageSender_Release(&sender);
+
+	return status;
+}
+
+/*
+ * Returns next pseudo random number (xorshift32)
+ */
+PRIVATE uint32_t nextRandom(uint32_t* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+
+	return *state;
+}
+
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	mockFlashReset();
+	mockUARTReset(BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
+	mockTimerReset();
+	mockSecurityReset();
+	mockCPUCoreReset();
+	BL_VerdictInit();
+
+	buildExpectedImage();
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+/*
+ * Tests upgrade using Intel HEX transport
+ */
+void test_Upgrade_IntelHexTransport(void)
+{
+	/* Noise before stream is skipped during transport detection */
+	mockUARTAppend("\r\n", 2);
+	appendIntelHexStream();
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(BL_UpgradeTransport_IntelHex, upgradeSettings.transport);
+
+	checkFlashContent();
+}
+
+/*
+ * Tests that an Intel HEX line with a CRC error fails upgrade
+ */
+void test_Upgrade_IntelHexCorruptedLine(void)
+{
+	char line[64];
+	uint32_t index;
+
+	for (index = 0; index < TEST_IMAGE_LINE_COUNT; index++)
+	{
+		strcpy(line, testImage[index]);
+
+		/* A data digit of a line in the middle of image is flipped */
+		if (index == (TEST_IMAGE_LINE_COUNT / 2))
+		{
+			line[9] = (line[9] == '0') ? '1' : '0';
+		}
+
+		mockUARTAppend(line, (uint32_t)strlen(line));
+		mockUARTAppend("\r\n", 2);
+	}
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_CorruptedData, BL_UpgradeFirmware());
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], expectedImage, expectedImageLength) != 0);
+}
+
+/*
+ * Tests upgrade using binary frames which fill flash write buffer
+ */
+void test_Upgrade_BinFrameTransport(void)
+{
+	uint32_t intelHexStreamLength;
+
+	appendIntelHexStream();
+	intelHexStreamLength = mockUARTStreamLength;
+
+	mockUARTReset(BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(BL_UpgradeTransport_BinFrame, upgradeSettings.transport);
+
+	checkFlashContent();
+
+	/* Binary stream must be less than half of Intel HEX stream */
+	TEST_ASSERT(mockUARTStreamLength * 2 < intelHexStreamLength);
+}
+
+/*
+ * Tests small frames which are split into small chunks
+ */
+void test_Upgrade_BinFrameSmallFramesAndChunks(void)
+{
+	mockUARTReset(7);
+	appendBinFrameStream(100, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	/* Only filled chunks of flash write buffer are written */
+	TEST_ASSERT_EQUAL((expectedImageLength + BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE - 1) / BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE, mockFlashWriteCount);
+}
+
+/*
+ * Tests that corrupted frames are discarded
+ */
+void test_Upgrade_BinFrameCorruptedFrameDiscarded(void)
+{
+	uint8_t garbage[16];
+
+	memset(garbage, 0x55, sizeof(garbage));
+
+	/* A corrupted frame with garbage data */
+	BinFrame_Encode(BINFRAME_TYPE_DATA, FIRMWARE_START_ADDRESS, garbage, sizeof(garbage), frame);
+	frame[BINFRAME_HEADER_LENGTH] ^= 0x01;
+	mockUARTAppend(frame, BINFRAME_FRAME_LENGTH(sizeof(garbage)));
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+}
+
+/*
+ * Tests data which targets bootloader area
+ */
+void test_Upgrade_InvalidAddress(void)
+{
+	uint8_t erased[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+	uint8_t data[4] = { 0x00, 0x01, 0x02, 0x03 };
+
+	/* Erased data (e.g. CRP word) is ignored */
+	appendFrame(BINFRAME_TYPE_DATA, 0x2FC, erased, sizeof(erased));
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, false);
+	appendFrame(BINFRAME_TYPE_DATA, 0x1000, data, sizeof(data));
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_InvalidAddress, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL_HEX8(0xFF, mockFlash[0x1000]);
+}
+
+/*
+ * Tests data of an already written block
+ */
+void test_Upgrade_OutOfOrderData(void)
+{
+	uint8_t data[16];
+
+	memset(data, 0x5A, sizeof(data));
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, false);
+	appendFrame(BINFRAME_TYPE_DATA, FIRMWARE_START_ADDRESS + BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE, data, sizeof(data));
+	appendFrame(BINFRAME_TYPE_DATA, FIRMWARE_START_ADDRESS + 0x10, data, sizeof(data));
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_OutOfOrderData, BL_UpgradeFirmware());
+
+	/* First block is queued before out of order data, rejected image is not written */
+	TEST_ASSERT_EQUAL(1, BL_GetUpgradeStats()->maxPendingBufferCount);
+	TEST_ASSERT_EQUAL(0, BL_GetUpgradeStats()->writtenBlockCount);
+}
+
+/*
+ * Tests an image without metadata
+ */
+void test_Upgrade_MissingMetaData(void)
+{
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_MissingMetaData, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(0, mockFlashWriteCount);
+}
+
+/*
+ * Tests a receive error of UART driver during upload
+ */
+void test_Upgrade_ReceiveFailure(void)
+{
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+	mockUARTErrorOffset = BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH;
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_ReceiveFailure, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(0, mockFlashWriteCount);
+}
+
+/*
+ * Tests a host which does not send an image
+ */
+void test_Upgrade_Timeout(void)
+{
+	mockTimerExpired = true;
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_Timeout, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(0, mockFlashWriteCount);
+}
+
+/*
+ * Tests sequenced frames which are received in order
+ */
+void test_Upgrade_SequencedFrames(void)
+{
+	uint32_t seqNo;
+
+	for (seqNo = 0; seqNo < TEST_SEQ_FRAME_COUNT; seqNo++)
+	{
+		appendSeqFrame(seqNo, false);
+	}
+
+	/* Duplicate and out of window frames are discarded */
+	appendSeqFrame(0, false);
+	appendSeqFrame(BL_UPGRADE_FRAMES_PER_BLOCK, false);
+
+	appendFrame(BINFRAME_TYPE_END, TEST_SEQ_FRAME_COUNT, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	parseResponses();
+
+	/* Each frame and duplicate is acknowledged, final ACKs confirm all frames */
+	TEST_ASSERT_EQUAL(0, countResponses(BINFRAME_TYPE_NAK));
+	TEST_ASSERT_EQUAL(TEST_SEQ_FRAME_COUNT + 1 + BL_UPGRADE_FINAL_ACK_REPEAT_COUNT, countResponses(BINFRAME_TYPE_ACK));
+	TEST_ASSERT_EQUAL_HEX32(0x03, responseBitmaps[1]);
+	TEST_ASSERT(responses[responseCount - 1].address >= TEST_SEQ_FRAME_COUNT);
+}
+
+/*
+ * Tests that only corrupted and missing frames are requested
+ */
+void test_Upgrade_SequencedFramesSelectiveRetransmit(void)
+{
+	uint32_t seqNo;
+
+	appendSeqFrame(0, false);
+	appendSeqFrame(1, true);
+
+	for (seqNo = 2; seqNo < TEST_SEQ_FRAME_COUNT - 1; seqNo++)
+	{
+		appendSeqFrame(seqNo, false);
+	}
+
+	/* Last frame is lost */
+	appendFrame(BINFRAME_TYPE_END, TEST_SEQ_FRAME_COUNT, NULL, 0);
+
+	/* Retransmissions */
+	appendSeqFrame(TEST_SEQ_FRAME_COUNT - 1, false);
+	appendSeqFrame(1, false);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	parseResponses();
+
+	/* ACK of first frame */
+	TEST_ASSERT_EQUAL(BINFRAME_TYPE_ACK, responses[0].type);
+	TEST_ASSERT_EQUAL_HEX32(0x01, responseBitmaps[0]);
+
+	/* NAK of corrupted frame */
+	TEST_ASSERT_EQUAL(BINFRAME_TYPE_NAK, responses[1].type);
+	TEST_ASSERT_EQUAL_HEX32(0x01, responseBitmaps[1]);
+
+	/* NAK of skipped frame */
+	TEST_ASSERT_EQUAL(BINFRAME_TYPE_NAK, responses[2].type);
+	TEST_ASSERT_EQUAL_HEX32(0x05, responseBitmaps[2]);
+
+	/* NAK of END since frames are missing */
+	TEST_ASSERT_EQUAL(BINFRAME_TYPE_NAK, responses[TEST_SEQ_FRAME_COUNT - 1].type);
+	TEST_ASSERT_EQUAL(0, responses[TEST_SEQ_FRAME_COUNT - 1].address);
+	TEST_ASSERT_EQUAL_HEX32((1UL << (TEST_SEQ_FRAME_COUNT - 1)) - 1 - 0x02, responseBitmaps[TEST_SEQ_FRAME_COUNT - 1]);
+
+	/* Skipped frame is requested only once */
+	TEST_ASSERT_EQUAL(3, countResponses(BINFRAME_TYPE_NAK));
+	TEST_ASSERT_EQUAL(BL_UPGRADE_FINAL_ACK_REPEAT_COUNT, countResponses(BINFRAME_TYPE_ACK) - (TEST_SEQ_FRAME_COUNT - 2));
+}
+
+/*
+ * Tests copies per upgraded byte. Received data is decoded from receive span
+ * of driver into flash write buffer directly, so binary payload is copied
+ * once and Intel HEX data is only decoded.
+ */
+void test_Upgrade_ZeroCopyReceive(void)
+{
+	uint32_t seqNo;
+	uint32_t copiedLength;
+
+	/* Intel HEX lines are decoded into flash write buffer */
+	appendIntelHexStream();
+	copiedByteCount = 0;
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+	checkFlashContent();
+	TEST_ASSERT_EQUAL(0, copiedByteCount);
+
+	/* Payload of data frames is copied into flash write buffer only */
+	mockFlashReset();
+	mockUARTReset(BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
+	mockSecurityReset();
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+	copiedByteCount = 0;
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+	checkFlashContent();
+	TEST_ASSERT_EQUAL(expectedImageLength, copiedByteCount);
+
+	/* Same for sequenced frames, payload of responses is also copied */
+	mockFlashReset();
+	mockUARTReset(BL_UPGRADE_MAX_RECEIVE_SPAN_LENGTH);
+	mockSecurityReset();
+	for (seqNo = 0; seqNo < TEST_SEQ_FRAME_COUNT; seqNo++)
+	{
+		appendSeqFrame(seqNo, false);
+	}
+	appendFrame(BINFRAME_TYPE_END, TEST_SEQ_FRAME_COUNT, NULL, 0);
+	copiedByteCount = 0;
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+	checkFlashContent();
+	copiedLength = copiedByteCount;
+
+	parseResponses();
+	TEST_ASSERT_EQUAL(expectedImageLength + (responseCount * BINFRAME_ACK_PAYLOAD_LENGTH), copiedLength);
+}
+
+/*
+ * Tests that blank image area is not erased
+ */
+void test_Upgrade_EraseSkipsBlankArea(void)
+{
+	const BLUpgradeStats* stats;
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(0, mockFlashEraseCount);
+	TEST_ASSERT_EQUAL(0, stats->eraseCallCount);
+	TEST_ASSERT_EQUAL(1, stats->skippedBlankBlockCount);
+	TEST_ASSERT_EQUAL(BL_UPGRADE_SECTOR_ERASE_TIME_IN_US, stats->savedEraseTimeInUs);
+}
+
+/*
+ * Tests that whole image area is erased up front using one command for each
+ * run of non-blank blocks
+ */
+void test_Upgrade_EraseImageArea(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+	const BLUpgradeStats* stats;
+	uint32_t firstBlockNo = (uint32_t)Drv_Flash_GetBlockNoOfAddress(FIRMWARE_START_ADDRESS);
+
+	/* Image area spans four blocks, second one is blank */
+	firmware->header.imageSize += 3 * MOCK_FLASH_32K_BLOCK_SIZE;
+
+	/* Previous firmware, image can be written only if it is erased */
+	memset(&mockFlash[FIRMWARE_START_ADDRESS], 0x00, expectedImageLength);
+	mockFlash[mockFlashBlockAddress(firstBlockNo + 2) + 100] = 0x00;
+	mockFlash[mockFlashBlockAddress(firstBlockNo + 4) - 1] = 0x00;
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+	TEST_ASSERT_EQUAL(FLASH_STATUS_SUCCESS, Drv_Flash_BlankCheckBlockRange(firstBlockNo + 1, firstBlockNo + 3));
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(2, mockFlashEraseCount);
+	TEST_ASSERT_EQUAL(2, stats->eraseCallCount);
+	TEST_ASSERT_EQUAL(3, stats->erasedBlockCount);
+	TEST_ASSERT_EQUAL(1, stats->skippedBlankBlockCount);
+}
+
+/*
+ * Simulates a differential upgrade where a single function is changed.
+ *	Sectors whose content matches sector manifest are neither erased nor
+ *	programmed, statistics report skipped sectors and saved time.
+ */
+void test_Upgrade_SkipUnchangedSectors(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+	const BLUpgradeStats* stats;
+	uint8_t digest[32];
+	uint32_t sectorNo;
+	uint32_t chunkCount = MOCK_FLASH_32K_BLOCK_SIZE / BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE;
+
+	/* Image area spans four sectors */
+	buildLargeImage(4 * MOCK_FLASH_32K_BLOCK_SIZE);
+	firmware->header.imageSize = expectedImageLength - FIRMWARE_METADATA_LENGTH;
+
+	firmware->sectorManifest.magic = FIRMWARE_SECTOR_MANIFEST_MAGIC;
+	firmware->sectorManifest.sectorCount = 4;
+	for (sectorNo = 0; sectorNo < 4; sectorNo++)
+	{
+		mbedtls_sha256(&expectedImage[sectorNo * MOCK_FLASH_32K_BLOCK_SIZE], MOCK_FLASH_32K_BLOCK_SIZE, digest, 0);
+		memcpy(firmware->sectorManifest.sectorHashes[sectorNo], digest, FIRMWARE_SECTOR_HASH_LENGTH);
+	}
+
+	/*
+	 * Slot B is active. Previous firmware of slot A differs in metadata and
+	 * in a function of third sector.
+	 */
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	memcpy(&mockFlash[FIRMWARE_START_ADDRESS], expectedImage, expectedImageLength);
+	memset(&mockFlash[FIRMWARE_START_ADDRESS + FIRMWARE_METADATA_LENGTH - 1], 0x00, 1);
+	memset(&mockFlash[FIRMWARE_START_ADDRESS + (2 * MOCK_FLASH_32K_BLOCK_SIZE) + 1000], 0x00, 48);
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(2, stats->unchangedBlockCount);
+	TEST_ASSERT_EQUAL(2, stats->eraseCallCount);
+	TEST_ASSERT_EQUAL(2, stats->erasedBlockCount);
+	TEST_ASSERT_EQUAL(0, stats->skippedBlankBlockCount);
+	/* Boot control record is written too */
+	TEST_ASSERT_EQUAL((2 * chunkCount) + 1, mockFlashWriteCount);
+	TEST_ASSERT_EQUAL(2 * BL_UPGRADE_SECTOR_ERASE_TIME_IN_US, stats->savedEraseTimeInUs);
+	TEST_ASSERT_EQUAL(2 * chunkCount * BL_UPGRADE_CHUNK_PROGRAM_TIME_IN_US, stats->savedWriteTimeInUs);
+}
+
+/*
+ * Tests that sectors are written if image has no sector manifest
+ */
+void test_Upgrade_NoSectorManifest(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+	const BLUpgradeStats* stats;
+
+	buildLargeImage(2 * MOCK_FLASH_32K_BLOCK_SIZE);
+	firmware->header.imageSize = expectedImageLength - FIRMWARE_METADATA_LENGTH;
+
+	/* Same firmware is upgraded again into inactive slot A */
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	memcpy(&mockFlash[FIRMWARE_START_ADDRESS], expectedImage, expectedImageLength);
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(0, stats->unchangedBlockCount);
+	TEST_ASSERT_EQUAL(2, stats->erasedBlockCount);
+	TEST_ASSERT_EQUAL(0, stats->savedWriteTimeInUs);
+}
+
+/*
+ * Tests that flash write buffers are written while next one is received
+ */
+void test_Upgrade_FlashWritePipeline(void)
+{
+	const BLUpgradeStats* stats;
+
+	buildLargeImage(4 * BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE);
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(4, stats->writtenBlockCount);
+	TEST_ASSERT_EQUAL(0, stats->bufferStallCount);
+	TEST_ASSERT_EQUAL(1, stats->maxPendingBufferCount);
+}
+
+/*
+ * Tests that parser waits for flash if all flash write buffers are filled
+ */
+void test_Upgrade_FlashWriteBufferStall(void)
+{
+	const BLUpgradeStats* stats;
+	uint32_t offset;
+
+	/* Sparse image, each small frame completes a flash write buffer */
+	memset(&expectedImage[FIRMWARE_METADATA_LENGTH], 0xFF, sizeof(expectedImage) - FIRMWARE_METADATA_LENGTH);
+
+	for (offset = BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE; offset < sizeof(expectedImage); offset += BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE)
+	{
+		memset(&expectedImage[offset], (uint8_t)offset, 16);
+		expectedImageLength = offset + 16;
+	}
+
+	appendFrame(BINFRAME_TYPE_DATA, FIRMWARE_START_ADDRESS, expectedImage, FIRMWARE_METADATA_LENGTH);
+
+	for (offset = BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE; offset < sizeof(expectedImage); offset += BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE)
+	{
+		appendFrame(BINFRAME_TYPE_DATA, FIRMWARE_START_ADDRESS + offset, &expectedImage[offset], 16);
+	}
+
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(sizeof(expectedImage) / BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE, stats->writtenBlockCount);
+	TEST_ASSERT(stats->bufferStallCount > 0);
+	TEST_ASSERT_EQUAL(BL_UPGRADE_FLASH_WRITE_BUFFER_COUNT, stats->maxPendingBufferCount);
+}
+
+/*
+ * Tests that a delta of an installed image without a boot control record is
+ * applied into slot B, so running image is not overwritten
+ */
+void test_Upgrade_DeltaWithoutBootControlRecord(void)
+{
+	const BLUpgradeStats* stats;
+
+	appendDeltaStream(FIRMWARE_SLOT_B_ADDRESS);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], expectedImage, expectedImageLength) == 0);
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], sourceImage, sourceImageLength) == 0);
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(deltaLength, stats->deltaLength);
+	TEST_ASSERT_EQUAL(0, stats->deltaBackupBlockCount);
+
+	/* Only changed parts and instructions are transferred */
+	TEST_ASSERT(deltaLength < (expectedImageLength / 50));
+}
+
+/*
+ * Tests that a delta of another image is rejected before flash is erased
+ */
+void test_Upgrade_DeltaSourceMismatch(void)
+{
+	appendDeltaStream(FIRMWARE_START_ADDRESS);
+	mockFlash[FIRMWARE_START_ADDRESS + 50000] ^= 0x01;
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_DeltaSourceMismatch, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(0, mockFlashEraseCount);
+	TEST_ASSERT_EQUAL(0, mockFlashWriteCount);
+}
+
+/*
+ * Tests upgrade using compressed frames, image is decompressed into flash
+ * write buffers
+ */
+void test_Upgrade_CompressedImage(void)
+{
+	const BLUpgradeStats* stats;
+
+	buildLargeImage(2 * BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE + 100);
+	appendCompressedStream(BINFRAME_MAX_PAYLOAD_LENGTH / 3);
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	checkFlashContent();
+
+	stats = BL_GetUpgradeStats();
+	TEST_ASSERT_EQUAL(deltaLength, stats->compressedLength);
+	TEST_ASSERT(deltaLength < expectedImageLength / 4);
+}
+
+/*
+ * Tests that an incomplete compressed image is not accepted
+ */
+void test_Upgrade_CompressedImageTruncated(void)
+{
+	buildLargeImage(2 * BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE + 100);
+	deltaLength = Compressor_Compress(expectedImage, expectedImageLength, COMPRESSOR_DEFAULT_WINDOW_BITS,
+									  COMPRESSOR_DEFAULT_LENGTH_BITS, delta, sizeof(delta));
+
+	appendFrame(BINFRAME_TYPE_COMPRESSED, 0, delta, deltaLength - 1);
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_InvalidCompressedData, BL_UpgradeFirmware());
+}
+
+/*
+ * Tests that image is hashed while it is written. Unchanged sectors are
+ * hashed from flash, signature is verified without a second image scan.
+ */
+void test_Upgrade_ImageHashedDuringUpload(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)expectedImage;
+	uint8_t digest[32];
+
+	buildLargeImage(3 * MOCK_FLASH_32K_BLOCK_SIZE + 100);
+	firmware->header.imageSize = expectedImageLength - FIRMWARE_METADATA_LENGTH;
+
+	/* Second sector is already installed */
+	firmware->sectorManifest.magic = FIRMWARE_SECTOR_MANIFEST_MAGIC;
+	firmware->sectorManifest.sectorCount = 2;
+	mbedtls_sha256(&expectedImage[MOCK_FLASH_32K_BLOCK_SIZE], MOCK_FLASH_32K_BLOCK_SIZE, digest, 0);
+	memcpy(firmware->sectorManifest.sectorHashes[1], digest, FIRMWARE_SECTOR_HASH_LENGTH);
+	memcpy(&mockFlash[FIRMWARE_START_ADDRESS + MOCK_FLASH_32K_BLOCK_SIZE], &expectedImage[MOCK_FLASH_32K_BLOCK_SIZE], MOCK_FLASH_32K_BLOCK_SIZE);
+
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(1, BL_GetUpgradeStats()->unchangedBlockCount);
+
+	checkFlashContent();
+
+	mbedtls_sha256(&expectedImage[FIRMWARE_METADATA_LENGTH], firmware->header.imageSize, digest, 0);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(digest, mockSecurityHash, sizeof(digest));
+}
+
+/*
+ * Tests that an image with an invalid signature is not accepted
+ */
+void test_Upgrade_InvalidSignature(void)
+{
+	mockSecurityVerifyStatus = (BLStatusCode)BL_StatusSecurity_RSAVerFail;
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_StatusSecurity_RSAVerFail, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(1, mockSecurityVerifyCount);
+}
+
+/*
+ * Tests that a chunk which is not programmed correctly is detected by
+ * read-back before image is accepted
+ */
+void test_Upgrade_FlashVerifyFailure(void)
+{
+	buildLargeImage(2 * BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE);
+	mockFlashFaultAddress = FIRMWARE_START_ADDRESS + BL_UPGRADE_FLASH_WRITE_BUFFER_SIZE + 1000;
+	appendBinFrameStream(BINFRAME_MAX_PAYLOAD_LENGTH, true);
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_FlashVerifyFailure, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(0, mockSecurityVerifyCount);
+}
+
+/*
+ * Tests that a stored verdict is used on next boots of same image
+ */
+void test_Verdict_CachedImage(void)
+{
+	uint8_t imageHash[32];
+
+	installImage(imageHash);
+
+	/* No record before first verification */
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+
+	/* Verifying same image again does not wear flash */
+	mockFlashWriteCount = 0;
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+	TEST_ASSERT_EQUAL(0, mockFlashWriteCount);
+}
+
+/*
+ * Tests that record does not match an image with different metadata or an
+ * image in another slot
+ */
+void test_Verdict_ChangedImage(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[FIRMWARE_START_ADDRESS];
+	uint8_t imageHash[32];
+
+	installImage(imageHash);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+
+	/* Another signature */
+	firmware->imageSignature[0] ^= 0x01;
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+	firmware->imageSignature[0] ^= 0x01;
+
+	/* Another size */
+	firmware->header.imageSize++;
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+	firmware->header.imageSize--;
+
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+
+	/* Same image in another slot */
+	memcpy(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], firmware, expectedImageLength);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+}
+
+/*
+ * Tests that a modified or copied record is rejected
+ */
+void test_Verdict_ForgedRecord(void)
+{
+	BLVerdictRecord* record = (BLVerdictRecord*)&mockFlash[getSlotAddress(0)];
+	uint8_t imageHash[32];
+
+	installImage(imageHash);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+
+	/* Record of another image (MAC is not updated) */
+	record->imageHash[5] ^= 0x80;
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+	record->imageHash[5] ^= 0x80;
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+
+	/* Record which is copied from another device */
+	mockFlashSerialNumber[3]++;
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+	mockFlashSerialNumber[3]--;
+}
+
+/*
+ * Tests that policy forces full verification after a watchdog reset and
+ * periodically
+ */
+void test_Verdict_ReverificationPolicy(void)
+{
+	uint8_t imageHash[32];
+	uint32_t bootNo;
+	uint32_t fullVerificationCount = 0;
+	bool cached;
+
+	installImage(imageHash);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+
+	mockCPUCoreWatchdogReset = true;
+	mockCPUCoreBootCount = 0;
+	BL_VerdictInit();
+	cached = BL_IsImageVerdictCached();
+	TEST_ASSERT_EQUAL(BL_VERDICT_REVERIFY_ON_WATCHDOG_RESET == 0, cached);
+
+	/* Retries of boot loop keep policy of boot and do not count boots */
+	TEST_ASSERT_EQUAL(cached, BL_IsImageVerdictCached());
+	TEST_ASSERT_EQUAL(1, mockCPUCoreBootCount);
+
+	/* Reset source is cleared, next boot uses record */
+	BL_VerdictInit();
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+
+	mockCPUCoreBootCount = 0;
+	for (bootNo = 0; bootNo < 10; bootNo++)
+	{
+		BL_VerdictInit();
+		fullVerificationCount += !BL_IsImageVerdictCached();
+	}
+
+	TEST_ASSERT_EQUAL((BL_VERDICT_REVERIFY_BOOT_INTERVAL > 0) ? (10 / MATH_MAX(BL_VERDICT_REVERIFY_BOOT_INTERVAL, 1)) : 0,
+					  fullVerificationCount);
+}
+
+/*
+ * Tests that record sector is erased only when all slots are used and
+ * counter keeps increasing
+ */
+void test_Verdict_SectorRollover(void)
+{
+	FirmwareInfo* firmware = (FirmwareInfo*)&mockFlash[FIRMWARE_START_ADDRESS];
+	BLVerdictRecord record;
+	uint8_t imageHash[32];
+	uint32_t freeSlotNo;
+	uint32_t index;
+
+	installImage(imageHash);
+
+	/* Each record is stored for another image */
+	for (index = 0; index < getSlotCount(); index++)
+	{
+		firmware->imageSignature[0] = (uint8_t)index;
+		TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+	}
+
+	TEST_ASSERT_EQUAL(0, mockFlashEraseCount);
+	TEST_ASSERT_TRUE(readLatestRecord(&record, &freeSlotNo));
+	TEST_ASSERT_EQUAL(getSlotCount(), freeSlotNo);
+
+	firmware->imageSignature[0] = 0xA5;
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+	TEST_ASSERT_EQUAL(1, mockFlashEraseCount);
+
+	TEST_ASSERT_TRUE(readLatestRecord(&record, &freeSlotNo));
+	TEST_ASSERT_EQUAL(1, freeSlotNo);
+	TEST_ASSERT_EQUAL(getSlotCount(), record.counter);
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+}
+
+/*
+ * Tests that a record which is not programmed correctly is detected
+ */
+void test_Verdict_FlashFailure(void)
+{
+	uint8_t imageHash[32];
+
+	installImage(imageHash);
+	mockFlashFaultAddress = getSlotAddress(0) + 40;
+
+	TEST_ASSERT_EQUAL(BL_StatusVerdict_FlashFailure, BL_StoreImageVerdict(imageHash));
+}
+
+/*
+ * Tests that an interrupted re-upload of verified image invalidates its
+ * verdict, so next boot of its slot verifies image again
+ */
+void test_Verdict_InterruptedUpgradeReverified(void)
+{
+	uint8_t imageHash[32];
+	uint32_t operationCount;
+
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_START_ADDRESS));
+	TEST_ASSERT_EQUAL(BL_Status_Success, validateSlotImage(FIRMWARE_START_ADDRESS, imageHash));
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_StoreImageVerdict(imageHash));
+	TEST_ASSERT_TRUE(BL_IsImageVerdictCached());
+
+	/* Slot A is inactive, so same image is uploaded into it again */
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	memcpy(flashSnapshot, mockFlash, sizeof(flashSnapshot));
+
+	TEST_ASSERT_TRUE(upgradeSlotWithPowerCut(0));
+	operationCount = mockFlashOperationCount;
+	memcpy(mockFlash, flashSnapshot, sizeof(mockFlash));
+
+	/* Power is cut after metadata is written, rest of image is erased */
+	TEST_ASSERT_FALSE(upgradeSlotWithPowerCut(operationCount / 2));
+	mockFlashRestorePower();
+	TEST_ASSERT_EQUAL(BL_StatusSecurity_RSAVerFail, validateSlotImage(FIRMWARE_START_ADDRESS, imageHash));
+
+	/* Boot rolls back to slot A */
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_START_ADDRESS));
+	BL_VerdictInit();
+	TEST_ASSERT_FALSE(BL_IsImageVerdictCached());
+}
+
+/*
+ * Tests that first upgrade of an empty device and of a device which has an
+ * image without a boot control record never overwrites a runnable image
+ */
+void test_Slot_FirstUpgradeWithoutBootControlRecord(void)
+{
+	/* Nothing runs on an empty device, slot A is upgraded */
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetUpgradeSlotAddress());
+
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+	memcpy(sourceImage, expectedImage, expectedImageLength);
+	sourceImageLength = expectedImageLength;
+
+	/* Programmed image runs from slot A, slot B is upgraded */
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetActiveSlotAddress());
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, BL_GetUpgradeSlotAddress());
+
+	buildSlotImage(FIRMWARE_SLOT_B_ADDRESS, 2);
+	appendSlotImageStream(FIRMWARE_SLOT_B_ADDRESS);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], expectedImage, expectedImageLength) == 0);
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], sourceImage, sourceImageLength) == 0);
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetActiveSlotAddress());
+}
+
+/*
+ * Tests that an image which is programmed without a boot control record
+ * boots from slot A and its slot is recorded once
+ */
+void test_Slot_FirstBootStoresRecord(void)
+{
+	uint8_t imageHash[32];
+	uint32_t slotAddress;
+
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetActiveSlotAddress());
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, BL_GetUpgradeSlotAddress());
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, slotAddress);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(((FirmwareInfo*)expectedImage)->imageSignature, imageHash, sizeof(imageHash));
+	TEST_ASSERT_EQUAL(1, mockFlashWriteCount);
+
+	/* Installed image is kept by next upgrade */
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, BL_GetUpgradeSlotAddress());
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+	TEST_ASSERT_EQUAL(1, mockFlashWriteCount);
+	TEST_ASSERT_EQUAL(0, mockFlashEraseCount);
+}
+
+/*
+ * Tests that upgrade writes inactive slot and a single write switches slots
+ */
+void test_Slot_UpgradeInactiveSlot(void)
+{
+	uint8_t imageHash[32];
+	uint32_t slotAddress;
+	uint32_t writeCount;
+
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_START_ADDRESS));
+	memcpy(sourceImage, expectedImage, expectedImageLength);
+	sourceImageLength = expectedImageLength;
+
+	buildSlotImage(FIRMWARE_SLOT_B_ADDRESS, 2);
+	appendSlotImageStream(FIRMWARE_SLOT_B_ADDRESS);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], expectedImage, expectedImageLength) == 0);
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], sourceImage, sourceImageLength) == 0);
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetActiveSlotAddress());
+
+	writeCount = mockFlashWriteCount;
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	TEST_ASSERT_EQUAL(writeCount + 1, mockFlashWriteCount);
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, BL_GetActiveSlotAddress());
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetUpgradeSlotAddress());
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, slotAddress);
+}
+
+/*
+ * Tests that an image which is linked for active slot is rejected before
+ * anything is erased
+ */
+void test_Slot_ImageOfActiveSlotRejected(void)
+{
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_START_ADDRESS));
+
+	/* Image is sent to inactive slot */
+	buildSlotImage(FIRMWARE_START_ADDRESS, 2);
+	appendSlotImageStream(FIRMWARE_SLOT_B_ADDRESS);
+
+	TEST_ASSERT_EQUAL(BL_StatusUpgrade_InCompatibleFWOffset, BL_UpgradeFirmware());
+	TEST_ASSERT_EQUAL(0, mockFlashEraseCount);
+	TEST_ASSERT_EQUAL(1, mockFlashWriteCount);
+}
+
+/*
+ * Tests that image of other slot boots and becomes active if image of
+ * active slot is not valid
+ */
+void test_Slot_Rollback(void)
+{
+	uint8_t imageHash[32];
+	uint32_t slotAddress;
+
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+	installSlotImage(FIRMWARE_SLOT_B_ADDRESS, 2);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+
+	mockFlash[FIRMWARE_SLOT_B_ADDRESS + 20000] ^= 0x01;
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, slotAddress);
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetActiveSlotAddress());
+
+	/* Erased metadata is not hashed */
+	memset(&mockFlash[FIRMWARE_START_ADDRESS], 0xFF, FIRMWARE_METADATA_LENGTH);
+
+	TEST_ASSERT_EQUAL(BL_StatusSecurity_RSAVerFail, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+
+	memset(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], 0xFF, FIRMWARE_METADATA_LENGTH);
+
+	TEST_ASSERT_EQUAL(BL_StatusSlot_InvalidMetaData, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+	TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, BL_GetActiveSlotAddress());
+}
+
+/*
+ * Tests that a delta is applied from active slot into inactive slot without
+ * backing up source blocks
+ */
+void test_Slot_DeltaFromActiveSlot(void)
+{
+	appendDeltaStream(FIRMWARE_SLOT_B_ADDRESS);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_START_ADDRESS));
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_UpgradeFirmware());
+
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], expectedImage, expectedImageLength) == 0);
+	TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], sourceImage, sourceImageLength) == 0);
+	TEST_ASSERT_EQUAL(0, BL_GetUpgradeStats()->deltaBackupBlockCount);
+}
+
+/*
+ * Tests that boot control sectors are used in turn and counter keeps
+ * increasing
+ */
+void test_Slot_RecordSectorRollover(void)
+{
+	BLBootControlRecord record;
+	uint32_t slotAddress;
+	uint32_t sectorNo;
+	uint32_t entryNo;
+	uint32_t index;
+
+	for (index = 0; index <= 2 * getEntryCount(); index++)
+	{
+		slotAddress = ((index % 2) == 0) ? FIRMWARE_START_ADDRESS : FIRMWARE_SLOT_B_ADDRESS;
+
+		TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(slotAddress));
+		TEST_ASSERT_EQUAL_HEX32(slotAddress, BL_GetActiveSlotAddress());
+	}
+
+	/* Second sector is blank when first one is full */
+	TEST_ASSERT_EQUAL(1, mockFlashEraseCount);
+
+	TEST_ASSERT_TRUE(readLatestBootControlRecord(&record, &sectorNo, &entryNo));
+	TEST_ASSERT_EQUAL(2 * getEntryCount(), record.counter);
+	TEST_ASSERT_EQUAL(0, sectorNo);
+	TEST_ASSERT_EQUAL(1, entryNo);
+}
+
+/*
+ * Tests slot switches with a power cut at each of their flash operations,
+ * including erases of boot control sectors
+ */
+void test_Slot_RecordPowerCutMatrix(void)
+{
+	uint32_t newSlotAddress;
+	uint32_t oldSlotAddress;
+	uint32_t cutNo;
+	uint32_t index;
+	bool activated;
+
+	for (index = 0; index <= (2 * getEntryCount()) + 1; index++)
+	{
+		newSlotAddress = ((index % 2) == 0) ? FIRMWARE_START_ADDRESS : FIRMWARE_SLOT_B_ADDRESS;
+		oldSlotAddress = ((index % 2) == 0) ? FIRMWARE_SLOT_B_ADDRESS : FIRMWARE_START_ADDRESS;
+
+		/* Slot A is active before first record */
+		if (index == 0)
+		{
+			oldSlotAddress = FIRMWARE_START_ADDRESS;
+		}
+
+		memcpy(flashSnapshot, mockFlash, sizeof(flashSnapshot));
+
+		/* A switch takes an erase and a write at most */
+		for (cutNo = 1; cutNo <= 3; cutNo++)
+		{
+			memcpy(mockFlash, flashSnapshot, sizeof(mockFlash));
+
+			mockFlashOperationCount = 0;
+			mockFlashPowerCutOperationNo = cutNo;
+
+			activated = (BL_ActivateSlot(newSlotAddress) == BL_Status_Success);
+
+			/* Reboot, new slot is active only if its record is completed */
+			mockFlashRestorePower();
+
+			TEST_ASSERT_EQUAL_HEX32(activated ? newSlotAddress : oldSlotAddress, BL_GetActiveSlotAddress());
+
+			if (activated)
+			{
+				break;
+			}
+
+			/* Switch is repeated */
+			TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(newSlotAddress));
+			TEST_ASSERT_EQUAL_HEX32(newSlotAddress, BL_GetActiveSlotAddress());
+		}
+
+		TEST_ASSERT_TRUE(activated);
+	}
+}
+
+/*
+ * Tests upgrade of inactive slot with a power cut at each flash operation.
+ *	After reboot, old image boots until new one is activated and an
+ *	interrupted upgrade is completed by next upgrade.
+ */
+void test_Slot_UpgradePowerCutMatrix(void)
+{
+	uint8_t imageHash[32];
+	uint32_t slotAddress;
+	uint32_t operationCount;
+	uint32_t cutNo;
+	bool activated;
+
+	/* Inactive slot keeps an older image, so it is erased by upgrade */
+	installSlotImage(FIRMWARE_SLOT_B_ADDRESS, 0);
+	installSlotImage(FIRMWARE_START_ADDRESS, 1);
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_START_ADDRESS));
+
+	memcpy(sourceImage, expectedImage, expectedImageLength);
+	sourceImageLength = expectedImageLength;
+	memcpy(flashSnapshot, mockFlash, sizeof(flashSnapshot));
+
+	buildSlotImage(FIRMWARE_SLOT_B_ADDRESS, 2);
+
+	TEST_ASSERT_TRUE(upgradeSlotWithPowerCut(0));
+	operationCount = mockFlashOperationCount;
+	TEST_ASSERT(operationCount > (expectedImageLength / BL_UPGRADE_FLASH_WRITE_CHUNK_SIZE));
+
+	for (cutNo = 1; cutNo <= operationCount + 1; cutNo++)
+	{
+		memcpy(mockFlash, flashSnapshot, sizeof(mockFlash));
+
+		activated = upgradeSlotWithPowerCut(cutNo);
+
+		/* Reboot */
+		mockFlashRestorePower();
+
+		TEST_ASSERT_EQUAL(cutNo > operationCount, activated);
+		TEST_ASSERT_EQUAL(BL_Status_Success, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+
+		if (activated)
+		{
+			TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, slotAddress);
+			break;
+		}
+
+		/* Active image is not changed */
+		TEST_ASSERT_EQUAL_HEX32(FIRMWARE_START_ADDRESS, slotAddress);
+		TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_START_ADDRESS], sourceImage, sourceImageLength) == 0);
+
+		TEST_ASSERT_TRUE(upgradeSlotWithPowerCut(0));
+		TEST_ASSERT_EQUAL(BL_Status_Success, BL_SelectBootSlot(validateSlotImage, &slotAddress, imageHash));
+		TEST_ASSERT_EQUAL_HEX32(FIRMWARE_SLOT_B_ADDRESS, slotAddress);
+		TEST_ASSERT(memcmp(&mockFlash[FIRMWARE_SLOT_B_ADDRESS], expectedImage, expectedImageLength) == 0);
+	}
+
+	TEST_ASSERT_EQUAL(operationCount + 1, cutNo);
+}
+
+/*
+ * Tests that an upload which is interrupted by a power cut is resumed after
+ * its last written block. Image is completed with same digest and blocks
+ * before checkpoint are not sent again.
+ */
+void test_Journal_ResumeAfterPowerCut(void)
+{
+	uint32_t randomState = 0x2F6B3C1D;
+	uint32_t operationCount;
+	uint32_t resumedUploadCount = 0;
+	uint32_t cutIndex;
+	uint32_t cutNo;
+	BLStatusCode status;
+
+	/* Slot A is inactive, so all uploads target it */
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	buildSlotImage(FIRMWARE_START_ADDRESS, 1);
+	memcpy(flashSnapshot, mockFlash, sizeof(flashSnapshot));
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, upgradeWithSender(0));
+	TEST_ASSERT_EQUAL(0, BL_GetUpgradeStats()->resumedLength);
+	operationCount = mockFlashOperationCount;
+
+	for (cutIndex = 0; cutIndex < TEST_RESUME_POWER_CUT_COUNT; cutIndex++)
+	{
+		cutNo = (nextRandom(&randomState) % operationCount) + 1;
+
+		memcpy(mockFlash, flashSnapshot, sizeof(mockFlash));
+
+		status = upgradeWithSender(cutNo);
+		TEST_ASSERT_NOT_EQUAL(BL_Status_Success, status);
+
+		/* Reboot */
+		mockFlashRestorePower();
+
+		TEST_ASSERT_EQUAL(BL_Status_Success, upgradeWithSender(0));
+		checkFlashContent();
+
+		/* Only first block and frames in flight are sent before checkpoint */
+		TEST_ASSERT(senderStats.sentFrameCount <= senderStats.frameCount -
+					(BL_GetUpgradeStats()->resumedLength / BINFRAME_SEQ_PAYLOAD_LENGTH) +
+					(2 * IMAGESENDER_DEFAULT_WINDOW_SIZE));
+
+		resumedUploadCount += (BL_GetUpgradeStats()->resumedLength > 0);
+	}
+
+	TEST_ASSERT(resumedUploadCount > 0);
+
+	/* Completed upload is not resumed again */
+	TEST_ASSERT_EQUAL(BL_Status_Success, upgradeWithSender(0));
+	TEST_ASSERT_EQUAL(0, BL_GetUpgradeStats()->resumedLength);
+	checkFlashContent();
+}
+
+/*
+ * Tests that checkpoints of an interrupted upload are not used by upload of
+ * another image
+ */
+void test_Journal_OtherImageNotResumed(void)
+{
+	uint32_t operationCount;
+
+	/* Slot A is inactive, so all uploads target it */
+	TEST_ASSERT_EQUAL(BL_Status_Success, BL_ActivateSlot(FIRMWARE_SLOT_B_ADDRESS));
+	buildSlotImage(FIRMWARE_START_ADDRESS, 1);
+	memcpy(flashSnapshot, mockFlash, sizeof(flashSnapshot));
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, upgradeWithSender(0));
+	operationCount = mockFlashOperationCount;
+
+	memcpy(mockFlash, flashSnapshot, sizeof(mockFlash));
+	TEST_ASSERT_NOT_EQUAL(BL_Status_Success, upgradeWithSender(operationCount - 2));
+	mockFlashRestorePower();
+
+	buildSlotImage(FIRMWARE_START_ADDRESS, 2);
+
+	TEST_ASSERT_EQUAL(BL_Status_Success, upgradeWithSender(0));
+	TEST_ASSERT_EQUAL(0, BL_GetUpgradeStats()->resumedLength);
+	TEST_ASSERT(senderStats.sentFrameCount >= senderStats.frameCount);
+	checkFlashContent();
+}
@@ -0,0 +1,52 @@
+################################################################################
+#
+# @file module.mk
+#
+# @author MC
+#
+# @brief Bootloader module make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+#
+# Get all source files (.c files) using 'find' command except test folders
+#
+BOOTLOADER_SRC_FILES := $(shell /usr/bin/find $(ROOT_PATH)/Bootloader -mindepth 1 -maxdepth 1 -name "*.c")
+
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Bootloader \
+	-I$(ROOT_PATH)/Bootloader/TestData \
+	-I$(ROOT_PATH)/Projects/Bootloader/config \
+	-I$(ROOT_PATH)/Projects/Bootloader/config/mbedtls
+
+#
+# Libraries which are used by upgrade transports and security
+#
+include $(ROOT_PATH)/Environment/Lib/IntelHex/module.mk
+include $(ROOT_PATH)/Environment/Lib/BinFrame/module.mk
+include $(ROOT_PATH)/Environment/Lib/Delta/module.mk
+include $(ROOT_PATH)/Environment/Lib/LZSS/module.mk
+include $(ROOT_PATH)/Environment/Lib/P256/module.mk
+include $(ROOT_PATH)/Environment/Lib/RSA2048/module.mk
+include $(ROOT_PATH)/Environment/Lib/Arena/module.mk
+include $(ROOT_PATH)/Environment/ExternalLib/mbedTLS/module.mk
+
+BOOTLOADER_SRC_FILES += \
+	$(INTELHEX_SRC_FILES) \
+	$(BINFRAME_SRC_FILES) \
+	$(DELTA_SRC_FILES) \
+	$(LZSS_SRC_FILES) \
+	$(P256_SRC_FILES) \
+	$(RSA2048_SRC_FILES) \
+	$(ARENA_SRC_FILES) \
+	$(MBEDTLS_SRC_FILES)
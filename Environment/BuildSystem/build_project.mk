@@ -79,22 +79,29 @@ PROJECT_OUT_PATH = $(ROOT_PATH)/out/Projects/$(PROJECT)
 PROJECT_OBJS_OUT_PATH= $(PROJECT_OUT_PATH)/obj
 
 
-# Get all Kernel Source files except Unit Test files
+# Get all Kernel Source files except Unit Test files (Kernel is optional)
+ifneq ($(wildcard $(KERNEL_PATH)),)
 KERNEL_SRC_FILES := $(shell /usr/bin/find $(KERNEL_PATH) -mindepth 1 -maxdepth 6 -name "*.c" ! -path "*UnitTest*")
-# Get all Project (Application) Source files except Unit Test files
-PROJECT_SRC_FILES := $(shell /usr/bin/find $(PROJECT_PATH) -mindepth 1 -maxdepth 6 -name "*.c" ! -path "*PSoCCreator*")
+endif
+# Get all Project (Application) Source files except Unit Test files and IDE projects
+PROJECT_SRC_FILES := $(shell /usr/bin/find $(PROJECT_PATH) -mindepth 1 -maxdepth 6 -name "*.c" ! -path "*PSoCCreator*" ! -path "*/VS/*" ! -path "*/uVision/*")
 
 # Include CPU, Board and Kernel makefiles to get specific rules
+#	Host (simulation) environments do not have a Board
 include $(CPU_PATH)/module.mk
+ifdef BOARD
 include $(BOARD_PATH)/module.mk
-include $(KERNEL_PATH)/Kernel.mk
+endif
+-include $(KERNEL_PATH)/Kernel.mk
 
 # Collect all source files
+#	Modules which are used by project are listed in project.mk (PROJECT_MODULE_SRC_FILES)
 SRC_FILES = \
 	$(KERNEL_SRC_FILES) \
 	$(CPU_SRC_FILES) \
 	$(BOARD_SRC_FILES) \
-	$(PROJECT_SRC_FILES)
+	$(PROJECT_SRC_FILES) \
+	$(PROJECT_MODULE_SRC_FILES)
 
 # Collect all Inclıde Files
 INCLUDE_PATHS = \
@@ -111,6 +118,9 @@ INCLUDE_PATHS = \
 # Target File name including all path
 BUILD_TARGET = $(PROJECT_OUT_PATH)/$(PROJECT)
 
+# Output of project. Host environments run .elf file itself
+PROJECT_TARGET_EXTENSION ?= .bin
+
 # Building depends on object (.o) files so let's get object versions of source files
 PROJECT_OBJECTS := $(SRC_FILES) # Get all source files
 PROJECT_OBJECTS := $(PROJECT_OBJECTS:.c=.o) # Convert .c extensions to .o
@@ -133,9 +143,9 @@ LD_SYS_LIBS = $(SYS_LIBRARIES)
 #
 #	Dependent to
 #  - Out folder creation
-#  - Project HEX (.bin) file creation
+#  - Project HEX (.bin) file creation (or executable of host environments)
 #
-default: createoutdir $(BUILD_TARGET).bin
+default: createoutdir $(BUILD_TARGET)$(PROJECT_TARGET_EXTENSION)
 	@echo "\nProject '$(PROJECT)' Compiled...\n"
 
 #
@@ -165,7 +175,7 @@ default: createoutdir $(BUILD_TARGET).bin
 #	- System Objects
 #
 $(BUILD_TARGET).elf: $(PROJECT_OBJECTS) $(SYS_OBJECTS)
-	$(LD) $(LD_FLAGS) -T$(LINKER_SCRIPT) $(LIBRARY_PATHS) -o $@ $^ $(PROJECT_LIBRARIES) $(SYS_LIBRARIES) $(PROJECT_LIBRARIES) $(SYS_LIBRARIES)
+	$(LD) $(LD_FLAGS) $(if $(LINKER_SCRIPT),-T$(LINKER_SCRIPT)) $(LIBRARY_PATHS) -o $@ $^ $(PROJECT_LIBRARIES) $(SYS_LIBRARIES) $(PROJECT_LIBRARIES) $(SYS_LIBRARIES)
 
 # TODO FIX it. Hacky code. Normally, we need to create object files under out dir but I (Murat Çakmak) could not.
 # As a temprory solution, create object file under source fine directories and when finished building, collect(move) them under out folder
@@ -0,0 +1,110 @@
+################################################################################
+#
+# @file build_tool.mk
+#
+# @author MC
+#
+# @brief Makefile to build a host tool
+#			> Builds a host side tool using libraries of code base
+#			> Runs tool if TOOL_ARGS is provided
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+################################################################################
+#                    		DEFINITIONS & INCLUDES                             #
+################################################################################
+
+# Path of Root
+ROOT_PATH = .
+
+#
+# Get Environment Info for Host Tool Build
+#
+ENV ?= x86
+ENV_MAKE_FILE = Environment/Target/$(ENV)/environment.mk
+ifeq ($(wildcard $(ENV_MAKE_FILE)),)
+$(error Invalid Environment : $(ENV))
+endif
+
+# include environment
+include $(ENV_MAKE_FILE)
+
+#
+# Include Specified Tool
+#
+include $(TOOL)/tool.mk
+
+# Path of out files
+TOOL_OUT_PATH = $(ROOT_PATH)/out/Tools/$(TOOL_TARGET_NAME)
+
+#
+# Tool source file
+#	IMP : Main source file must be named as <TARGET>.c
+#
+TOOL_FILE = $(TOOL)/$(TOOL_TARGET_NAME).c
+
+#
+# Tool output (executable) file
+#
+TARGET = $(TOOL_OUT_PATH)/$(TOOL_TARGET_NAME)$(UNITTEST_TARGET_EXTENSION)
+
+#
+# Include Directories
+#
+INC_DIRS = \
+	-I$(ROOT_PATH)/Include \
+	-I$(ROOT_PATH)/Include/BSP \
+	-I$(ROOT_PATH)/Environment/Tools/Debug \
+	-I$(TOOL) \
+	$(MODULE_INC_PATHS)
+
+#
+# CFLAGS
+#	- Environment specific host tool flags (TOOL_CFLAGS)
+#
+CFLAGS += \
+	$(TOOL_CFLAGS)
+
+#
+# Compiler Symbols
+#
+SYMBOLS += \
+	-DHOST_TOOL
+
+################################################################################
+#                    		     RULES                                   	   #
+################################################################################
+
+#
+# Default Rule
+#	- Builds tool and runs it if arguments are provided
+#
+default: \
+	build_tool \
+	run_tool
+
+#
+# Rule to build tool
+#
+build_tool:
+	mkdir -p $(TOOL_OUT_PATH)
+
+	$(CC) $(CFLAGS) $(INC_DIRS) $(SYMBOLS) $(TOOL_FILE) $(TOOL_SRC_FILES) -o $(TARGET) $(TOOL_LIBS)
+
+#
+# Rule to run tool
+#
+run_tool: build_tool
+ifneq ($(TOOL_ARGS),)
+	./$(TARGET) $(TOOL_ARGS)
+endif
@@ -0,0 +1,116 @@
+################################################################################
+#
+# @file execute_benchmark.mk
+#
+# @author MC
+#
+# @brief Makefile to build and run a benchmark on host (x86)
+#			> Builds benchmark application with optimizations
+#			> Runs benchmark and prints results
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+################################################################################
+#                    		DEFINITIONS & INCLUDES                             #
+################################################################################
+
+# Path of Root
+ROOT_PATH = .
+
+#
+# Get Environment Info for Benchmark Build
+#
+ENV ?= x86
+ENV_MAKE_FILE = Environment/Target/$(ENV)/environment.mk
+ifeq ($(wildcard $(ENV_MAKE_FILE)),)
+$(error Invalid Environment : $(ENV))
+endif
+
+# include environment
+include $(ENV_MAKE_FILE)
+
+include $(BENCH_MODULE)/module.mk
+#
+# Include Specified Benchmark
+#
+BENCH_DIR = $(BENCH_MODULE)/Benchmark
+include $(BENCH_DIR)/benchmark.mk
+
+# Path of out files
+BENCH_OUT_PATH = $(ROOT_PATH)/out/Benchmark/$(BENCH_TARGET_NAME)
+
+#
+# Benchmark file name
+#	IMP : Benchmark file must be name as benchmark_<TARGET>
+#
+BENCH_FILE = $(BENCH_DIR)/benchmark_$(BENCH_TARGET_NAME).c
+
+#
+# Benchmark output (executable) file
+#
+TARGET = $(BENCH_OUT_PATH)/$(BENCH_TARGET_NAME)$(UNITTEST_TARGET_EXTENSION)
+
+#
+# Include Directories
+#
+INC_DIRS = \
+	-I$(ROOT_PATH)/Include \
+	-I$(ROOT_PATH)/Include/BSP \
+	-I$(ROOT_PATH)/Environment/Tools/Debug \
+	-I$(BENCH_MODULE) \
+	-I$(BENCH_DIR) \
+	$(MODULE_INC_PATHS)
+
+#
+# CFLAGS
+#	- Benchmarks are built with optimizations as a release build
+#	- Environment specific Benchmark flags (BENCHMARK_CFLAGS)
+#
+CFLAGS += \
+	$(BENCHMARK_CFLAGS) \
+	$(BENCH_CFLAGS)
+
+#
+# Compiler Symbols
+#
+SYMBOLS += \
+	-DBENCHMARK
+
+################################################################################
+#                    		     RULES                                   	   #
+################################################################################
+
+#
+# Default Rule
+#	- Builds and runs benchmark
+#
+default: \
+	intro \
+	run_benchmark
+
+#
+# Introduction for Benchmarked Module
+#
+intro:
+	@echo "\n=================================================================="
+	@echo "  >> Benchmarking $(BENCH_MODULE) Module"
+
+#
+# Rule to build and run Benchmark
+#
+run_benchmark:
+	mkdir -p $(BENCH_OUT_PATH)
+
+	$(CC) $(CFLAGS) $(INC_DIRS) $(SYMBOLS) $(BENCH_FILE) $(BENCH_SRC_FILES) -o $(TARGET) $(BENCH_LIBS)
+
+	./$(TARGET) $(BENCH_ARGS)
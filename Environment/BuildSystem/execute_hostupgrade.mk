@@ -0,0 +1,103 @@
+################################################################################
+#
+# @file execute_hostupgrade.mk
+#
+# @author MC
+#
+# @brief Makefile to run an end-to-end upgrade on host (x86)
+#			> Builds bootloader for simulated CPU (PROJECT=Bootloader ENV=x86)
+#			  and ImageTool
+#			> Starts bootloader on an erased flash file
+#			> Uploads image over pseudo terminal UART using ImageTool
+#			> Prints upload statistics of ImageTool and upgrade times of
+#			  bootloader
+#
+#		Bootloader exits when it jumps to upgraded image. Run fails if
+#		image is not uploaded or bootloader does not jump in time.
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+################################################################################
+#                    		DEFINITIONS & INCLUDES                             #
+################################################################################
+
+# Path of Root
+ROOT_PATH = .
+
+# Path which includes all makefiles
+MAKE_FILES_PATH = Environment/BuildSystem
+
+#
+# Upload settings
+#
+IMAGE ?= Bootloader/TestData/ER_IROM1.signed
+BAUD ?= 115200
+WINDOW ?= 16
+
+# Maximum duration of a run in seconds
+TIMEOUT ?= 60
+
+# Path of out files
+HOSTUPGRADE_OUT_PATH = $(ROOT_PATH)/out/HostUpgrade
+
+#
+# Simulated bootloader and host tool
+#
+BOOTLOADER = $(ROOT_PATH)/out/Projects/Bootloader/Bootloader.elf
+IMAGETOOL = $(ROOT_PATH)/out/Tools/ImageTool/ImageTool.out
+
+#
+# Flash content, UART link and output of bootloader
+#
+FLASH_FILE = $(HOSTUPGRADE_OUT_PATH)/flash.bin
+UART_LINK = $(HOSTUPGRADE_OUT_PATH)/uart
+BOOTLOADER_LOG = $(HOSTUPGRADE_OUT_PATH)/bootloader.log
+
+################################################################################
+#                    		     RULES                                   	   #
+################################################################################
+
+#
+# Default Rule
+#	- Builds bootloader and tool, runs upgrade
+#
+default: \
+	build_hostupgrade \
+	run_hostupgrade
+
+#
+# Rule to build simulated bootloader and ImageTool
+#
+build_hostupgrade:
+	$(MAKE) -f $(MAKE_FILES_PATH)/build_project.mk PROJECT=Bootloader ENV=x86
+	$(MAKE) -f $(MAKE_FILES_PATH)/build_tool.mk TOOL=Environment/Tools/ImageTool TOOL_ARGS=
+
+#
+# Rule to run an upgrade
+#	Each run starts with erased flash, so image is installed into first slot
+#
+run_hostupgrade: build_hostupgrade
+	mkdir -p $(HOSTUPGRADE_OUT_PATH)
+	rm -f $(FLASH_FILE) $(UART_LINK)
+
+	SIM_FLASH_FILE=$(FLASH_FILE) SIM_UART_LINK=$(UART_LINK) timeout $(TIMEOUT) $(BOOTLOADER) > $(BOOTLOADER_LOG) & \
+	bootloader=$$!; \
+	while [ ! -e $(UART_LINK) ] && kill -0 $$bootloader 2> /dev/null; do sleep 0.1; done; \
+	timeout $(TIMEOUT) $(IMAGETOOL) send $(IMAGE) $(UART_LINK) $(BAUD) $(WINDOW); \
+	upload=$$?; \
+	[ $$upload -eq 0 ] || kill $$bootloader; \
+	wait $$bootloader; \
+	result=$$?; \
+	cat $(BOOTLOADER_LOG); \
+	echo "\n"; \
+	test $$upload -eq 0 -a $$result -eq 0
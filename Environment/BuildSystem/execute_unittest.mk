@@ -75,11 +75,14 @@ TARGET = $(UNITY_OUT_PATH)/$(TEST_TARGET_NAME)$(UNITTEST_TARGET_EXTENSION)
 #	- Unity.c : Source code of Unity tool
 #	- Unit Test source file
 #	- Test Runner source file
+#	- Sources which are linked with unit test (TEST_SRC_FILES), e.g. a
+#	  reference implementation which tested module is compared with
 #
 ALL_SRC_FILES= \
 	$(UNITY_ROOT)/unity.c \
 	$(TEST_DIR)/$(TEST_FILE) \
-	$(TEST_RUNNER_FILE)
+	$(TEST_RUNNER_FILE) \
+	$(TEST_SRC_FILES)
 
 #
 # Source files under to be tested module.
@@ -0,0 +1,35 @@
+################################################################################
+#
+# @file benchmark.mk
+#
+# @author MC
+#
+# @brief Benchmark make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+BENCH_TARGET_NAME = SHA256
+
+# mbedTLS configuration of bootloader
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Projects/Bootloader/config \
+	-I$(ROOT_PATH)/Projects/Bootloader/config/mbedtls
+
+# SHA-256 implementations are included by benchmark
+BENCH_SRC_FILES =
+
+# Firmware images which are hashed
+BENCH_ARGS = \
+	$(ROOT_PATH)/Bootloader/TestData/ER_IROM1 \
+	$(ROOT_PATH)/Bootloader/TestData/ER_IROM1.signed \
+	$(ROOT_PATH)/Bootloader/TestData/App.hex
@@ -0,0 +1,289 @@
+/*******************************************************************************
+ *
+ * @file benchmark_SHA256.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for SHA-256 compression function of mbedTLS.
+ *
+ *        Firmware images and a full firmware area of random data are hashed
+ *        by default (rolled by 8 rounds) and unrolled (MBEDTLS_SHA256_UNROLLED)
+ *        implementations. Digests must match, MB/s and cycles per byte (TSC)
+ *        are reported for host.
+ *
+ *        Cortex-M3 cycles are estimated from Thumb-2 instructions of a round
+ *        (rotations are operands of EOR, round constant is a literal load)
+ *        and of a message schedule step. Cycles on target are measured by
+ *        bootloader with BL_BOOT_TIME_MEASUREMENT (DWT cycle counter).
+ *
+ *        [USAGE] : benchmark_SHA256 <Image File> [Image File ...]
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#include "postypes.h"
+
+#include "mbedtls/config.h"
+
+/*
+ * Default implementation is built under reference names
+ */
+#undef MBEDTLS_SHA256_UNROLLED
+
+#define mbedtls_sha256_init					reference_sha256_init
+#define mbedtls_sha256_free					reference_sha256_free
+#define mbedtls_sha256_clone				reference_sha256_clone
+#define mbedtls_sha256_starts				reference_sha256_starts
+#define mbedtls_sha256_update				reference_sha256_update
+#define mbedtls_sha256_finish				reference_sha256_finish
+#define mbedtls_sha256_process				reference_sha256_process
+#define mbedtls_sha256						reference_sha256
+#define mbedtls_zeroize						reference_zeroize
+#define sha256_padding						reference_padding
+
+#include "../library/sha256.c"
+
+#undef mbedtls_sha256_init
+#undef mbedtls_sha256_free
+#undef mbedtls_sha256_clone
+#undef mbedtls_sha256_starts
+#undef mbedtls_sha256_update
+#undef mbedtls_sha256_finish
+#undef mbedtls_sha256_process
+#undef mbedtls_sha256
+#undef mbedtls_zeroize
+#undef sha256_padding
+
+/*
+ * Unrolled implementation is built under mbedTLS names
+ */
+#define MBEDTLS_SHA256_UNROLLED
+
+#include "../library/sha256.c"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Firmware area of bootloader in LPC1768 flash (512K - 64K) */
+#define BENCH_FIRMWARE_AREA_SIZE			(0x70000)
+
+/* Length of SHA-256 digest */
+#define BENCH_DIGEST_LENGTH					(32)
+
+/* Minimum measurement duration of an implementation */
+#define BENCH_MIN_DURATION_IN_NS			(200000000ULL)
+
+/* Core clock of LPC1768 */
+#define BENCH_CORE_CLOCK_IN_MHZ				(100)
+
+/* Cortex-M3 cycles of a round (12 data processing, 2 literal load, 4 state loads and stores) */
+#define BENCH_CM3_CYCLES_PER_ROUND			(22)
+
+/* Cortex-M3 cycles of a message schedule step (4 loads, 1 store, 8 data processing) */
+#define BENCH_CM3_CYCLES_PER_SCHEDULE		(14)
+
+/* Cortex-M3 cycles of a block, 48 of 64 rounds extend message schedule */
+#define BENCH_CM3_CYCLES_PER_BLOCK			((64 * BENCH_CM3_CYCLES_PER_ROUND) + (48 * BENCH_CM3_CYCLES_PER_SCHEDULE))
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Measured implementation
+ */
+typedef struct
+{
+	const char* name;
+	void (*hash)(const unsigned char* input, size_t length, unsigned char output[32], int is224);
+} BenchImplementation;
+
+/*
+ * Measurement of an implementation
+ */
+typedef struct
+{
+	uint8_t digest[BENCH_DIGEST_LENGTH];
+	double megaBytesPerSecond;
+	double cyclesPerByte;
+} BenchResult;
+
+/******************************** VARIABLES ***********************************/
+
+/* Hashed data */
+PRIVATE uint8_t image[BENCH_FIRMWARE_AREA_SIZE];
+PRIVATE uint32_t imageLength;
+
+/* Rolled implementation is the reference */
+PRIVATE const BenchImplementation implementations[] =
+{
+	{ "default", reference_sha256 },
+	{ "unrolled", mbedtls_sha256 }
+};
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns monotonic time in nanoseconds
+ */
+PRIVATE uint64_t getTimeInNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Loads image file
+ */
+PRIVATE bool loadImage(const char* fileName)
+{
+	FILE* file;
+
+	file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	imageLength = (uint32_t)fread(image, 1, sizeof(image), file);
+	fclose(file);
+
+	return (imageLength > 0);
+}
+
+/*
+ * Fills firmware area with pseudo random data
+ */
+PRIVATE void fillFirmwareArea(void)
+{
+	uint32_t seed = 0x2545F491;
+	uint32_t index;
+
+	for (index = 0; index < sizeof(image); index++)
+	{
+		seed = (seed * 1103515245) + 12345;
+		image[index] = (uint8_t)(seed >> 16);
+	}
+
+	imageLength = sizeof(image);
+}
+
+/*
+ * Hashes image until minimum duration is reached
+ */
+PRIVATE void runImplementation(const BenchImplementation* implementation, BenchResult* result)
+{
+	uint64_t hashedLength = 0;
+	uint64_t startCycles;
+	uint64_t startTime;
+	uint64_t elapsedTime;
+
+	startTime = getTimeInNs();
+	startCycles = __rdtsc();
+
+	do
+	{
+		implementation->hash(image, imageLength, result->digest, 0);
+
+		hashedLength += imageLength;
+		elapsedTime = getTimeInNs() - startTime;
+	} while (elapsedTime < BENCH_MIN_DURATION_IN_NS);
+
+	result->cyclesPerByte = (double)(__rdtsc() - startCycles) / (double)hashedLength;
+	result->megaBytesPerSecond = ((double)hashedLength * 1000.0) / (double)elapsedTime;
+}
+
+/*
+ * Hashes image by all implementations and prints results
+ */
+PRIVATE bool runImage(const char* name)
+{
+	BenchResult results[sizeof(implementations) / sizeof(implementations[0])];
+	uint32_t index;
+
+	printf("\n %s (%u bytes)\n", name, imageLength);
+
+	for (index = 0; index < sizeof(implementations) / sizeof(implementations[0]); index++)
+	{
+		runImplementation(&implementations[index], &results[index]);
+
+		if (memcmp(results[index].digest, results[0].digest, BENCH_DIGEST_LENGTH) != 0)
+		{
+			return false;
+		}
+
+		printf("  %-10s : %8.2f MB/s, %6.2f cycles/byte on host, %5.2fx\n",
+			   implementations[index].name,
+			   results[index].megaBytesPerSecond,
+			   results[index].cyclesPerByte,
+			   results[index].megaBytesPerSecond / results[0].megaBytesPerSecond);
+	}
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(int argc, char* argv[])
+{
+	uint32_t blockCount;
+	int fileNo;
+
+	if (argc < 2)
+	{
+		printf("Usage : %s <Image File> [Image File ...]\n", argv[0]);
+		return RESULT_FAIL;
+	}
+
+	printf("\nSHA-256 Benchmark (default vs unrolled compression function)\n");
+
+	for (fileNo = 1; fileNo < argc; fileNo++)
+	{
+		if (!loadImage(argv[fileNo]))
+		{
+			printf("Image File could not be loaded : %s\n", argv[fileNo]);
+			return RESULT_FAIL;
+		}
+
+		if (!runImage(argv[fileNo]))
+		{
+			printf("Digests do not match!\n");
+			return RESULT_FAIL;
+		}
+	}
+
+	fillFirmwareArea();
+
+	if (!runImage("firmware area"))
+	{
+		printf("Digests do not match!\n");
+		return RESULT_FAIL;
+	}
+
+	/* Padding adds a block at most */
+	blockCount = (imageLength / 64) + 1;
+
+	printf("\n Unrolled on Cortex-M3 (estimate) : %u cycles/block, %.1f cycles/byte, firmware area in %.1f ms at %u MHz\n",
+		   BENCH_CM3_CYCLES_PER_BLOCK,
+		   BENCH_CM3_CYCLES_PER_BLOCK / 64.0,
+		   ((double)blockCount * BENCH_CM3_CYCLES_PER_BLOCK) / (BENCH_CORE_CLOCK_IN_MHZ * 1000.0),
+		   BENCH_CORE_CLOCK_IN_MHZ);
+
+	return RESULT_SUCCESS;
+}
@@ -0,0 +1,26 @@
+################################################################################
+#
+# @file unittest.mk
+#
+# @author MC
+#
+# @brief Unit test make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+TEST_TARGET_NAME=Bignum
+
+# mbedTLS configuration of bootloader
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Projects/Bootloader/config \
+	-I$(ROOT_PATH)/Projects/Bootloader/config/mbedtls
@@ -0,0 +1,322 @@
+/*******************************************************************************
+ *
+ * @file unittest_Bignum.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Montgomery arithmetic of mbedTLS bignum
+ *
+ *		  Fused Montgomery multiplication and squaring (MULADDC2) are
+ *		  cross-checked on random 2048-bit operands against schoolbook
+ *		  multiplication and division of mbedTLS (MULADDC path).
+ *
+ *		  On x86, portable MULADDC2 is used. Thumb-2 assembly is tested
+ *		  when unit test is cross compiled with optimization (GCC does not
+ *		  let assembly use r7 at -O0) and run under QEMU user-mode, e.g.
+ *		  arm-none-eabi-gcc -mcpu=cortex-m3 -O2 ... && qemu-arm -cpu cortex-m3
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+
+#include "postypes.h"
+
+/* Fused path is also used on hosts without assembly */
+#define MBEDTLS_MPI_MULADDC2_PORTABLE
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../library/bignum.c"
+#include "../library/platform.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Operand length (RSA-2048) */
+#define TEST_OPERAND_LENGTH						(256)
+
+/* Number of random operands of each test */
+#define TEST_RANDOM_OPERAND_COUNT				(64)
+
+/* Number of exponentiations with random (full length) exponents */
+#define TEST_RANDOM_EXPONENT_COUNT				(4)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* State of deterministic random generator */
+PRIVATE uint32_t randomState;
+
+/* Operands */
+PRIVATE mbedtls_mpi N;
+PRIVATE mbedtls_mpi A;
+PRIVATE mbedtls_mpi B;
+PRIVATE mbedtls_mpi E;
+PRIVATE mbedtls_mpi T;
+PRIVATE mbedtls_mpi X;
+PRIVATE mbedtls_mpi expected;
+PRIVATE mbedtls_mpi_uint mm;
+
+/**************************** PRIVATE FUNCTIONS *******************************/
+/*
+ * Xorshift random generator, same operands on each run
+ */
+PRIVATE int getRandom(void* state, unsigned char* output, size_t length)
+{
+	uint32_t* x = (uint32_t*)state;
+
+	while (length-- > 0)
+	{
+		*x ^= *x << 13;
+		*x ^= *x >> 17;
+		*x ^= *x << 5;
+		*output++ = (unsigned char)*x;
+	}
+
+	return 0;
+}
+
+/*
+ * Random full length odd modulus
+ */
+PRIVATE void randomModulus(mbedtls_mpi* modulus)
+{
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_fill_random(modulus, TEST_OPERAND_LENGTH, getRandom, &randomState));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_set_bit(modulus, (TEST_OPERAND_LENGTH * 8) - 1, 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_set_bit(modulus, 0, 1));
+}
+
+/*
+ * Random operand which is less than modulus, grown as exponentiation does
+ */
+PRIVATE void randomOperand(mbedtls_mpi* operand, const mbedtls_mpi* modulus)
+{
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_fill_random(operand, TEST_OPERAND_LENGTH, getRandom, &randomState));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_mod_mpi(operand, operand, modulus));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_grow(operand, modulus->n + 1));
+}
+
+/*
+ * Prepares Montgomery constant and temporary of modulus
+ */
+PRIVATE void initMontgomery(const mbedtls_mpi* modulus)
+{
+	mpi_montg_init(&mm, modulus);
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_grow(&T, (modulus->n + 1) * 2));
+}
+
+/*
+ * Reference Montgomery multiplication: result = a * b * R^-1 mod modulus
+ */
+PRIVATE void referenceMontMul(mbedtls_mpi* result, const mbedtls_mpi* a, const mbedtls_mpi* b, const mbedtls_mpi* modulus)
+{
+	mbedtls_mpi R;
+
+	mbedtls_mpi_init(&R);
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_lset(&R, 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_shift_l(&R, modulus->n * biL));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_inv_mod(&R, &R, modulus));
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_mul_mpi(result, a, b));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_mod_mpi(result, result, modulus));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_mul_mpi(result, result, &R));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_mod_mpi(result, result, modulus));
+
+	mbedtls_mpi_free(&R);
+}
+
+/*
+ * Reference exponentiation (square and multiply): result = a ^ e mod modulus
+ */
+PRIVATE void referenceExpMod(mbedtls_mpi* result, const mbedtls_mpi* a, const mbedtls_mpi* e, const mbedtls_mpi* modulus)
+{
+	size_t bitNo = mbedtls_mpi_bitlen(e);
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_lset(result, 1));
+
+	while (bitNo-- > 0)
+	{
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_mul_mpi(result, result, result));
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_mod_mpi(result, result, modulus));
+
+		if (mbedtls_mpi_get_bit(e, bitNo))
+		{
+			TEST_ASSERT_EQUAL(0, mbedtls_mpi_mul_mpi(result, result, a));
+			TEST_ASSERT_EQUAL(0, mbedtls_mpi_mod_mpi(result, result, modulus));
+		}
+	}
+}
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	mbedtls_platform_set_calloc_free(calloc, free);
+
+	randomState = 0x2016C0DE;
+
+	mbedtls_mpi_init(&N);
+	mbedtls_mpi_init(&A);
+	mbedtls_mpi_init(&B);
+	mbedtls_mpi_init(&E);
+	mbedtls_mpi_init(&T);
+	mbedtls_mpi_init(&X);
+	mbedtls_mpi_init(&expected);
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	mbedtls_mpi_free(&N);
+	mbedtls_mpi_free(&A);
+	mbedtls_mpi_free(&B);
+	mbedtls_mpi_free(&E);
+	mbedtls_mpi_free(&T);
+	mbedtls_mpi_free(&X);
+	mbedtls_mpi_free(&expected);
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+void test_MontMul_RandomOperands(void)
+{
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_OPERAND_COUNT; index++)
+	{
+		randomModulus(&N);
+		randomOperand(&A, &N);
+		randomOperand(&B, &N);
+		initMontgomery(&N);
+
+		referenceMontMul(&expected, &A, &B, &N);
+
+		TEST_ASSERT_EQUAL(0, mpi_montmul(&A, &B, &N, mm, &T));
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &A));
+	}
+}
+
+void test_MontSqr_RandomOperands(void)
+{
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_OPERAND_COUNT; index++)
+	{
+		randomModulus(&N);
+		randomOperand(&A, &N);
+		initMontgomery(&N);
+
+		referenceMontMul(&expected, &A, &A, &N);
+
+		TEST_ASSERT_EQUAL(0, mpi_montsqr(&A, &N, mm, &T));
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &A));
+	}
+}
+
+void test_MontSqr_MaximumCarries(void)
+{
+	/* All limbs of modulus and operand are ones, every product carries */
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_lset(&N, 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_shift_l(&N, TEST_OPERAND_LENGTH * 8));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_sub_int(&N, &N, 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_shrink(&N, 0));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_sub_int(&A, &N, 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_copy(&B, &A));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_grow(&A, N.n + 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_grow(&B, N.n + 1));
+	initMontgomery(&N);
+
+	referenceMontMul(&expected, &A, &A, &N);
+
+	TEST_ASSERT_EQUAL(0, mpi_montmul(&B, &A, &N, mm, &T));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &B));
+
+	TEST_ASSERT_EQUAL(0, mpi_montsqr(&A, &N, mm, &T));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &A));
+}
+
+void test_MontRed_SingleLimbOperand(void)
+{
+	/* Reduction multiplies by a single limb, rows are not fused */
+	randomModulus(&N);
+	randomOperand(&A, &N);
+	initMontgomery(&N);
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_lset(&B, 1));
+
+	referenceMontMul(&expected, &A, &B, &N);
+
+	TEST_ASSERT_EQUAL(0, mpi_montred(&A, &N, mm, &T));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &A));
+}
+
+void test_MontSqr_ShortTemporary(void)
+{
+	randomModulus(&N);
+	randomOperand(&A, &N);
+	initMontgomery(&N);
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_shrink(&T, N.n + 1));
+	T.n = N.n + 1;
+
+	TEST_ASSERT_EQUAL(MBEDTLS_ERR_MPI_BAD_INPUT_DATA, mpi_montsqr(&A, &N, mm, &T));
+}
+
+void test_ExpMod_PublicExponent(void)
+{
+	uint32_t index;
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_lset(&E, 65537));
+
+	for (index = 0; index < TEST_RANDOM_OPERAND_COUNT; index++)
+	{
+		randomModulus(&N);
+		randomOperand(&A, &N);
+
+		referenceExpMod(&expected, &A, &E, &N);
+
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_exp_mod(&X, &A, &E, &N, NULL));
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &X));
+	}
+}
+
+void test_ExpMod_RandomExponent(void)
+{
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_EXPONENT_COUNT; index++)
+	{
+		randomModulus(&N);
+		randomOperand(&A, &N);
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_fill_random(&E, TEST_OPERAND_LENGTH, getRandom, &randomState));
+
+		referenceExpMod(&expected, &A, &E, &N);
+
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_exp_mod(&X, &A, &E, &N, NULL));
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_cmp_mpi(&expected, &X));
+	}
+}
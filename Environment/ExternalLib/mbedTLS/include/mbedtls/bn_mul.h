@@ -657,6 +657,63 @@
            "r6", "r7", "cc"                     \
          );
 
+/*
+ * Two rows of Montgomery multiplication in a single pass (Thumb-2):
+ *   d[k] += a * s[k] + b * t[k], with separate carries c0 and c1
+ * d is loaded and stored once for both products. Cortex-M4 and later
+ * (DSP extension) accumulate carries by UMAAL, Cortex-M3 by UMLAL.
+ */
+#define MULADDC2_INIT                                   \
+    asm(                                                \
+            "ldr    r0, %5                      \n\t"   \
+            "ldr    r1, %6                      \n\t"   \
+            "ldr    r2, %7                      \n\t"   \
+            "ldr    r3, %8                      \n\t"   \
+            "ldr    r4, %9                      \n\t"   \
+            "ldr    r5, %10                     \n\t"   \
+            "ldr    r6, %11                     \n\t"
+
+#if defined(__ARM_FEATURE_DSP)
+
+#define MULADDC2_CORE                                   \
+            "ldr    r7, [r0], #4                \n\t"   \
+            "ldr    r8, [r2]                    \n\t"   \
+            "umaal  r8, r5, r3, r7              \n\t"   \
+            "ldr    r7, [r1], #4                \n\t"   \
+            "umaal  r8, r6, r4, r7              \n\t"   \
+            "str    r8, [r2], #4                \n\t"
+
+#else
+
+#define MULADDC2_CORE                                   \
+            "ldr    r7, [r0], #4                \n\t"   \
+            "ldr    r8, [r2]                    \n\t"   \
+            "mov    r9, #0                      \n\t"   \
+            "umlal  r8, r9, r3, r7              \n\t"   \
+            "adds   r8, r8, r5                  \n\t"   \
+            "adc    r5, r9, #0                  \n\t"   \
+            "ldr    r7, [r1], #4                \n\t"   \
+            "mov    r9, #0                      \n\t"   \
+            "umlal  r8, r9, r4, r7              \n\t"   \
+            "adds   r8, r8, r6                  \n\t"   \
+            "adc    r6, r9, #0                  \n\t"   \
+            "str    r8, [r2], #4                \n\t"
+
+#endif /* DSP */
+
+#define MULADDC2_STOP                                   \
+            "str    r5, %0                      \n\t"   \
+            "str    r6, %1                      \n\t"   \
+            "str    r0, %2                      \n\t"   \
+            "str    r1, %3                      \n\t"   \
+            "str    r2, %4                      \n\t"   \
+         : "=m" (c0), "=m" (c1), "=m" (s), "=m" (t), "=m" (d) \
+         : "m" (s), "m" (t), "m" (d), "m" (a), "m" (b),       \
+           "m" (c0), "m" (c1)                                 \
+         : "r0", "r1", "r2", "r3", "r4", "r5",  \
+           "r6", "r7", "r8", "r9", "cc", "memory" \
+         );
+
 #endif /* Thumb */
 
 #endif /* ARMv3 */
@@ -882,4 +939,30 @@
 #endif /* C (generic)  */
 #endif /* C (longlong) */
 
+/*
+ * Portable version of MULADDC2 (see Thumb-2 version). It is not used by
+ * default so other hosts keep MULADDC path, unit tests define
+ * MBEDTLS_MPI_MULADDC2_PORTABLE to run fused Montgomery path on host.
+ */
+#if !defined(MULADDC2_CORE) && defined(MBEDTLS_HAVE_UDBL) && \
+    defined(MBEDTLS_MPI_MULADDC2_PORTABLE)
+
+#define MULADDC2_INIT                   \
+{                                       \
+    mbedtls_t_udbl r;
+
+#define MULADDC2_CORE                   \
+    r  = *(s++) * (mbedtls_t_udbl) a;   \
+    r += *d; r += c0;                   \
+    c0 = (mbedtls_mpi_uint)( r >> biL ); \
+    r  = *(t++) * (mbedtls_t_udbl) b + (mbedtls_mpi_uint) r; \
+    r += c1;                            \
+    c1 = (mbedtls_mpi_uint)( r >> biL ); \
+    *(d++) = (mbedtls_mpi_uint) r;
+
+#define MULADDC2_STOP                   \
+}
+
+#endif /* C (portable MULADDC2) */
+
 #endif /* bn_mul.h */
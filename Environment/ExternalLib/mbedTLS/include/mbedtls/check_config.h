@@ -445,6 +445,10 @@
 #error "MBEDTLS_RSA_C defined, but none of the PKCS1 versions enabled"
 #endif
 
+#if defined(MBEDTLS_SHA256_UNROLLED) && defined(MBEDTLS_SHA256_SMALLER)
+#error "MBEDTLS_SHA256_UNROLLED and MBEDTLS_SHA256_SMALLER cannot be defined simultaneously"
+#endif
+
 #if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT) &&                        \
     ( !defined(MBEDTLS_RSA_C) || !defined(MBEDTLS_PKCS1_V21) )
 #error "MBEDTLS_X509_RSASSA_PSS_SUPPORT defined, but not all prerequisites"
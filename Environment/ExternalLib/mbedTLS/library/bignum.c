@@ -1162,6 +1162,44 @@ void mpi_mul_hlp( size_t i, mbedtls_mpi_uint *s, mbedtls_mpi_uint *d, mbedtls_mp
     while( c != 0 );
 }
 
+#if defined(MULADDC2_CORE)
+/*
+ * Helper for fused Montgomery multiplication: d += a * s + b * t, where s
+ * and t have i limbs. Both rows are accumulated in a single pass over d.
+ */
+static void mpi_mul2_hlp( size_t i, const mbedtls_mpi_uint *s, const mbedtls_mpi_uint *t,
+                          mbedtls_mpi_uint *d, mbedtls_mpi_uint a, mbedtls_mpi_uint b )
+{
+    mbedtls_mpi_uint c0 = 0, c1 = 0, c;
+
+    for( ; i >= 8; i -= 8 )
+    {
+        MULADDC2_INIT
+        MULADDC2_CORE   MULADDC2_CORE
+        MULADDC2_CORE   MULADDC2_CORE
+
+        MULADDC2_CORE   MULADDC2_CORE
+        MULADDC2_CORE   MULADDC2_CORE
+        MULADDC2_STOP
+    }
+
+    for( ; i > 0; i-- )
+    {
+        MULADDC2_INIT
+        MULADDC2_CORE
+        MULADDC2_STOP
+    }
+
+    c = c0 + c1; c1 = ( c < c0 );
+    *d += c; c1 += ( *d < c ); d++;
+
+    while( c1 != 0 )
+    {
+        *d += c1; c1 = ( *d < c1 ); d++;
+    }
+}
+#endif /* MULADDC2_CORE */
+
 /*
  * Baseline multiplication: X = A * B  (HAC 14.12)
  */
@@ -1565,8 +1603,15 @@ static int mpi_montmul( mbedtls_mpi *A, const mbedtls_mpi *B, const mbedtls_mpi
         u0 = A->p[i];
         u1 = ( d[0] + u0 * B->p[0] ) * mm;
 
-        mpi_mul_hlp( m, B->p, d, u0 );
-        mpi_mul_hlp( n, N->p, d, u1 );
+#if defined(MULADDC2_CORE)
+        if( m == n )
+            mpi_mul2_hlp( n, B->p, N->p, d, u0, u1 );
+        else
+#endif
+        {
+            mpi_mul_hlp( m, B->p, d, u0 );
+            mpi_mul_hlp( n, N->p, d, u1 );
+        }
 
         *d++ = u0; d[n + 1] = 0;
     }
@@ -1582,6 +1627,68 @@ static int mpi_montmul( mbedtls_mpi *A, const mbedtls_mpi *B, const mbedtls_mpi
     return( 0 );
 }
 
+/*
+ * Montgomery squaring: A = A * A * R^-1 mod N
+ *
+ * With MULADDC2 (Thumb-2 assembly), A^2 is computed from products of
+ * distinct limbs which are doubled, then reduced. It needs 1.5 n^2 limb
+ * products instead of 2 n^2 of mpi_montmul. T needs 2 * n + 2 limbs.
+ */
+static int mpi_montsqr( mbedtls_mpi *A, const mbedtls_mpi *N, mbedtls_mpi_uint mm,
+                         const mbedtls_mpi *T )
+{
+#if defined(MULADDC2_CORE)
+    size_t i, n;
+    mbedtls_mpi_uint c, z, *d;
+
+    n = N->n;
+
+    if( T->n < n * 2 + 2 || T->p == NULL || A->n < n + 1 )
+        return( MBEDTLS_ERR_MPI_BAD_INPUT_DATA );
+
+    memset( T->p, 0, T->n * ciL );
+
+    d = T->p;
+
+    /*
+     * T = 2 * sum(A[i] * A[j] * 2^(biL * (i + j))), i < j
+     */
+    for( i = 0; i + 1 < n; i++ )
+        mpi_mul_hlp( n - i - 1, A->p + i + 1, d + i * 2 + 1, A->p[i] );
+
+    for( i = 0, c = 0; i < n * 2; i++ )
+    {
+        z = d[i] >> ( biL - 1 );
+        d[i] = ( d[i] << 1 ) | c;
+        c = z;
+    }
+
+    /*
+     * T += A[i]^2 * 2^(biL * 2 * i)
+     */
+    for( i = 0; i < n; i++ )
+        mpi_mul_hlp( 1, A->p + i, d + i * 2, A->p[i] );
+
+    /*
+     * T = T * R^-1 (HAC 14.32)
+     */
+    for( i = 0; i < n; i++ )
+        mpi_mul_hlp( n, N->p, d + i, d[i] * mm );
+
+    memcpy( A->p, d + n, ( n + 1 ) * ciL );
+
+    if( mbedtls_mpi_cmp_abs( A, N ) >= 0 )
+        mpi_sub_hlp( n, N->p, A->p );
+    else
+        /* prevent timing attacks */
+        mpi_sub_hlp( n, A->p, T->p );
+
+    return( 0 );
+#else
+    return( mpi_montmul( A, A, N, mm, T ) );
+#endif /* MULADDC2_CORE */
+}
+
 /*
  * Montgomery reduction: A = A * R^-1 mod N
  */
@@ -1689,7 +1796,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
         MBEDTLS_MPI_CHK( mbedtls_mpi_copy( &W[j], &W[1]    ) );
 
         for( i = 0; i < wsize - 1; i++ )
-            MBEDTLS_MPI_CHK( mpi_montmul( &W[j], &W[j], N, mm, &T ) );
+            MBEDTLS_MPI_CHK( mpi_montsqr( &W[j], N, mm, &T ) );
 
         /*
          * W[i] = W[i - 1] * W[1]
@@ -1736,7 +1843,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
             /*
              * out of window, square X
              */
-            MBEDTLS_MPI_CHK( mpi_montmul( X, X, N, mm, &T ) );
+            MBEDTLS_MPI_CHK( mpi_montsqr( X, N, mm, &T ) );
             continue;
         }
 
@@ -1754,7 +1861,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
              * X = X^wsize R^-1 mod N
              */
             for( i = 0; i < wsize; i++ )
-                MBEDTLS_MPI_CHK( mpi_montmul( X, X, N, mm, &T ) );
+                MBEDTLS_MPI_CHK( mpi_montsqr( X, N, mm, &T ) );
 
             /*
              * X = X * W[wbits] R^-1 mod N
@@ -1772,7 +1879,7 @@ int mbedtls_mpi_exp_mod( mbedtls_mpi *X, const mbedtls_mpi *A, const mbedtls_mpi
      */
     for( i = 0; i < nbits; i++ )
     {
-        MBEDTLS_MPI_CHK( mpi_montmul( X, X, N, mm, &T ) );
+        MBEDTLS_MPI_CHK( mpi_montsqr( X, N, mm, &T ) );
 
         wbits <<= 1;
 
@@ -131,6 +131,7 @@ void mbedtls_sha256_starts( mbedtls_sha256_context *ctx, int is224 )
 }
 
 #if !defined(MBEDTLS_SHA256_PROCESS_ALT)
+#if !defined(MBEDTLS_SHA256_UNROLLED)
 static const uint32_t K[] =
 {
     0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
@@ -150,6 +151,7 @@ static const uint32_t K[] =
     0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
     0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
 };
+#endif /* !MBEDTLS_SHA256_UNROLLED */
 
 #define  SHR(x,n) ((x & 0xFFFFFFFF) >> n)
 #define ROTR(x,n) (SHR(x,n) | (x << (32 - n)))
@@ -176,6 +178,119 @@ static const uint32_t K[] =
     d += temp1; h = temp1 + temp2;              \
 }
 
+#if defined(MBEDTLS_SHA256_UNROLLED)
+/*
+ * Fully unrolled compression function (MBEDTLS_SHA256_UNROLLED).
+ *
+ * Working variables are locals which are renamed between rounds instead of
+ * being moved, so they can stay in registers. Round constants are
+ * immediates and message schedule is a circular buffer of 16 words.
+ * Sigma functions are nested rotations, which are a rotated operand each
+ * on ARMv7-M (EOR Rd, Rn, Rm, ROR #n).
+ */
+#define ROR(x,n) ( ( (x) >> (n) ) | ( (x) << (32 - (n)) ) )
+
+#define US0(x) ( ROR( (x) ^ ROR( (x), 11 ),  7 ) ^ ( (x) >>  3 ) )
+#define US1(x) ( ROR( (x) ^ ROR( (x),  2 ), 17 ) ^ ( (x) >> 10 ) )
+
+#define US2(x) ROR( (x) ^ ROR( (x) ^ ROR( (x),  9 ), 11 ), 2 )
+#define US3(x) ROR( (x) ^ ROR( (x) ^ ROR( (x), 14 ),  5 ), 6 )
+
+#define LOAD(t) ( W[t] )
+
+#define SCHED(t)                                                \
+(                                                               \
+    W[(t) & 15] += US1( W[((t) -  2) & 15] ) +                  \
+                   US0( W[((t) - 15) & 15] ) + W[((t) - 7) & 15] \
+)
+
+#define RND(a,b,c,d,e,f,g,h,x,K)                                \
+{                                                               \
+    h += US3(e) + F1(e,f,g) + K + x;                            \
+    d += h;                                                     \
+    h += US2(a) + F0(a,b,c);                                    \
+}
+
+void mbedtls_sha256_process( mbedtls_sha256_context *ctx, const unsigned char data[64] )
+{
+    uint32_t a, b, c, d, e, f, g, h, W[16];
+    unsigned int i;
+
+    for( i = 0; i < 16; i++ )
+        GET_UINT32_BE( W[i], data, 4 * i );
+
+    a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2]; d = ctx->state[3];
+    e = ctx->state[4]; f = ctx->state[5]; g = ctx->state[6]; h = ctx->state[7];
+
+    RND( a, b, c, d, e, f, g, h, LOAD( 0), 0x428A2F98 );
+    RND( h, a, b, c, d, e, f, g, LOAD( 1), 0x71374491 );
+    RND( g, h, a, b, c, d, e, f, LOAD( 2), 0xB5C0FBCF );
+    RND( f, g, h, a, b, c, d, e, LOAD( 3), 0xE9B5DBA5 );
+    RND( e, f, g, h, a, b, c, d, LOAD( 4), 0x3956C25B );
+    RND( d, e, f, g, h, a, b, c, LOAD( 5), 0x59F111F1 );
+    RND( c, d, e, f, g, h, a, b, LOAD( 6), 0x923F82A4 );
+    RND( b, c, d, e, f, g, h, a, LOAD( 7), 0xAB1C5ED5 );
+    RND( a, b, c, d, e, f, g, h, LOAD( 8), 0xD807AA98 );
+    RND( h, a, b, c, d, e, f, g, LOAD( 9), 0x12835B01 );
+    RND( g, h, a, b, c, d, e, f, LOAD(10), 0x243185BE );
+    RND( f, g, h, a, b, c, d, e, LOAD(11), 0x550C7DC3 );
+    RND( e, f, g, h, a, b, c, d, LOAD(12), 0x72BE5D74 );
+    RND( d, e, f, g, h, a, b, c, LOAD(13), 0x80DEB1FE );
+    RND( c, d, e, f, g, h, a, b, LOAD(14), 0x9BDC06A7 );
+    RND( b, c, d, e, f, g, h, a, LOAD(15), 0xC19BF174 );
+    RND( a, b, c, d, e, f, g, h, SCHED(16), 0xE49B69C1 );
+    RND( h, a, b, c, d, e, f, g, SCHED(17), 0xEFBE4786 );
+    RND( g, h, a, b, c, d, e, f, SCHED(18), 0x0FC19DC6 );
+    RND( f, g, h, a, b, c, d, e, SCHED(19), 0x240CA1CC );
+    RND( e, f, g, h, a, b, c, d, SCHED(20), 0x2DE92C6F );
+    RND( d, e, f, g, h, a, b, c, SCHED(21), 0x4A7484AA );
+    RND( c, d, e, f, g, h, a, b, SCHED(22), 0x5CB0A9DC );
+    RND( b, c, d, e, f, g, h, a, SCHED(23), 0x76F988DA );
+    RND( a, b, c, d, e, f, g, h, SCHED(24), 0x983E5152 );
+    RND( h, a, b, c, d, e, f, g, SCHED(25), 0xA831C66D );
+    RND( g, h, a, b, c, d, e, f, SCHED(26), 0xB00327C8 );
+    RND( f, g, h, a, b, c, d, e, SCHED(27), 0xBF597FC7 );
+    RND( e, f, g, h, a, b, c, d, SCHED(28), 0xC6E00BF3 );
+    RND( d, e, f, g, h, a, b, c, SCHED(29), 0xD5A79147 );
+    RND( c, d, e, f, g, h, a, b, SCHED(30), 0x06CA6351 );
+    RND( b, c, d, e, f, g, h, a, SCHED(31), 0x14292967 );
+    RND( a, b, c, d, e, f, g, h, SCHED(32), 0x27B70A85 );
+    RND( h, a, b, c, d, e, f, g, SCHED(33), 0x2E1B2138 );
+    RND( g, h, a, b, c, d, e, f, SCHED(34), 0x4D2C6DFC );
+    RND( f, g, h, a, b, c, d, e, SCHED(35), 0x53380D13 );
+    RND( e, f, g, h, a, b, c, d, SCHED(36), 0x650A7354 );
+    RND( d, e, f, g, h, a, b, c, SCHED(37), 0x766A0ABB );
+    RND( c, d, e, f, g, h, a, b, SCHED(38), 0x81C2C92E );
+    RND( b, c, d, e, f, g, h, a, SCHED(39), 0x92722C85 );
+    RND( a, b, c, d, e, f, g, h, SCHED(40), 0xA2BFE8A1 );
+    RND( h, a, b, c, d, e, f, g, SCHED(41), 0xA81A664B );
+    RND( g, h, a, b, c, d, e, f, SCHED(42), 0xC24B8B70 );
+    RND( f, g, h, a, b, c, d, e, SCHED(43), 0xC76C51A3 );
+    RND( e, f, g, h, a, b, c, d, SCHED(44), 0xD192E819 );
+    RND( d, e, f, g, h, a, b, c, SCHED(45), 0xD6990624 );
+    RND( c, d, e, f, g, h, a, b, SCHED(46), 0xF40E3585 );
+    RND( b, c, d, e, f, g, h, a, SCHED(47), 0x106AA070 );
+    RND( a, b, c, d, e, f, g, h, SCHED(48), 0x19A4C116 );
+    RND( h, a, b, c, d, e, f, g, SCHED(49), 0x1E376C08 );
+    RND( g, h, a, b, c, d, e, f, SCHED(50), 0x2748774C );
+    RND( f, g, h, a, b, c, d, e, SCHED(51), 0x34B0BCB5 );
+    RND( e, f, g, h, a, b, c, d, SCHED(52), 0x391C0CB3 );
+    RND( d, e, f, g, h, a, b, c, SCHED(53), 0x4ED8AA4A );
+    RND( c, d, e, f, g, h, a, b, SCHED(54), 0x5B9CCA4F );
+    RND( b, c, d, e, f, g, h, a, SCHED(55), 0x682E6FF3 );
+    RND( a, b, c, d, e, f, g, h, SCHED(56), 0x748F82EE );
+    RND( h, a, b, c, d, e, f, g, SCHED(57), 0x78A5636F );
+    RND( g, h, a, b, c, d, e, f, SCHED(58), 0x84C87814 );
+    RND( f, g, h, a, b, c, d, e, SCHED(59), 0x8CC70208 );
+    RND( e, f, g, h, a, b, c, d, SCHED(60), 0x90BEFFFA );
+    RND( d, e, f, g, h, a, b, c, SCHED(61), 0xA4506CEB );
+    RND( c, d, e, f, g, h, a, b, SCHED(62), 0xBEF9A3F7 );
+    RND( b, c, d, e, f, g, h, a, SCHED(63), 0xC67178F2 );
+
+    ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+    ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+#else /* MBEDTLS_SHA256_UNROLLED */
 void mbedtls_sha256_process( mbedtls_sha256_context *ctx, const unsigned char data[64] )
 {
     uint32_t temp1, temp2, W[64];
@@ -230,6 +345,7 @@ void mbedtls_sha256_process( mbedtls_sha256_context *ctx, const unsigned char da
     for( i = 0; i < 8; i++ )
         ctx->state[i] += A[i];
 }
+#endif /* MBEDTLS_SHA256_UNROLLED */
 #endif /* !MBEDTLS_SHA256_PROCESS_ALT */
 
 /*
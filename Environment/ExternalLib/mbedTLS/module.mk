@@ -0,0 +1,29 @@
+################################################################################
+#
+# @file module.mk
+#
+# @author MC
+#
+# @brief mbedTLS library module make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+#
+# Get all source files (.c files) using 'find' command
+#	Configuration (config.h) is provided by project which uses library.
+#
+MBEDTLS_SRC_FILES := $(shell /usr/bin/find $(ROOT_PATH)/Environment/ExternalLib/mbedTLS/library -mindepth 1 -maxdepth 1 -name "*.c")
+
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Environment/ExternalLib/mbedTLS/include \
+	-I$(ROOT_PATH)/Environment/ExternalLib/mbedTLS/include/mbedtls
@@ -0,0 +1,154 @@
+/*******************************************************************************
+*
+* @file Arena.c
+*
+* @author MC
+*
+* @brief Static Arena Allocator Implementation
+*
+*		 A block is a header, which keeps size class of block, followed by
+*		 data of class length. Data of a free block links it into free list
+*		 of its class.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Arena.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Data length of a size class */
+#define ARENA_CLASS_LENGTH(classNo)			(1UL << (ARENA_MIN_CLASS_SHIFT + (classNo)))
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns header of a block
+ */
+PRIVATE ALWAYS_INLINE uint32_t* GetHeader(void* block)
+{
+	return (uint32_t*)((uint8_t*)block - ARENA_HEADER_LENGTH);
+}
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/**
+ * Initializes an empty arena
+ */
+void Arena_Init(Arena* arena, void* memory, uint32_t length)
+{
+	uint32_t misalignment = (uint32_t)((uintptr_t)memory & (ARENA_ALIGNMENT - 1));
+	uint32_t padding = (misalignment > 0) ? (ARENA_ALIGNMENT - misalignment) : 0;
+
+	arena->memory = (uint8_t*)memory + padding;
+	arena->length = (length > padding) ? (length - padding) : 0;
+	arena->highWaterMark = 0;
+
+	Arena_Reset(arena);
+}
+
+/**
+ * Allocates a block
+ */
+void* Arena_Alloc(Arena* arena, uint32_t length)
+{
+	ArenaFreeBlock* freeBlock;
+	uint32_t classNo = 0;
+	uint32_t blockLength;
+	uint8_t* block;
+
+	if (length > ARENA_MAX_BLOCK_LENGTH)
+	{
+		return NULL;
+	}
+
+	while (ARENA_CLASS_LENGTH(classNo) < length)
+	{
+		classNo++;
+	}
+
+	/* Released block of same class is reused first */
+	freeBlock = arena->freeLists[classNo];
+	if (freeBlock != NULL)
+	{
+		arena->freeLists[classNo] = freeBlock->next;
+
+		return freeBlock;
+	}
+
+	blockLength = ARENA_HEADER_LENGTH + ARENA_CLASS_LENGTH(classNo);
+	if (blockLength > arena->length - arena->top)
+	{
+		return NULL;
+	}
+
+	block = &arena->memory[arena->top + ARENA_HEADER_LENGTH];
+	*GetHeader(block) = classNo;
+
+	arena->top += blockLength;
+	arena->highWaterMark = MATH_MAX(arena->highWaterMark, arena->top);
+
+	return block;
+}
+
+/**
+ * Releases a block
+ */
+void Arena_Free(Arena* arena, void* block)
+{
+	ArenaFreeBlock* freeBlock = (ArenaFreeBlock*)block;
+	uint32_t classNo;
+
+	if (block == NULL)
+	{
+		return;
+	}
+
+	classNo = *GetHeader(block);
+
+	/* Last bumped block is returned to arena, so following allocations of any class can use it */
+	if ((uint8_t*)block + ARENA_CLASS_LENGTH(classNo) == &arena->memory[arena->top])
+	{
+		arena->top -= ARENA_HEADER_LENGTH + ARENA_CLASS_LENGTH(classNo);
+		return;
+	}
+
+	freeBlock->next = arena->freeLists[classNo];
+	arena->freeLists[classNo] = freeBlock;
+}
+
+/**
+ * Releases all blocks
+ */
+void Arena_Reset(Arena* arena)
+{
+	uint32_t classNo;
+
+	arena->top = 0;
+
+	for (classNo = 0; classNo < ARENA_CLASS_COUNT; classNo++)
+	{
+		arena->freeLists[classNo] = NULL;
+	}
+}
+
+/**
+ * Returns high water mark of arena
+ */
+uint32_t Arena_GetHighWaterMark(const Arena* arena)
+{
+	return arena->highWaterMark;
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ *
+ * @file Arena.h
+ *
+ * @author MC
+ *
+ * @brief Static Arena Allocator with Size Class Free Lists
+ *
+ *		  Blocks are bumped from a static memory area and rounded up to a
+ *		  power of two size class. Freed blocks are kept in free list of
+ *		  their class and reused by next allocation of same class, so
+ *		  allocation and free are a few instructions without any search.
+ *		  Freeing the most recently bumped block returns it to arena.
+ *
+ *		  Blocks are not coalesced. Arena is reset in one step when all of
+ *		  its blocks are released (e.g. after a signature verification).
+ *
+ *		  Highest bumped offset is kept as high water mark to size memory
+ *		  area of arena.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Alignment of blocks, enough for 64 bit words */
+#define ARENA_ALIGNMENT						(8)
+
+/* Header of a block keeps its size class */
+#define ARENA_HEADER_LENGTH					(ARENA_ALIGNMENT)
+
+/* Smallest size class is 2^ARENA_MIN_CLASS_SHIFT bytes */
+#define ARENA_MIN_CLASS_SHIFT				(4)
+
+/* Number of size classes (16 bytes to 4K) */
+#define ARENA_CLASS_COUNT					(9)
+
+/* Largest block which can be allocated */
+#define ARENA_MAX_BLOCK_LENGTH				(1UL << (ARENA_MIN_CLASS_SHIFT + ARENA_CLASS_COUNT - 1))
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Free block, link is kept in its data
+ */
+typedef struct ArenaFreeBlock
+{
+	struct ArenaFreeBlock* next;
+} ArenaFreeBlock;
+
+/*
+ * Arena.
+ *	Fields are private to arena.
+ */
+typedef struct
+{
+	/* Aligned memory area and its length */
+	uint8_t* memory;
+	uint32_t length;
+	/* Offset of next bumped block */
+	uint32_t top;
+	/* Highest top since initialization */
+	uint32_t highWaterMark;
+	/* Released blocks of each size class */
+	ArenaFreeBlock* freeLists[ARENA_CLASS_COUNT];
+} Arena;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Initializes an empty arena.
+ *
+ * @param arena Arena to be initialized
+ * @param memory Memory area of arena, aligned inside
+ * @param length Length of memory area
+ *
+ * @return none
+ */
+void Arena_Init(Arena* arena, void* memory, uint32_t length);
+
+/*
+ * Allocates a block. Content of block is not initialized.
+ *
+ * @param arena Arena
+ * @param length Requested length, up to ARENA_MAX_BLOCK_LENGTH
+ *
+ * @return Aligned block or NULL if arena is exhausted
+ */
+void* Arena_Alloc(Arena* arena, uint32_t length);
+
+/*
+ * Releases a block into free list of its size class.
+ *
+ * @param arena Arena which block is allocated from
+ * @param block Block to be released, NULL is ignored
+ *
+ * @return none
+ */
+void Arena_Free(Arena* arena, void* block);
+
+/*
+ * Releases all blocks at once. Blocks must not be used after reset.
+ *
+ * @param arena Arena
+ *
+ * @return none
+ */
+void Arena_Reset(Arena* arena);
+
+/*
+ * Returns highest number of bumped bytes (blocks and headers) since
+ * initialization, which is the required length of memory area.
+ */
+uint32_t Arena_GetHighWaterMark(const Arena* arena);
+
+#endif	/* __ARENA_H */
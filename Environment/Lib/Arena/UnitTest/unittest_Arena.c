@@ -0,0 +1,252 @@
+/*******************************************************************************
+ *
+ * @file unittest_Arena.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Static Arena Allocator Library
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../Arena.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Length of memory area which is used by tests */
+#define TEST_ARENA_LENGTH				(1024)
+
+/* Number of live blocks and operations of random allocation test */
+#define TEST_RANDOM_BLOCK_COUNT			(16)
+#define TEST_RANDOM_OPERATION_COUNT		(20000)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Live block of random allocation test
+ */
+typedef struct
+{
+	uint8_t* data;
+	uint32_t length;
+	uint8_t pattern;
+} TestBlock;
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+PRIVATE Arena arena;
+PRIVATE uint64_t arenaMemory[TEST_ARENA_LENGTH / sizeof(uint64_t)];
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	memset(arenaMemory, 0, sizeof(arenaMemory));
+
+	Arena_Init(&arena, arenaMemory, sizeof(arenaMemory));
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/*
+ * Returns next random number using a linear congruential generator
+ */
+PRIVATE uint32_t nextRandom(uint32_t* seed)
+{
+	*seed = (*seed * 1103515245) + 12345;
+
+	return *seed >> 16;
+}
+
+/*
+ * Checks whether all bytes of a block have a pattern
+ */
+PRIVATE bool hasPattern(const uint8_t* data, uint32_t length, uint8_t pattern)
+{
+	uint32_t index;
+
+	for (index = 0; index < length; index++)
+	{
+		if (data[index] != pattern)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/****************************** TEST FUNCTIONS ********************************/
+
+void test_Alloc_SizeClasses(void)
+{
+	uint8_t* first = Arena_Alloc(&arena, 1);
+	uint8_t* second = Arena_Alloc(&arena, 17);
+	uint8_t* third = Arena_Alloc(&arena, 0);
+
+	/* Blocks are aligned and rounded up to their class after a header */
+	TEST_ASSERT_EQUAL_PTR((uint8_t*)arenaMemory + ARENA_HEADER_LENGTH, first);
+	TEST_ASSERT_EQUAL_PTR(first + 16 + ARENA_HEADER_LENGTH, second);
+	TEST_ASSERT_EQUAL_PTR(second + 32 + ARENA_HEADER_LENGTH, third);
+	TEST_ASSERT_EQUAL(0, (uintptr_t)third % ARENA_ALIGNMENT);
+
+	TEST_ASSERT_EQUAL(16 + 32 + 16 + (3 * ARENA_HEADER_LENGTH), Arena_GetHighWaterMark(&arena));
+
+	/* Larger than largest class */
+	TEST_ASSERT_NULL(Arena_Alloc(&arena, ARENA_MAX_BLOCK_LENGTH + 1));
+}
+
+void test_Init_AlignsMemory(void)
+{
+	uint8_t* block;
+
+	Arena_Init(&arena, (uint8_t*)arenaMemory + 3, sizeof(arenaMemory) - 3);
+
+	block = Arena_Alloc(&arena, 8);
+
+	TEST_ASSERT_EQUAL_PTR((uint8_t*)arenaMemory + ARENA_ALIGNMENT + ARENA_HEADER_LENGTH, block);
+}
+
+void test_Free_ReusesSameClass(void)
+{
+	uint8_t* first = Arena_Alloc(&arena, 100);
+	uint8_t* second = Arena_Alloc(&arena, 20);
+	uint32_t highWaterMark = Arena_GetHighWaterMark(&arena);
+
+	/* Block which is not on top goes to free list of its class */
+	Arena_Free(&arena, first);
+
+	TEST_ASSERT_EQUAL_PTR(first, Arena_Alloc(&arena, 128));
+	TEST_ASSERT_EQUAL(highWaterMark, Arena_GetHighWaterMark(&arena));
+
+	Arena_Free(&arena, first);
+
+	/* Other classes are bumped */
+	TEST_ASSERT_EQUAL_PTR(second + 32 + ARENA_HEADER_LENGTH, Arena_Alloc(&arena, 64));
+
+	Arena_Free(&arena, NULL);
+}
+
+void test_Free_TopBlockReturnsToArena(void)
+{
+	uint8_t* first = Arena_Alloc(&arena, 16);
+	uint8_t* second = Arena_Alloc(&arena, 256);
+
+	/* Top block is popped, so a block of another class takes its place */
+	Arena_Free(&arena, second);
+
+	TEST_ASSERT_EQUAL_PTR(second, Arena_Alloc(&arena, 512));
+	TEST_ASSERT_EQUAL_PTR(first + 16 + ARENA_HEADER_LENGTH, second);
+	TEST_ASSERT_EQUAL(16 + 512 + (2 * ARENA_HEADER_LENGTH), Arena_GetHighWaterMark(&arena));
+}
+
+void test_Alloc_Exhausted(void)
+{
+	uint32_t count = 0;
+
+	/* 64 byte blocks with headers fill arena exactly */
+	while (Arena_Alloc(&arena, 64) != NULL)
+	{
+		count++;
+	}
+
+	TEST_ASSERT_EQUAL(TEST_ARENA_LENGTH / (64 + ARENA_HEADER_LENGTH), count);
+	TEST_ASSERT_NULL(Arena_Alloc(&arena, 1));
+	TEST_ASSERT_TRUE(Arena_GetHighWaterMark(&arena) <= TEST_ARENA_LENGTH);
+}
+
+void test_Reset_ReleasesAllBlocks(void)
+{
+	uint8_t* first = Arena_Alloc(&arena, 40);
+	uint8_t* second = Arena_Alloc(&arena, 40);
+	uint32_t highWaterMark;
+
+	Arena_Free(&arena, first);
+	highWaterMark = Arena_GetHighWaterMark(&arena);
+
+	Arena_Reset(&arena);
+
+	/* Free lists are cleared and bumping starts from beginning */
+	TEST_ASSERT_EQUAL_PTR(first, Arena_Alloc(&arena, 500));
+	TEST_ASSERT_TRUE(second > first);
+
+	/* High water mark survives reset */
+	TEST_ASSERT_EQUAL(512 + ARENA_HEADER_LENGTH, Arena_GetHighWaterMark(&arena));
+	TEST_ASSERT_TRUE(Arena_GetHighWaterMark(&arena) > highWaterMark);
+}
+
+void test_Alloc_RandomBlocksDoNotOverlap(void)
+{
+	static uint64_t memory[(64 * 1024) / sizeof(uint64_t)];
+	TestBlock blocks[TEST_RANDOM_BLOCK_COUNT];
+	uint32_t seed = 1;
+	uint32_t operation;
+	uint32_t index;
+
+	Arena_Init(&arena, memory, sizeof(memory));
+	memset(blocks, 0, sizeof(blocks));
+
+	for (operation = 0; operation < TEST_RANDOM_OPERATION_COUNT; operation++)
+	{
+		index = nextRandom(&seed) % TEST_RANDOM_BLOCK_COUNT;
+
+		if (blocks[index].data != NULL)
+		{
+			/* Pattern is kept while other blocks are allocated and released */
+			TEST_ASSERT_TRUE(hasPattern(blocks[index].data, blocks[index].length, blocks[index].pattern));
+
+			Arena_Free(&arena, blocks[index].data);
+			blocks[index].data = NULL;
+		}
+		else
+		{
+			blocks[index].length = 1 + (nextRandom(&seed) % 600);
+			blocks[index].pattern = (uint8_t)operation;
+			blocks[index].data = Arena_Alloc(&arena, blocks[index].length);
+
+			TEST_ASSERT_NOT_NULL(blocks[index].data);
+			TEST_ASSERT_EQUAL(0, (uintptr_t)blocks[index].data % ARENA_ALIGNMENT);
+
+			memset(blocks[index].data, blocks[index].pattern, blocks[index].length);
+		}
+	}
+
+	for (index = 0; index < TEST_RANDOM_BLOCK_COUNT; index++)
+	{
+		if (blocks[index].data != NULL)
+		{
+			TEST_ASSERT_TRUE(hasPattern(blocks[index].data, blocks[index].length, blocks[index].pattern));
+		}
+	}
+
+	/* Reuse keeps arena bounded although blocks are never coalesced */
+	TEST_ASSERT_TRUE(Arena_GetHighWaterMark(&arena) <= sizeof(memory));
+}
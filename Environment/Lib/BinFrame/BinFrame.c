@@ -0,0 +1,210 @@
+/*******************************************************************************
+*
+* @file BinFrame.c
+*
+* @author MC
+*
+* @brief Binary Frame Library Implementation
+*
+*		 Payload bytes are copied in bulk, so parsing cost is dominated by
+*		 CRC calculation.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "BinFrame.h"
+#include "CRC32.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+/*
+ * Offsets of header fields
+ */
+#define BINFRAME_TYPE_OFFSET						(1)
+#define BINFRAME_LENGTH_OFFSET						(2)
+#define BINFRAME_ADDRESS_OFFSET						(4)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Writes a 32 bit value in little endian order
+ */
+PRIVATE ALWAYS_INLINE void writeLE32(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)value;
+	buffer[1] = (uint8_t)(value >> 8);
+	buffer[2] = (uint8_t)(value >> 16);
+	buffer[3] = (uint8_t)(value >> 24);
+}
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/**
+ * Initializes a streaming binary frame parser context
+ */
+void BinFrame_InitContext(BinFrameContext* context, uint8_t* payloadBuffer, uint32_t payloadBufferSize)
+{
+	memset(context, 0, sizeof(BinFrameContext));
+
+	context->payloadBuffer = payloadBuffer;
+	context->payloadBufferSize = payloadBufferSize;
+	context->frame.payload = payloadBuffer;
+}
+
+/**
+ * Sets payload locator of parser
+ */
+void BinFrame_SetPayloadLocator(BinFrameContext* context, BinFramePayloadLocator payloadLocator)
+{
+	context->payloadLocator = payloadLocator;
+}
+
+/**
+ * Feeds received bytes into streaming binary frame parser
+ */
+uint32_t BinFrame_Feed(BinFrameContext* context, const uint8_t* bytes, uint32_t length, BinFrameHandler frameHandler)
+{
+	BinFrame* frame = &context->frame;
+	BinFrameStatusCode status;
+	uint32_t index = 0;
+	uint32_t offset;
+	uint32_t copyLength;
+
+	while (index < length)
+	{
+		if (!context->inFrame)
+		{
+			/* Skip everything until a new frame starts */
+			if (bytes[index++] == BINFRAME_START_OF_FRAME)
+			{
+				context->inFrame = true;
+				context->receivedLength = 1;
+				context->calculatedCRC = CRC32_INITIAL_VALUE;
+				context->receivedCRC = 0;
+				frame->type = 0;
+				frame->length = 0;
+				frame->address = 0;
+			}
+
+			continue;
+		}
+
+		offset = context->receivedLength;
+
+		if (offset < BINFRAME_HEADER_LENGTH)
+		{
+			/* Header fields are collected byte by byte */
+			if (offset == BINFRAME_TYPE_OFFSET)
+			{
+				frame->type = bytes[index];
+			}
+			else if (offset < BINFRAME_ADDRESS_OFFSET)
+			{
+				frame->length |= (uint32_t)bytes[index] << ((offset - BINFRAME_LENGTH_OFFSET) * 8);
+			}
+			else
+			{
+				frame->address |= (uint32_t)bytes[index] << ((offset - BINFRAME_ADDRESS_OFFSET) * 8);
+			}
+
+			context->calculatedCRC = CRC32_Update(context->calculatedCRC, &bytes[index], 1);
+			context->receivedLength++;
+			index++;
+
+			if (context->receivedLength == BINFRAME_HEADER_LENGTH)
+			{
+				if (frame->length > context->payloadBufferSize)
+				{
+					/* Frame is discarded, parser resynchronizes on next SOF */
+					context->inFrame = false;
+					if (!frameHandler(BinFrame_Err_PayloadLengthExceedsAllowed, frame))
+					{
+						return index;
+					}
+
+					continue;
+				}
+
+				/* Client can receive payload into its final place */
+				frame->payload = (context->payloadLocator != NULL) ? context->payloadLocator(frame) : NULL;
+				if (frame->payload == NULL)
+				{
+					frame->payload = context->payloadBuffer;
+				}
+			}
+
+			continue;
+		}
+
+		offset -= BINFRAME_HEADER_LENGTH;
+
+		if (offset < frame->length)
+		{
+			/* Copy as much payload as available at once */
+			copyLength = MATH_MIN(frame->length - offset, length - index);
+
+			memcpy(&frame->payload[offset], &bytes[index], copyLength);
+			context->calculatedCRC = CRC32_Update(context->calculatedCRC, &bytes[index], copyLength);
+			context->receivedLength += copyLength;
+			index += copyLength;
+
+			continue;
+		}
+
+		offset -= frame->length;
+
+		context->receivedCRC |= (uint32_t)bytes[index] << (offset * 8);
+		context->receivedLength++;
+		index++;
+
+		if (offset == BINFRAME_CRC_LENGTH - 1)
+		{
+			/* Frame is completed */
+			context->inFrame = false;
+
+			status = (context->receivedCRC == context->calculatedCRC) ? BinFrame_Success : BinFrame_Err_CRCError;
+			if (!frameHandler(status, frame))
+			{
+				return index;
+			}
+		}
+	}
+
+	return index;
+}
+
+/**
+ * Encodes a frame
+ */
+uint32_t BinFrame_Encode(uint32_t type, uint32_t address, const uint8_t* payload, uint32_t length, uint8_t* frame)
+{
+	uint32_t crc;
+
+	frame[0] = BINFRAME_START_OF_FRAME;
+	frame[BINFRAME_TYPE_OFFSET] = (uint8_t)type;
+	frame[BINFRAME_LENGTH_OFFSET] = (uint8_t)length;
+	frame[BINFRAME_LENGTH_OFFSET + 1] = (uint8_t)(length >> 8);
+	writeLE32(&frame[BINFRAME_ADDRESS_OFFSET], address);
+
+	if (length > 0)
+	{
+		memcpy(&frame[BINFRAME_HEADER_LENGTH], payload, length);
+	}
+
+	crc = CRC32_Update(CRC32_INITIAL_VALUE, &frame[BINFRAME_TYPE_OFFSET], BINFRAME_HEADER_LENGTH - BINFRAME_TYPE_OFFSET + length);
+	writeLE32(&frame[BINFRAME_HEADER_LENGTH + length], crc);
+
+	return BINFRAME_FRAME_LENGTH(length);
+}
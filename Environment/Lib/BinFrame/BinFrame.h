@@ -0,0 +1,239 @@
+/*******************************************************************************
+ *
+ * @file BinFrame.h
+ *
+ * @author MC
+ *
+ * @brief Binary Frame Library
+ *
+ *		  Compact binary transport for firmware images. Each frame carries
+ *		  an address and up to BINFRAME_MAX_PAYLOAD_LENGTH bytes of raw data
+ *		  protected with CRC-32.
+ *
+ *		  Frame Format (multi byte fields are little endian)
+ *
+ *		  | SOF | Type | Length | Address | Payload  | CRC-32 |
+ *		  |  1  |  1   |   2    |    4    | <Length> |   4    |
+ *
+ *		  CRC-32 covers all fields between SOF and CRC.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __BIN_FRAME_H
+#define __BIN_FRAME_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/*
+ * Binary frames start with SOF (Start of Frame) byte.
+ *	It differs from Intel HEX prefix (':') so transport can be detected using
+ *	first received byte.
+ */
+#define BINFRAME_START_OF_FRAME							(0xA5)
+
+/* Length of frame header (SOF, Type, Length and Address) */
+#define BINFRAME_HEADER_LENGTH							(8)
+
+/* Length of CRC at the end of frame */
+#define BINFRAME_CRC_LENGTH								(4)
+
+/* Length of frame except payload */
+#define BINFRAME_OVERHEAD_LENGTH						(BINFRAME_HEADER_LENGTH + BINFRAME_CRC_LENGTH)
+
+/* Maximum payload length of a frame */
+#define BINFRAME_MAX_PAYLOAD_LENGTH						(4 * 1024)
+
+/* Length of a frame with its payload */
+#define BINFRAME_FRAME_LENGTH(payloadLength)			(BINFRAME_OVERHEAD_LENGTH + (payloadLength))
+
+/*
+ * Frame Types
+ */
+/* Payload is data which will be written to Address */
+#define BINFRAME_TYPE_DATA								(1)
+/*
+ * End of image, no payload. Address is number of sequenced data frames or
+ * zero if image is sent using DATA frames.
+ */
+#define BINFRAME_TYPE_END								(2)
+/*
+ * Sequenced data for acknowledged transfers. Address is sequence number and
+ * payload is BINFRAME_SEQ_PAYLOAD_LENGTH bytes of image (except last frame)
+ * from firmware start address.
+ */
+#define BINFRAME_TYPE_SEQ_DATA							(3)
+/*
+ * Acknowledge (ACK) and Negative Acknowledge (NAK) of sequenced frames.
+ *	Address is first sequence number which is not completed yet, all previous
+ *	frames are received. Payload is a 32 bit bitmap of received frames
+ *	starting from address followed by 32 bit receive window (number of frames
+ *	which are accepted starting from address).
+ */
+#define BINFRAME_TYPE_ACK								(4)
+#define BINFRAME_TYPE_NAK								(5)
+/*
+ * Part of a binary delta (see Delta.h) which transforms installed image into
+ * new image. Address is offset of payload in delta, frames are sent in order.
+ */
+#define BINFRAME_TYPE_PATCH								(6)
+/*
+ * Part of a compressed image (see LZSS.h) which is placed at firmware start
+ * address. Address is offset of payload in compressed stream, frames are
+ * sent in order.
+ */
+#define BINFRAME_TYPE_COMPRESSED						(7)
+
+/* Payload length of sequenced data frames */
+#define BINFRAME_SEQ_PAYLOAD_LENGTH						(256)
+
+/* Payload length of ACK and NAK frames */
+#define BINFRAME_ACK_PAYLOAD_LENGTH						(8)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Binary Frame Library Specific Status Codes
+ */
+typedef enum
+{
+	/* Frame is received successfully */
+	BinFrame_Success = 0,
+	/* Frame is corrupted */
+	BinFrame_Err_CRCError,
+	/* Frame payload does not fit into payload buffer */
+	BinFrame_Err_PayloadLengthExceedsAllowed
+} BinFrameStatusCode;
+
+/*
+ * Received Frame Details
+ */
+typedef struct
+{
+	/* Type of frame. BINFRAME_TYPE_ defines */
+	uint32_t type;
+	/* Length of payload */
+	uint32_t length;
+	/* Address of payload or sequence number (see frame types) */
+	uint32_t address;
+	/* Payload of frame */
+	uint8_t* payload;
+} BinFrame;
+
+/*
+ * Frame Handler which is called by BinFrame_Feed for each frame.
+ *
+ * @param status BinFrame_Success if frame is valid. Otherwise error code to
+ *		  inform about discarded frame.
+ * @param frame Received frame. Valid only if status is success and only
+ *		  during callback.
+ *
+ * @return true to continue parsing, false to stop parsing of remaining data
+ */
+typedef bool (*BinFrameHandler)(BinFrameStatusCode status, BinFrame* frame);
+
+/*
+ * Payload Locator which is called by BinFrame_Feed when header of a frame is
+ * received. Allows client to receive payload directly into its final place
+ * (e.g. flash write buffer) instead of payload buffer.
+ *
+ * @param frame Received header fields (type, length and address)
+ *
+ * @return Buffer for 'length' bytes of payload or NULL to use payload buffer.
+ *		   Payload is written before CRC is checked, so buffer must not keep
+ *		   valid data.
+ */
+typedef uint8_t* (*BinFramePayloadLocator)(const BinFrame* frame);
+
+/*
+ * Streaming Binary Frame Parser Context.
+ *	Fields are private to parser.
+ */
+typedef struct
+{
+	/* Frame which is being received */
+	BinFrame frame;
+	/* Buffer for payloads */
+	uint8_t* payloadBuffer;
+	/* Size of payload buffer */
+	uint32_t payloadBufferSize;
+	/* Optional locator for payloads, NULL if not used */
+	BinFramePayloadLocator payloadLocator;
+	/* Number of received bytes of current frame */
+	uint32_t receivedLength;
+	/* Running CRC of received bytes */
+	uint32_t calculatedCRC;
+	/* CRC which is received in frame */
+	uint32_t receivedCRC;
+	/* Parser is inside of a frame (after SOF) */
+	uint8_t inFrame;
+} BinFrameContext;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Initializes a streaming binary frame parser context.
+ *
+ * @param context Parser context to be initialized
+ * @param payloadBuffer Buffer which keeps payload of received frames
+ * @param payloadBufferSize Size of payload buffer. Frames with longer
+ *		  payloads are discarded.
+ *
+ * @return none
+ */
+void BinFrame_InitContext(BinFrameContext* context, uint8_t* payloadBuffer, uint32_t payloadBufferSize);
+
+/*
+ * Sets payload locator of parser.
+ *
+ * @param context Initialized parser context
+ * @param payloadLocator Called for each frame header. NULL to receive all
+ *		  payloads into payload buffer.
+ *
+ * @return none
+ */
+void BinFrame_SetPayloadLocator(BinFrameContext* context, BinFramePayloadLocator payloadLocator);
+
+/*
+ * Feeds received bytes into streaming binary frame parser.
+ *
+ *	Bytes can be split or glued at any position. Bytes outside of frames
+ *	are skipped until a SOF is received.
+ *
+ * @param context Parser context. Must be initialized using
+ *		  BinFrame_InitContext before first call.
+ * @param bytes Received bytes
+ * @param length Number of received bytes
+ * @param frameHandler Called for each received or discarded frame
+ *
+ * @return Number of consumed bytes. It is less than 'length' only if
+ *		   frameHandler requests to stop.
+ */
+uint32_t BinFrame_Feed(BinFrameContext* context, const uint8_t* bytes, uint32_t length, BinFrameHandler frameHandler);
+
+/*
+ * Encodes a frame.
+ *
+ * @param type Frame type. BINFRAME_TYPE_ defines
+ * @param address Address of payload
+ * @param payload Payload of frame
+ * @param length Length of payload. Must not exceed BINFRAME_MAX_PAYLOAD_LENGTH
+ * @param frame [out] Encoded frame. Must have BINFRAME_FRAME_LENGTH(length)
+ *		  bytes.
+ *
+ * @return Length of encoded frame
+ */
+uint32_t BinFrame_Encode(uint32_t type, uint32_t address, const uint8_t* payload, uint32_t length, uint8_t* frame);
+
+#endif	/* __BIN_FRAME_H */
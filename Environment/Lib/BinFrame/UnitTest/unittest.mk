@@ -0,0 +1,21 @@
+################################################################################
+#
+# @file unittest.mk
+#
+# @author MC
+#
+# @brief Unit test make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+TEST_TARGET_NAME=BinFrame
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ *
+ * @file unittest_BinFrame.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Binary Frame Library
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../../CRC32/CRC32.c"
+#include "../BinFrame.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Maximum number of frames which can be collected from parser */
+#define TEST_MAX_FRAME_COUNT			(16)
+
+/* Payload buffer size of parser */
+#define TEST_PAYLOAD_BUFFER_SIZE		(256)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Parser context and its payload buffer */
+PRIVATE BinFrameContext context;
+PRIVATE uint8_t payloadBuffer[TEST_PAYLOAD_BUFFER_SIZE];
+
+/* Frames and statuses emitted by parser */
+PRIVATE BinFrame frames[TEST_MAX_FRAME_COUNT];
+PRIVATE BinFrameStatusCode statuses[TEST_MAX_FRAME_COUNT];
+PRIVATE uint8_t payloads[TEST_MAX_FRAME_COUNT][TEST_PAYLOAD_BUFFER_SIZE];
+PRIVATE uint32_t frameCount;
+
+/* Encoded stream */
+PRIVATE uint8_t stream[1024];
+PRIVATE uint32_t streamLength;
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	frameCount = 0;
+	streamLength = 0;
+
+	BinFrame_InitContext(&context, payloadBuffer, sizeof(payloadBuffer));
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/*
+ * Collects frames emitted by parser
+ */
+PRIVATE bool collectFrame(BinFrameStatusCode status, BinFrame* frame)
+{
+	if (frameCount < TEST_MAX_FRAME_COUNT)
+	{
+		statuses[frameCount] = status;
+		frames[frameCount] = *frame;
+		memcpy(payloads[frameCount], frame->payload, MATH_MIN(frame->length, TEST_PAYLOAD_BUFFER_SIZE));
+		frameCount++;
+	}
+
+	return true;
+}
+
+/*
+ * Stops parsing after first frame
+ */
+PRIVATE bool collectFirstFrame(BinFrameStatusCode status, BinFrame* frame)
+{
+	collectFrame(status, frame);
+
+	return false;
+}
+
+/*
+ * Appends a frame to stream
+ */
+PRIVATE uint32_t appendFrame(uint32_t type, uint32_t address, const uint8_t* payload, uint32_t length)
+{
+	uint32_t frameLength = BinFrame_Encode(type, address, payload, length, &stream[streamLength]);
+
+	streamLength += frameLength;
+
+	return frameLength;
+}
+
+/*
+ * Appends a test frame set to stream
+ */
+PRIVATE void appendTestFrames(void)
+{
+	uint8_t payload[200];
+	uint32_t index;
+
+	for (index = 0; index < sizeof(payload); index++)
+	{
+		payload[index] = (uint8_t)(index * 7);
+	}
+
+	appendFrame(BINFRAME_TYPE_DATA, 0x10000, payload, sizeof(payload));
+	appendFrame(BINFRAME_TYPE_DATA, 0x100C8, payload, 3);
+	appendFrame(BINFRAME_TYPE_END, 0, NULL, 0);
+}
+
+/*
+ * Checks frames which are parsed from test frame set
+ */
+PRIVATE void checkTestFrames(void)
+{
+	TEST_ASSERT_EQUAL(3, frameCount);
+
+	TEST_ASSERT_EQUAL(BinFrame_Success, statuses[0]);
+	TEST_ASSERT_EQUAL(BINFRAME_TYPE_DATA, frames[0].type);
+	TEST_ASSERT_EQUAL_HEX32(0x10000, frames[0].address);
+	TEST_ASSERT_EQUAL(200, frames[0].length);
+	TEST_ASSERT_EQUAL_HEX8(199 * 7 & 0xFF, payloads[0][199]);
+
+	TEST_ASSERT_EQUAL(BinFrame_Success, statuses[1]);
+	TEST_ASSERT_EQUAL_HEX32(0x100C8, frames[1].address);
+	TEST_ASSERT_EQUAL(3, frames[1].length);
+	TEST_ASSERT_EQUAL_HEX8(14, payloads[1][2]);
+
+	TEST_ASSERT_EQUAL(BinFrame_Success, statuses[2]);
+	TEST_ASSERT_EQUAL(BINFRAME_TYPE_END, frames[2].type);
+	TEST_ASSERT_EQUAL(0, frames[2].length);
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+/*
+ * Tests CRC-32 check value
+ */
+void test_CRC32_CheckValue(void)
+{
+	const char* checkInput = "123456789";
+
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926, CRC32_Update(CRC32_INITIAL_VALUE, (const uint8_t*)checkInput, 9));
+
+	/* Incremental update gives same result */
+	TEST_ASSERT_EQUAL_HEX32(0xCBF43926, CRC32_Update(CRC32_Update(CRC32_INITIAL_VALUE, (const uint8_t*)checkInput, 4), (const uint8_t*)&checkInput[4], 5));
+}
+
+/*
+ * Tests encoded frame layout
+ */
+void test_Encode_Layout(void)
+{
+	const uint8_t payload[2] = { 0xAB, 0xCD };
+
+	TEST_ASSERT_EQUAL(BINFRAME_OVERHEAD_LENGTH + 2, appendFrame(BINFRAME_TYPE_DATA, 0x00010203, payload, sizeof(payload)));
+
+	TEST_ASSERT_EQUAL_HEX8(BINFRAME_START_OF_FRAME, stream[0]);
+	TEST_ASSERT_EQUAL_HEX8(BINFRAME_TYPE_DATA, stream[1]);
+	TEST_ASSERT_EQUAL_HEX8(0x02, stream[2]);
+	TEST_ASSERT_EQUAL_HEX8(0x00, stream[3]);
+	TEST_ASSERT_EQUAL_HEX8(0x03, stream[4]);
+	TEST_ASSERT_EQUAL_HEX8(0x02, stream[5]);
+	TEST_ASSERT_EQUAL_HEX8(0x01, stream[6]);
+	TEST_ASSERT_EQUAL_HEX8(0x00, stream[7]);
+	TEST_ASSERT_EQUAL_HEX8(0xAB, stream[8]);
+	TEST_ASSERT_EQUAL_HEX8(0xCD, stream[9]);
+}
+
+/*
+ * Tests frames which are fed at once and byte by byte
+ */
+void test_Feed_Chunks(void)
+{
+	uint32_t chunkLength;
+	uint32_t offset;
+	uint32_t length;
+
+	appendTestFrames();
+
+	for (chunkLength = 1; chunkLength <= streamLength; chunkLength += 13)
+	{
+		frameCount = 0;
+
+		for (offset = 0; offset < streamLength; offset += length)
+		{
+			length = MATH_MIN(chunkLength, streamLength - offset);
+			TEST_ASSERT_EQUAL(length, BinFrame_Feed(&context, &stream[offset], length, collectFrame));
+		}
+
+		checkTestFrames();
+	}
+}
+
+/*
+ * Tests corrupted frames and resynchronization on next frame
+ */
+void test_Feed_CorruptedFrames(void)
+{
+	uint8_t payload[4] = { 1, 2, 3, 4 };
+	uint32_t frameLength;
+
+	/* Noise before first frame */
+	stream[streamLength++] = 0x00;
+	stream[streamLength++] = ':';
+
+	/* CRC error */
+	frameLength = appendFrame(BINFRAME_TYPE_DATA, 0x10000, payload, sizeof(payload));
+	stream[streamLength - frameLength + BINFRAME_HEADER_LENGTH] ^= 0x80;
+
+	/* Payload longer than payload buffer */
+	BinFrame_Encode(BINFRAME_TYPE_DATA, 0x10000, NULL, 0, &stream[streamLength]);
+	stream[streamLength + 3] = 0x10;
+	streamLength += BINFRAME_HEADER_LENGTH;
+
+	appendTestFrames();
+
+	TEST_ASSERT_EQUAL(streamLength, BinFrame_Feed(&context, stream, streamLength, collectFrame));
+
+	TEST_ASSERT_EQUAL(5, frameCount);
+	TEST_ASSERT_EQUAL(BinFrame_Err_CRCError, statuses[0]);
+	TEST_ASSERT_EQUAL(BinFrame_Err_PayloadLengthExceedsAllowed, statuses[1]);
+
+	/* Parser is synchronized with next frames */
+	frameCount -= 2;
+	memmove(statuses, &statuses[2], sizeof(statuses[0]) * frameCount);
+	memmove(frames, &frames[2], sizeof(frames[0]) * frameCount);
+	memmove(payloads, &payloads[2], sizeof(payloads[0]) * frameCount);
+
+	checkTestFrames();
+}
+
+/*
+ * Tests stop request of frame handler
+ */
+void test_Feed_StopRequest(void)
+{
+	uint32_t consumedLength;
+
+	appendTestFrames();
+
+	consumedLength = BinFrame_Feed(&context, stream, streamLength, collectFirstFrame);
+
+	TEST_ASSERT_EQUAL(BINFRAME_FRAME_LENGTH(200), consumedLength);
+	TEST_ASSERT_EQUAL(1, frameCount);
+}
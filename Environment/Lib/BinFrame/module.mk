@@ -0,0 +1,32 @@
+################################################################################
+#
+# @file module.mk
+#
+# @author MC
+#
+# @brief Binary Frame Library module make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+#
+# Get all source files (.c files) using 'find' command except test folders
+#
+BINFRAME_SRC_FILES := $(shell /usr/bin/find $(ROOT_PATH)/Environment/Lib/BinFrame -mindepth 1 -maxdepth 1 -name "*.c")
+
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Environment/Lib/BinFrame
+
+# Binary frames are protected with CRC-32
+include $(ROOT_PATH)/Environment/Lib/CRC32/module.mk
+
+BINFRAME_SRC_FILES += $(CRC32_SRC_FILES)
@@ -0,0 +1,60 @@
+/*******************************************************************************
+*
+* @file CRC32.c
+*
+* @author MC
+*
+* @brief CRC-32 (IEEE 802.3) Implementation
+*
+*		 Uses a 16 entry (nibble) table to keep footprint small. It is fast
+*		 enough to check data at UART speeds.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "CRC32.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+/*
+ * CRC table for a nibble (reflected polynomial 0xEDB88320)
+ */
+PRIVATE const uint32_t crcNibbleTable[16] =
+{
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/**
+ * Updates CRC-32 with new data
+ */
+uint32_t CRC32_Update(uint32_t crc, const uint8_t* data, uint32_t length)
+{
+	crc = ~crc;
+
+	while (length-- > 0)
+	{
+		crc ^= *data++;
+		crc = (crc >> 4) ^ crcNibbleTable[crc & 0x0F];
+		crc = (crc >> 4) ^ crcNibbleTable[crc & 0x0F];
+	}
+
+	return ~crc;
+}
@@ -0,0 +1,50 @@
+/*******************************************************************************
+ *
+ * @file CRC32.h
+ *
+ * @author MC
+ *
+ * @brief CRC-32 (IEEE 802.3) Library
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __CRC32_H
+#define __CRC32_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Initial CRC value to start a new calculation */
+#define CRC32_INITIAL_VALUE						(0)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Updates CRC-32 with new data.
+ *
+ *	CRC can be calculated in parts. Start with CRC32_INITIAL_VALUE and pass
+ *	returned value to next call. Result is compatible with zlib crc32().
+ *
+ * @param crc CRC of previous data or CRC32_INITIAL_VALUE
+ * @param data Data to be added into CRC
+ * @param length Length of data
+ *
+ * @return Updated CRC
+ */
+uint32_t CRC32_Update(uint32_t crc, const uint8_t* data, uint32_t length);
+
+#endif	/* __CRC32_H */
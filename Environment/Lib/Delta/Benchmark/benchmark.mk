@@ -0,0 +1,41 @@
+################################################################################
+#
+# @file benchmark.mk
+#
+# @author MC
+#
+# @brief Benchmark make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+BENCH_TARGET_NAME = Delta
+
+include $(ROOT_PATH)/Environment/Lib/IntelHex/module.mk
+include $(ROOT_PATH)/Environment/Lib/BinFrame/module.mk
+
+# Host side delta generator
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Environment/Tools/ImageTool
+
+# Sources under benchmark
+BENCH_SRC_FILES = \
+	$(DELTA_SRC_FILES) \
+	$(INTELHEX_SRC_FILES) \
+	$(BINFRAME_SRC_FILES) \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/DeltaGenerator.c
+
+# Firmware images whose deltas are measured
+BENCH_ARGS = \
+	$(ROOT_PATH)/Bootloader/TestData/ER_IROM1 \
+	$(ROOT_PATH)/Bootloader/TestData/ER_IROM1.signed \
+	$(ROOT_PATH)/Bootloader/TestData/App.hex
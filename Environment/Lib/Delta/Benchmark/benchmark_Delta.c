@@ -0,0 +1,362 @@
+/*******************************************************************************
+ *
+ * @file benchmark_Delta.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for Binary Delta Updates.
+ *
+ *        Generates deltas of typical changes (modified function, inserted
+ *        code, appended code) for firmware images and reports patch size
+ *        against full image. Each delta is applied back and compared with
+ *        new image.
+ *
+ *        [USAGE] : benchmark_Delta <Image File> [Image File ...]
+ *
+ *          Image files are raw binary or Intel HEX files.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "Delta.h"
+#include "DeltaGenerator.h"
+#include "IntelHex.h"
+#include "BinFrame.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Images are mapped into LPC1768 flash (512K) */
+#define BENCH_FLASH_SIZE					(0x80000)
+
+/* Firmware area of LPC1768 consists of 32K sectors */
+#define BENCH_SECTOR_SIZE					(32 * 1024)
+
+/* Lengths of synthetic changes */
+#define BENCH_MODIFIED_LENGTH				(32)
+#define BENCH_INSERTED_LENGTH				(16)
+#define BENCH_APPENDED_LENGTH				(256)
+
+/* Number of measured runs of generator and decoder */
+#define BENCH_RUN_COUNT						(100)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Synthetic change of an image
+ */
+typedef enum
+{
+	Bench_Change_None = 0,
+	Bench_Change_ModifiedFunction,
+	Bench_Change_InsertedCode,
+	Bench_Change_AppendedCode,
+	Bench_Change_Count
+} BenchChange;
+
+/******************************** VARIABLES ***********************************/
+
+/* Flash content of loaded image, first and last address of Intel HEX data */
+PRIVATE uint8_t flash[BENCH_FLASH_SIZE];
+PRIVATE uint32_t flashStart;
+PRIVATE uint32_t flashEnd;
+PRIVATE uint32_t segmentAddress;
+
+/* Installed image, new image, delta and image produced by decoder */
+PRIVATE uint8_t source[BENCH_FLASH_SIZE];
+PRIVATE uint32_t sourceLength;
+PRIVATE uint8_t target[BENCH_FLASH_SIZE];
+PRIVATE uint32_t targetLength;
+PRIVATE uint8_t delta[BENCH_FLASH_SIZE + DELTA_HEADER_LENGTH + DELTA_MAX_INSTRUCTION_LENGTH];
+PRIVATE uint8_t output[BENCH_FLASH_SIZE];
+
+PRIVATE const char* changeNames[Bench_Change_Count] =
+{
+	"identical",
+	"modified function",
+	"inserted code",
+	"appended code"
+};
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns monotonic time in nanoseconds
+ */
+PRIVATE uint64_t getTimeInNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Places data lines of Intel HEX files into flash
+ */
+PRIVATE bool intelHexLineHandler(IntelHexStatusCode status, IntelHexLine* intelHexLine)
+{
+	uint32_t address;
+
+	if (status != IntelHex_Success)
+	{
+		return false;
+	}
+
+	if (intelHexLine->recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+	{
+		segmentAddress = ((intelHexLine->data[0] << 8) | intelHexLine->data[1]) * INTELHEX_SEGMENT_SIZE;
+	}
+	else if (intelHexLine->recordType == INTELHEX_RECORDTYPE_DATA)
+	{
+		address = segmentAddress + intelHexLine->address;
+		if (address + intelHexLine->lenght > BENCH_FLASH_SIZE)
+		{
+			return false;
+		}
+
+		memcpy(&flash[address], intelHexLine->data, intelHexLine->lenght);
+		flashStart = MATH_MIN(flashStart, address);
+		flashEnd = MATH_MAX(flashEnd, address + intelHexLine->lenght);
+	}
+
+	return true;
+}
+
+/*
+ * Loads image file as installed image
+ */
+PRIVATE bool loadImage(const char* fileName)
+{
+	IntelHexContext context;
+	FILE* file;
+	long fileSize;
+	uint8_t* content;
+
+	file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	content = malloc((size_t)fileSize + 1);
+	if ((content == NULL) || (fileSize > BENCH_FLASH_SIZE) || (fread(content, 1, (size_t)fileSize, file) != (size_t)fileSize))
+	{
+		free(content);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	if ((fileSize > 0) && (content[0] == INTELHEX_PREFIX))
+	{
+		memset(flash, 0xFF, sizeof(flash));
+		flashStart = BENCH_FLASH_SIZE;
+		flashEnd = 0;
+		segmentAddress = 0;
+
+		IntelHex_InitContext(&context);
+		IntelHex_Feed(&context, content, (uint32_t)fileSize, intelHexLineHandler);
+
+		sourceLength = (flashEnd > flashStart) ? (flashEnd - flashStart) : 0;
+		memcpy(source, &flash[flashStart], sourceLength);
+	}
+	else
+	{
+		sourceLength = (uint32_t)fileSize;
+		memcpy(source, content, sourceLength);
+	}
+
+	free(content);
+
+	return (sourceLength > BENCH_MODIFIED_LENGTH);
+}
+
+/*
+ * Builds new image by applying a synthetic change to installed image
+ */
+PRIVATE void buildTarget(BenchChange change)
+{
+	uint32_t position = sourceLength / 2;
+	uint32_t index;
+
+	memcpy(target, source, sourceLength);
+	targetLength = sourceLength;
+
+	switch (change)
+	{
+		case Bench_Change_ModifiedFunction:
+			for (index = 0; index < BENCH_MODIFIED_LENGTH; index++)
+			{
+				target[position + index] ^= (uint8_t)(0x5A + index);
+			}
+			break;
+		case Bench_Change_InsertedCode:
+			/* Following code is shifted */
+			position = sourceLength / 4;
+			memcpy(&target[position + BENCH_INSERTED_LENGTH], &source[position], sourceLength - position);
+			memset(&target[position], 0xA5, BENCH_INSERTED_LENGTH);
+			targetLength += BENCH_INSERTED_LENGTH;
+			break;
+		case Bench_Change_AppendedCode:
+			for (index = 0; index < BENCH_APPENDED_LENGTH; index++)
+			{
+				target[sourceLength + index] = (uint8_t)(index * 13);
+			}
+			targetLength += BENCH_APPENDED_LENGTH;
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Decoder reads installed image from RAM copy
+ */
+PRIVATE bool readSource(uint32_t offset, uint8_t* data, uint32_t length)
+{
+	memcpy(data, &source[offset], length);
+
+	return true;
+}
+
+/*
+ * Decoder produces new image into output buffer
+ */
+PRIVATE bool writeOutput(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	memcpy(&output[offset], data, length);
+
+	return true;
+}
+
+/*
+ * Accepts every header, source is not checked by benchmark
+ */
+PRIVATE bool acceptHeader(const DeltaHeader* header)
+{
+	return (header->targetLength <= sizeof(output));
+}
+
+/*
+ * Returns length of frame stream which carries given length of data
+ */
+PRIVATE uint32_t getStreamLength(uint32_t length)
+{
+	uint32_t frameCount = (length + BINFRAME_MAX_PAYLOAD_LENGTH - 1) / BINFRAME_MAX_PAYLOAD_LENGTH;
+
+	/* END frame is added */
+	return length + ((frameCount + 1) * BINFRAME_OVERHEAD_LENGTH);
+}
+
+/*
+ * Generates and applies delta of a change, prints its results
+ */
+PRIVATE bool runChange(BenchChange change)
+{
+	static const DeltaHandlers handlers = { acceptHeader, readSource, writeOutput };
+	DeltaContext context;
+	uint32_t deltaLength = 0;
+	uint32_t run;
+	uint64_t startTime;
+	uint64_t generateTime;
+	uint64_t applyTime;
+
+	buildTarget(change);
+
+	startTime = getTimeInNs();
+	for (run = 0; run < BENCH_RUN_COUNT; run++)
+	{
+		deltaLength = DeltaGenerator_Generate(source, sourceLength, target, targetLength, BENCH_SECTOR_SIZE, delta, sizeof(delta));
+	}
+	generateTime = (getTimeInNs() - startTime) / BENCH_RUN_COUNT;
+
+	if (deltaLength == 0)
+	{
+		return false;
+	}
+
+	startTime = getTimeInNs();
+	for (run = 0; run < BENCH_RUN_COUNT; run++)
+	{
+		Delta_InitContext(&context, &handlers);
+		Delta_Feed(&context, delta, deltaLength);
+	}
+	applyTime = (getTimeInNs() - startTime) / BENCH_RUN_COUNT;
+
+	if (!Delta_IsCompleted(&context) || (memcmp(output, target, targetLength) != 0))
+	{
+		return false;
+	}
+
+	printf("  %-18s : %7u -> %7u bytes (%5.1f %%), stream %7u -> %7u bytes, generate %8.1f us, apply %6.1f us\n",
+		   changeNames[change],
+		   targetLength,
+		   deltaLength,
+		   (100.0 * deltaLength) / targetLength,
+		   getStreamLength(targetLength),
+		   getStreamLength(deltaLength),
+		   generateTime / 1000.0,
+		   applyTime / 1000.0);
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(int argc, char* argv[])
+{
+	int fileNo;
+	uint32_t change;
+
+	if (argc < 2)
+	{
+		printf("Usage : %s <Image File> [Image File ...]\n", argv[0]);
+		return RESULT_FAIL;
+	}
+
+	printf("\nBinary Delta Benchmark (patch size vs full image)\n");
+
+	for (fileNo = 1; fileNo < argc; fileNo++)
+	{
+		if (!loadImage(argv[fileNo]))
+		{
+			printf("Image File could not be loaded : %s\n", argv[fileNo]);
+			return RESULT_FAIL;
+		}
+
+		printf("\n %s (%u bytes)\n", argv[fileNo], sourceLength);
+
+		for (change = 0; change < Bench_Change_Count; change++)
+		{
+			if (!runChange((BenchChange)change))
+			{
+				printf("Delta of %s could not be applied!\n", changeNames[change]);
+				return RESULT_FAIL;
+			}
+		}
+	}
+
+	return RESULT_SUCCESS;
+}
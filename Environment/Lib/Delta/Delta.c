@@ -0,0 +1,306 @@
+/*******************************************************************************
+*
+* @file Delta.c
+*
+* @author MC
+*
+* @brief Streaming Binary Delta Decoder Implementation
+*
+*		 Inserted data is passed to client directly from received bytes,
+*		 only copied source chunks are buffered.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "Delta.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+/*
+ * Offsets of header fields
+ */
+#define DELTA_MAGIC_OFFSET							(0)
+#define DELTA_SOURCE_LENGTH_OFFSET					(4)
+#define DELTA_SOURCE_CRC_OFFSET						(8)
+#define DELTA_TARGET_LENGTH_OFFSET					(12)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Decoder states, field of delta which is expected next
+ */
+typedef enum
+{
+	Delta_State_Header = 0,
+	Delta_State_Opcode,
+	Delta_State_Length,
+	Delta_State_SourceOffset,
+	Delta_State_InsertData
+} DeltaState;
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Writes a 32 bit value in little endian order
+ */
+PRIVATE ALWAYS_INLINE void storeLE32(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)value;
+	buffer[1] = (uint8_t)(value >> 8);
+	buffer[2] = (uint8_t)(value >> 16);
+	buffer[3] = (uint8_t)(value >> 24);
+}
+
+/*
+ * Reads a 32 bit value in little endian order
+ */
+PRIVATE ALWAYS_INLINE uint32_t loadLE32(const uint8_t* buffer)
+{
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+/*
+ * Encodes an unsigned LEB128 number
+ */
+PRIVATE uint32_t encodeNumber(uint32_t value, uint8_t* buffer)
+{
+	uint32_t length = 0;
+
+	while (value >= 0x80)
+	{
+		buffer[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+
+	buffer[length++] = (uint8_t)value;
+
+	return length;
+}
+
+/*
+ * Processes completed header
+ */
+PRIVATE DeltaStatusCode processHeader(DeltaContext* context)
+{
+	if (loadLE32(&context->headerBuffer[DELTA_MAGIC_OFFSET]) != DELTA_MAGIC)
+	{
+		return Delta_Err_InvalidFormat;
+	}
+
+	context->header.sourceLength = loadLE32(&context->headerBuffer[DELTA_SOURCE_LENGTH_OFFSET]);
+	context->header.sourceCRC = loadLE32(&context->headerBuffer[DELTA_SOURCE_CRC_OFFSET]);
+	context->header.targetLength = loadLE32(&context->headerBuffer[DELTA_TARGET_LENGTH_OFFSET]);
+
+	if (!context->handlers->headerHandler(&context->header))
+	{
+		return Delta_Err_Rejected;
+	}
+
+	context->state = Delta_State_Opcode;
+
+	return Delta_Success;
+}
+
+/*
+ * Processes a decoded number of current instruction
+ */
+PRIVATE DeltaStatusCode processNumber(DeltaContext* context)
+{
+	uint32_t sourceOffset;
+	uint32_t chunkLength;
+
+	if (context->state == Delta_State_Length)
+	{
+		/* Instructions must produce data within target image */
+		if ((context->number == 0) || (context->number > context->header.targetLength - context->targetOffset))
+		{
+			return Delta_Err_InvalidFormat;
+		}
+
+		context->length = context->number;
+		context->state = (context->opcode == DELTA_OP_COPY) ? Delta_State_SourceOffset : Delta_State_InsertData;
+
+		return Delta_Success;
+	}
+
+	/* Source offset of COPY instruction, copy is executed at once */
+	sourceOffset = context->number;
+
+	if ((sourceOffset > context->header.sourceLength) || (context->length > context->header.sourceLength - sourceOffset))
+	{
+		return Delta_Err_InvalidFormat;
+	}
+
+	while (context->length > 0)
+	{
+		chunkLength = MATH_MIN(context->length, DELTA_COPY_CHUNK_LENGTH);
+
+		if (!context->handlers->sourceReader(sourceOffset, context->copyBuffer, chunkLength))
+		{
+			return Delta_Err_SourceReadFailure;
+		}
+
+		if (!context->handlers->outputHandler(context->targetOffset, context->copyBuffer, chunkLength))
+		{
+			return Delta_Err_OutputFailure;
+		}
+
+		sourceOffset += chunkLength;
+		context->targetOffset += chunkLength;
+		context->length -= chunkLength;
+	}
+
+	context->state = Delta_State_Opcode;
+
+	return Delta_Success;
+}
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/**
+ * Initializes a streaming delta decoder context
+ */
+void Delta_InitContext(DeltaContext* context, const DeltaHandlers* handlers)
+{
+	memset(context, 0, sizeof(DeltaContext));
+
+	context->handlers = handlers;
+	context->status = Delta_Success;
+	context->state = Delta_State_Header;
+}
+
+/**
+ * Feeds received delta bytes into decoder
+ */
+DeltaStatusCode Delta_Feed(DeltaContext* context, const uint8_t* bytes, uint32_t length)
+{
+	uint32_t index = 0;
+	uint32_t copyLength;
+
+	while ((index < length) && (context->status == Delta_Success))
+	{
+		switch (context->state)
+		{
+			case Delta_State_Header:
+				copyLength = MATH_MIN(DELTA_HEADER_LENGTH - context->headerLength, length - index);
+
+				memcpy(&context->headerBuffer[context->headerLength], &bytes[index], copyLength);
+				context->headerLength += copyLength;
+				index += copyLength;
+
+				if (context->headerLength == DELTA_HEADER_LENGTH)
+				{
+					context->status = processHeader(context);
+				}
+				break;
+			case Delta_State_Opcode:
+				context->opcode = bytes[index++];
+
+				/* Nothing can follow completed target image */
+				if (((context->opcode != DELTA_OP_COPY) && (context->opcode != DELTA_OP_INSERT)) ||
+					(context->targetOffset == context->header.targetLength))
+				{
+					context->status = Delta_Err_InvalidFormat;
+					break;
+				}
+
+				context->number = 0;
+				context->numberShift = 0;
+				context->state = Delta_State_Length;
+				break;
+			case Delta_State_Length:
+			case Delta_State_SourceOffset:
+				/* Numbers are collected 7 bits per byte, last byte has MSB cleared */
+				if ((context->numberShift > 28) || ((context->numberShift == 28) && (bytes[index] > 0x0F)))
+				{
+					context->status = Delta_Err_InvalidFormat;
+					break;
+				}
+
+				context->number |= (uint32_t)(bytes[index] & 0x7F) << context->numberShift;
+				context->numberShift += 7;
+
+				if ((bytes[index++] & 0x80) == 0)
+				{
+					context->status = processNumber(context);
+					context->number = 0;
+					context->numberShift = 0;
+				}
+				break;
+			case Delta_State_InsertData:
+				/* Inserted data is produced as much as available at once */
+				copyLength = MATH_MIN(context->length, length - index);
+
+				if (!context->handlers->outputHandler(context->targetOffset, &bytes[index], copyLength))
+				{
+					context->status = Delta_Err_OutputFailure;
+					break;
+				}
+
+				context->targetOffset += copyLength;
+				context->length -= copyLength;
+				index += copyLength;
+
+				if (context->length == 0)
+				{
+					context->state = Delta_State_Opcode;
+				}
+				break;
+			default:
+				context->status = Delta_Err_InvalidFormat;
+				break;
+		}
+	}
+
+	return context->status;
+}
+
+/**
+ * Checks whether whole target image is produced
+ */
+bool Delta_IsCompleted(const DeltaContext* context)
+{
+	return (context->status == Delta_Success) &&
+		   (context->state == Delta_State_Opcode) &&
+		   (context->targetOffset == context->header.targetLength);
+}
+
+/**
+ * Encodes delta header
+ */
+uint32_t Delta_EncodeHeader(const DeltaHeader* header, uint8_t* buffer)
+{
+	storeLE32(&buffer[DELTA_MAGIC_OFFSET], DELTA_MAGIC);
+	storeLE32(&buffer[DELTA_SOURCE_LENGTH_OFFSET], header->sourceLength);
+	storeLE32(&buffer[DELTA_SOURCE_CRC_OFFSET], header->sourceCRC);
+	storeLE32(&buffer[DELTA_TARGET_LENGTH_OFFSET], header->targetLength);
+
+	return DELTA_HEADER_LENGTH;
+}
+
+/**
+ * Encodes an instruction
+ */
+uint32_t Delta_EncodeInstruction(uint8_t opcode, uint32_t length, uint32_t sourceOffset, uint8_t* buffer)
+{
+	uint32_t encodedLength = 0;
+
+	buffer[encodedLength++] = opcode;
+	encodedLength += encodeNumber(length, &buffer[encodedLength]);
+
+	if (opcode == DELTA_OP_COPY)
+	{
+		encodedLength += encodeNumber(sourceOffset, &buffer[encodedLength]);
+	}
+
+	return encodedLength;
+}
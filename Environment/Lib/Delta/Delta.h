@@ -0,0 +1,199 @@
+/*******************************************************************************
+ *
+ * @file Delta.h
+ *
+ * @author MC
+ *
+ * @brief Streaming Binary Delta (Patch) Decoder.
+ *
+ *		  A delta transforms a source image (currently installed firmware)
+ *		  into a target image. It starts with a header and continues with
+ *		  instructions which produce target image in ascending order:
+ *
+ *		  Header      : Magic | Source Length | Source CRC | Target Length
+ *		  (4 bytes each, little endian, CRC is CRC-32 of source image)
+ *
+ *		  COPY        : DELTA_OP_COPY   | Length | Source Offset
+ *		  INSERT      : DELTA_OP_INSERT | Length | Data (Length bytes)
+ *
+ *		  Length and Source Offset are unsigned LEB128 numbers. Decoder
+ *		  keeps a single copy chunk, so RAM usage does not depend on
+ *		  image size.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __DELTA_H
+#define __DELTA_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Magic of delta header ("SPDL") */
+#define DELTA_MAGIC									(0x4C445053)
+
+/* Length of delta header */
+#define DELTA_HEADER_LENGTH							(16)
+
+/*
+ * Instruction Opcodes
+ */
+/* Copies Length bytes from Source Offset of source image */
+#define DELTA_OP_COPY								(1)
+/* Inserts following Length bytes */
+#define DELTA_OP_INSERT								(2)
+
+/* Maximum length of an encoded 32 bit number */
+#define DELTA_MAX_NUMBER_LENGTH						(5)
+
+/* Maximum length of an encoded instruction except inserted data */
+#define DELTA_MAX_INSTRUCTION_LENGTH				(1 + (2 * DELTA_MAX_NUMBER_LENGTH))
+
+/* Source image is read in chunks of this length for COPY instructions */
+#define DELTA_COPY_CHUNK_LENGTH						(256)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Delta Library Specific Status Codes
+ */
+typedef enum
+{
+	Delta_Success = 0,
+	/* Delta is corrupted or does not match its header */
+	Delta_Err_InvalidFormat,
+	/* Header is rejected by client (e.g. source does not match) */
+	Delta_Err_Rejected,
+	/* Source image could not be read */
+	Delta_Err_SourceReadFailure,
+	/* Target image could not be written */
+	Delta_Err_OutputFailure
+} DeltaStatusCode;
+
+/*
+ * Delta Header
+ */
+typedef struct
+{
+	/* Length of source image */
+	uint32_t sourceLength;
+	/* CRC-32 of source image */
+	uint32_t sourceCRC;
+	/* Length of target image */
+	uint32_t targetLength;
+} DeltaHeader;
+
+/*
+ * Client callbacks of decoder. Each callback returns false to stop decoding.
+ */
+typedef struct
+{
+	/* Called once when header is received, before any other callback */
+	bool (*headerHandler)(const DeltaHeader* header);
+	/* Reads 'length' bytes of source image from 'offset' */
+	bool (*sourceReader)(uint32_t offset, uint8_t* data, uint32_t length);
+	/* Writes next 'length' bytes of target image at 'offset' */
+	bool (*outputHandler)(uint32_t offset, const uint8_t* data, uint32_t length);
+} DeltaHandlers;
+
+/*
+ * Streaming Delta Decoder Context.
+ *	Fields are private to decoder.
+ */
+typedef struct
+{
+	/* Client callbacks */
+	const DeltaHandlers* handlers;
+	/* Received header */
+	DeltaHeader header;
+	/* Status of decoding, an error stops decoding */
+	DeltaStatusCode status;
+	/* Current field of delta which is being decoded */
+	uint8_t state;
+	/* Opcode of current instruction */
+	uint8_t opcode;
+	/* Received part of header */
+	uint8_t headerBuffer[DELTA_HEADER_LENGTH];
+	uint32_t headerLength;
+	/* Number which is being decoded and its bit position */
+	uint32_t number;
+	uint32_t numberShift;
+	/* Remaining length of current instruction */
+	uint32_t length;
+	/* Produced length of target image */
+	uint32_t targetOffset;
+	/* Buffer for source image chunks */
+	uint8_t copyBuffer[DELTA_COPY_CHUNK_LENGTH];
+} DeltaContext;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Initializes a streaming delta decoder context.
+ *
+ * @param context Decoder context to be initialized
+ * @param handlers Client callbacks. Must be valid while decoding.
+ *
+ * @return none
+ */
+void Delta_InitContext(DeltaContext* context, const DeltaHandlers* handlers);
+
+/*
+ * Feeds received delta bytes into decoder.
+ *
+ *	Bytes can be split at any position. Target image is produced using
+ *	callbacks while delta is fed.
+ *
+ * @param context Decoder context. Must be initialized using
+ *		  Delta_InitContext before first call.
+ * @param bytes Received bytes of delta
+ * @param length Number of received bytes
+ *
+ * @return Delta_Success or error which stopped decoding. Errors are kept,
+ *		   later calls return same error.
+ */
+DeltaStatusCode Delta_Feed(DeltaContext* context, const uint8_t* bytes, uint32_t length);
+
+/*
+ * Checks whether whole target image is produced.
+ *
+ * @param context Decoder context
+ *
+ * @return true if header is received and target image is completed
+ */
+bool Delta_IsCompleted(const DeltaContext* context);
+
+/*
+ * Encodes delta header.
+ *
+ * @param header Header to be encoded
+ * @param buffer [out] Encoded header. Must have DELTA_HEADER_LENGTH bytes.
+ *
+ * @return Length of encoded header
+ */
+uint32_t Delta_EncodeHeader(const DeltaHeader* header, uint8_t* buffer);
+
+/*
+ * Encodes an instruction. Data of INSERT instruction must follow it.
+ *
+ * @param opcode DELTA_OP_ defines
+ * @param length Length of produced target data
+ * @param sourceOffset Offset in source image, only for COPY
+ * @param buffer [out] Encoded instruction. Must have
+ *		  DELTA_MAX_INSTRUCTION_LENGTH bytes.
+ *
+ * @return Length of encoded instruction
+ */
+uint32_t Delta_EncodeInstruction(uint8_t opcode, uint32_t length, uint32_t sourceOffset, uint8_t* buffer);
+
+#endif	/* __DELTA_H */
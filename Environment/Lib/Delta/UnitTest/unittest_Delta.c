@@ -0,0 +1,280 @@
+/*******************************************************************************
+ *
+ * @file unittest_Delta.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Binary Delta Library
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../Delta.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Length of source image, longer than a copy chunk */
+#define TEST_SOURCE_LENGTH				(600)
+
+/* Maximum length of target image */
+#define TEST_TARGET_MAX_LENGTH			(1024)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+PRIVATE bool handleHeader(const DeltaHeader* header);
+PRIVATE bool readSource(uint32_t offset, uint8_t* data, uint32_t length);
+PRIVATE bool writeTarget(uint32_t offset, const uint8_t* data, uint32_t length);
+
+/******************************** VARIABLES ***********************************/
+
+PRIVATE const DeltaHandlers handlers = { handleHeader, readSource, writeTarget };
+
+PRIVATE DeltaContext context;
+
+/* Source and produced target images */
+PRIVATE uint8_t source[TEST_SOURCE_LENGTH];
+PRIVATE uint8_t target[TEST_TARGET_MAX_LENGTH];
+PRIVATE uint32_t targetLength;
+
+/* Header handler result and number of calls */
+PRIVATE bool acceptHeader;
+PRIVATE uint32_t headerCount;
+
+/* Encoded delta */
+PRIVATE uint8_t delta[TEST_TARGET_MAX_LENGTH];
+PRIVATE uint32_t deltaLength;
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	uint32_t index;
+
+	for (index = 0; index < TEST_SOURCE_LENGTH; index++)
+	{
+		source[index] = (uint8_t)(index * 7);
+	}
+
+	memset(target, 0, sizeof(target));
+	targetLength = 0;
+	acceptHeader = true;
+	headerCount = 0;
+	deltaLength = 0;
+
+	Delta_InitContext(&context, &handlers);
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+PRIVATE bool handleHeader(const DeltaHeader* header)
+{
+	(void)header;
+
+	headerCount++;
+
+	return acceptHeader;
+}
+
+PRIVATE bool readSource(uint32_t offset, uint8_t* data, uint32_t length)
+{
+	TEST_ASSERT(length <= DELTA_COPY_CHUNK_LENGTH);
+
+	memcpy(data, &source[offset], length);
+
+	return true;
+}
+
+/*
+ * Collects target image, it must be produced in ascending order
+ */
+PRIVATE bool writeTarget(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	TEST_ASSERT_EQUAL(targetLength, offset);
+
+	memcpy(&target[offset], data, length);
+	targetLength += length;
+
+	return true;
+}
+
+/*
+ * Appends header to delta
+ */
+PRIVATE void appendHeader(uint32_t targetLength)
+{
+	DeltaHeader header = { TEST_SOURCE_LENGTH, 0, targetLength };
+
+	deltaLength += Delta_EncodeHeader(&header, &delta[deltaLength]);
+}
+
+/*
+ * Appends an instruction to delta
+ */
+PRIVATE void appendInstruction(uint8_t opcode, uint32_t length, uint32_t sourceOffset, const char* data)
+{
+	deltaLength += Delta_EncodeInstruction(opcode, length, sourceOffset, &delta[deltaLength]);
+
+	if (data != NULL)
+	{
+		memcpy(&delta[deltaLength], data, length);
+		deltaLength += length;
+	}
+}
+
+/*
+ * Appends delta which copies around an insertion
+ */
+PRIVATE void appendTestDelta(void)
+{
+	appendHeader(10 + 3 + 300);
+	appendInstruction(DELTA_OP_COPY, 10, 5, NULL);
+	appendInstruction(DELTA_OP_INSERT, 3, 0, "xyz");
+	appendInstruction(DELTA_OP_COPY, 300, 290, NULL);
+}
+
+/*
+ * Checks target image which is produced by test delta
+ */
+PRIVATE void checkTestTarget(void)
+{
+	TEST_ASSERT_EQUAL(313, targetLength);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(&source[5], target, 10);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY("xyz", &target[10], 3);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(&source[290], &target[13], 300);
+	TEST_ASSERT_TRUE(Delta_IsCompleted(&context));
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+void test_Decode_CopyAndInsert(void)
+{
+	appendTestDelta();
+
+	TEST_ASSERT_FALSE(Delta_IsCompleted(&context));
+	TEST_ASSERT_EQUAL(Delta_Success, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(1, headerCount);
+
+	checkTestTarget();
+}
+
+void test_Decode_SplitStream(void)
+{
+	uint32_t index;
+
+	appendTestDelta();
+
+	/* Every field is split */
+	for (index = 0; index < deltaLength; index++)
+	{
+		TEST_ASSERT_EQUAL(Delta_Success, Delta_Feed(&context, &delta[index], 1));
+	}
+
+	checkTestTarget();
+}
+
+void test_Decode_HeaderRejected(void)
+{
+	acceptHeader = false;
+	appendTestDelta();
+
+	TEST_ASSERT_EQUAL(Delta_Err_Rejected, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(0, targetLength);
+
+	/* Error is kept */
+	TEST_ASSERT_EQUAL(Delta_Err_Rejected, Delta_Feed(&context, delta, 1));
+	TEST_ASSERT_FALSE(Delta_IsCompleted(&context));
+}
+
+void test_Decode_InvalidMagic(void)
+{
+	appendTestDelta();
+	delta[0] ^= 0xFF;
+
+	TEST_ASSERT_EQUAL(Delta_Err_InvalidFormat, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(0, headerCount);
+}
+
+void test_Decode_CopyExceedsSource(void)
+{
+	appendHeader(20);
+	appendInstruction(DELTA_OP_COPY, 20, TEST_SOURCE_LENGTH - 10, NULL);
+
+	TEST_ASSERT_EQUAL(Delta_Err_InvalidFormat, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(0, targetLength);
+}
+
+void test_Decode_InstructionExceedsTarget(void)
+{
+	appendHeader(2);
+	appendInstruction(DELTA_OP_INSERT, 3, 0, "xyz");
+
+	TEST_ASSERT_EQUAL(Delta_Err_InvalidFormat, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(0, targetLength);
+}
+
+void test_Decode_InvalidInstruction(void)
+{
+	static const uint8_t unknownOpcode[] = { 0x7F };
+	static const uint8_t longNumber[] = { DELTA_OP_INSERT, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F };
+
+	appendHeader(4);
+	TEST_ASSERT_EQUAL(Delta_Success, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(Delta_Err_InvalidFormat, Delta_Feed(&context, unknownOpcode, sizeof(unknownOpcode)));
+
+	/* Numbers must fit into 32 bits */
+	Delta_InitContext(&context, &handlers);
+	TEST_ASSERT_EQUAL(Delta_Success, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(Delta_Err_InvalidFormat, Delta_Feed(&context, longNumber, sizeof(longNumber)));
+}
+
+void test_Decode_DataAfterTarget(void)
+{
+	appendHeader(3);
+	appendInstruction(DELTA_OP_INSERT, 3, 0, "xyz");
+	appendInstruction(DELTA_OP_INSERT, 1, 0, "!");
+
+	TEST_ASSERT_EQUAL(Delta_Err_InvalidFormat, Delta_Feed(&context, delta, deltaLength));
+	TEST_ASSERT_EQUAL(3, targetLength);
+}
+
+void test_Encode_Instruction(void)
+{
+	uint8_t buffer[DELTA_MAX_INSTRUCTION_LENGTH];
+
+	/* Small numbers take a single byte */
+	TEST_ASSERT_EQUAL(2, Delta_EncodeInstruction(DELTA_OP_INSERT, 127, 0, buffer));
+	TEST_ASSERT_EQUAL(4, Delta_EncodeInstruction(DELTA_OP_COPY, 1, 128, buffer));
+	TEST_ASSERT_EQUAL_HEX8(0x80, buffer[2]);
+	TEST_ASSERT_EQUAL_HEX8(0x01, buffer[3]);
+
+	TEST_ASSERT_EQUAL(DELTA_MAX_INSTRUCTION_LENGTH, Delta_EncodeInstruction(DELTA_OP_COPY, 0xFFFFFFFF, 0xFFFFFFFF, buffer));
+}
@@ -0,0 +1,27 @@
+################################################################################
+#
+# @file module.mk
+#
+# @author MC
+#
+# @brief Binary Delta Library module make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+#
+# Get all source files (.c files) using 'find' command except test folders
+#
+DELTA_SRC_FILES := $(shell /usr/bin/find $(ROOT_PATH)/Environment/Lib/Delta -mindepth 1 -maxdepth 1 -name "*.c")
+
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Environment/Lib/Delta
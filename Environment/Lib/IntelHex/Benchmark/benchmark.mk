@@ -0,0 +1,27 @@
+################################################################################
+#
+# @file benchmark.mk
+#
+# @author MC
+#
+# @brief Benchmark make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+BENCH_TARGET_NAME = IntelHex
+
+# Sources under benchmark
+BENCH_SRC_FILES = $(INTELHEX_SRC_FILES)
+
+# Intel HEX file which is parsed during benchmark
+BENCH_ARGS = $(ROOT_PATH)/Bootloader/TestData/App.hex
@@ -0,0 +1,318 @@
+/*******************************************************************************
+ *
+ * @file benchmark_IntelHex.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for Intel HEX Parser.
+ *
+ *        Compares table driven parser (IntelHex_Parse) with previous sscanf
+ *        based parser on an Intel HEX file and reports parsed records per
+ *        second for both parsers.
+ *
+ *        [USAGE] : benchmark_IntelHex <Intel HEX File>
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "IntelHex.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Maximum record count which can be loaded from Intel HEX File */
+#define BENCH_MAX_RECORD_COUNT				(16 * 1024)
+
+/* Minimum measurement duration for each parser */
+#define BENCH_MIN_DURATION_IN_NS			(1000000000ULL)
+
+/* Header format and length of sscanf based parser */
+#define LEGACY_INTELHEX_HEADER_FORMAT		":%2x%4x%2x"
+#define LEGACY_INTELHEX_HEADER_LENGTH		(9)
+#define LEGACY_INTELHEX_LINE_LENGTH(len)	(LEGACY_INTELHEX_HEADER_LENGTH + ((len) * 2) + 2)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/* Parser function type to benchmark different implementations */
+typedef IntelHexStatusCode (*IntelHexParser)(uint8_t* intelHexStr, uint32_t intelHexStrLen, IntelHexLine* intelHexLine, uint32_t* parsedLineLength);
+
+/*
+ * A record (line) of Intel HEX File
+ */
+typedef struct
+{
+	/* NULL terminated record string */
+	uint8_t* str;
+	/* Length of record string */
+	uint32_t length;
+} BenchRecord;
+
+/******************************** VARIABLES ***********************************/
+
+/* Records which are loaded from Intel HEX file */
+PRIVATE BenchRecord records[BENCH_MAX_RECORD_COUNT];
+PRIVATE uint32_t recordCount;
+
+/* Avoids dead code elimination of parse results */
+PRIVATE volatile uint32_t benchSink;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * sscanf based Intel HEX Parser which is replaced by table driven parser.
+ *	Kept here as reference of benchmark.
+ */
+PRIVATE IntelHexStatusCode LegacyIntelHex_Parse(uint8_t* intelHexStr, uint32_t intelHexStrLength, IntelHexLine* intelHexLine, uint32_t* parsedLineLength)
+{
+	uint32_t index;
+	uint8_t* dataPtr;
+	uint8_t crcSum;
+	uint32_t value;
+	uint32_t intelHexLineLength;
+	char* secondPrefixPtr;
+
+	*parsedLineLength = 0;
+
+	if (intelHexStrLength < LEGACY_INTELHEX_HEADER_LENGTH)
+	{
+		*parsedLineLength = intelHexStrLength;
+		return IntelHex_Err_MissingLine;
+	}
+
+	sscanf((char*)intelHexStr, LEGACY_INTELHEX_HEADER_FORMAT,
+		&intelHexLine->lenght,
+		&intelHexLine->address,
+		&intelHexLine->recordType);
+
+	if (intelHexLine->lenght > INTELHEX_ALLOWED_MAX_DATA_LENGTH)
+	{
+		return IntelHex_Err_DataLengthExceedsAllowed;
+	}
+
+	intelHexLineLength = LEGACY_INTELHEX_LINE_LENGTH(intelHexLine->lenght);
+	if (intelHexStrLength < intelHexLineLength)
+	{
+		*parsedLineLength = intelHexStrLength;
+		return IntelHex_Err_MissingLine;
+	}
+
+	secondPrefixPtr = strchr((char*)(&intelHexStr[1]), INTELHEX_PREFIX);
+	if ((secondPrefixPtr != NULL) && ((uint32_t)(secondPrefixPtr - (char*)intelHexStr) < intelHexLineLength))
+	{
+		*parsedLineLength = (uint32_t)(secondPrefixPtr - (char*)intelHexStr);
+		return IntelHex_Err_IncompleteLine;
+	}
+
+	crcSum = (uint8_t)(intelHexLine->lenght + (intelHexLine->address >> 8) + (intelHexLine->address & 0xFF) + intelHexLine->recordType);
+
+	dataPtr = &intelHexStr[LEGACY_INTELHEX_HEADER_LENGTH];
+
+	for (index = 0; index < intelHexLine->lenght; index++)
+	{
+		sscanf((char*)dataPtr, "%2x", &value);
+		intelHexLine->data[index] = (uint8_t)value;
+
+		dataPtr += 2;
+
+		crcSum += intelHexLine->data[index];
+	}
+
+	sscanf((char*)dataPtr, "%2x", &value);
+	intelHexLine->crc = (uint8_t)value;
+
+	crcSum = (uint8_t)((~crcSum) + 1);
+
+	*parsedLineLength = intelHexLineLength;
+
+	if (crcSum != intelHexLine->crc)
+	{
+		return IntelHex_Err_CRCError;
+	}
+
+	return IntelHex_Success;
+}
+
+/*
+ * Returns monotonic time in nanoseconds
+ */
+PRIVATE uint64_t getTimeInNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Loads Intel HEX file and splits it into NULL terminated records
+ */
+PRIVATE bool loadRecords(const char* fileName)
+{
+	FILE* file;
+	long fileSize;
+	uint8_t* content;
+	uint8_t* lineStart;
+	long index;
+
+	file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	content = malloc((size_t)fileSize + 1);
+	if ((content == NULL) || (fread(content, 1, (size_t)fileSize, file) != (size_t)fileSize))
+	{
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	content[fileSize] = '\0';
+
+	/* Split file into lines, line endings are replaced with terminator */
+	lineStart = content;
+	for (index = 0; index <= fileSize; index++)
+	{
+		if ((content[index] == '\r') || (content[index] == '\n') || (content[index] == '\0'))
+		{
+			content[index] = '\0';
+
+			if ((*lineStart == INTELHEX_PREFIX) && (recordCount < BENCH_MAX_RECORD_COUNT))
+			{
+				records[recordCount].str = lineStart;
+				records[recordCount].length = (uint32_t)(&content[index] - lineStart);
+				recordCount++;
+			}
+
+			lineStart = &content[index + 1];
+		}
+	}
+
+	return (recordCount > 0);
+}
+
+/*
+ * Checks whether both parsers produce same results for all records
+ */
+PRIVATE bool verifyParsers(void)
+{
+	uint32_t index;
+	IntelHexLine legacyLine;
+	IntelHexLine line;
+	uint32_t legacyParsedLength;
+	uint32_t parsedLength;
+	IntelHexStatusCode legacyStatus;
+	IntelHexStatusCode status;
+
+	for (index = 0; index < recordCount; index++)
+	{
+		legacyStatus = LegacyIntelHex_Parse(records[index].str, records[index].length, &legacyLine, &legacyParsedLength);
+		status = IntelHex_Parse(records[index].str, records[index].length, &line, &parsedLength);
+
+		if ((legacyStatus != status) || (legacyParsedLength != parsedLength))
+		{
+			return false;
+		}
+
+		if ((status == IntelHex_Success) &&
+			((legacyLine.lenght != line.lenght) ||
+			 (legacyLine.address != line.address) ||
+			 (legacyLine.recordType != line.recordType) ||
+			 (legacyLine.crc != line.crc) ||
+			 (memcmp(legacyLine.data, line.data, line.lenght) != 0)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Runs a parser on all records until minimum duration is reached
+ *
+ * @return Parsed records per second
+ */
+PRIVATE double runParser(IntelHexParser parser)
+{
+	IntelHexLine line;
+	uint32_t parsedLength;
+	uint32_t index;
+	uint64_t parsedRecords = 0;
+	uint64_t startTime;
+	uint64_t elapsedTime;
+
+	startTime = getTimeInNs();
+
+	do
+	{
+		for (index = 0; index < recordCount; index++)
+		{
+			benchSink += (uint32_t)parser(records[index].str, records[index].length, &line, &parsedLength);
+			benchSink += line.data[0];
+		}
+
+		parsedRecords += recordCount;
+		elapsedTime = getTimeInNs() - startTime;
+	} while (elapsedTime < BENCH_MIN_DURATION_IN_NS);
+
+	return ((double)parsedRecords * 1000000000.0) / (double)elapsedTime;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(int argc, char* argv[])
+{
+	double legacyRate;
+	double rate;
+
+	if (argc < 2)
+	{
+		printf("Usage : %s <Intel HEX File>\n", argv[0]);
+		return RESULT_FAIL;
+	}
+
+	if (!loadRecords(argv[1]))
+	{
+		printf("Intel HEX File could not be loaded : %s\n", argv[1]);
+		return RESULT_FAIL;
+	}
+
+	if (!verifyParsers())
+	{
+		printf("Parser results do not match!\n");
+		return RESULT_FAIL;
+	}
+
+	legacyRate = runParser(LegacyIntelHex_Parse);
+	rate = runParser(IntelHex_Parse);
+
+	printf("\nIntel HEX Parse Benchmark (%s, %u records)\n", argv[1], recordCount);
+	printf("  sscanf parser    : %12.0f records/s\n", legacyRate);
+	printf("  table parser     : %12.0f records/s\n", rate);
+	printf("  speedup          : %12.2fx\n", rate / legacyRate);
+
+	return RESULT_SUCCESS;
+}
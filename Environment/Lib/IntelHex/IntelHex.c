@@ -31,9 +31,7 @@
  *    AAAA		: Address
  *        RT	: Record Type
  */
-#define INTELHEX_HEADER_FORMAT				":%2x%4x%2x"
-
-/* Length of Intel HEX Header (INTELHEX_HEADER_FORMAT) */
+/* Length of Intel HEX Header */
 #define INTELHEX_HEADER_LENGTH				(9)
 
 /* Intel HEX  CRC String Length */
@@ -45,23 +43,153 @@
 /* String length of a regular Intel HEX */
 #define INTEL_HEX_LINE_LENGTH(dataLength)	(INTELHEX_HEADER_LENGTH + (dataLength * 2) + INTELHEX_CRC_LENGTH)
 
+/* Value of non hex digit characters in nibble table */
+#define INTELHEX_INVALID_NIBBLE				(0xFF)
+
+/* Byte offsets of fields in a line (excluding prefix) */
+#define INTELHEX_LENGTH_BYTE_OFFSET			(0)
+#define INTELHEX_ADDRESS_HIGH_BYTE_OFFSET	(1)
+#define INTELHEX_ADDRESS_LOW_BYTE_OFFSET	(2)
+#define INTELHEX_RECORDTYPE_BYTE_OFFSET		(3)
+#define INTELHEX_DATA_BYTE_OFFSET			(4)
+
 /***************************** TYPE DEFINITIONS *******************************/
 
+/******************************** VARIABLES ***********************************/
+
+#define NA		INTELHEX_INVALID_NIBBLE
+/*
+ * ASCII to nibble lookup table.
+ *
+ *	Maps hex digits ('0'-'9', 'A'-'F', 'a'-'f') to their values and all other
+ *	characters to INTELHEX_INVALID_NIBBLE. A byte is decoded and validated
+ *	with two table reads, so an invalid character (e.g. prefix of a next line)
+ *	is detected while decoding without scanning the string again.
+ */
+PRIVATE const uint8_t nibbleTable[256] =
+{
+	/* 0x00 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x10 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x20 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x30 */ 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, NA, NA, NA, NA, NA, NA,
+	/* 0x40 */ NA, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x50 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x60 */ NA, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x70 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x80 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0x90 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0xA0 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0xB0 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0xC0 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0xD0 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0xE0 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA,
+	/* 0xF0 */ NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA, NA
+};
+#undef NA
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Decodes hex characters into bytes and adds decoded bytes to checksum.
+ *
+ *	If length is odd, last character is only validated. It will be decoded
+ *	with its pair once remaining part of line is received.
+ *
+ * @return Number of valid characters. It is less than 'hexLength' if an
+ *		   invalid character is found and equals to offset of that character.
+ */
+PRIVATE ALWAYS_INLINE uint32_t decodeHexBytes(const uint8_t* hexStr, uint32_t hexLength, uint8_t* bytes, uint8_t* crcSum)
+{
+	uint32_t offset = 0;
+	uint8_t sum = *crcSum;
+	uint8_t high;
+	uint8_t low;
+
+	while (offset + 1 < hexLength)
+	{
+		high = nibbleTable[hexStr[offset]];
+		low = nibbleTable[hexStr[offset + 1]];
+
+		/* Only invalid characters have upper nibble */
+		if ((high | low) & 0xF0)
+		{
+			if ((high & 0xF0) == 0)
+			{
+				/* First character of pair is valid */
+				offset++;
+			}
+
+			*crcSum = sum;
+
+			return offset;
+		}
+
+		*bytes = (uint8_t)((high << 4) | low);
+		sum += *bytes;
+
+		bytes++;
+		offset += 2;
+	}
+
+	/* Validate unpaired last character */
+	if ((offset < hexLength) && ((nibbleTable[hexStr[offset]] & 0xF0) == 0))
+	{
+		offset++;
+	}
+
+	*crcSum = sum;
+
+	return offset;
+}
+
+/*
+ * Starts a new line in streaming parser context
+ */
+PRIVATE ALWAYS_INLINE void startLine(IntelHexContext* context)
+{
+	context->inLine = true;
+	context->charCount = 0;
+	context->crcSum = 0;
+}
+
 /*************************** FUNCTION DEFINITIONS *****************************/
 /**
  * Parses Intel HEX String
+ *
+ *	Decoding and checksum calculation are done in a single pass and only
+ *	characters of current record are accessed.
  */
 IntelHexStatusCode IntelHex_Parse(uint8_t* intelHexStr, uint32_t intelHexStrLength, IntelHexLine* intelHexLine, uint32_t* parsedLineLength)
 {
-	uint32_t index;
-	uint8_t* dataPtr;
+	uint8_t header[(INTELHEX_HEADER_LENGTH - 1) / 2];
 	uint8_t crcSum = 0;
-	uint32_t intelHexLineLength = 0;
-	char* secondPrefixPtr;
-	uint32_t secondPrefixOffset;
+	uint32_t intelHexLineLength;
+	uint32_t partLength;
+	uint32_t validLength;
 
 	*parsedLineLength = 0;
 
+	if (intelHexStrLength == 0)
+	{
+		return IntelHex_Err_MissingLine;
+	}
+
+	/* Intel HEX line must start with prefix, skip the character otherwise */
+	if (intelHexStr[0] != INTELHEX_PREFIX)
+	{
+		*parsedLineLength = 1;
+		return IntelHex_Err_IncompleteLine;
+	}
+
+	/* Decode Intel HEX Header first (only received part of it) */
+	partLength = MATH_MIN(intelHexStrLength, INTELHEX_HEADER_LENGTH) - 1;
+	validLength = decodeHexBytes(&intelHexStr[1], partLength, header, &crcSum);
+	if (validLength < partLength)
+	{
+		/* Line is interrupted (e.g. by a new line prefix), no way to recover */
+		*parsedLineLength = 1 + validLength;
+		return IntelHex_Err_IncompleteLine;
+	}
+
 	/* Intel HEX String should be longer than Intel HEX Header Length */
 	if (intelHexStrLength < INTELHEX_HEADER_LENGTH)
 	{
@@ -69,73 +197,189 @@ IntelHexStatusCode IntelHex_Parse(uint8_t* intelHexStr, uint32_t intelHexStrLeng
 		return IntelHex_Err_MissingLine;
 	}
 
-	/* Parse Intel HEX Header first */
-	sscanf((char*)intelHexStr, INTELHEX_HEADER_FORMAT,
-		&intelHexLine->lenght,
-		&intelHexLine->address,
-		&intelHexLine->recordType);
+	intelHexLine->lenght = header[0];
+	intelHexLine->address = ((uint32_t)header[1] << 8) | header[2];
+	intelHexLine->recordType = header[3];
 
 	/* Check allowed data length */
 	if (intelHexLine->lenght > INTELHEX_ALLOWED_MAX_DATA_LENGTH)
 	{
+		/* Skip prefix so remaining part can be realigned to next line */
+		*parsedLineLength = 1;
 		return IntelHex_Err_DataLengthExceedsAllowed;
 	}
 
 	intelHexLineLength = INTEL_HEX_LINE_LENGTH(intelHexLine->lenght);
-	/* Intel HEX String should not be shorter than regular length */
-	if (intelHexStrLength < intelHexLineLength)
+
+	/* Decode received part of data */
+	partLength = MATH_MIN(intelHexStrLength, intelHexLineLength - INTELHEX_CRC_LENGTH) - INTELHEX_DATA_OFFSET;
+	validLength = decodeHexBytes(&intelHexStr[INTELHEX_DATA_OFFSET], partLength, intelHexLine->data, &crcSum);
+	if (validLength < partLength)
 	{
-		*parsedLineLength = intelHexStrLength;
-		return IntelHex_Err_MissingLine;
+		*parsedLineLength = INTELHEX_DATA_OFFSET + validLength;
+		return IntelHex_Err_IncompleteLine;
 	}
 
-	secondPrefixPtr = strchr((char*)(&intelHexStr[1]), INTELHEX_PREFIX);
-	if (secondPrefixPtr != NULL)
+	/* Decode received part of CRC */
+	if (intelHexStrLength > intelHexLineLength - INTELHEX_CRC_LENGTH)
 	{
-		/*
-		 * If there exists a second Intel HEX Prefix, we can check
-		 * whether first intel HEX part is valid
-		 */
-		secondPrefixOffset = secondPrefixPtr - (char*)intelHexStr;
-		if (secondPrefixOffset < intelHexLineLength)
+		partLength = MATH_MIN(intelHexStrLength, intelHexLineLength) - (intelHexLineLength - INTELHEX_CRC_LENGTH);
+		validLength = decodeHexBytes(&intelHexStr[intelHexLineLength - INTELHEX_CRC_LENGTH], partLength, &intelHexLine->crc, &crcSum);
+		if (validLength < partLength)
 		{
-			*parsedLineLength = secondPrefixOffset;
+			*parsedLineLength = intelHexLineLength - INTELHEX_CRC_LENGTH + validLength;
 			return IntelHex_Err_IncompleteLine;
 		}
 	}
 
-	/* Start to calculate crc of intel hex line */
-	crcSum = intelHexLine->lenght + (intelHexLine->address >> 8) + (intelHexLine->address & 0xFF) + intelHexLine->recordType;
+	/* Intel HEX String should not be shorter than regular length */
+	if (intelHexStrLength < intelHexLineLength)
+	{
+		*parsedLineLength = intelHexStrLength;
+		return IntelHex_Err_MissingLine;
+	}
 
-	/* Get offset of Data */
-	dataPtr = &intelHexStr[INTELHEX_DATA_OFFSET];
+	/* return parsed line length */
+	*parsedLineLength = intelHexLineLength;
 
-	for (index = 0; index < intelHexLine->lenght; index++)
+	/*
+	 * Sum of all bytes including CRC is zero for a valid line because CRC is
+	 * two's complement of sum of other bytes
+	 */
+	if (crcSum != 0)
 	{
-		/* Parse all data byte by byte */
-		sscanf((char*)dataPtr, "%2x", (uint32_t*)&intelHexLine->data[index]);
+		return IntelHex_Err_CRCError;
+	}
 
-		dataPtr += 2;
+	return IntelHex_Success;
+}
 
-		/* Add also parsed byte to crc calculation */
-		crcSum += intelHexLine->data[index];
-	}
+/**
+ * Initializes streaming parser context
+ */
+void IntelHex_InitContext(IntelHexContext* context)
+{
+	context->inLine = false;
+	context->charCount = 0;
+	context->crcSum = 0;
+	context->highNibble = 0;
+	context->dataLocator = NULL;
+	context->lineData = context->line.data;
+}
 
-	/* parse crc */
-	sscanf((char*)dataPtr, "%2x", (uint32_t*)&intelHexLine->crc);
+/**
+ * Sets data locator of streaming parser
+ */
+void IntelHex_SetDataLocator(IntelHexContext* context, IntelHexDataLocator dataLocator)
+{
+	context->dataLocator = dataLocator;
+}
 
-	/* need to two complimentary to finalize crc calculation ss*/
-	crcSum = (~crcSum) + 1;
+/**
+ * Feeds bytes into streaming parser
+ *
+ *	A state machine which decodes each character once using nibble table. A
+ *	line is emitted to handler as soon as its CRC byte is received.
+ */
+uint32_t IntelHex_Feed(IntelHexContext* context, const uint8_t* bytes, uint32_t length, IntelHexLineHandler lineHandler)
+{
+	IntelHexLine* line = &context->line;
+	IntelHexStatusCode status;
+	uint32_t index;
+	uint32_t byteOffset;
+	uint8_t nibble;
+	uint8_t value;
 
-	/* Content CRC Check */
-	if (crcSum != intelHexLine->crc)
+	for (index = 0; index < length; index++)
 	{
-		*parsedLineLength = intelHexLineLength;
-		return IntelHex_Err_CRCError;
-	}
+		if (!context->inLine)
+		{
+			/* Skip everything (e.g. line endings) until a new line starts */
+			if (bytes[index] == INTELHEX_PREFIX)
+			{
+				startLine(context);
+			}
 
-	/* return parsed line length */
-	*parsedLineLength = intelHexLineLength;
+			continue;
+		}
 
-	return IntelHex_Success;
+		nibble = nibbleTable[bytes[index]];
+
+		if (nibble & 0xF0)
+		{
+			/* Line is interrupted, a prefix also starts a new line */
+			context->inLine = false;
+			if (bytes[index] == INTELHEX_PREFIX)
+			{
+				startLine(context);
+			}
+
+			if (!lineHandler(IntelHex_Err_IncompleteLine, line))
+			{
+				return index + 1;
+			}
+
+			continue;
+		}
+
+		/* Wait for low nibble to complete a byte */
+		if ((context->charCount++ & 1) == 0)
+		{
+			context->highNibble = nibble;
+			continue;
+		}
+
+		value = (uint8_t)((context->highNibble << 4) | nibble);
+		context->crcSum += value;
+		byteOffset = (context->charCount >> 1) - 1;
+
+		switch (byteOffset)
+		{
+			case INTELHEX_LENGTH_BYTE_OFFSET:
+				line->lenght = value;
+				if (value > INTELHEX_ALLOWED_MAX_DATA_LENGTH)
+				{
+					status = IntelHex_Err_DataLengthExceedsAllowed;
+					break;
+				}
+				continue;
+			case INTELHEX_ADDRESS_HIGH_BYTE_OFFSET:
+				line->address = (uint32_t)value << 8;
+				continue;
+			case INTELHEX_ADDRESS_LOW_BYTE_OFFSET:
+				line->address |= value;
+				continue;
+			case INTELHEX_RECORDTYPE_BYTE_OFFSET:
+				line->recordType = value;
+
+				/* Client can receive data into its final place */
+				context->lineData = (context->dataLocator != NULL) ? context->dataLocator(line) : NULL;
+				if (context->lineData == NULL)
+				{
+					context->lineData = line->data;
+				}
+				continue;
+			default:
+				if (byteOffset < INTELHEX_DATA_BYTE_OFFSET + line->lenght)
+				{
+					context->lineData[byteOffset - INTELHEX_DATA_BYTE_OFFSET] = value;
+					continue;
+				}
+
+				/* Last byte is CRC, sum of all bytes must be zero */
+				line->crc = value;
+				status = (context->crcSum == 0) ? IntelHex_Success : IntelHex_Err_CRCError;
+				break;
+		}
+
+		/* Line is completed or discarded */
+		context->inLine = false;
+
+		if (!lineHandler(status, line))
+		{
+			return index + 1;
+		}
+	}
+
+	return length;
 }
@@ -91,13 +91,64 @@ typedef struct
 	uint8_t crc;
 } IntelHexLine;
 
+/*
+ * Intel HEX Line Handler which is called by IntelHex_Feed for each line.
+ *
+ * @param status IntelHex_Success if line is completed and valid. Otherwise
+ *		  IntelHex_Err_CRCError, IntelHex_Err_IncompleteLine or
+ *		  IntelHex_Err_DataLengthExceedsAllowed to inform about discarded line
+ * @param intelHexLine Parsed Intel HEX line. Valid only if status is success
+ *		  and only during callback.
+ *
+ * @return true to continue parsing, false to stop parsing of remaining data
+ */
+typedef bool (*IntelHexLineHandler)(IntelHexStatusCode status, IntelHexLine* intelHexLine);
+
+/*
+ * Intel HEX Data Locator which is called by IntelHex_Feed once record type of
+ * a line is received. Allows client to decode data directly into its final
+ * place (e.g. flash write buffer) instead of 'data' field of line.
+ *
+ * @param intelHexLine Received header fields (length, address, record type)
+ *
+ * @return Buffer for 'lenght' bytes of data or NULL to use 'data' field.
+ *		   Data is written before CRC is checked, so buffer must not keep
+ *		   valid data.
+ */
+typedef uint8_t* (*IntelHexDataLocator)(const IntelHexLine* intelHexLine);
+
+/*
+ * Streaming Intel HEX Parser Context.
+ *
+ *	Keeps state of a partially received line between IntelHex_Feed calls so
+ *	memory usage is bounded by a single line. Fields are private to parser.
+ */
+typedef struct
+{
+	/* Line which is being parsed */
+	IntelHexLine line;
+	/* Running checksum of received bytes */
+	uint8_t crcSum;
+	/* High nibble of partially received byte */
+	uint8_t highNibble;
+	/* Parser is inside of a line (after prefix) */
+	uint8_t inLine;
+	/* Number of received hex characters after prefix */
+	uint32_t charCount;
+	/* Optional locator for data of lines, NULL if not used */
+	IntelHexDataLocator dataLocator;
+	/* Destination of data bytes of current line */
+	uint8_t* lineData;
+} IntelHexContext;
+
 /*************************** FUNCTION DEFINITIONS *****************************/
 /*
  * Parses an Intel HEX string and returns IntelHexLine object as parsed data.
  *
  * IMP :
- * - Caller is responsible to send a intel hex string which starts with ':'
- * and ends with terminator char ('\0')
+ * - Caller is responsible to send a intel hex string which starts with ':'.
+ * Terminator char ('\0') is not required, only 'intelHexStrLen' characters
+ * of current line are accessed.
  * - Check 'intelHexLine' variable if function returns success
  *
  * @param intelHexStr Intel HEX String to be parsed
@@ -111,13 +162,56 @@ typedef struct
  * @retval IntelHex_Err_CRCError Intel HEX string is corrupted.
  *		   parsedLineLength returns corrupted but parsed data length.
  * @retval IntelHex_Err_IncompleteLine Intel HEX is incomplete and
- *		   unrecoverable. parsedLineLength returns incomplete line length.
+ *		   unrecoverable (e.g. an invalid character or a new line prefix is
+ *		   found inside of line). parsedLineLength returns incomplete line
+ *		   length.
  * @retval IntelHex_Err_MissingLine Intel HEX has missing part and once it is
  *		   completed string can be retried to parse again. parsedLineLength
  *		   returns all length of intel HEX string.
  * @retval IntelHex_Err_DataLengthExceedsAllowed this function has a data
- *		   length limitation. Please see INTELHEX_ALLOWED_MAX_DATA_LENGTH
+ *		   length limitation. Please see INTELHEX_ALLOWED_MAX_DATA_LENGTH.
+ *		   parsedLineLength returns 1 to skip prefix of line.
  */
 IntelHexStatusCode IntelHex_Parse(uint8_t* intelHexStr, uint32_t intelHexStrLen, IntelHexLine* intelHexLine, uint32_t* parsedLineLength);
 
+/*
+ * Initializes a streaming Intel HEX parser context.
+ *	Any partially received line is discarded.
+ *
+ * @param context Parser context to be initialized
+ *
+ * @return none
+ */
+void IntelHex_InitContext(IntelHexContext* context);
+
+/*
+ * Sets data locator of streaming Intel HEX parser.
+ *
+ * @param context Initialized parser context
+ * @param dataLocator Called for each line header. NULL to decode all data
+ *		  into 'data' field of line.
+ *
+ * @return none
+ */
+void IntelHex_SetDataLocator(IntelHexContext* context, IntelHexDataLocator dataLocator);
+
+/*
+ * Feeds received bytes into streaming Intel HEX parser.
+ *
+ *	Bytes can be split or glued at any position (e.g. as received from UART),
+ *	parser keeps its state in context and continues with next call. Every
+ *	byte is accessed once and there is no need to realign or copy the data.
+ *	Characters between lines (e.g. line endings) are skipped.
+ *
+ * @param context Parser context. Must be initialized using
+ *		  IntelHex_InitContext before first call.
+ * @param bytes Received bytes
+ * @param length Number of received bytes
+ * @param lineHandler Called for each completed or discarded line
+ *
+ * @return Number of consumed bytes. It is less than 'length' only if
+ *		   lineHandler requests to stop.
+ */
+uint32_t IntelHex_Feed(IntelHexContext* context, const uint8_t* bytes, uint32_t length, IntelHexLineHandler lineHandler);
+
 #endif	/* __INTEL_HEX_H */
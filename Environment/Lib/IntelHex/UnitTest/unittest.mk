@@ -0,0 +1,30 @@
+################################################################################
+#
+# @file unittest.mk
+#
+# @author MC
+#
+# @brief Unit test make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+TEST_TARGET_NAME=IntelHex
+
+# Test Image which is delivered by x86 UART Driver
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Bootloader/TestData \
+	-I$(ROOT_PATH)/Environment/Lib/RingBuffer
+
+# x86 UART Driver can receive from a pseudo terminal
+SYMBOLS += \
+	-D_XOPEN_SOURCE=600
@@ -0,0 +1,364 @@
+/*******************************************************************************
+ *
+ * @file unittest_IntelHex.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Intel HEX Parser
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include Intel HEX source file for WHITE-BOX unit testing */
+#include "../IntelHex.c"
+
+/* x86 UART Driver delivers test image in random chunks */
+#include "../../../../BSP/CPU/x86/Drv_UART.c"
+#include "../../RingBuffer/RingBuffer.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Maximum number of lines which can be collected from streaming parser */
+#define TEST_MAX_LINE_COUNT				(256)
+
+/* Number of random seeds for each chunk length */
+#define TEST_RANDOM_SEED_COUNT			(50)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Parsed line and length for each test */
+PRIVATE IntelHexLine line;
+PRIVATE uint32_t parsedLength;
+
+/* Streaming parser context */
+PRIVATE IntelHexContext context;
+
+/* Lines parsed line by line from test image as reference */
+PRIVATE IntelHexLine referenceLines[TEST_MAX_LINE_COUNT];
+PRIVATE uint32_t referenceLineCount;
+
+/* Lines and statuses emitted by streaming parser */
+PRIVATE IntelHexLine fedLines[TEST_MAX_LINE_COUNT];
+PRIVATE IntelHexStatusCode fedStatuses[TEST_MAX_LINE_COUNT];
+PRIVATE uint32_t fedLineCount;
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	memset(&line, 0, sizeof(line));
+	parsedLength = 0xFFFFFFFF;
+
+	fedLineCount = 0;
+	IntelHex_InitContext(&context);
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/*
+ * UART data received handler, data is polled by tests
+ */
+PRIVATE void dataReceivedHandler(void)
+{
+}
+
+/*
+ * Collects lines emitted by streaming parser
+ */
+PRIVATE bool collectLine(IntelHexStatusCode status, IntelHexLine* intelHexLine)
+{
+	if (fedLineCount < TEST_MAX_LINE_COUNT)
+	{
+		fedStatuses[fedLineCount] = status;
+		fedLines[fedLineCount] = *intelHexLine;
+		fedLineCount++;
+	}
+
+	return true;
+}
+
+/*
+ * Collects lines and stops at end of file
+ */
+PRIVATE bool collectLineUntilEOF(IntelHexStatusCode status, IntelHexLine* intelHexLine)
+{
+	collectLine(status, intelHexLine);
+
+	return (intelHexLine->recordType != INTELHEX_RECORDTYPE_EOF);
+}
+
+/*
+ * Feeds a NULL terminated string into streaming parser
+ */
+PRIVATE uint32_t feedString(const char* str)
+{
+	return IntelHex_Feed(&context, (const uint8_t*)str, (uint32_t)strlen(str), collectLine);
+}
+
+/*
+ * Parses each line of test image as reference for streaming parser
+ */
+PRIVATE void buildReferenceLines(void)
+{
+	uint32_t index;
+
+	referenceLineCount = 0;
+
+	for (index = 0; index < LENGTH_OF_REGULAR; index++)
+	{
+		TEST_ASSERT_EQUAL(IntelHex_Success,
+			IntelHex_Parse((uint8_t*)TEST_DATA[index], (uint32_t)strlen(TEST_DATA[index]), &referenceLines[referenceLineCount], &parsedLength));
+
+		referenceLineCount++;
+	}
+}
+
+/*
+ * Feeds test image which is received from UART in random chunks
+ */
+PRIVATE void feedSimulatedStream(uint32_t seed, uint32_t maxChunkLength)
+{
+	uint8_t buffer[256];
+	int32_t receivedLength;
+
+	Drv_UART_SimulateChunks(seed, maxChunkLength);
+
+	receivedLength = Drv_UART_Receive(0, buffer, sizeof(buffer));
+	while (receivedLength > 0)
+	{
+		TEST_ASSERT(IntelHex_Feed(&context, buffer, (uint32_t)receivedLength, collectLine) == (uint32_t)receivedLength);
+
+		receivedLength = Drv_UART_Receive(0, buffer, sizeof(buffer));
+	}
+}
+
+/*
+ * Parses a NULL terminated string
+ */
+PRIVATE IntelHexStatusCode parseString(const char* str)
+{
+	return IntelHex_Parse((uint8_t*)str, (uint32_t)strlen(str), &line, &parsedLength);
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+/*
+ * Tests a regular data line
+ */
+void test_Parse_DataLine(void)
+{
+	const uint8_t expectedData[] = { 0x60, 0x04, 0x00, 0x10, 0x4D, 0x81, 0x00, 0x00,
+									 0x55, 0x81, 0x00, 0x00, 0x57, 0x81, 0x00, 0x00 };
+
+	TEST_ASSERT_EQUAL(IntelHex_Success, parseString(":10800000600400104D810000558100005781000080"));
+
+	TEST_ASSERT_EQUAL(43, parsedLength);
+	TEST_ASSERT_EQUAL(16, line.lenght);
+	TEST_ASSERT_EQUAL(0x8000, line.address);
+	TEST_ASSERT_EQUAL(INTELHEX_RECORDTYPE_DATA, line.recordType);
+	TEST_ASSERT_EQUAL(0x80, line.crc);
+	TEST_ASSERT_EQUAL_MEMORY(expectedData, line.data, sizeof(expectedData));
+}
+
+/*
+ * Tests lower case hex digits and special records
+ */
+void test_Parse_SpecialRecords(void)
+{
+	TEST_ASSERT_EQUAL(IntelHex_Success, parseString(":00000001FF"));
+	TEST_ASSERT_EQUAL(INTELHEX_RECORDTYPE_EOF, line.recordType);
+	TEST_ASSERT_EQUAL(11, parsedLength);
+
+	TEST_ASSERT_EQUAL(IntelHex_Success, parseString(":020000040001f9"));
+	TEST_ASSERT_EQUAL(INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS, line.recordType);
+	TEST_ASSERT_EQUAL(0x00, line.data[0]);
+	TEST_ASSERT_EQUAL(0x01, line.data[1]);
+}
+
+/*
+ * Tests a corrupted line
+ */
+void test_Parse_CRCError(void)
+{
+	TEST_ASSERT_EQUAL(IntelHex_Err_CRCError, parseString(":0402FC00FFFFFFFF01"));
+	TEST_ASSERT_EQUAL(19, parsedLength);
+}
+
+/*
+ * Tests lines which are not received completely yet
+ */
+void test_Parse_MissingLine(void)
+{
+	/* Partial header */
+	TEST_ASSERT_EQUAL(IntelHex_Err_MissingLine, parseString(":1080"));
+	TEST_ASSERT_EQUAL(5, parsedLength);
+
+	/* Partial data */
+	TEST_ASSERT_EQUAL(IntelHex_Err_MissingLine, parseString(":108030006181000000000000"));
+	TEST_ASSERT_EQUAL(25, parsedLength);
+
+	/* Partial CRC */
+	TEST_ASSERT_EQUAL(IntelHex_Err_MissingLine, parseString(":00000001F"));
+	TEST_ASSERT_EQUAL(10, parsedLength);
+
+	TEST_ASSERT_EQUAL(IntelHex_Err_MissingLine, IntelHex_Parse((uint8_t*)"", 0, &line, &parsedLength));
+	TEST_ASSERT_EQUAL(0, parsedLength);
+}
+
+/*
+ * Tests lines which are interrupted by a new line
+ */
+void test_Parse_IncompleteLine(void)
+{
+	/* Interrupted in header */
+	TEST_ASSERT_EQUAL(IntelHex_Err_IncompleteLine, parseString(":1080:10800000600400104D810000558100005781000080"));
+	TEST_ASSERT_EQUAL(5, parsedLength);
+
+	/* Interrupted in data */
+	TEST_ASSERT_EQUAL(IntelHex_Err_IncompleteLine, parseString(":10800000:10800000600400104D810000558100005781000080"));
+	TEST_ASSERT_EQUAL(9, parsedLength);
+
+	/* Interrupted at odd position of data */
+	TEST_ASSERT_EQUAL(IntelHex_Err_IncompleteLine, parseString(":108000006:10800000600400104D810000558100005781000080"));
+	TEST_ASSERT_EQUAL(10, parsedLength);
+
+	/* Interrupted in CRC */
+	TEST_ASSERT_EQUAL(IntelHex_Err_IncompleteLine, parseString(":00000001F:00000001FF"));
+	TEST_ASSERT_EQUAL(10, parsedLength);
+
+	/* Line does not start with prefix */
+	TEST_ASSERT_EQUAL(IntelHex_Err_IncompleteLine, parseString("1000598100005B8100005D81000000000000CC"));
+	TEST_ASSERT_EQUAL(1, parsedLength);
+}
+
+/*
+ * Tests a line which has more data than allowed
+ */
+void test_Parse_DataLengthExceedsAllowed(void)
+{
+	TEST_ASSERT_EQUAL(IntelHex_Err_DataLengthExceedsAllowed, parseString(":21000000"));
+	TEST_ASSERT_EQUAL(1, parsedLength);
+}
+
+/*
+ * Tests characters after line are not accessed
+ */
+void test_Parse_TrailingData(void)
+{
+	TEST_ASSERT_EQUAL(IntelHex_Success, parseString(":00000001FF\r\n:0000"));
+	TEST_ASSERT_EQUAL(11, parsedLength);
+}
+
+/*
+ * Tests streaming parser with test image which is split and glued at random
+ * positions by x86 UART driver.
+ *	Every line must be emitted once with the same content of line by line
+ *	parsing.
+ */
+void test_Feed_RandomChunkBoundaries(void)
+{
+	const uint32_t maxChunkLengths[] = { 1, 2, 3, 7, 11, 16, 43, 64, 255 };
+	uint32_t chunkIndex;
+	uint32_t seed;
+	uint32_t index;
+
+	Drv_UART_Get(0, 115200, dataReceivedHandler);
+
+	buildReferenceLines();
+
+	for (chunkIndex = 0; chunkIndex < sizeof(maxChunkLengths) / sizeof(maxChunkLengths[0]); chunkIndex++)
+	{
+		for (seed = 1; seed <= TEST_RANDOM_SEED_COUNT; seed++)
+		{
+			fedLineCount = 0;
+			IntelHex_InitContext(&context);
+
+			feedSimulatedStream(seed, maxChunkLengths[chunkIndex]);
+
+			TEST_ASSERT_EQUAL(referenceLineCount, fedLineCount);
+
+			for (index = 0; index < fedLineCount; index++)
+			{
+				TEST_ASSERT_EQUAL(IntelHex_Success, fedStatuses[index]);
+				TEST_ASSERT_EQUAL(referenceLines[index].lenght, fedLines[index].lenght);
+				TEST_ASSERT_EQUAL(referenceLines[index].address, fedLines[index].address);
+				TEST_ASSERT_EQUAL(referenceLines[index].recordType, fedLines[index].recordType);
+				TEST_ASSERT_EQUAL(referenceLines[index].crc, fedLines[index].crc);
+				TEST_ASSERT(memcmp(referenceLines[index].data, fedLines[index].data, fedLines[index].lenght) == 0);
+			}
+		}
+	}
+}
+
+/*
+ * Tests corrupted, interrupted and split lines
+ */
+void test_Feed_CorruptedLines(void)
+{
+	feedString(":0402FC00FFFFFFFF01\r\n");
+	feedString(":10800000:10800000600400104D810000558100005781000080");
+	feedString("1000598100005B8100005D81000000000000CC");
+	feedString(":108030006181000000000000");
+	feedString("638100006581000094\r\n:21000000");
+	feedString(":00000001FF");
+
+	TEST_ASSERT_EQUAL(6, fedLineCount);
+
+	TEST_ASSERT_EQUAL(IntelHex_Err_CRCError, fedStatuses[0]);
+
+	/* Interrupted by a new line, new line is parsed */
+	TEST_ASSERT_EQUAL(IntelHex_Err_IncompleteLine, fedStatuses[1]);
+	TEST_ASSERT_EQUAL(IntelHex_Success, fedStatuses[2]);
+	TEST_ASSERT_EQUAL(0x8000, fedLines[2].address);
+
+	/* Line without prefix is skipped and split line is parsed */
+	TEST_ASSERT_EQUAL(IntelHex_Success, fedStatuses[3]);
+	TEST_ASSERT_EQUAL(0x8030, fedLines[3].address);
+	TEST_ASSERT_EQUAL(0x94, fedLines[3].crc);
+
+	TEST_ASSERT_EQUAL(IntelHex_Err_DataLengthExceedsAllowed, fedStatuses[4]);
+
+	TEST_ASSERT_EQUAL(IntelHex_Success, fedStatuses[5]);
+	TEST_ASSERT_EQUAL(INTELHEX_RECORDTYPE_EOF, fedLines[5].recordType);
+}
+
+/*
+ * Tests that parser stops when handler requests
+ */
+void test_Feed_StopRequest(void)
+{
+	const char* stream = ":00000001FF:020000040001F9";
+
+	TEST_ASSERT_EQUAL(11, IntelHex_Feed(&context, (const uint8_t*)stream, (uint32_t)strlen(stream), collectLineUntilEOF));
+	TEST_ASSERT_EQUAL(1, fedLineCount);
+}
@@ -0,0 +1,44 @@
+################################################################################
+#
+# @file benchmark.mk
+#
+# @author MC
+#
+# @brief Benchmark make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+BENCH_TARGET_NAME = LZSS
+
+include $(ROOT_PATH)/Environment/Lib/IntelHex/module.mk
+include $(ROOT_PATH)/Environment/Lib/BinFrame/module.mk
+
+# Host side compressor
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Environment/Tools/ImageTool
+
+# Sources under benchmark
+BENCH_SRC_FILES = \
+	$(LZSS_SRC_FILES) \
+	$(INTELHEX_SRC_FILES) \
+	$(BINFRAME_SRC_FILES) \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/Compressor.c
+
+# Firmware images which are compressed
+BENCH_ARGS = \
+	$(ROOT_PATH)/Bootloader/TestData/ER_IROM1 \
+	$(ROOT_PATH)/Bootloader/TestData/ER_IROM1.signed \
+	$(ROOT_PATH)/Bootloader/TestData/App.hex
+
+# Decoder accepts all measured windows
+BENCH_CFLAGS = -DLZSS_WINDOW_BITS=12
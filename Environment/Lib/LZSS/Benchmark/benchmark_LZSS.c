@@ -0,0 +1,311 @@
+/*******************************************************************************
+ *
+ * @file benchmark_LZSS.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for LZSS Compressed Upgrades.
+ *
+ *        Compresses firmware images with several windows and measures
+ *        decompression speed. Transfer time of full and compressed frame
+ *        streams is reported for several baud rates, with the decoder cycle
+ *        budget per image byte at which compressed upgrade is still faster
+ *        (decompression is not overlapped with reception).
+ *
+ *        [USAGE] : benchmark_LZSS <Image File> [Image File ...]
+ *
+ *          Image files are raw binary or Intel HEX files. Intel HEX files
+ *          are used from firmware start address as bootloader receives them.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "LZSS.h"
+#include "Compressor.h"
+#include "IntelHex.h"
+#include "BinFrame.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Images are mapped into LPC1768 flash (512K) */
+#define BENCH_FLASH_SIZE					(0x80000)
+
+/* Firmware start address of bootloader */
+#define BENCH_FIRMWARE_START_ADDRESS		(0x10000)
+
+/* Core clock of LPC1768 to express cycle budgets */
+#define BENCH_CORE_CLOCK_IN_MHZ				(100)
+
+/* UART frame length in bits for 8N1 */
+#define BENCH_UART_BITS_PER_BYTE			(10)
+
+/* Minimum measurement duration of decoder */
+#define BENCH_MIN_DURATION_IN_NS			(200000000ULL)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Flash content of Intel HEX files and last address of their data */
+PRIVATE uint8_t flash[BENCH_FLASH_SIZE];
+PRIVATE uint32_t flashEnd;
+PRIVATE uint32_t segmentAddress;
+
+/* Image, compressed stream and decompressed image */
+PRIVATE uint8_t image[BENCH_FLASH_SIZE];
+PRIVATE uint32_t imageLength;
+PRIVATE uint8_t compressed[LZSS_HEADER_LENGTH + BENCH_FLASH_SIZE + (BENCH_FLASH_SIZE / 8) + 1];
+PRIVATE uint8_t output[BENCH_FLASH_SIZE];
+
+PRIVATE LZSSContext context;
+
+/* Measured windows */
+PRIVATE const uint8_t windowBits[] = { 8, 10, 11, 12 };
+
+/* Reported baud rates */
+PRIVATE const uint32_t baudRates[] = { 9600, 57600, 115200, 460800, 921600 };
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns monotonic time in nanoseconds
+ */
+PRIVATE uint64_t getTimeInNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Places data lines of Intel HEX files into flash
+ */
+PRIVATE bool intelHexLineHandler(IntelHexStatusCode status, IntelHexLine* intelHexLine)
+{
+	uint32_t address;
+
+	if (status != IntelHex_Success)
+	{
+		return false;
+	}
+
+	if (intelHexLine->recordType == INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS)
+	{
+		segmentAddress = ((intelHexLine->data[0] << 8) | intelHexLine->data[1]) * INTELHEX_SEGMENT_SIZE;
+	}
+	else if (intelHexLine->recordType == INTELHEX_RECORDTYPE_DATA)
+	{
+		address = segmentAddress + intelHexLine->address;
+		if (address + intelHexLine->lenght > BENCH_FLASH_SIZE)
+		{
+			return false;
+		}
+
+		memcpy(&flash[address], intelHexLine->data, intelHexLine->lenght);
+		flashEnd = MATH_MAX(flashEnd, address + intelHexLine->lenght);
+	}
+
+	return true;
+}
+
+/*
+ * Loads image file
+ */
+PRIVATE bool loadImage(const char* fileName)
+{
+	IntelHexContext intelHexContext;
+	FILE* file;
+	long fileSize;
+	uint8_t* content;
+
+	file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	content = malloc((size_t)fileSize + 1);
+	if ((content == NULL) || (fileSize > BENCH_FLASH_SIZE) || (fread(content, 1, (size_t)fileSize, file) != (size_t)fileSize))
+	{
+		free(content);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	if ((fileSize > 0) && (content[0] == INTELHEX_PREFIX))
+	{
+		memset(flash, 0xFF, sizeof(flash));
+		flashEnd = 0;
+		segmentAddress = 0;
+
+		IntelHex_InitContext(&intelHexContext);
+		IntelHex_Feed(&intelHexContext, content, (uint32_t)fileSize, intelHexLineHandler);
+
+		imageLength = (flashEnd > BENCH_FIRMWARE_START_ADDRESS) ? (flashEnd - BENCH_FIRMWARE_START_ADDRESS) : 0;
+		memcpy(image, &flash[BENCH_FIRMWARE_START_ADDRESS], imageLength);
+	}
+	else
+	{
+		imageLength = (uint32_t)fileSize;
+		memcpy(image, content, imageLength);
+	}
+
+	free(content);
+
+	return (imageLength > 0);
+}
+
+/*
+ * Decoder produces image into output buffer
+ */
+PRIVATE bool writeOutput(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	memcpy(&output[offset], data, length);
+
+	return true;
+}
+
+/*
+ * Returns length of frame stream which sends data in frames of maximum length
+ */
+PRIVATE uint32_t getStreamLength(uint32_t length)
+{
+	uint32_t frameCount = (length + BINFRAME_MAX_PAYLOAD_LENGTH - 1) / BINFRAME_MAX_PAYLOAD_LENGTH;
+
+	/* END frame is added */
+	return length + ((frameCount + 1) * BINFRAME_OVERHEAD_LENGTH);
+}
+
+/*
+ * Decompresses stream until minimum duration is reached
+ *
+ * @return Decompression time per image byte in nanoseconds
+ */
+PRIVATE double runDecoder(uint32_t compressedLength)
+{
+	uint64_t decodedLength = 0;
+	uint64_t startTime;
+	uint64_t elapsedTime;
+
+	startTime = getTimeInNs();
+
+	do
+	{
+		LZSS_InitContext(&context, writeOutput);
+		LZSS_Feed(&context, compressed, compressedLength);
+
+		decodedLength += imageLength;
+		elapsedTime = getTimeInNs() - startTime;
+	} while (elapsedTime < BENCH_MIN_DURATION_IN_NS);
+
+	return (double)elapsedTime / (double)decodedLength;
+}
+
+/*
+ * Compresses image with a window, checks decompressed image and prints results
+ */
+PRIVATE bool runWindow(uint8_t bits)
+{
+	uint32_t compressedLength;
+	uint32_t fullStreamLength = getStreamLength(imageLength);
+	uint32_t streamLength;
+	uint32_t index;
+	double nsPerByte;
+	double fullTime;
+	double compressedTime;
+
+	compressedLength = Compressor_Compress(image, imageLength, bits, COMPRESSOR_DEFAULT_LENGTH_BITS, compressed, sizeof(compressed));
+	if (compressedLength == 0)
+	{
+		return false;
+	}
+
+	nsPerByte = runDecoder(compressedLength);
+
+	if (!LZSS_IsCompleted(&context) || (memcmp(output, image, imageLength) != 0))
+	{
+		return false;
+	}
+
+	streamLength = getStreamLength(compressedLength);
+
+	printf("  window %4u      : %7u -> %7u bytes (%5.1f %%), decompress %6.2f ns/byte on host\n",
+		   1U << bits, imageLength, compressedLength, (100.0 * compressedLength) / imageLength, nsPerByte);
+
+	for (index = 0; index < sizeof(baudRates) / sizeof(baudRates[0]); index++)
+	{
+		fullTime = ((double)fullStreamLength * BENCH_UART_BITS_PER_BYTE) / baudRates[index];
+		compressedTime = ((double)streamLength * BENCH_UART_BITS_PER_BYTE) / baudRates[index];
+
+		printf("    %6u baud    : %8.3f s -> %8.3f s, break-even %8.1f cycles/byte at %u MHz\n",
+			   baudRates[index],
+			   fullTime,
+			   compressedTime,
+			   ((fullTime - compressedTime) * BENCH_CORE_CLOCK_IN_MHZ * 1000000.0) / imageLength,
+			   BENCH_CORE_CLOCK_IN_MHZ);
+	}
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(int argc, char* argv[])
+{
+	int fileNo;
+	uint32_t index;
+
+	if (argc < 2)
+	{
+		printf("Usage : %s <Image File> [Image File ...]\n", argv[0]);
+		return RESULT_FAIL;
+	}
+
+	printf("\nLZSS Compressed Upgrade Benchmark (transfer time vs decompression)\n");
+
+	for (fileNo = 1; fileNo < argc; fileNo++)
+	{
+		if (!loadImage(argv[fileNo]))
+		{
+			printf("Image File could not be loaded : %s\n", argv[fileNo]);
+			return RESULT_FAIL;
+		}
+
+		printf("\n %s (%u bytes)\n", argv[fileNo], imageLength);
+
+		for (index = 0; index < sizeof(windowBits); index++)
+		{
+			if (!runWindow(windowBits[index]))
+			{
+				printf("Decompressed image does not match!\n");
+				return RESULT_FAIL;
+			}
+		}
+	}
+
+	return RESULT_SUCCESS;
+}
@@ -0,0 +1,287 @@
+/*******************************************************************************
+*
+* @file LZSS.c
+*
+* @author MC
+*
+* @brief Streaming LZSS Decompressor Implementation
+*
+*		 Decompressed bytes are collected in window and passed to client
+*		 when window wraps and when received bytes are consumed.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "LZSS.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+/*
+ * Offsets of header fields
+ */
+#define LZSS_MAGIC_OFFSET							(0)
+#define LZSS_ORIGINAL_LENGTH_OFFSET					(4)
+#define LZSS_WINDOW_BITS_OFFSET						(8)
+#define LZSS_LENGTH_BITS_OFFSET						(9)
+
+/* Index of window position */
+#define LZSS_WINDOW_INDEX(position)					((position) & (LZSS_WINDOW_SIZE - 1))
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Decoder states, field of stream which is expected next
+ */
+typedef enum
+{
+	LZSS_State_Header = 0,
+	LZSS_State_Tag,
+	LZSS_State_Literal,
+	LZSS_State_Offset,
+	LZSS_State_Length,
+	LZSS_State_Completed
+} LZSSState;
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Writes a little endian word of header
+ */
+PRIVATE ALWAYS_INLINE void writeHeaderWord(uint8_t* buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)value;
+	buffer[1] = (uint8_t)(value >> 8);
+	buffer[2] = (uint8_t)(value >> 16);
+	buffer[3] = (uint8_t)(value >> 24);
+}
+
+/*
+ * Reads a little endian word of header
+ */
+PRIVATE ALWAYS_INLINE uint32_t readHeaderWord(const uint8_t* buffer)
+{
+	return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+/*
+ * Passes decompressed bytes which are not passed yet to client
+ */
+PRIVATE bool flushWindow(LZSSContext* context)
+{
+	uint32_t length = context->outputLength - context->flushedLength;
+	bool success = true;
+
+	if (length > 0)
+	{
+		success = context->outputHandler(context->flushedLength, &context->window[LZSS_WINDOW_INDEX(context->flushedLength)], length);
+		context->flushedLength = context->outputLength;
+	}
+
+	return success;
+}
+
+/*
+ * Appends a decompressed byte to window, full window is flushed
+ */
+PRIVATE ALWAYS_INLINE bool appendByte(LZSSContext* context, uint8_t byte)
+{
+	context->window[LZSS_WINDOW_INDEX(context->outputLength)] = byte;
+	context->outputLength++;
+
+	return (LZSS_WINDOW_INDEX(context->outputLength) != 0) || flushWindow(context);
+}
+
+/*
+ * Processes completed header
+ */
+PRIVATE LZSSStatusCode processStreamHeader(LZSSContext* context)
+{
+	context->windowBits = context->headerBuffer[LZSS_WINDOW_BITS_OFFSET];
+	context->lengthBits = context->headerBuffer[LZSS_LENGTH_BITS_OFFSET];
+	context->originalLength = readHeaderWord(&context->headerBuffer[LZSS_ORIGINAL_LENGTH_OFFSET]);
+
+	if ((readHeaderWord(&context->headerBuffer[LZSS_MAGIC_OFFSET]) != LZSS_MAGIC) ||
+		(context->windowBits == 0) || (context->windowBits > LZSS_WINDOW_BITS) ||
+		(context->lengthBits == 0) || (context->lengthBits > LZSS_MAX_LENGTH_BITS))
+	{
+		return LZSS_Err_InvalidFormat;
+	}
+
+	context->state = (context->originalLength > 0) ? LZSS_State_Tag : LZSS_State_Completed;
+
+	return LZSS_Success;
+}
+
+/*
+ * Processes a decoded field of bit stream
+ */
+PRIVATE LZSSStatusCode processField(LZSSContext* context, uint32_t value)
+{
+	uint32_t length;
+
+	switch (context->state)
+	{
+		case LZSS_State_Tag:
+			context->state = (value != 0) ? LZSS_State_Literal : LZSS_State_Offset;
+			return LZSS_Success;
+		case LZSS_State_Literal:
+			if (!appendByte(context, (uint8_t)value))
+			{
+				return LZSS_Err_OutputFailure;
+			}
+			break;
+		case LZSS_State_Offset:
+			context->referenceOffset = value + 1;
+			if (context->referenceOffset > context->outputLength)
+			{
+				return LZSS_Err_InvalidFormat;
+			}
+			context->state = LZSS_State_Length;
+			return LZSS_Success;
+		case LZSS_State_Length:
+			length = value + 1;
+			if (length > context->originalLength - context->outputLength)
+			{
+				return LZSS_Err_InvalidFormat;
+			}
+
+			/* Reference may overlap bytes which it produces */
+			while (length-- > 0)
+			{
+				if (!appendByte(context, context->window[LZSS_WINDOW_INDEX(context->outputLength - context->referenceOffset)]))
+				{
+					return LZSS_Err_OutputFailure;
+				}
+			}
+			break;
+		default:
+			return LZSS_Err_InvalidFormat;
+	}
+
+	context->state = (context->outputLength == context->originalLength) ? LZSS_State_Completed : LZSS_State_Tag;
+
+	return LZSS_Success;
+}
+
+/*
+ * Returns bit count of field which is expected next
+ */
+PRIVATE ALWAYS_INLINE uint32_t getFieldBitCount(const LZSSContext* context)
+{
+	switch (context->state)
+	{
+		case LZSS_State_Tag:
+			return 1;
+		case LZSS_State_Literal:
+			return 8;
+		case LZSS_State_Offset:
+			return context->windowBits;
+		default:
+			return context->lengthBits;
+	}
+}
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/**
+ * Initializes a streaming decoder context
+ */
+void LZSS_InitContext(LZSSContext* context, LZSSOutputHandler outputHandler)
+{
+	context->outputHandler = outputHandler;
+	context->status = LZSS_Success;
+	context->state = LZSS_State_Header;
+	context->headerLength = 0;
+	context->originalLength = 0;
+	context->bitBuffer = 0;
+	context->bitCount = 0;
+	context->outputLength = 0;
+	context->flushedLength = 0;
+}
+
+/**
+ * Feeds received compressed bytes into decoder
+ */
+LZSSStatusCode LZSS_Feed(LZSSContext* context, const uint8_t* bytes, uint32_t length)
+{
+	uint32_t index = 0;
+	uint32_t copyLength;
+	uint32_t bitCount;
+
+	while ((index < length) && (context->status == LZSS_Success))
+	{
+		if (context->state == LZSS_State_Header)
+		{
+			copyLength = MATH_MIN(LZSS_HEADER_LENGTH - context->headerLength, length - index);
+
+			memcpy(&context->headerBuffer[context->headerLength], &bytes[index], copyLength);
+			context->headerLength += copyLength;
+			index += copyLength;
+
+			if (context->headerLength == LZSS_HEADER_LENGTH)
+			{
+				context->status = processStreamHeader(context);
+			}
+			continue;
+		}
+
+		if (context->state == LZSS_State_Completed)
+		{
+			/* Only padding bits of last byte can follow original data */
+			context->status = LZSS_Err_InvalidFormat;
+			break;
+		}
+
+		/* Fields are at most 12 bits, they always fit after a byte is added */
+		context->bitBuffer = (context->bitBuffer << 8) | bytes[index++];
+		context->bitCount += 8;
+
+		bitCount = getFieldBitCount(context);
+		while ((context->bitCount >= bitCount) && (context->status == LZSS_Success) && (context->state != LZSS_State_Completed))
+		{
+			context->bitCount -= bitCount;
+			context->status = processField(context, (context->bitBuffer >> context->bitCount) & ((1U << bitCount) - 1));
+			bitCount = getFieldBitCount(context);
+		}
+	}
+
+	/* Data which is decoded before an invalid field is passed too */
+	if ((context->status != LZSS_Err_OutputFailure) && !flushWindow(context))
+	{
+		context->status = LZSS_Err_OutputFailure;
+	}
+
+	return context->status;
+}
+
+/**
+ * Checks whether whole original data is decompressed
+ */
+bool LZSS_IsCompleted(const LZSSContext* context)
+{
+	return (context->status == LZSS_Success) && (context->state == LZSS_State_Completed);
+}
+
+/**
+ * Encodes compressed stream header
+ */
+uint32_t LZSS_EncodeHeader(uint32_t originalLength, uint8_t windowBits, uint8_t lengthBits, uint8_t* buffer)
+{
+	writeHeaderWord(&buffer[LZSS_MAGIC_OFFSET], LZSS_MAGIC);
+	writeHeaderWord(&buffer[LZSS_ORIGINAL_LENGTH_OFFSET], originalLength);
+	buffer[LZSS_WINDOW_BITS_OFFSET] = windowBits;
+	buffer[LZSS_LENGTH_BITS_OFFSET] = lengthBits;
+	buffer[LZSS_LENGTH_BITS_OFFSET + 1] = 0;
+	buffer[LZSS_LENGTH_BITS_OFFSET + 2] = 0;
+
+	return LZSS_HEADER_LENGTH;
+}
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ *
+ * @file LZSS.h
+ *
+ * @author MC
+ *
+ * @brief Streaming LZSS Decompressor.
+ *
+ *		  Compressed stream starts with a header and continues with a bit
+ *		  stream (MSB first) of literals and back references:
+ *
+ *		  Header      : Magic | Original Length | Window Bits | Length Bits | 0 | 0
+ *		  (Magic and Original Length are 4 bytes each, little endian)
+ *
+ *		  Literal     : 1 | Byte (8 bits)
+ *		  Reference   : 0 | Offset - 1 (Window Bits) | Length - 1 (Length Bits)
+ *
+ *		  Bit stream layout is the same as heatshrink. Last byte is padded
+ *		  with zero bits. Decoder keeps only a window of decompressed data,
+ *		  so RAM usage does not depend on image size.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __LZSS_H
+#define __LZSS_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Magic of compressed stream header ("SPLZ") */
+#define LZSS_MAGIC									(0x5A4C5053)
+
+/* Length of compressed stream header */
+#define LZSS_HEADER_LENGTH							(12)
+
+/*
+ * Maximum window of decoder. Streams with smaller windows are accepted too.
+ */
+#ifndef LZSS_WINDOW_BITS
+#define LZSS_WINDOW_BITS							(11)
+#endif
+
+#if (LZSS_WINDOW_BITS < 4) || (LZSS_WINDOW_BITS > 12)
+#error "LZSS window must be between 16 bytes and 4K"
+#endif
+
+#define LZSS_WINDOW_SIZE							(1 << LZSS_WINDOW_BITS)
+
+/* Maximum bit count of reference lengths */
+#define LZSS_MAX_LENGTH_BITS						(8)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * LZSS Library Specific Status Codes
+ */
+typedef enum
+{
+	LZSS_Success = 0,
+	/* Stream is corrupted or does not match its header */
+	LZSS_Err_InvalidFormat,
+	/* Decompressed data could not be written */
+	LZSS_Err_OutputFailure
+} LZSSStatusCode;
+
+/*
+ * Handler of decompressed data, data is produced in ascending order.
+ *	Returns false to stop decoding.
+ */
+typedef bool (*LZSSOutputHandler)(uint32_t offset, const uint8_t* data, uint32_t length);
+
+/*
+ * Streaming LZSS Decoder Context.
+ *	Fields are private to decoder.
+ */
+typedef struct
+{
+	/* Client callback */
+	LZSSOutputHandler outputHandler;
+	/* Status of decoding, an error stops decoding */
+	LZSSStatusCode status;
+	/* Current field of stream which is being decoded */
+	uint8_t state;
+	/* Parameters of stream */
+	uint8_t windowBits;
+	uint8_t lengthBits;
+	/* Received part of header */
+	uint8_t headerBuffer[LZSS_HEADER_LENGTH];
+	uint32_t headerLength;
+	/* Length of decompressed data */
+	uint32_t originalLength;
+	/* Received bits which are not decoded yet */
+	uint32_t bitBuffer;
+	uint32_t bitCount;
+	/* Offset of current reference */
+	uint32_t referenceOffset;
+	/* Produced length and length which is passed to output handler */
+	uint32_t outputLength;
+	uint32_t flushedLength;
+	/* Last decompressed bytes */
+	uint8_t window[LZSS_WINDOW_SIZE];
+} LZSSContext;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Initializes a streaming decoder context.
+ *
+ * @param context Decoder context to be initialized
+ * @param outputHandler Handler of decompressed data
+ *
+ * @return none
+ */
+void LZSS_InitContext(LZSSContext* context, LZSSOutputHandler outputHandler);
+
+/*
+ * Feeds received compressed bytes into decoder.
+ *
+ *	Bytes can be split at any position. All decompressed data is passed to
+ *	output handler before function returns.
+ *
+ * @param context Decoder context. Must be initialized using
+ *		  LZSS_InitContext before first call.
+ * @param bytes Received compressed bytes
+ * @param length Number of received bytes
+ *
+ * @return LZSS_Success or error which stopped decoding. Errors are kept,
+ *		   later calls return same error.
+ */
+LZSSStatusCode LZSS_Feed(LZSSContext* context, const uint8_t* bytes, uint32_t length);
+
+/*
+ * Checks whether whole original data is decompressed.
+ *
+ * @param context Decoder context
+ *
+ * @return true if header is received and original data is completed
+ */
+bool LZSS_IsCompleted(const LZSSContext* context);
+
+/*
+ * Encodes compressed stream header.
+ *
+ * @param originalLength Length of decompressed data
+ * @param windowBits Window bits of stream
+ * @param lengthBits Length bits of stream
+ * @param buffer [out] Encoded header. Must have LZSS_HEADER_LENGTH bytes.
+ *
+ * @return Length of encoded header
+ */
+uint32_t LZSS_EncodeHeader(uint32_t originalLength, uint8_t windowBits, uint8_t lengthBits, uint8_t* buffer);
+
+#endif	/* __LZSS_H */
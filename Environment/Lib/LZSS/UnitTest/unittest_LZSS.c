@@ -0,0 +1,260 @@
+/*******************************************************************************
+ *
+ * @file unittest_LZSS.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for LZSS Decompression Library
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../LZSS.c"
+
+/* Host side compressor produces test streams */
+#include "../../../Tools/ImageTool/Compressor.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Length of test data, longer than decoder window */
+#define TEST_DATA_LENGTH				(3 * LZSS_WINDOW_SIZE + 100)
+
+/* Maximum length of compressed stream */
+#define TEST_STREAM_MAX_LENGTH			(2 * TEST_DATA_LENGTH)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+PRIVATE bool writeOutput(uint32_t offset, const uint8_t* data, uint32_t length);
+
+/******************************** VARIABLES ***********************************/
+
+PRIVATE LZSSContext context;
+
+/* Original and decompressed data */
+PRIVATE uint8_t data[TEST_DATA_LENGTH];
+PRIVATE uint8_t output[TEST_DATA_LENGTH];
+PRIVATE uint32_t outputLength;
+PRIVATE uint32_t outputCallCount;
+
+/* Result of output handler */
+PRIVATE bool acceptOutput;
+
+/* Compressed stream */
+PRIVATE uint8_t stream[TEST_STREAM_MAX_LENGTH];
+PRIVATE uint32_t streamLength;
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	uint32_t index;
+	uint32_t seed = 1;
+
+	/* Repeated code like blocks with some random bytes */
+	for (index = 0; index < TEST_DATA_LENGTH; index++)
+	{
+		seed = (seed * 1103515245) + 12345;
+		data[index] = ((index % 64) < 48) ? (uint8_t)(index % 48) : (uint8_t)(seed >> 16);
+	}
+
+	memset(output, 0, sizeof(output));
+	outputLength = 0;
+	outputCallCount = 0;
+	acceptOutput = true;
+	memset(stream, 0, sizeof(stream));
+	streamLength = 0;
+
+	LZSS_InitContext(&context, writeOutput);
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/*
+ * Collects decompressed data, it must be produced in ascending order
+ */
+PRIVATE bool writeOutput(uint32_t offset, const uint8_t* data, uint32_t length)
+{
+	TEST_ASSERT_EQUAL(outputLength, offset);
+	TEST_ASSERT(length <= LZSS_WINDOW_SIZE);
+
+	memcpy(&output[offset], data, length);
+	outputLength += length;
+	outputCallCount++;
+
+	return acceptOutput;
+}
+
+/*
+ * Compresses test data
+ */
+PRIVATE void compressData(uint32_t length, uint8_t windowBits)
+{
+	streamLength = Compressor_Compress(data, length, windowBits, COMPRESSOR_DEFAULT_LENGTH_BITS, stream, sizeof(stream));
+
+	TEST_ASSERT(streamLength > 0);
+}
+
+/*
+ * Appends a bit field to a hand made stream
+ */
+PRIVATE void appendBits(uint32_t* bitOffset, uint32_t value, uint32_t bitCount)
+{
+	while (bitCount-- > 0)
+	{
+		if (value & (1U << bitCount))
+		{
+			stream[*bitOffset / 8] |= (uint8_t)(0x80 >> (*bitOffset % 8));
+		}
+		(*bitOffset)++;
+	}
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+void test_Decode_RoundTrip(void)
+{
+	compressData(TEST_DATA_LENGTH, LZSS_WINDOW_BITS);
+
+	TEST_ASSERT(streamLength < TEST_DATA_LENGTH);
+	TEST_ASSERT_FALSE(LZSS_IsCompleted(&context));
+	TEST_ASSERT_EQUAL(LZSS_Success, LZSS_Feed(&context, stream, streamLength));
+	TEST_ASSERT_TRUE(LZSS_IsCompleted(&context));
+
+	TEST_ASSERT_EQUAL(TEST_DATA_LENGTH, outputLength);
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, output, TEST_DATA_LENGTH);
+
+	/* Output is passed in window sized spans */
+	TEST_ASSERT_EQUAL((TEST_DATA_LENGTH + LZSS_WINDOW_SIZE - 1) / LZSS_WINDOW_SIZE, outputCallCount);
+}
+
+void test_Decode_SplitStream(void)
+{
+	uint32_t index;
+
+	compressData(TEST_DATA_LENGTH, LZSS_WINDOW_BITS);
+
+	/* Every field is split */
+	for (index = 0; index < streamLength; index++)
+	{
+		TEST_ASSERT_EQUAL(LZSS_Success, LZSS_Feed(&context, &stream[index], 1));
+	}
+
+	TEST_ASSERT_TRUE(LZSS_IsCompleted(&context));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, output, TEST_DATA_LENGTH);
+}
+
+void test_Decode_SmallerWindow(void)
+{
+	compressData(TEST_DATA_LENGTH, 8);
+
+	TEST_ASSERT_EQUAL(LZSS_Success, LZSS_Feed(&context, stream, streamLength));
+	TEST_ASSERT_TRUE(LZSS_IsCompleted(&context));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, output, TEST_DATA_LENGTH);
+}
+
+void test_Decode_EmptyData(void)
+{
+	compressData(0, LZSS_WINDOW_BITS);
+
+	TEST_ASSERT_EQUAL(LZSS_HEADER_LENGTH, streamLength);
+	TEST_ASSERT_EQUAL(LZSS_Success, LZSS_Feed(&context, stream, streamLength));
+	TEST_ASSERT_TRUE(LZSS_IsCompleted(&context));
+	TEST_ASSERT_EQUAL(0, outputCallCount);
+}
+
+void test_Decode_OverlappingReference(void)
+{
+	uint32_t bitOffset = LZSS_HEADER_LENGTH * 8;
+
+	/* 'a' followed by a reference which repeats it 5 times */
+	LZSS_EncodeHeader(6, 4, 4, stream);
+	appendBits(&bitOffset, 1, 1);
+	appendBits(&bitOffset, 'a', 8);
+	appendBits(&bitOffset, 0, 1);
+	appendBits(&bitOffset, 0, 4);
+	appendBits(&bitOffset, 4, 4);
+
+	TEST_ASSERT_EQUAL(LZSS_Success, LZSS_Feed(&context, stream, (bitOffset + 7) / 8));
+	TEST_ASSERT_TRUE(LZSS_IsCompleted(&context));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY("aaaaaa", output, 6);
+}
+
+void test_Decode_InvalidReference(void)
+{
+	uint32_t bitOffset = LZSS_HEADER_LENGTH * 8;
+
+	/* Reference before start of data */
+	LZSS_EncodeHeader(6, 4, 4, stream);
+	appendBits(&bitOffset, 1, 1);
+	appendBits(&bitOffset, 'a', 8);
+	appendBits(&bitOffset, 0, 1);
+	appendBits(&bitOffset, 1, 4);
+	appendBits(&bitOffset, 4, 4);
+
+	TEST_ASSERT_EQUAL(LZSS_Err_InvalidFormat, LZSS_Feed(&context, stream, (bitOffset + 7) / 8));
+	TEST_ASSERT_FALSE(LZSS_IsCompleted(&context));
+
+	/* Error is kept */
+	TEST_ASSERT_EQUAL(LZSS_Err_InvalidFormat, LZSS_Feed(&context, stream, 1));
+}
+
+void test_Decode_InvalidHeader(void)
+{
+	compressData(100, LZSS_WINDOW_BITS);
+	stream[0] ^= 0xFF;
+
+	TEST_ASSERT_EQUAL(LZSS_Err_InvalidFormat, LZSS_Feed(&context, stream, streamLength));
+	TEST_ASSERT_EQUAL(0, outputLength);
+
+	/* Window must fit into decoder */
+	LZSS_InitContext(&context, writeOutput);
+	LZSS_EncodeHeader(100, LZSS_WINDOW_BITS + 1, 4, stream);
+	TEST_ASSERT_EQUAL(LZSS_Err_InvalidFormat, LZSS_Feed(&context, stream, LZSS_HEADER_LENGTH));
+}
+
+void test_Decode_DataAfterEnd(void)
+{
+	compressData(100, LZSS_WINDOW_BITS);
+	stream[streamLength++] = 0;
+
+	TEST_ASSERT_EQUAL(LZSS_Err_InvalidFormat, LZSS_Feed(&context, stream, streamLength));
+	TEST_ASSERT_EQUAL(100, outputLength);
+}
+
+void test_Decode_OutputFailure(void)
+{
+	compressData(TEST_DATA_LENGTH, LZSS_WINDOW_BITS);
+	acceptOutput = false;
+
+	TEST_ASSERT_EQUAL(LZSS_Err_OutputFailure, LZSS_Feed(&context, stream, streamLength));
+	TEST_ASSERT_EQUAL(1, outputCallCount);
+}
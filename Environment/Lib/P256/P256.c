@@ -0,0 +1,548 @@
+/*******************************************************************************
+*
+* @file P256.c
+*
+* @author MC
+*
+* @brief Compact ECDSA P-256 Signature Verification Implementation
+*
+*		 Points are kept in Jacobian coordinates in Montgomery domain, so
+*		 only two inversions are required. u1 * G + u2 * Q is calculated by
+*		 a single double-and-add loop (Shamir's trick).
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "P256.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of 32 bit words of a field element or scalar */
+#define P256_WORD_COUNT								(8)
+
+/* Number of bits of a scalar */
+#define P256_BIT_COUNT								(256)
+
+/*
+ * Called for each Montgomery multiplication. Benchmarks count
+ * multiplications to estimate target cycles.
+ */
+#ifndef P256_MONT_MUL_HOOK
+#define P256_MONT_MUL_HOOK()
+#endif
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Modulus of field (p) or group order (n) with its Montgomery constants
+ */
+typedef struct
+{
+	uint32_t m[P256_WORD_COUNT];
+	/* -m^-1 mod 2^32 */
+	uint32_t mInv;
+	/* R^2 mod m, R = 2^256 */
+	uint32_t rr[P256_WORD_COUNT];
+} P256Modulus;
+
+/*
+ * Point in Jacobian coordinates (X / Z^2, Y / Z^3), Z is zero at infinity
+ */
+typedef struct
+{
+	uint32_t x[P256_WORD_COUNT];
+	uint32_t y[P256_WORD_COUNT];
+	uint32_t z[P256_WORD_COUNT];
+} P256Point;
+
+/******************************** VARIABLES ***********************************/
+/*
+ * Curve parameters, words are little endian
+ */
+PRIVATE const P256Modulus fieldModulus =
+{
+	{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF },
+	0x00000001,
+	{ 0x00000003, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFB, 0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFD, 0x00000004 }
+};
+
+PRIVATE const P256Modulus orderModulus =
+{
+	{ 0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF },
+	0xEE00BC4F,
+	{ 0xBE79EEA2, 0x83244C95, 0x49BD6FA6, 0x4699799C, 0x2B6BEC59, 0x2845B239, 0xF3D95620, 0x66E12D94 }
+};
+
+PRIVATE const uint32_t curveB[P256_WORD_COUNT] =
+{
+	0x27D2604B, 0x3BCE3C3E, 0xCC53B0F6, 0x651D06B0, 0x769886BC, 0xB3EBBD55, 0xAA3A93E7, 0x5AC635D8
+};
+
+PRIVATE const uint32_t generatorX[P256_WORD_COUNT] =
+{
+	0xD898C296, 0xF4A13945, 0x2DEB33A0, 0x77037D81, 0x63A440F2, 0xF8BCE6E5, 0xE12C4247, 0x6B17D1F2
+};
+
+PRIVATE const uint32_t generatorY[P256_WORD_COUNT] =
+{
+	0x37BF51F5, 0xCBB64068, 0x6B315ECE, 0x2BCE3357, 0x7C0F9E16, 0x8EE7EB4A, 0xFE1A7F9B, 0x4FE342E2
+};
+
+PRIVATE const uint32_t one[P256_WORD_COUNT] = { 1 };
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Reads a big endian coordinate or scalar
+ */
+PRIVATE void readWords(uint32_t* words, const uint8_t* bytes)
+{
+	uint32_t index;
+
+	for (index = 0; index < P256_WORD_COUNT; index++)
+	{
+		const uint8_t* word = &bytes[P256_COORDINATE_LENGTH - 4 - (4 * index)];
+
+		words[index] = ((uint32_t)word[0] << 24) | ((uint32_t)word[1] << 16) | ((uint32_t)word[2] << 8) | word[3];
+	}
+}
+
+PRIVATE bool isZero(const uint32_t* a)
+{
+	uint32_t bits = 0;
+	uint32_t index;
+
+	for (index = 0; index < P256_WORD_COUNT; index++)
+	{
+		bits |= a[index];
+	}
+
+	return (bits == 0);
+}
+
+/*
+ * Compares two numbers, returns -1, 0 or 1
+ */
+PRIVATE int32_t compare(const uint32_t* a, const uint32_t* b)
+{
+	int32_t index;
+
+	for (index = P256_WORD_COUNT - 1; index >= 0; index--)
+	{
+		if (a[index] != b[index])
+		{
+			return (a[index] > b[index]) ? 1 : -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * r = a + b, returns carry
+ */
+PRIVATE uint32_t addWords(uint32_t* r, const uint32_t* a, const uint32_t* b)
+{
+	uint64_t sum = 0;
+	uint32_t index;
+
+	for (index = 0; index < P256_WORD_COUNT; index++)
+	{
+		sum += (uint64_t)a[index] + b[index];
+		r[index] = (uint32_t)sum;
+		sum >>= 32;
+	}
+
+	return (uint32_t)sum;
+}
+
+/*
+ * r = a - b, returns borrow
+ */
+PRIVATE uint32_t subWords(uint32_t* r, const uint32_t* a, const uint32_t* b)
+{
+	int64_t difference = 0;
+	uint32_t index;
+
+	for (index = 0; index < P256_WORD_COUNT; index++)
+	{
+		difference += (int64_t)a[index] - b[index];
+		r[index] = (uint32_t)difference;
+		difference >>= 32;
+	}
+
+	return (uint32_t)(difference & 1);
+}
+
+/*
+ * r = a + b mod m
+ */
+PRIVATE void modAdd(uint32_t* r, const uint32_t* a, const uint32_t* b, const P256Modulus* modulus)
+{
+	if (addWords(r, a, b) || (compare(r, modulus->m) >= 0))
+	{
+		subWords(r, r, modulus->m);
+	}
+}
+
+/*
+ * r = a - b mod m
+ */
+PRIVATE void modSub(uint32_t* r, const uint32_t* a, const uint32_t* b, const P256Modulus* modulus)
+{
+	if (subWords(r, a, b))
+	{
+		addWords(r, r, modulus->m);
+	}
+}
+
+/*
+ * r = a * b / R mod m (CIOS Montgomery multiplication)
+ */
+PRIVATE void montMul(uint32_t* r, const uint32_t* a, const uint32_t* b, const P256Modulus* modulus)
+{
+	uint32_t t[P256_WORD_COUNT + 2] = { 0 };
+	uint64_t product;
+	uint32_t carry;
+	uint32_t factor;
+	uint32_t i;
+	uint32_t j;
+
+	P256_MONT_MUL_HOOK();
+
+	for (i = 0; i < P256_WORD_COUNT; i++)
+	{
+		carry = 0;
+		for (j = 0; j < P256_WORD_COUNT; j++)
+		{
+			product = (uint64_t)a[j] * b[i] + t[j] + carry;
+			t[j] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		product = (uint64_t)t[P256_WORD_COUNT] + carry;
+		t[P256_WORD_COUNT] = (uint32_t)product;
+		t[P256_WORD_COUNT + 1] = (uint32_t)(product >> 32);
+
+		/* Lowest word is cleared and shifted out */
+		factor = t[0] * modulus->mInv;
+		product = (uint64_t)factor * modulus->m[0] + t[0];
+		carry = (uint32_t)(product >> 32);
+		for (j = 1; j < P256_WORD_COUNT; j++)
+		{
+			product = (uint64_t)factor * modulus->m[j] + t[j] + carry;
+			t[j - 1] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		product = (uint64_t)t[P256_WORD_COUNT] + carry;
+		t[P256_WORD_COUNT - 1] = (uint32_t)product;
+		t[P256_WORD_COUNT] = t[P256_WORD_COUNT + 1] + (uint32_t)(product >> 32);
+	}
+
+	/* Result is less than 2m */
+	if ((t[P256_WORD_COUNT] != 0) || (compare(t, modulus->m) >= 0))
+	{
+		subWords(t, t, modulus->m);
+	}
+
+	memcpy(r, t, P256_WORD_COUNT * sizeof(uint32_t));
+}
+
+PRIVATE ALWAYS_INLINE void toMont(uint32_t* r, const uint32_t* a, const P256Modulus* modulus)
+{
+	montMul(r, a, modulus->rr, modulus);
+}
+
+PRIVATE ALWAYS_INLINE void fromMont(uint32_t* r, const uint32_t* a, const P256Modulus* modulus)
+{
+	montMul(r, a, one, modulus);
+}
+
+/*
+ * r = a^-1 mod m (a^(m-2), Fermat). Input and output are in Montgomery domain.
+ */
+PRIVATE void montInv(uint32_t* r, const uint32_t* a, const P256Modulus* modulus)
+{
+	const uint32_t two[P256_WORD_COUNT] = { 2 };
+	uint32_t exponent[P256_WORD_COUNT];
+	uint32_t result[P256_WORD_COUNT];
+	int32_t bitNo;
+
+	subWords(exponent, modulus->m, two);
+	toMont(result, one, modulus);
+
+	for (bitNo = P256_BIT_COUNT - 1; bitNo >= 0; bitNo--)
+	{
+		montMul(result, result, result, modulus);
+
+		if (exponent[bitNo / 32] & (1UL << (bitNo % 32)))
+		{
+			montMul(result, result, a, modulus);
+		}
+	}
+
+	memcpy(r, result, sizeof(result));
+}
+
+/*
+ * r = 2 * p (a = -3, dbl-2001-b)
+ */
+PRIVATE void pointDouble(P256Point* r, const P256Point* p)
+{
+	const P256Modulus* f = &fieldModulus;
+	uint32_t delta[P256_WORD_COUNT];
+	uint32_t gamma[P256_WORD_COUNT];
+	uint32_t beta[P256_WORD_COUNT];
+	uint32_t alpha[P256_WORD_COUNT];
+	uint32_t t1[P256_WORD_COUNT];
+	uint32_t t2[P256_WORD_COUNT];
+
+	if (isZero(p->z))
+	{
+		*r = *p;
+		return;
+	}
+
+	montMul(delta, p->z, p->z, f);
+	montMul(gamma, p->y, p->y, f);
+	montMul(beta, p->x, gamma, f);
+
+	/* alpha = 3 * (x - delta) * (x + delta) */
+	modSub(t1, p->x, delta, f);
+	modAdd(t2, p->x, delta, f);
+	montMul(alpha, t1, t2, f);
+	modAdd(t1, alpha, alpha, f);
+	modAdd(alpha, t1, alpha, f);
+
+	/* z3 = (y + z)^2 - gamma - delta */
+	modAdd(t1, p->y, p->z, f);
+	montMul(t1, t1, t1, f);
+	modSub(t1, t1, gamma, f);
+	modSub(r->z, t1, delta, f);
+
+	/* x3 = alpha^2 - 8 * beta */
+	modAdd(beta, beta, beta, f);
+	modAdd(beta, beta, beta, f);
+	modAdd(t2, beta, beta, f);
+	montMul(t1, alpha, alpha, f);
+	modSub(r->x, t1, t2, f);
+
+	/* y3 = alpha * (4 * beta - x3) - 8 * gamma^2 */
+	montMul(gamma, gamma, gamma, f);
+	modAdd(gamma, gamma, gamma, f);
+	modAdd(gamma, gamma, gamma, f);
+	modAdd(gamma, gamma, gamma, f);
+	modSub(t1, beta, r->x, f);
+	montMul(t1, alpha, t1, f);
+	modSub(r->y, t1, gamma, f);
+}
+
+/*
+ * r = p + q (add-2007-bl)
+ */
+PRIVATE void pointAdd(P256Point* r, const P256Point* p, const P256Point* q)
+{
+	const P256Modulus* f = &fieldModulus;
+	uint32_t z1z1[P256_WORD_COUNT];
+	uint32_t z2z2[P256_WORD_COUNT];
+	uint32_t u1[P256_WORD_COUNT];
+	uint32_t u2[P256_WORD_COUNT];
+	uint32_t s1[P256_WORD_COUNT];
+	uint32_t s2[P256_WORD_COUNT];
+	uint32_t h[P256_WORD_COUNT];
+	uint32_t hh[P256_WORD_COUNT];
+	uint32_t t[P256_WORD_COUNT];
+
+	if (isZero(p->z))
+	{
+		*r = *q;
+		return;
+	}
+
+	if (isZero(q->z))
+	{
+		*r = *p;
+		return;
+	}
+
+	montMul(z1z1, p->z, p->z, f);
+	montMul(z2z2, q->z, q->z, f);
+	montMul(u1, p->x, z2z2, f);
+	montMul(u2, q->x, z1z1, f);
+	montMul(s1, p->y, q->z, f);
+	montMul(s1, s1, z2z2, f);
+	montMul(s2, q->y, p->z, f);
+	montMul(s2, s2, z1z1, f);
+
+	modSub(h, u2, u1, f);
+	modSub(s2, s2, s1, f);
+
+	if (isZero(h))
+	{
+		if (isZero(s2))
+		{
+			pointDouble(r, p);
+		}
+		else
+		{
+			memset(r, 0, sizeof(P256Point));
+		}
+		return;
+	}
+
+	/* z3 = z1 * z2 * h */
+	montMul(t, p->z, q->z, f);
+	montMul(r->z, t, h, f);
+
+	/* hh = h^2, h = h^3, u1 = u1 * h^2 */
+	montMul(hh, h, h, f);
+	montMul(h, h, hh, f);
+	montMul(u1, u1, hh, f);
+
+	/* x3 = r^2 - h^3 - 2 * u1 * h^2 */
+	montMul(t, s2, s2, f);
+	modSub(t, t, h, f);
+	modSub(t, t, u1, f);
+	modSub(r->x, t, u1, f);
+
+	/* y3 = r * (u1 * h^2 - x3) - s1 * h^3 */
+	modSub(t, u1, r->x, f);
+	montMul(t, s2, t, f);
+	montMul(s1, s1, h, f);
+	modSub(r->y, t, s1, f);
+}
+
+/*
+ * Checks y^2 = x^3 - 3x + b, coordinates are in Montgomery domain
+ */
+PRIVATE bool isOnCurve(const uint32_t* x, const uint32_t* y)
+{
+	const P256Modulus* f = &fieldModulus;
+	uint32_t left[P256_WORD_COUNT];
+	uint32_t right[P256_WORD_COUNT];
+	uint32_t t[P256_WORD_COUNT];
+
+	montMul(left, y, y, f);
+
+	montMul(right, x, x, f);
+	montMul(right, right, x, f);
+	modSub(right, right, x, f);
+	modSub(right, right, x, f);
+	modSub(right, right, x, f);
+	toMont(t, curveB, f);
+	modAdd(right, right, t, f);
+
+	return (compare(left, right) == 0);
+}
+
+/*
+ * Reads a scalar and checks 0 < scalar < n
+ */
+PRIVATE bool readScalar(uint32_t* scalar, const uint8_t* bytes)
+{
+	readWords(scalar, bytes);
+
+	return !isZero(scalar) && (compare(scalar, orderModulus.m) < 0);
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Verifies an ECDSA P-256 signature of a digest
+ */
+P256StatusCode P256_VerifySignature(const uint8_t* publicKey, const uint8_t* hash, const uint8_t* signature)
+{
+	const P256Modulus* f = &fieldModulus;
+	const P256Modulus* n = &orderModulus;
+	/* G, Q and G + Q */
+	P256Point points[3];
+	P256Point result;
+	uint32_t r[P256_WORD_COUNT];
+	uint32_t s[P256_WORD_COUNT];
+	uint32_t e[P256_WORD_COUNT];
+	uint32_t u1[P256_WORD_COUNT];
+	uint32_t u2[P256_WORD_COUNT];
+	uint32_t t[P256_WORD_COUNT];
+	uint32_t index;
+	int32_t bitNo;
+
+	/* Public key must be a point of curve */
+	readWords(points[1].x, publicKey);
+	readWords(points[1].y, &publicKey[P256_COORDINATE_LENGTH]);
+
+	if ((compare(points[1].x, f->m) >= 0) || (compare(points[1].y, f->m) >= 0))
+	{
+		return P256_Err_InvalidPublicKey;
+	}
+
+	toMont(points[1].x, points[1].x, f);
+	toMont(points[1].y, points[1].y, f);
+	toMont(points[1].z, one, f);
+
+	if (!isOnCurve(points[1].x, points[1].y))
+	{
+		return P256_Err_InvalidPublicKey;
+	}
+
+	if (!readScalar(r, signature) || !readScalar(s, &signature[P256_COORDINATE_LENGTH]))
+	{
+		return P256_Err_InvalidSignature;
+	}
+
+	/* Digest is as long as order, e < 2n */
+	readWords(e, hash);
+	if (compare(e, n->m) >= 0)
+	{
+		subWords(e, e, n->m);
+	}
+
+	/* u1 = e / s, u2 = r / s (mod n) */
+	toMont(t, s, n);
+	montInv(t, t, n);
+	montMul(u1, e, t, n);
+	montMul(u2, r, t, n);
+
+	toMont(points[0].x, generatorX, f);
+	toMont(points[0].y, generatorY, f);
+	toMont(points[0].z, one, f);
+	pointAdd(&points[2], &points[0], &points[1]);
+
+	/* result = u1 * G + u2 * Q */
+	memset(&result, 0, sizeof(result));
+
+	for (bitNo = P256_BIT_COUNT - 1; bitNo >= 0; bitNo--)
+	{
+		pointDouble(&result, &result);
+
+		index = ((u1[bitNo / 32] >> (bitNo % 32)) & 1) | (((u2[bitNo / 32] >> (bitNo % 32)) & 1) << 1);
+		if (index != 0)
+		{
+			pointAdd(&result, &result, &points[index - 1]);
+		}
+	}
+
+	if (isZero(result.z))
+	{
+		return P256_Err_InvalidSignature;
+	}
+
+	/* x = X / Z^2, signature is valid if x mod n = r */
+	montInv(t, result.z, f);
+	montMul(t, t, t, f);
+	montMul(t, result.x, t, f);
+	fromMont(t, t, f);
+
+	if (compare(t, n->m) >= 0)
+	{
+		subWords(t, t, n->m);
+	}
+
+	return (compare(t, r) == 0) ? P256_Success : P256_Err_InvalidSignature;
+}
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *
+ * @file P256.h
+ *
+ * @author MC
+ *
+ * @brief Compact ECDSA P-256 Signature Verification.
+ *
+ *		  Verifies ECDSA signatures on NIST P-256 (secp256r1) curve. Field
+ *		  and scalar arithmetic uses fixed 8 x 32 bit words with Montgomery
+ *		  multiplication, so verification does not allocate heap memory.
+ *		  Only public data is processed, operations are not constant time.
+ *
+ *		  Keys and signatures are big endian byte arrays:
+ *
+ *		  Public Key  : X (32 bytes) | Y (32 bytes)
+ *		  Signature   : R (32 bytes) | S (32 bytes)
+ *
+ * @see FIPS 186-4, SEC 1 v2 (4.1.4)
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __P256_H
+#define __P256_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Length of a coordinate or scalar in bytes */
+#define P256_COORDINATE_LENGTH						(32)
+
+/* Length of uncompressed public key (without 0x04 prefix) */
+#define P256_PUBLIC_KEY_LENGTH						(2 * P256_COORDINATE_LENGTH)
+
+/* Length of raw signature */
+#define P256_SIGNATURE_LENGTH						(2 * P256_COORDINATE_LENGTH)
+
+/* Length of message digest (SHA-256) */
+#define P256_HASH_LENGTH							(32)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * P256 Library Specific Status Codes
+ */
+typedef enum
+{
+	P256_Success = 0,
+	/* Public key is not a point of curve */
+	P256_Err_InvalidPublicKey,
+	/* Signature is out of range or does not match */
+	P256_Err_InvalidSignature
+} P256StatusCode;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Verifies an ECDSA P-256 signature of a digest.
+ *
+ * @param publicKey Uncompressed public key (P256_PUBLIC_KEY_LENGTH bytes)
+ * @param hash Digest of signed message (P256_HASH_LENGTH bytes)
+ * @param signature Signature (P256_SIGNATURE_LENGTH bytes)
+ *
+ * @return P256_Success if signature is valid
+ */
+P256StatusCode P256_VerifySignature(const uint8_t* publicKey, const uint8_t* hash, const uint8_t* signature);
+
+#endif	/* __P256_H */
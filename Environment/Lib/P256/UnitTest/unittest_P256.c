@@ -0,0 +1,189 @@
+/*******************************************************************************
+ *
+ * @file unittest_P256.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for ECDSA P-256 Signature Verification Library
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../P256.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Public key of test signatures */
+PRIVATE const uint8_t testPublicKey[P256_PUBLIC_KEY_LENGTH] =
+{
+	0xFD, 0x8A, 0xF6, 0x7E, 0x36, 0x95, 0xF0, 0x39, 0xD4, 0xB7, 0xAE, 0xF7, 0x66, 0x5D, 0x4F, 0xF4,
+	0x29, 0x17, 0x42, 0x6F, 0x39, 0x13, 0x12, 0x26, 0x61, 0xF6, 0xFD, 0x6D, 0xE5, 0x52, 0x4A, 0xBE,
+	0x90, 0x5A, 0xDB, 0x39, 0x1A, 0xCF, 0x00, 0x8B, 0xA6, 0x59, 0xEE, 0xC0, 0xDA, 0x0C, 0x17, 0x70,
+	0xB4, 0xD0, 0x20, 0x95, 0x09, 0x6A, 0x74, 0x2D, 0x4C, 0x20, 0x30, 0x09, 0x00, 0x89, 0xC1, 0x51
+};
+
+/* SHA-256 digest of "abc" and its signature */
+PRIVATE const uint8_t testHash[P256_HASH_LENGTH] =
+{
+	0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+	0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+};
+
+PRIVATE const uint8_t testSignature[P256_SIGNATURE_LENGTH] =
+{
+	0xC0, 0xE7, 0xD9, 0x11, 0x38, 0x04, 0xAF, 0x67, 0x5D, 0x91, 0x41, 0xAB, 0x1D, 0x6C, 0x3B, 0x0F,
+	0xBA, 0x10, 0x42, 0x3C, 0x76, 0xA2, 0xE0, 0x1E, 0x99, 0x91, 0x6B, 0xCA, 0x4D, 0x7E, 0x34, 0x31,
+	0x39, 0xE7, 0x4B, 0xD4, 0xCB, 0x9F, 0x10, 0xA5, 0x0B, 0xA6, 0x65, 0x6D, 0x67, 0x93, 0x69, 0x22,
+	0xF6, 0xFF, 0x77, 0x78, 0xCD, 0x10, 0xA9, 0x75, 0xD8, 0x9B, 0x08, 0xEE, 0x5D, 0x2B, 0x39, 0xF6
+};
+
+/* Signature of a digest which is greater than order (all bytes 0xFF) */
+PRIVATE const uint8_t testLargeHashSignature[P256_SIGNATURE_LENGTH] =
+{
+	0x3E, 0xD7, 0xA2, 0x8E, 0xC6, 0x48, 0xED, 0xCE, 0x5D, 0x5B, 0x7E, 0x25, 0x2F, 0x6B, 0x2A, 0xAF,
+	0xBB, 0x44, 0x83, 0x51, 0x14, 0xA2, 0x4B, 0x3C, 0xAA, 0x8F, 0x71, 0x0F, 0x64, 0x99, 0x3B, 0xC2,
+	0xF1, 0xD1, 0x84, 0x4A, 0x7D, 0xBE, 0x6C, 0xA0, 0x44, 0xC4, 0xB2, 0x0C, 0x7C, 0xEE, 0x0A, 0xE2,
+	0x27, 0x34, 0xF5, 0x9F, 0x07, 0x82, 0x14, 0xD7, 0x4C, 0xF7, 0x5F, 0x7B, 0x3D, 0xC9, 0x00, 0x43
+};
+
+/* Modifiable copies */
+PRIVATE uint8_t publicKey[P256_PUBLIC_KEY_LENGTH];
+PRIVATE uint8_t hash[P256_HASH_LENGTH];
+PRIVATE uint8_t signature[P256_SIGNATURE_LENGTH];
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	memcpy(publicKey, testPublicKey, sizeof(publicKey));
+	memcpy(hash, testHash, sizeof(hash));
+	memcpy(signature, testSignature, sizeof(signature));
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/***************************** TEST FUNCTIONS *******************************/
+
+void test_Verify_ValidSignature(void)
+{
+	TEST_ASSERT_EQUAL(P256_Success, P256_VerifySignature(publicKey, hash, signature));
+}
+
+void test_Verify_LargeHash(void)
+{
+	memset(hash, 0xFF, sizeof(hash));
+
+	TEST_ASSERT_EQUAL(P256_Success, P256_VerifySignature(publicKey, hash, testLargeHashSignature));
+}
+
+void test_Verify_ModifiedHash(void)
+{
+	hash[P256_HASH_LENGTH - 1] ^= 0x01;
+
+	TEST_ASSERT_EQUAL(P256_Err_InvalidSignature, P256_VerifySignature(publicKey, hash, signature));
+}
+
+void test_Verify_ModifiedSignature(void)
+{
+	signature[5] ^= 0x40;
+	TEST_ASSERT_EQUAL(P256_Err_InvalidSignature, P256_VerifySignature(publicKey, hash, signature));
+
+	memcpy(signature, testSignature, sizeof(signature));
+	signature[P256_COORDINATE_LENGTH + 20] ^= 0x02;
+	TEST_ASSERT_EQUAL(P256_Err_InvalidSignature, P256_VerifySignature(publicKey, hash, signature));
+}
+
+void test_Verify_SignatureOutOfRange(void)
+{
+	/* r = 0 */
+	memset(signature, 0, P256_COORDINATE_LENGTH);
+	TEST_ASSERT_EQUAL(P256_Err_InvalidSignature, P256_VerifySignature(publicKey, hash, signature));
+
+	/* s >= n */
+	memcpy(signature, testSignature, sizeof(signature));
+	memset(&signature[P256_COORDINATE_LENGTH], 0xFF, P256_COORDINATE_LENGTH);
+	TEST_ASSERT_EQUAL(P256_Err_InvalidSignature, P256_VerifySignature(publicKey, hash, signature));
+}
+
+void test_Verify_InvalidPublicKey(void)
+{
+	/* Point is not on curve */
+	publicKey[P256_PUBLIC_KEY_LENGTH - 1] ^= 0x01;
+	TEST_ASSERT_EQUAL(P256_Err_InvalidPublicKey, P256_VerifySignature(publicKey, hash, signature));
+
+	/* Coordinate is not a field element */
+	memset(publicKey, 0xFF, P256_COORDINATE_LENGTH);
+	TEST_ASSERT_EQUAL(P256_Err_InvalidPublicKey, P256_VerifySignature(publicKey, hash, signature));
+}
+
+void test_Field_Inversion(void)
+{
+	uint32_t a[P256_WORD_COUNT];
+	uint32_t inverse[P256_WORD_COUNT];
+	uint32_t product[P256_WORD_COUNT];
+
+	toMont(a, generatorX, &fieldModulus);
+	montInv(inverse, a, &fieldModulus);
+	montMul(product, a, inverse, &fieldModulus);
+	fromMont(product, product, &fieldModulus);
+
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(one, product, P256_WORD_COUNT);
+}
+
+void test_Point_AddEqualsDouble(void)
+{
+	P256Point g;
+	P256Point sum;
+	P256Point doubled;
+	uint32_t x1[P256_WORD_COUNT];
+	uint32_t x2[P256_WORD_COUNT];
+	uint32_t t[P256_WORD_COUNT];
+
+	toMont(g.x, generatorX, &fieldModulus);
+	toMont(g.y, generatorY, &fieldModulus);
+	toMont(g.z, one, &fieldModulus);
+
+	pointAdd(&sum, &g, &g);
+	pointDouble(&doubled, &g);
+
+	/* Same point in different projective forms */
+	montMul(t, doubled.z, doubled.z, &fieldModulus);
+	montMul(x1, sum.x, t, &fieldModulus);
+	montMul(t, sum.z, sum.z, &fieldModulus);
+	montMul(x2, doubled.x, t, &fieldModulus);
+
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(x1, x2, P256_WORD_COUNT);
+}
@@ -0,0 +1,338 @@
+/*******************************************************************************
+*
+* @file RSA2048.c
+*
+* @author MC
+*
+* @brief Fixed Width RSA-2048 Signature Verification Implementation
+*
+*		 s^65537 mod n is 16 Montgomery squarings of s * R and a Montgomery
+*		 multiplication by s, which also leaves Montgomery domain. Squaring
+*		 computes each cross product once (1.5 n^2 multiplications with its
+*		 reduction instead of 2 n^2). Encoded
+*		 message is compared with expected encoding byte by byte, so it is
+*		 not written into a buffer.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "RSA2048.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Public exponent is 2^RSA2048_EXPONENT_SQUARE_COUNT + 1 */
+#define RSA2048_EXPONENT_SQUARE_COUNT				(16)
+
+/*
+ * EMSA-PKCS1-v1_5 encoding : 00 01 FF .. FF 00 DigestInfo Hash
+ */
+#define RSA2048_HASH_OFFSET							(RSA2048_SIGNATURE_LENGTH - RSA2048_HASH_LENGTH)
+#define RSA2048_DIGEST_INFO_OFFSET					(RSA2048_HASH_OFFSET - sizeof(digestInfo))
+#define RSA2048_SEPARATOR_OFFSET					(RSA2048_DIGEST_INFO_OFFSET - 1)
+
+/*
+ * Called for each Montgomery multiplication and squaring. Benchmarks count
+ * them to estimate target cycles.
+ */
+#ifndef RSA2048_MONT_MUL_HOOK
+#define RSA2048_MONT_MUL_HOOK()
+#endif
+
+#ifndef RSA2048_MONT_SQR_HOOK
+#define RSA2048_MONT_SQR_HOOK()
+#endif
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+/*
+ * DER encoded DigestInfo prefix of SHA-256
+ */
+PRIVATE const uint8_t digestInfo[] =
+{
+	0x30, 0x31, 0x30, 0x0D, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+	0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20
+};
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Reads a big endian number
+ */
+PRIVATE void readWords(uint32_t* words, const uint8_t* bytes)
+{
+	uint32_t index;
+
+	for (index = 0; index < RSA2048_WORD_COUNT; index++)
+	{
+		const uint8_t* word = &bytes[RSA2048_SIGNATURE_LENGTH - 4 - (4 * index)];
+
+		words[index] = ((uint32_t)word[0] << 24) | ((uint32_t)word[1] << 16) | ((uint32_t)word[2] << 8) | word[3];
+	}
+}
+
+/*
+ * Compares two numbers, returns -1, 0 or 1
+ */
+PRIVATE int32_t compare(const uint32_t* a, const uint32_t* b)
+{
+	int32_t index;
+
+	for (index = RSA2048_WORD_COUNT - 1; index >= 0; index--)
+	{
+		if (a[index] != b[index])
+		{
+			return (a[index] > b[index]) ? 1 : -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * r = a - b, returns borrow
+ */
+PRIVATE uint32_t subWords(uint32_t* r, const uint32_t* a, const uint32_t* b)
+{
+	int64_t difference = 0;
+	uint32_t index;
+
+	for (index = 0; index < RSA2048_WORD_COUNT; index++)
+	{
+		difference += (int64_t)a[index] - b[index];
+		r[index] = (uint32_t)difference;
+		difference >>= 32;
+	}
+
+	return (uint32_t)(difference & 1);
+}
+
+/*
+ * Returns -n^-1 mod 2^32 of an odd n (Newton iteration, each step doubles
+ * correct bits)
+ */
+PRIVATE uint32_t getMontgomeryFactor(uint32_t n)
+{
+	/* n * n = 1 mod 8 */
+	uint32_t inverse = n;
+	uint32_t step;
+
+	for (step = 0; step < 4; step++)
+	{
+		inverse *= 2 - (n * inverse);
+	}
+
+	return 0 - inverse;
+}
+
+/*
+ * r = a * b / R mod n (CIOS Montgomery multiplication), a, b < n
+ */
+PRIVATE void montMul(uint32_t* r, const uint32_t* a, const uint32_t* b, const uint32_t* n, uint32_t nInv)
+{
+	uint32_t t[RSA2048_WORD_COUNT + 2] = { 0 };
+	uint64_t product;
+	uint32_t carry;
+	uint32_t factor;
+	uint32_t i;
+	uint32_t j;
+
+	RSA2048_MONT_MUL_HOOK();
+
+	for (i = 0; i < RSA2048_WORD_COUNT; i++)
+	{
+		carry = 0;
+		for (j = 0; j < RSA2048_WORD_COUNT; j++)
+		{
+			product = (uint64_t)a[j] * b[i] + t[j] + carry;
+			t[j] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		product = (uint64_t)t[RSA2048_WORD_COUNT] + carry;
+		t[RSA2048_WORD_COUNT] = (uint32_t)product;
+		t[RSA2048_WORD_COUNT + 1] = (uint32_t)(product >> 32);
+
+		/* Lowest word is cleared and shifted out */
+		factor = t[0] * nInv;
+		product = (uint64_t)factor * n[0] + t[0];
+		carry = (uint32_t)(product >> 32);
+		for (j = 1; j < RSA2048_WORD_COUNT; j++)
+		{
+			product = (uint64_t)factor * n[j] + t[j] + carry;
+			t[j - 1] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		product = (uint64_t)t[RSA2048_WORD_COUNT] + carry;
+		t[RSA2048_WORD_COUNT - 1] = (uint32_t)product;
+		t[RSA2048_WORD_COUNT] = t[RSA2048_WORD_COUNT + 1] + (uint32_t)(product >> 32);
+	}
+
+	/* Result is less than 2n */
+	if ((t[RSA2048_WORD_COUNT] != 0) || (compare(t, n) >= 0))
+	{
+		subWords(t, t, n);
+	}
+
+	memcpy(r, t, RSA2048_WORD_COUNT * sizeof(uint32_t));
+}
+
+/*
+ * r = a * a / R mod n, a < n
+ */
+PRIVATE void montSqr(uint32_t* r, const uint32_t* a, const uint32_t* n, uint32_t nInv)
+{
+	uint32_t t[2 * RSA2048_WORD_COUNT] = { 0 };
+	uint64_t product;
+	uint32_t carry;
+	uint32_t topCarry;
+	uint32_t factor;
+	uint32_t i;
+	uint32_t j;
+
+	RSA2048_MONT_SQR_HOOK();
+
+	/* Cross products a[i] * a[j], i < j */
+	for (i = 0; i < RSA2048_WORD_COUNT; i++)
+	{
+		carry = 0;
+		for (j = i + 1; j < RSA2048_WORD_COUNT; j++)
+		{
+			product = (uint64_t)a[i] * a[j] + t[i + j] + carry;
+			t[i + j] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		t[i + RSA2048_WORD_COUNT] = carry;
+	}
+
+	/* Cross products are doubled and squares are added */
+	carry = 0;
+	for (i = 0; i < 2 * RSA2048_WORD_COUNT; i++)
+	{
+		uint32_t word = t[i];
+
+		t[i] = (word << 1) | carry;
+		carry = word >> 31;
+	}
+
+	carry = 0;
+	for (i = 0; i < RSA2048_WORD_COUNT; i++)
+	{
+		product = (uint64_t)a[i] * a[i] + t[2 * i] + carry;
+		t[2 * i] = (uint32_t)product;
+		product = (uint64_t)t[2 * i + 1] + (product >> 32);
+		t[2 * i + 1] = (uint32_t)product;
+		carry = (uint32_t)(product >> 32);
+	}
+
+	/* Lowest words are cleared, carries of top words are kept apart */
+	topCarry = 0;
+	for (i = 0; i < RSA2048_WORD_COUNT; i++)
+	{
+		factor = t[i] * nInv;
+		carry = 0;
+		for (j = 0; j < RSA2048_WORD_COUNT; j++)
+		{
+			product = (uint64_t)factor * n[j] + t[i + j] + carry;
+			t[i + j] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		product = (uint64_t)t[i + RSA2048_WORD_COUNT] + carry + topCarry;
+		t[i + RSA2048_WORD_COUNT] = (uint32_t)product;
+		topCarry = (uint32_t)(product >> 32);
+	}
+
+	/* Result is less than 2n */
+	if ((topCarry != 0) || (compare(&t[RSA2048_WORD_COUNT], n) >= 0))
+	{
+		subWords(&t[RSA2048_WORD_COUNT], &t[RSA2048_WORD_COUNT], n);
+	}
+
+	memcpy(r, &t[RSA2048_WORD_COUNT], RSA2048_WORD_COUNT * sizeof(uint32_t));
+}
+
+/*
+ * r = s^65537 mod n, s < n
+ */
+PRIVATE void publicOperation(uint32_t* r, const uint32_t* s, const RSA2048PublicKey* publicKey)
+{
+	uint32_t nInv = getMontgomeryFactor(publicKey->n[0]);
+	uint32_t squareNo;
+
+	/* s * R */
+	montMul(r, s, publicKey->rr, publicKey->n, nInv);
+
+	for (squareNo = 0; squareNo < RSA2048_EXPONENT_SQUARE_COUNT; squareNo++)
+	{
+		montSqr(r, r, publicKey->n, nInv);
+	}
+
+	/* s^65536 * R * s / R */
+	montMul(r, r, s, publicKey->n, nInv);
+}
+
+/*
+ * Returns byte of expected encoded message at given (big endian) position
+ */
+PRIVATE uint8_t getEncodedByte(const uint8_t* hash, uint32_t position)
+{
+	if (position >= RSA2048_HASH_OFFSET)
+	{
+		return hash[position - RSA2048_HASH_OFFSET];
+	}
+
+	if (position >= RSA2048_DIGEST_INFO_OFFSET)
+	{
+		return digestInfo[position - RSA2048_DIGEST_INFO_OFFSET];
+	}
+
+	if ((position == 0) || (position == RSA2048_SEPARATOR_OFFSET))
+	{
+		return 0x00;
+	}
+
+	return (position == 1) ? 0x01 : 0xFF;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Verifies an RSA-2048 PKCS#1 v1.5 signature of a SHA-256 digest
+ */
+RSA2048StatusCode RSA2048_VerifySignature(const RSA2048PublicKey* publicKey, const uint8_t* hash, const uint8_t* signature)
+{
+	uint32_t s[RSA2048_WORD_COUNT];
+	uint32_t m[RSA2048_WORD_COUNT];
+	uint32_t position;
+	uint8_t mismatch = 0;
+
+	if (((publicKey->n[0] & 1) == 0) || ((publicKey->n[RSA2048_WORD_COUNT - 1] >> 31) == 0))
+	{
+		return RSA2048_Err_InvalidPublicKey;
+	}
+
+	readWords(s, signature);
+	if (compare(s, publicKey->n) >= 0)
+	{
+		return RSA2048_Err_InvalidSignature;
+	}
+
+	publicOperation(m, s, publicKey);
+
+	for (position = 0; position < RSA2048_SIGNATURE_LENGTH; position++)
+	{
+		uint32_t byteNo = RSA2048_SIGNATURE_LENGTH - 1 - position;
+
+		mismatch |= (uint8_t)(m[byteNo / 4] >> (8 * (byteNo % 4))) ^ getEncodedByte(hash, position);
+	}
+
+	return (mismatch == 0) ? RSA2048_Success : RSA2048_Err_InvalidSignature;
+}
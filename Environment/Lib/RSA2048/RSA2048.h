@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *
+ * @file RSA2048.h
+ *
+ * @author MC
+ *
+ * @brief Fixed Width RSA-2048 Signature Verification.
+ *
+ *		  Verifies RSASSA-PKCS1-v1_5 signatures with SHA-256 digests and
+ *		  public exponent 65537. Numbers are fixed 64 x 32 bit words on stack,
+ *		  heap is not used and there is no recursion, so stack depth is
+ *		  bounded: verification frame keeps two numbers (512 bytes) and
+ *		  Montgomery squaring, the deepest leaf, keeps a double width
+ *		  product (128 words).
+ *		  Only public data is processed, operations are not constant time.
+ *
+ *		  Public key is modulus and R^2 mod modulus (R = 2^2048) as little
+ *		  endian words (see KeyGenerator.h), signature is big endian bytes.
+ *
+ * @see RFC 8017 (8.2.2, 9.2)
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __RSA2048_H
+#define __RSA2048_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of 32 bit words of modulus */
+#define RSA2048_WORD_COUNT							(64)
+
+/* Length of modulus and signature in bytes */
+#define RSA2048_SIGNATURE_LENGTH					(4 * RSA2048_WORD_COUNT)
+
+/* Length of message digest (SHA-256) */
+#define RSA2048_HASH_LENGTH							(32)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * RSA-2048 Library Specific Status Codes
+ */
+typedef enum
+{
+	RSA2048_Success = 0,
+	/* Modulus is not an odd 2048 bit number */
+	RSA2048_Err_InvalidPublicKey,
+	/* Signature is out of range or does not match */
+	RSA2048_Err_InvalidSignature
+} RSA2048StatusCode;
+
+/*
+ * Public key, words are little endian
+ */
+typedef struct
+{
+	/* Modulus */
+	uint32_t n[RSA2048_WORD_COUNT];
+	/* R^2 mod n, R = 2^2048 */
+	uint32_t rr[RSA2048_WORD_COUNT];
+} RSA2048PublicKey;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Verifies an RSA-2048 PKCS#1 v1.5 signature of a SHA-256 digest.
+ *
+ * @param publicKey Public key (exponent is 65537)
+ * @param hash Digest of signed message (RSA2048_HASH_LENGTH bytes)
+ * @param signature Signature (RSA2048_SIGNATURE_LENGTH bytes)
+ *
+ * @return RSA2048_Success if signature is valid
+ */
+RSA2048StatusCode RSA2048_VerifySignature(const RSA2048PublicKey* publicKey, const uint8_t* hash, const uint8_t* signature);
+
+#endif	/* __RSA2048_H */
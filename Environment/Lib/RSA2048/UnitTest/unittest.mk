@@ -0,0 +1,36 @@
+################################################################################
+#
+# @file unittest.mk
+#
+# @author MC
+#
+# @brief Unit test make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+TEST_TARGET_NAME=RSA2048
+
+# mbedTLS RSA is reference of cross validation
+include $(ROOT_PATH)/Environment/ExternalLib/mbedTLS/module.mk
+
+TEST_SRC_FILES = $(MBEDTLS_SRC_FILES)
+
+# mbedTLS configuration and test key of bootloader
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Projects/Bootloader/config \
+	-I$(ROOT_PATH)/Projects/Bootloader/config/mbedtls \
+	-I$(ROOT_PATH)/Bootloader/TestData
+
+# Private key of test key signs randomized digests
+UNITTEST_CFLAGS += \
+	-DTEST_RSA_PRIVATE_KEY_FILE=\"$(ROOT_PATH)/Bootloader/TestData/rsa_priv.txt\"
@@ -0,0 +1,368 @@
+/*******************************************************************************
+ *
+ * @file unittest_RSA2048.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for Fixed Width RSA-2048 Signature Verification
+ *		  Library
+ *
+ *		  Verifier is cross validated with mbedtls_rsa_pkcs1_verify on
+ *		  randomized signatures. Test key of bootloader (rsa_priv.txt) signs
+ *		  random digests and encodings.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../RSA2048.c"
+
+/* Reference implementation */
+#include "mbedtls/config.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/rsa.h"
+
+/* Key words of generated test key */
+#define RSA_KEY_WORDS(low, high)				(low), (high)
+
+#include "TestRSAKey.h"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of randomized signatures of each test */
+#define TEST_RANDOM_SIGNATURE_COUNT				(16)
+
+/* Maximum length of a line of key file */
+#define TEST_MAX_LINE_LENGTH					(1100)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Public key under test */
+PRIVATE const RSA2048PublicKey publicKey = { TEST_RSA_KEY_N, TEST_RSA_KEY_RN };
+
+/* Reference context with private key */
+PRIVATE mbedtls_rsa_context rsa;
+
+/* State of deterministic random generator */
+PRIVATE uint32_t randomState;
+
+/**************************** PRIVATE FUNCTIONS *******************************/
+/*
+ * Xorshift random generator, same signatures on each run
+ */
+PRIVATE int getRandom(void* state, unsigned char* output, size_t length)
+{
+	uint32_t* x = (uint32_t*)state;
+
+	while (length-- > 0)
+	{
+		*x ^= *x << 13;
+		*x ^= *x >> 17;
+		*x ^= *x << 5;
+		*output++ = (unsigned char)*x;
+	}
+
+	return 0;
+}
+
+/*
+ * Reads private key ("N = <hex>" lines) into reference context
+ */
+PRIVATE void readPrivateKey(void)
+{
+	char line[TEST_MAX_LINE_LENGTH];
+	char name[4];
+	char digits[TEST_MAX_LINE_LENGTH];
+	mbedtls_mpi* number;
+	FILE* file = fopen(TEST_RSA_PRIVATE_KEY_FILE, "r");
+
+	TEST_ASSERT_NOT_NULL(file);
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		if (sscanf(line, "%3s = %1099s", name, digits) != 2)
+		{
+			continue;
+		}
+
+		if (strcmp(name, "N") == 0)			number = &rsa.N;
+		else if (strcmp(name, "E") == 0)	number = &rsa.E;
+		else if (strcmp(name, "D") == 0)	number = &rsa.D;
+		else if (strcmp(name, "P") == 0)	number = &rsa.P;
+		else if (strcmp(name, "Q") == 0)	number = &rsa.Q;
+		else if (strcmp(name, "DP") == 0)	number = &rsa.DP;
+		else if (strcmp(name, "DQ") == 0)	number = &rsa.DQ;
+		else if (strcmp(name, "QP") == 0)	number = &rsa.QP;
+		else								continue;
+
+		TEST_ASSERT_EQUAL(0, mbedtls_mpi_read_string(number, 16, digits));
+	}
+
+	fclose(file);
+
+	rsa.len = mbedtls_mpi_size(&rsa.N);
+	TEST_ASSERT_EQUAL(0, mbedtls_rsa_check_privkey(&rsa));
+}
+
+/*
+ * Verifies by both verifiers, they must agree
+ *
+ * @return true if signature is valid
+ */
+PRIVATE bool verifyBoth(const uint8_t* hash, const uint8_t* signature)
+{
+	int referenceResult = mbedtls_rsa_pkcs1_verify(&rsa, NULL, NULL, MBEDTLS_RSA_PUBLIC, MBEDTLS_MD_SHA256,
+												   RSA2048_HASH_LENGTH, hash, signature);
+	RSA2048StatusCode status = RSA2048_VerifySignature(&publicKey, hash, signature);
+
+	TEST_ASSERT_EQUAL(referenceResult == 0, status == RSA2048_Success);
+
+	return (status == RSA2048_Success);
+}
+
+/*
+ * Signs an encoded message by private key
+ */
+PRIVATE void signEncoded(const uint8_t* encoded, uint8_t* signature)
+{
+	TEST_ASSERT_EQUAL(0, mbedtls_rsa_private(&rsa, getRandom, &randomState, encoded, signature));
+}
+
+/*
+ * Writes PKCS#1 v1.5 encoding of a digest
+ */
+PRIVATE void encode(const uint8_t* hash, uint8_t* encoded)
+{
+	uint32_t position;
+
+	for (position = 0; position < RSA2048_SIGNATURE_LENGTH; position++)
+	{
+		encoded[position] = getEncodedByte(hash, position);
+	}
+}
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	randomState = 0x2545F491;
+
+	mbedtls_platform_set_calloc_free(calloc, free);
+
+	mbedtls_rsa_init(&rsa, MBEDTLS_RSA_PKCS_V15, 0);
+	readPrivateKey();
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	mbedtls_rsa_free(&rsa);
+}
+
+/****************************** TEST FUNCTIONS ********************************/
+
+void test_PublicKey_MatchesPrivateKey(void)
+{
+	uint8_t modulus[RSA2048_SIGNATURE_LENGTH];
+	uint32_t words[RSA2048_WORD_COUNT];
+	mbedtls_mpi rr;
+
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_write_binary(&rsa.N, modulus, sizeof(modulus)));
+	readWords(words, modulus);
+	TEST_ASSERT_EQUAL_UINT32_ARRAY(words, publicKey.n, RSA2048_WORD_COUNT);
+
+	/* R^2 mod N */
+	mbedtls_mpi_init(&rr);
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_lset(&rr, 1));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_shift_l(&rr, 2 * 8 * RSA2048_SIGNATURE_LENGTH));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_mod_mpi(&rr, &rr, &rsa.N));
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_write_binary(&rr, modulus, sizeof(modulus)));
+	mbedtls_mpi_free(&rr);
+
+	readWords(words, modulus);
+	TEST_ASSERT_EQUAL_UINT32_ARRAY(words, publicKey.rr, RSA2048_WORD_COUNT);
+}
+
+void test_MontgomeryFactor(void)
+{
+	uint32_t n;
+	uint32_t index;
+
+	for (index = 0; index < 1000; index++)
+	{
+		getRandom(&randomState, (uint8_t*)&n, sizeof(n));
+		n |= 1;
+
+		TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, n * getMontgomeryFactor(n));
+	}
+}
+
+void test_MontgomerySquare_MatchesMultiplication(void)
+{
+	uint8_t input[RSA2048_SIGNATURE_LENGTH];
+	uint32_t a[RSA2048_WORD_COUNT];
+	uint32_t expected[RSA2048_WORD_COUNT];
+	uint32_t square[RSA2048_WORD_COUNT];
+	uint32_t nInv = getMontgomeryFactor(publicKey.n[0]);
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_SIGNATURE_COUNT; index++)
+	{
+		getRandom(&randomState, input, sizeof(input));
+		input[0] &= 0x7F;
+
+		readWords(a, input);
+		montMul(expected, a, a, publicKey.n, nInv);
+		montSqr(square, a, publicKey.n, nInv);
+		TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, square, RSA2048_WORD_COUNT);
+	}
+
+	/* Largest number, n - 1 */
+	memcpy(a, publicKey.n, sizeof(a));
+	a[0]--;
+	montMul(expected, a, a, publicKey.n, nInv);
+	montSqr(square, a, publicKey.n, nInv);
+	TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, square, RSA2048_WORD_COUNT);
+}
+
+void test_PublicOperation_RandomNumbers(void)
+{
+	uint8_t input[RSA2048_SIGNATURE_LENGTH];
+	uint8_t expected[RSA2048_SIGNATURE_LENGTH];
+	uint8_t hash[RSA2048_HASH_LENGTH] = { 0 };
+	uint32_t s[RSA2048_WORD_COUNT];
+	uint32_t m[RSA2048_WORD_COUNT];
+	uint32_t words[RSA2048_WORD_COUNT];
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_SIGNATURE_COUNT; index++)
+	{
+		getRandom(&randomState, input, sizeof(input));
+		input[0] &= 0x7F;
+
+		TEST_ASSERT_EQUAL(0, mbedtls_rsa_public(&rsa, input, expected));
+
+		readWords(s, input);
+		publicOperation(m, s, &publicKey);
+		readWords(words, expected);
+		TEST_ASSERT_EQUAL_UINT32_ARRAY(words, m, RSA2048_WORD_COUNT);
+
+		/* Random number is not a valid signature */
+		TEST_ASSERT_FALSE(verifyBoth(hash, input));
+	}
+}
+
+void test_Verify_RandomSignatures(void)
+{
+	uint8_t hash[RSA2048_HASH_LENGTH];
+	uint8_t signature[RSA2048_SIGNATURE_LENGTH];
+	uint32_t bitNo;
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_SIGNATURE_COUNT; index++)
+	{
+		getRandom(&randomState, hash, sizeof(hash));
+
+		TEST_ASSERT_EQUAL(0, mbedtls_rsa_pkcs1_sign(&rsa, getRandom, &randomState, MBEDTLS_RSA_PRIVATE,
+													MBEDTLS_MD_SHA256, RSA2048_HASH_LENGTH, hash, signature));
+
+		TEST_ASSERT_TRUE(verifyBoth(hash, signature));
+
+		/* A flipped bit of digest */
+		getRandom(&randomState, (uint8_t*)&bitNo, sizeof(bitNo));
+		hash[(bitNo / 8) % RSA2048_HASH_LENGTH] ^= (uint8_t)(1 << (bitNo % 8));
+		TEST_ASSERT_FALSE(verifyBoth(hash, signature));
+		hash[(bitNo / 8) % RSA2048_HASH_LENGTH] ^= (uint8_t)(1 << (bitNo % 8));
+
+		/* A flipped bit of signature */
+		getRandom(&randomState, (uint8_t*)&bitNo, sizeof(bitNo));
+		signature[(bitNo / 8) % RSA2048_SIGNATURE_LENGTH] ^= (uint8_t)(1 << (bitNo % 8));
+		TEST_ASSERT_FALSE(verifyBoth(hash, signature));
+	}
+}
+
+void test_Verify_RandomEncodingErrors(void)
+{
+	uint8_t hash[RSA2048_HASH_LENGTH];
+	uint8_t encoded[RSA2048_SIGNATURE_LENGTH];
+	uint8_t signature[RSA2048_SIGNATURE_LENGTH];
+	uint32_t position;
+	uint32_t index;
+
+	for (index = 0; index < TEST_RANDOM_SIGNATURE_COUNT; index++)
+	{
+		getRandom(&randomState, hash, sizeof(hash));
+		encode(hash, encoded);
+
+		/* Signature of own encoding is valid */
+		signEncoded(encoded, signature);
+		TEST_ASSERT_TRUE(verifyBoth(hash, signature));
+
+		/* A byte of padding, separator or DigestInfo is changed */
+		getRandom(&randomState, (uint8_t*)&position, sizeof(position));
+		position = 1 + (position % (RSA2048_HASH_OFFSET - 1));
+		encoded[position] ^= 0x5A;
+
+		signEncoded(encoded, signature);
+		TEST_ASSERT_FALSE(verifyBoth(hash, signature));
+	}
+}
+
+void test_Verify_SignatureOutOfRange(void)
+{
+	uint8_t hash[RSA2048_HASH_LENGTH] = { 0 };
+	uint8_t signature[RSA2048_SIGNATURE_LENGTH];
+
+	/* Signature equal to modulus */
+	TEST_ASSERT_EQUAL(0, mbedtls_mpi_write_binary(&rsa.N, signature, sizeof(signature)));
+	TEST_ASSERT_EQUAL(RSA2048_Err_InvalidSignature, RSA2048_VerifySignature(&publicKey, hash, signature));
+	TEST_ASSERT_FALSE(verifyBoth(hash, signature));
+
+	memset(signature, 0xFF, sizeof(signature));
+	TEST_ASSERT_EQUAL(RSA2048_Err_InvalidSignature, RSA2048_VerifySignature(&publicKey, hash, signature));
+	TEST_ASSERT_FALSE(verifyBoth(hash, signature));
+}
+
+void test_Verify_InvalidPublicKey(void)
+{
+	RSA2048PublicKey key = publicKey;
+	uint8_t hash[RSA2048_HASH_LENGTH] = { 0 };
+	uint8_t signature[RSA2048_SIGNATURE_LENGTH] = { 0 };
+
+	/* Even modulus */
+	key.n[0] &= ~1U;
+	TEST_ASSERT_EQUAL(RSA2048_Err_InvalidPublicKey, RSA2048_VerifySignature(&key, hash, signature));
+
+	/* Shorter modulus */
+	key = publicKey;
+	key.n[RSA2048_WORD_COUNT - 1] >>= 1;
+	TEST_ASSERT_EQUAL(RSA2048_Err_InvalidPublicKey, RSA2048_VerifySignature(&key, hash, signature));
+}
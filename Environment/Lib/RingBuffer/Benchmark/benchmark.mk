@@ -0,0 +1,28 @@
+################################################################################
+#
+# @file benchmark.mk
+#
+# @author MC
+#
+# @brief Benchmark make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+BENCH_TARGET_NAME = RingBuffer
+
+# Sources under benchmark
+BENCH_SRC_FILES = $(RINGBUFFER_SRC_FILES)
+
+# Producer and consumer run on different threads
+BENCH_CFLAGS = -pthread
+BENCH_LIBS = -pthread
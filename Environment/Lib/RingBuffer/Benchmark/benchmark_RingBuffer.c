@@ -0,0 +1,294 @@
+/*******************************************************************************
+ *
+ * @file benchmark_RingBuffer.c
+ *
+ * @author MC
+ *
+ * @brief Benchmark for SPSC Ring Buffer.
+ *
+ *        Transfers bytes between a producer and a consumer thread (x86 model
+ *        of UART ISR and Drv_UART_Receive) and compares lock-free ring with
+ *        a mutex protected ring. Throughput is also reported relative to
+ *        highest supported UART line rate.
+ *
+ *        [USAGE] : benchmark_RingBuffer
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "RingBuffer.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Size of ring, same as UART receive ring of LPC1768 driver */
+#define BENCH_RING_SIZE						(1024)
+
+/* Number of bytes which are transferred for each measurement */
+#define BENCH_TRANSFER_LENGTH				(16 * 1024 * 1024)
+
+/* Maximum chunk length of producer and consumer */
+#define BENCH_MAX_CHUNK_LENGTH				(256)
+
+/* Line rate of 3 Mbaud UART (8N1, 10 bits per byte) in bytes per second */
+#define BENCH_UART_LINE_RATE				(3000000 / 10)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Ring operations to benchmark different implementations
+ */
+typedef struct
+{
+	/* Name of implementation */
+	const char* name;
+	/* Producer side write */
+	uint32_t (*write)(const uint8_t* data, uint32_t length);
+	/* Consumer side read */
+	uint32_t (*read)(uint8_t* data, uint32_t length);
+} BenchRingOps;
+
+/*
+ * Shared state of a measurement
+ */
+typedef struct
+{
+	/* Ring implementation under benchmark */
+	const BenchRingOps* ops;
+	/* Length of chunks which are written and read */
+	uint32_t chunkLength;
+	/* Sum of bytes which are read by consumer */
+	uint64_t readSum;
+} BenchTransfer;
+
+/******************************** VARIABLES ***********************************/
+
+/* Lock-free ring */
+PRIVATE RingBuffer ring;
+PRIVATE uint8_t ringStorage[BENCH_RING_SIZE];
+
+/*
+ * Mutex protected ring which is kept as reference of benchmark.
+ *	Indexes are plain variables and all accesses are done under lock.
+ */
+PRIVATE pthread_mutex_t lockedRingMutex = PTHREAD_MUTEX_INITIALIZER;
+PRIVATE uint8_t lockedRingStorage[BENCH_RING_SIZE];
+PRIVATE uint32_t lockedRingHead;
+PRIVATE uint32_t lockedRingTail;
+
+/* Bytes which are written by producer */
+PRIVATE uint8_t sourceData[BENCH_MAX_CHUNK_LENGTH];
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns monotonic time in nanoseconds
+ */
+PRIVATE uint64_t getTimeInNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+PRIVATE uint32_t lockFreeWrite(const uint8_t* data, uint32_t length)
+{
+	return RingBuffer_Write(&ring, data, length);
+}
+
+PRIVATE uint32_t lockFreeRead(uint8_t* data, uint32_t length)
+{
+	return RingBuffer_Read(&ring, data, length);
+}
+
+PRIVATE uint32_t lockedWrite(const uint8_t* data, uint32_t length)
+{
+	uint32_t index;
+
+	pthread_mutex_lock(&lockedRingMutex);
+
+	length = MATH_MIN(length, BENCH_RING_SIZE - (lockedRingHead - lockedRingTail));
+	for (index = 0; index < length; index++)
+	{
+		lockedRingStorage[(lockedRingHead + index) & (BENCH_RING_SIZE - 1)] = data[index];
+	}
+	lockedRingHead += length;
+
+	pthread_mutex_unlock(&lockedRingMutex);
+
+	return length;
+}
+
+PRIVATE uint32_t lockedRead(uint8_t* data, uint32_t length)
+{
+	uint32_t index;
+
+	pthread_mutex_lock(&lockedRingMutex);
+
+	length = MATH_MIN(length, lockedRingHead - lockedRingTail);
+	for (index = 0; index < length; index++)
+	{
+		data[index] = lockedRingStorage[(lockedRingTail + index) & (BENCH_RING_SIZE - 1)];
+	}
+	lockedRingTail += length;
+
+	pthread_mutex_unlock(&lockedRingMutex);
+
+	return length;
+}
+
+/*
+ * Producer thread, writes transfer length bytes in chunks
+ */
+PRIVATE void* producerThread(void* arg)
+{
+	BenchTransfer* transfer = (BenchTransfer*)arg;
+	uint32_t writtenLength = 0;
+	uint32_t length;
+
+	while (writtenLength < BENCH_TRANSFER_LENGTH)
+	{
+		length = transfer->ops->write(sourceData, transfer->chunkLength);
+		if (length == 0)
+		{
+			sched_yield();
+		}
+
+		writtenLength += length;
+	}
+
+	return NULL;
+}
+
+/*
+ * Consumer thread, reads transfer length bytes in chunks
+ */
+PRIVATE void* consumerThread(void* arg)
+{
+	BenchTransfer* transfer = (BenchTransfer*)arg;
+	uint8_t data[BENCH_MAX_CHUNK_LENGTH];
+	uint32_t readLength = 0;
+	uint32_t length;
+	uint32_t index;
+
+	while (readLength < BENCH_TRANSFER_LENGTH)
+	{
+		length = transfer->ops->read(data, transfer->chunkLength);
+		if (length == 0)
+		{
+			sched_yield();
+		}
+
+		for (index = 0; index < length; index++)
+		{
+			transfer->readSum += data[index];
+		}
+
+		readLength += length;
+	}
+
+	return NULL;
+}
+
+/*
+ * Transfers bytes between producer and consumer threads
+ *
+ * @return Transferred bytes per second or zero if transfer is corrupted
+ */
+PRIVATE double runTransfer(const BenchRingOps* ops, uint32_t chunkLength)
+{
+	pthread_t producer;
+	pthread_t consumer;
+	BenchTransfer transfer = { ops, chunkLength, 0 };
+	uint64_t expectedSum = 0;
+	uint64_t startTime;
+	uint64_t elapsedTime;
+	uint32_t index;
+
+	RingBuffer_Init(&ring, ringStorage, sizeof(ringStorage));
+	lockedRingHead = 0;
+	lockedRingTail = 0;
+
+	startTime = getTimeInNs();
+
+	pthread_create(&consumer, NULL, consumerThread, &transfer);
+	pthread_create(&producer, NULL, producerThread, &transfer);
+
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+
+	elapsedTime = getTimeInNs() - startTime;
+
+	/* Chunks always start from beginning of source data */
+	for (index = 0; index < chunkLength; index++)
+	{
+		expectedSum += sourceData[index];
+	}
+	expectedSum *= BENCH_TRANSFER_LENGTH / chunkLength;
+
+	if (transfer.readSum != expectedSum)
+	{
+		return 0;
+	}
+
+	return ((double)BENCH_TRANSFER_LENGTH * 1000000000.0) / (double)elapsedTime;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Benchmark entry point
+ */
+int main(void)
+{
+	static const BenchRingOps lockFreeOps = { "lock-free", lockFreeWrite, lockFreeRead };
+	static const BenchRingOps lockedOps = { "mutex", lockedWrite, lockedRead };
+	static const uint32_t chunkLengths[] = { 1, 16, 256 };
+	double lockFreeRate;
+	double lockedRate;
+	uint32_t index;
+
+	for (index = 0; index < BENCH_MAX_CHUNK_LENGTH; index++)
+	{
+		sourceData[index] = (uint8_t)(index * 7);
+	}
+
+	printf("\nSPSC Ring Buffer Benchmark (%u byte ring, %u MB per run)\n", BENCH_RING_SIZE, BENCH_TRANSFER_LENGTH / (1024 * 1024));
+	printf("  chunk | %-10s MB/s | %-10s MB/s | speedup | 3 Mbaud headroom\n", lockFreeOps.name, lockedOps.name);
+
+	for (index = 0; index < sizeof(chunkLengths) / sizeof(chunkLengths[0]); index++)
+	{
+		lockFreeRate = runTransfer(&lockFreeOps, chunkLengths[index]);
+		lockedRate = runTransfer(&lockedOps, chunkLengths[index]);
+
+		if ((lockFreeRate == 0) || (lockedRate == 0))
+		{
+			printf("Transferred data is corrupted!\n");
+			return RESULT_FAIL;
+		}
+
+		printf("  %5u | %15.1f | %15.1f | %6.2fx | %15.0fx\n",
+			chunkLengths[index],
+			lockFreeRate / (1024 * 1024),
+			lockedRate / (1024 * 1024),
+			lockFreeRate / lockedRate,
+			lockFreeRate / BENCH_UART_LINE_RATE);
+	}
+
+	return RESULT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/*******************************************************************************
+*
+* @file RingBuffer.c
+*
+* @author MC
+*
+* @brief Lock-free SPSC Ring Buffer Implementation
+*
+*		 Each side loads index of other side with acquire semantic and
+*		 stores its own index with release semantic. So bytes are visible
+*		 to consumer before head which publishes them, and space is
+*		 released to producer only after bytes are read.
+*
+* @see
+*
+******************************************************************************
+*
+* GNU GPLv3
+*
+* Copyright (c) 2016 SP
+*
+*  See LICENSE file in Root Directory for license details.
+*
+******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include "RingBuffer.h"
+
+#if defined(WIN32)
+#include <intrin.h>
+#endif
+
+/***************************** MACRO DEFINITIONS ******************************/
+/*
+ * Index accesses with memory ordering.
+ *	Cortex-M3 (ARMCC) needs a data memory barrier for DMA and other bus
+ *	masters. x86 keeps store order so a compiler barrier is enough on Windows.
+ */
+#if defined(WIN32)
+
+	#define RINGBUFFER_BARRIER()					_ReadWriteBarrier()
+
+#elif defined(__ARMCC_VERSION)
+
+	#define RINGBUFFER_BARRIER()					__dmb(0xF)
+
+#endif
+
+#if defined(RINGBUFFER_BARRIER)
+
+	PRIVATE ALWAYS_INLINE uint32_t RINGBUFFER_LOAD_ACQUIRE(volatile uint32_t* index)
+	{
+		uint32_t value = *index;
+
+		RINGBUFFER_BARRIER();
+
+		return value;
+	}
+
+	#define RINGBUFFER_STORE_RELEASE(index, value)	{ RINGBUFFER_BARRIER(); *(index) = (value); }
+
+#else /* GCC */
+
+	#define RINGBUFFER_LOAD_ACQUIRE(index)			__atomic_load_n((index), __ATOMIC_ACQUIRE)
+	#define RINGBUFFER_STORE_RELEASE(index, value)	__atomic_store_n((index), (value), __ATOMIC_RELEASE)
+
+#endif
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/**
+ * Initializes an empty ring buffer
+ */
+void RingBuffer_Init(RingBuffer* ring, uint8_t* buffer, uint32_t size)
+{
+	ring->buffer = buffer;
+	ring->mask = size - 1;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+/**
+ * Returns number of bytes which can be read
+ */
+uint32_t RingBuffer_GetCount(RingBuffer* ring)
+{
+	return RINGBUFFER_LOAD_ACQUIRE(&ring->head) - ring->tail;
+}
+
+/**
+ * Returns number of bytes which can be written
+ */
+uint32_t RingBuffer_GetFree(RingBuffer* ring)
+{
+	return (ring->mask + 1) - (ring->head - RINGBUFFER_LOAD_ACQUIRE(&ring->tail));
+}
+
+/**
+ * Writes bytes into ring
+ */
+uint32_t RingBuffer_Write(RingBuffer* ring, const uint8_t* data, uint32_t length)
+{
+	uint8_t* span;
+	uint32_t spanLength;
+	uint32_t writtenLength = 0;
+
+	/* Free part can wrap around end of buffer so it is written in two spans */
+	while (writtenLength < length)
+	{
+		spanLength = RingBuffer_GetWriteSpan(ring, &span);
+		if (spanLength == 0)
+		{
+			break;
+		}
+
+		spanLength = MATH_MIN(spanLength, length - writtenLength);
+
+		memcpy(span, &data[writtenLength], spanLength);
+
+		RingBuffer_CommitWrite(ring, spanLength);
+
+		writtenLength += spanLength;
+	}
+
+	return writtenLength;
+}
+
+/**
+ * Reads bytes from ring
+ */
+uint32_t RingBuffer_Read(RingBuffer* ring, uint8_t* data, uint32_t length)
+{
+	uint8_t* span;
+	uint32_t spanLength;
+	uint32_t readLength = 0;
+
+	while (readLength < length)
+	{
+		spanLength = RingBuffer_GetReadSpan(ring, &span);
+		if (spanLength == 0)
+		{
+			break;
+		}
+
+		spanLength = MATH_MIN(spanLength, length - readLength);
+
+		memcpy(&data[readLength], span, spanLength);
+
+		RingBuffer_Consume(ring, spanLength);
+
+		readLength += spanLength;
+	}
+
+	return readLength;
+}
+
+/**
+ * Gets contiguous free part of ring
+ */
+uint32_t RingBuffer_GetWriteSpan(RingBuffer* ring, uint8_t** span)
+{
+	uint32_t offset = ring->head & ring->mask;
+	/* Other side moves its index concurrently, so it is loaded only once */
+	uint32_t freeLength = RingBuffer_GetFree(ring);
+
+	*span = &ring->buffer[offset];
+
+	return MATH_MIN(freeLength, (ring->mask + 1) - offset);
+}
+
+/**
+ * Publishes directly written bytes
+ */
+void RingBuffer_CommitWrite(RingBuffer* ring, uint32_t length)
+{
+	RINGBUFFER_STORE_RELEASE(&ring->head, ring->head + length);
+}
+
+/**
+ * Gets contiguous readable part of ring
+ */
+uint32_t RingBuffer_GetReadSpan(RingBuffer* ring, uint8_t** span)
+{
+	uint32_t offset = ring->tail & ring->mask;
+	/* Other side moves its index concurrently, so it is loaded only once */
+	uint32_t count = RingBuffer_GetCount(ring);
+
+	*span = &ring->buffer[offset];
+
+	return MATH_MIN(count, (ring->mask + 1) - offset);
+}
+
+/**
+ * Releases read bytes
+ */
+void RingBuffer_Consume(RingBuffer* ring, uint32_t length)
+{
+	RINGBUFFER_STORE_RELEASE(&ring->tail, ring->tail + length);
+}
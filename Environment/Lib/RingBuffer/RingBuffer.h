@@ -0,0 +1,148 @@
+/*******************************************************************************
+ *
+ * @file RingBuffer.h
+ *
+ * @author MC
+ *
+ * @brief Lock-free Single Producer Single Consumer (SPSC) Ring Buffer
+ *
+ *		  Ring can be shared between an interrupt (or DMA) producer and a
+ *		  thread consumer without disabling interrupts. Producer only writes
+ *		  'head' and consumer only writes 'tail' so no locks are required.
+ *
+ *		  Indexes are free running and masked during buffer accesses, so all
+ *		  bytes of buffer are usable and buffer size must be power of two.
+ *
+ *		  Span functions provide direct access to contiguous parts of buffer
+ *		  for producers and consumers which do not want to copy data (e.g.
+ *		  DMA writes into buffer directly).
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __RING_BUFFER_H
+#define __RING_BUFFER_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Checks whether size is a valid ring buffer size (power of two) */
+#define RINGBUFFER_IS_VALID_SIZE(size)				(((size) != 0) && (((size) & ((size) - 1)) == 0))
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * SPSC Ring Buffer.
+ *	Fields are private to ring buffer.
+ */
+typedef struct
+{
+	/* Storage of ring. Size is (mask + 1) */
+	uint8_t* buffer;
+	/* Mask to convert free running indexes to buffer offsets */
+	uint32_t mask;
+	/* Free running write index. Written only by producer */
+	volatile uint32_t head;
+	/* Free running read index. Written only by consumer */
+	volatile uint32_t tail;
+} RingBuffer;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Initializes an empty ring buffer.
+ *
+ * @param ring Ring buffer to be initialized
+ * @param buffer Storage of ring
+ * @param size Size of storage. Must be power of two.
+ *
+ * @return none
+ */
+void RingBuffer_Init(RingBuffer* ring, uint8_t* buffer, uint32_t size);
+
+/*
+ * Returns number of bytes which can be read. Consumer side.
+ */
+uint32_t RingBuffer_GetCount(RingBuffer* ring);
+
+/*
+ * Returns number of bytes which can be written. Producer side.
+ */
+uint32_t RingBuffer_GetFree(RingBuffer* ring);
+
+/*
+ * Writes bytes into ring. Producer side.
+ *
+ * @param ring Ring buffer
+ * @param data Bytes to be written
+ * @param length Number of bytes to be written
+ *
+ * @return Number of written bytes. Less than length if ring is full.
+ */
+uint32_t RingBuffer_Write(RingBuffer* ring, const uint8_t* data, uint32_t length);
+
+/*
+ * Reads bytes from ring. Consumer side.
+ *
+ * @param ring Ring buffer
+ * @param data [out] Read bytes
+ * @param length Maximum number of bytes to be read
+ *
+ * @return Number of read bytes. Zero if ring is empty.
+ */
+uint32_t RingBuffer_Read(RingBuffer* ring, uint8_t* data, uint32_t length);
+
+/*
+ * Gets contiguous free part of ring which starts from write position.
+ *	Producer side. Bytes are published using RingBuffer_CommitWrite.
+ *
+ * @param ring Ring buffer
+ * @param span [out] Start of free part
+ *
+ * @return Length of contiguous free part
+ */
+uint32_t RingBuffer_GetWriteSpan(RingBuffer* ring, uint8_t** span);
+
+/*
+ * Publishes bytes which are written into ring storage directly (using
+ * write span or DMA). Producer side.
+ *
+ * @param ring Ring buffer
+ * @param length Number of written bytes. Must not exceed free length.
+ *
+ * @return none
+ */
+void RingBuffer_CommitWrite(RingBuffer* ring, uint32_t length);
+
+/*
+ * Gets contiguous readable part of ring which starts from read position.
+ *	Consumer side. Bytes are released using RingBuffer_Consume.
+ *
+ * @param ring Ring buffer
+ * @param span [out] Start of readable part
+ *
+ * @return Length of contiguous readable part
+ */
+uint32_t RingBuffer_GetReadSpan(RingBuffer* ring, uint8_t** span);
+
+/*
+ * Releases read bytes. Consumer side.
+ *
+ * @param ring Ring buffer
+ * @param length Number of released bytes. Must not exceed readable length.
+ *
+ * @return none
+ */
+void RingBuffer_Consume(RingBuffer* ring, uint32_t length);
+
+#endif	/* __RING_BUFFER_H */
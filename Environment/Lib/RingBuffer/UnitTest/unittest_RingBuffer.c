@@ -0,0 +1,358 @@
+/*******************************************************************************
+ *
+ * @file unittest_RingBuffer.c
+ *
+ * @author MC
+ *
+ * @brief Unit test file for SPSC Ring Buffer Library
+ *
+ *		  Stress tests run producer and consumer on different threads as x86
+ *		  model of ISR (or DMA) and thread sides of a driver.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+/* POSIX threads are not part of C99 */
+#define _POSIX_C_SOURCE					200112L
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "postypes.h"
+
+/* Include source files for WHITE-BOX unit testing */
+#include "../RingBuffer.c"
+
+/* Include Unity Framework */
+#include "unity.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Size of ring which is used by functional tests */
+#define TEST_RING_SIZE					(16)
+
+/*
+ * Size of ring and number of transferred bytes for stress tests.
+ *	Ring is small to wrap around frequently.
+ */
+#define TEST_STRESS_RING_SIZE			(64)
+#define TEST_STRESS_LENGTH				(4 * 1024 * 1024)
+
+/* Maximum chunk length of producer and consumer in stress tests */
+#define TEST_STRESS_MAX_CHUNK_LENGTH	(48)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Side of a stress test which runs on its own thread
+ */
+typedef struct
+{
+	/* Transfers bytes using span functions instead of copying functions */
+	bool useSpans;
+	/* Seed for chunk lengths */
+	uint32_t seed;
+	/* Number of transferred bytes */
+	uint32_t length;
+	/* Number of bytes which do not match with expected sequence */
+	uint32_t errorCount;
+} StressSide;
+
+/**************************** FUNCTION PROTOTYPES *****************************/
+
+/******************************** VARIABLES ***********************************/
+
+PRIVATE RingBuffer ring;
+PRIVATE uint8_t ringStorage[TEST_STRESS_RING_SIZE];
+
+/**************************** INTERNAL FUNCTIONS ******************************/
+/**
+ * @brief Constructor Method for each test case
+ *
+ */
+void setUp(void)
+{
+	memset(ringStorage, 0, sizeof(ringStorage));
+
+	RingBuffer_Init(&ring, ringStorage, TEST_RING_SIZE);
+}
+
+/**
+ * @brief Destructor Method for each test case
+ *
+ */
+void tearDown(void)
+{
+	/* For now, nothing to do */
+}
+
+/*
+ * Returns byte of transferred sequence at given position
+ */
+PRIVATE uint8_t sequenceByte(uint32_t position)
+{
+	return (uint8_t)((position * 31) ^ (position >> 8));
+}
+
+/*
+ * Returns next chunk length using a linear congruential generator
+ */
+PRIVATE uint32_t nextChunkLength(uint32_t* seed)
+{
+	*seed = (*seed * 1103515245) + 12345;
+
+	return 1 + ((*seed >> 16) % TEST_STRESS_MAX_CHUNK_LENGTH);
+}
+
+/*
+ * Producer thread. Writes sequence into ring.
+ */
+PRIVATE void* producerThread(void* arg)
+{
+	StressSide* side = (StressSide*)arg;
+	uint8_t chunk[TEST_STRESS_MAX_CHUNK_LENGTH];
+	uint8_t* span;
+	uint32_t spanLength;
+	uint32_t chunkLength;
+	uint32_t writtenLength;
+	uint32_t index;
+
+	while (side->length < TEST_STRESS_LENGTH)
+	{
+		/* MATH_MIN evaluates its arguments twice, so calls are not nested in it */
+		chunkLength = nextChunkLength(&side->seed);
+		chunkLength = MATH_MIN(chunkLength, TEST_STRESS_LENGTH - side->length);
+
+		if (side->useSpans)
+		{
+			/* Emulates DMA which writes into storage and publishes later */
+			spanLength = RingBuffer_GetWriteSpan(&ring, &span);
+			chunkLength = MATH_MIN(chunkLength, spanLength);
+			for (index = 0; index < chunkLength; index++)
+			{
+				span[index] = sequenceByte(side->length + index);
+			}
+			RingBuffer_CommitWrite(&ring, chunkLength);
+			writtenLength = chunkLength;
+		}
+		else
+		{
+			for (index = 0; index < chunkLength; index++)
+			{
+				chunk[index] = sequenceByte(side->length + index);
+			}
+			writtenLength = RingBuffer_Write(&ring, chunk, chunkLength);
+		}
+
+		side->length += writtenLength;
+
+		if (writtenLength == 0)
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Consumer thread. Reads sequence from ring and verifies it.
+ */
+PRIVATE void* consumerThread(void* arg)
+{
+	StressSide* side = (StressSide*)arg;
+	uint8_t chunk[TEST_STRESS_MAX_CHUNK_LENGTH];
+	uint8_t* span;
+	uint8_t* data;
+	uint32_t spanLength;
+	uint32_t chunkLength;
+	uint32_t readLength;
+	uint32_t index;
+
+	while (side->length < TEST_STRESS_LENGTH)
+	{
+		chunkLength = nextChunkLength(&side->seed);
+
+		if (side->useSpans)
+		{
+			spanLength = RingBuffer_GetReadSpan(&ring, &span);
+			readLength = MATH_MIN(chunkLength, spanLength);
+			data = span;
+		}
+		else
+		{
+			readLength = RingBuffer_Read(&ring, chunk, chunkLength);
+			data = chunk;
+		}
+
+		for (index = 0; index < readLength; index++)
+		{
+			if (data[index] != sequenceByte(side->length + index))
+			{
+				side->errorCount++;
+			}
+		}
+
+		if (side->useSpans)
+		{
+			RingBuffer_Consume(&ring, readLength);
+		}
+
+		side->length += readLength;
+
+		if (readLength == 0)
+		{
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Transfers stress sequence between producer and consumer threads
+ */
+PRIVATE void runStressTest(bool useSpans)
+{
+	pthread_t producer;
+	pthread_t consumer;
+	StressSide producerSide = { useSpans, 1, 0, 0 };
+	StressSide consumerSide = { useSpans, 7, 0, 0 };
+
+	RingBuffer_Init(&ring, ringStorage, TEST_STRESS_RING_SIZE);
+
+	TEST_ASSERT_EQUAL(0, pthread_create(&consumer, NULL, consumerThread, &consumerSide));
+	TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, producerThread, &producerSide));
+
+	TEST_ASSERT_EQUAL(0, pthread_join(producer, NULL));
+	TEST_ASSERT_EQUAL(0, pthread_join(consumer, NULL));
+
+	TEST_ASSERT_EQUAL(TEST_STRESS_LENGTH, producerSide.length);
+	TEST_ASSERT_EQUAL(TEST_STRESS_LENGTH, consumerSide.length);
+	TEST_ASSERT_EQUAL(0, consumerSide.errorCount);
+	TEST_ASSERT_EQUAL(0, RingBuffer_GetCount(&ring));
+}
+
+/****************************** TEST FUNCTIONS ********************************/
+
+void test_Init_Empty(void)
+{
+	uint8_t data[4];
+
+	TEST_ASSERT_TRUE(RINGBUFFER_IS_VALID_SIZE(TEST_RING_SIZE));
+	TEST_ASSERT_FALSE(RINGBUFFER_IS_VALID_SIZE(24));
+	TEST_ASSERT_FALSE(RINGBUFFER_IS_VALID_SIZE(0));
+
+	TEST_ASSERT_EQUAL(0, RingBuffer_GetCount(&ring));
+	TEST_ASSERT_EQUAL(TEST_RING_SIZE, RingBuffer_GetFree(&ring));
+	TEST_ASSERT_EQUAL(0, RingBuffer_Read(&ring, data, sizeof(data)));
+}
+
+void test_WriteRead_WrapAround(void)
+{
+	uint8_t data[TEST_RING_SIZE];
+	uint8_t readData[TEST_RING_SIZE];
+	uint32_t round;
+	uint32_t index;
+
+	/* 11 bytes per round moves indexes over end of storage several times */
+	for (round = 0; round < 8; round++)
+	{
+		for (index = 0; index < 11; index++)
+		{
+			data[index] = (uint8_t)(round * 11 + index);
+		}
+
+		TEST_ASSERT_EQUAL(11, RingBuffer_Write(&ring, data, 11));
+		TEST_ASSERT_EQUAL(11, RingBuffer_GetCount(&ring));
+		TEST_ASSERT_EQUAL(TEST_RING_SIZE - 11, RingBuffer_GetFree(&ring));
+
+		TEST_ASSERT_EQUAL(11, RingBuffer_Read(&ring, readData, sizeof(readData)));
+		TEST_ASSERT_EQUAL_UINT8_ARRAY(data, readData, 11);
+	}
+
+	TEST_ASSERT_EQUAL(0, RingBuffer_GetCount(&ring));
+}
+
+void test_Write_Full(void)
+{
+	uint8_t data[TEST_RING_SIZE + 4];
+	uint8_t readData[TEST_RING_SIZE + 4];
+	uint32_t index;
+
+	for (index = 0; index < sizeof(data); index++)
+	{
+		data[index] = (uint8_t)index;
+	}
+
+	/* Only size of ring is written, all bytes are usable */
+	TEST_ASSERT_EQUAL(TEST_RING_SIZE, RingBuffer_Write(&ring, data, sizeof(data)));
+	TEST_ASSERT_EQUAL(0, RingBuffer_GetFree(&ring));
+	TEST_ASSERT_EQUAL(0, RingBuffer_Write(&ring, data, 1));
+
+	/* Partial read releases space for partial write */
+	TEST_ASSERT_EQUAL(3, RingBuffer_Read(&ring, readData, 3));
+	TEST_ASSERT_EQUAL(3, RingBuffer_Write(&ring, &data[TEST_RING_SIZE], 4));
+
+	TEST_ASSERT_EQUAL(TEST_RING_SIZE, RingBuffer_Read(&ring, &readData[3], sizeof(readData)));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY(data, readData, TEST_RING_SIZE + 3);
+}
+
+void test_Spans(void)
+{
+	uint8_t data[TEST_RING_SIZE];
+	uint8_t* span;
+
+	memset(data, 0x5A, sizeof(data));
+
+	/* Move indexes close to end of storage */
+	TEST_ASSERT_EQUAL(12, RingBuffer_Write(&ring, data, 12));
+	TEST_ASSERT_EQUAL(12, RingBuffer_Read(&ring, data, 12));
+
+	/* Free part wraps, so write span ends at end of storage */
+	TEST_ASSERT_EQUAL(4, RingBuffer_GetWriteSpan(&ring, &span));
+	TEST_ASSERT_EQUAL_PTR(&ringStorage[12], span);
+	memcpy(span, "ABCD", 4);
+	RingBuffer_CommitWrite(&ring, 4);
+
+	TEST_ASSERT_EQUAL(12, RingBuffer_GetWriteSpan(&ring, &span));
+	TEST_ASSERT_EQUAL_PTR(&ringStorage[0], span);
+	memcpy(span, "EF", 2);
+	RingBuffer_CommitWrite(&ring, 2);
+
+	/* Readable part wraps too */
+	TEST_ASSERT_EQUAL(4, RingBuffer_GetReadSpan(&ring, &span));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY("ABCD", span, 4);
+	RingBuffer_Consume(&ring, 3);
+
+	TEST_ASSERT_EQUAL(1, RingBuffer_GetReadSpan(&ring, &span));
+	TEST_ASSERT_EQUAL_UINT8('D', *span);
+	RingBuffer_Consume(&ring, 1);
+
+	TEST_ASSERT_EQUAL(2, RingBuffer_GetReadSpan(&ring, &span));
+	TEST_ASSERT_EQUAL_UINT8_ARRAY("EF", span, 2);
+	RingBuffer_Consume(&ring, 2);
+
+	TEST_ASSERT_EQUAL(0, RingBuffer_GetReadSpan(&ring, &span));
+	TEST_ASSERT_EQUAL(TEST_RING_SIZE, RingBuffer_GetFree(&ring));
+}
+
+void test_Stress_CopyingThreads(void)
+{
+	runStressTest(false);
+}
+
+void test_Stress_SpanThreads(void)
+{
+	runStressTest(true);
+}
@@ -27,6 +27,37 @@
 #
 CC = gcc
 
+################################################################################
+#							HOST PROJECT BUILD
+################################################################################
+#
+# Projects are built as host executables on simulated CPU (BSP/CPU/x86)
+#	[USAGE] : make PROJECT=<PROJECT_NAME> ENV=x86
+#
+#	Simulated CPU has no board, linker script and binary image. Output is
+#	.elf executable of host. Debug prints go to standard output.
+#
+CPU      = x86
+BOARD    =
+AS       = as
+CPP      = g++
+LD       = gcc
+OBJCOPY  = objcopy
+
+MCU_CC_FLAGS             =
+LINKER_SCRIPT            =
+PROJECT_TARGET_EXTENSION = .elf
+
+SYS_OBJECTS   =
+SYS_INC_PATHS = -I.
+SYS_LIB_PATHS =
+SYS_LIBRARIES = -lm
+SYS_LD_FLAGS  =
+
+CC_DEBUG_FLAGS = -g
+CC_OPTIM_FLAGS = -O2
+CC_SYMBOLS     = -DNODEBUG -DSIMULATION_MODE=1 -DENABLE_DEBUG_PRINT=1
+
 ################################################################################
 #								TESTING
 ################################################################################
@@ -45,4 +76,23 @@ endif
 #
 UNITTEST_CFLAGS = -std=c99 -Wall -Wextra -Werror  -Wpointer-arith -Wcast-align -Wwrite-strings \
             -Wswitch-default -Wunreachable-code -Winit-self -Wmissing-field-initializers \
-            -Wno-unknown-pragmas -Wstrict-prototypes -Wundef -Wold-style-definition
\ No newline at end of file
+            -Wno-unknown-pragmas -Wstrict-prototypes -Wundef -Wold-style-definition
+
+################################################################################
+#								BENCHMARKING
+################################################################################
+
+#
+# Benchmark specific CFLAGS for x86 platform
+#	GNU extensions are enabled for POSIX timing functions
+#
+BENCHMARK_CFLAGS = -std=gnu99 -O2 -Wall -Wextra -Werror
+
+################################################################################
+#								HOST TOOLS
+################################################################################
+
+#
+# Host tool specific CFLAGS for x86 platform
+#
+TOOL_CFLAGS = -std=gnu99 -O2 -Wall -Wextra -Werror
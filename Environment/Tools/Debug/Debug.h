@@ -43,8 +43,17 @@
 #define DEBUG_LEVEL_WARNING				2
 #define DEBUG_LEVEL_ERROR				3
 
+#if defined(ENABLE_DEBUG_PRINT) && ENABLE_DEBUG_PRINT
+
+	#include <stdio.h>
+
+	/* Host (simulation) builds print messages to standard output */
+	#define DEBUG_PRINT(level, message, ...) { (void)(level); printf(message, ##__VA_ARGS__); fflush(stdout); }
+
+#else
 /* TODO : Define a output for that macro */
 #define DEBUG_PRINT(level, message, ...)
+#endif	/* ENABLE_DEBUG_PRINT */
 
 #if ENABLE_DEBUG_ASSERT
 
@@ -0,0 +1,207 @@
+/*******************************************************************************
+ *
+ * @file Compressor.c
+ *
+ * @author MC
+ *
+ * @brief Host side LZSS compressor of firmware images.
+ *
+ *		  Greedy matcher. Positions in window are indexed by their first two
+ *		  bytes, longest match of a limited number of candidates is used.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+
+#include "Compressor.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of hash buckets, a bucket for each two byte value */
+#define COMPRESSOR_HASH_SIZE						(1 << 16)
+
+/* Maximum number of candidates which are checked for a position */
+#define COMPRESSOR_MAX_CANDIDATE_COUNT				(256)
+
+/* No position */
+#define COMPRESSOR_NO_POSITION						(-1)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Bit stream writer
+ */
+typedef struct
+{
+	uint8_t* output;
+	uint32_t outputSize;
+	uint32_t outputLength;
+	/* Bits which are not written yet */
+	uint32_t bitBuffer;
+	uint32_t bitCount;
+	bool overflow;
+} CompressorWriter;
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Appends bits to stream, MSB first
+ */
+PRIVATE void writeBits(CompressorWriter* writer, uint32_t value, uint32_t bitCount)
+{
+	writer->bitBuffer = (writer->bitBuffer << bitCount) | (value & ((1U << bitCount) - 1));
+	writer->bitCount += bitCount;
+
+	while (writer->bitCount >= 8)
+	{
+		writer->bitCount -= 8;
+
+		if (writer->outputLength < writer->outputSize)
+		{
+			writer->output[writer->outputLength++] = (uint8_t)(writer->bitBuffer >> writer->bitCount);
+		}
+		else
+		{
+			writer->overflow = true;
+		}
+	}
+}
+
+/*
+ * Returns hash of two bytes at position
+ */
+PRIVATE ALWAYS_INLINE uint32_t hashPosition(const uint8_t* data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Compresses data into an LZSS stream
+ */
+uint32_t Compressor_Compress(const uint8_t* input,
+							 uint32_t inputLength,
+							 uint8_t windowBits,
+							 uint8_t lengthBits,
+							 uint8_t* output,
+							 uint32_t outputSize)
+{
+	CompressorWriter writer;
+	int32_t* head;
+	int32_t* previous;
+	int32_t position;
+	uint32_t windowSize = 1U << windowBits;
+	uint32_t maxLength = 1U << lengthBits;
+	uint32_t offset = 0;
+	uint32_t indexed = 0;
+	uint32_t length;
+	uint32_t bestLength;
+	uint32_t bestOffset = 0;
+	uint32_t candidateCount;
+	uint32_t index;
+
+	if ((outputSize < LZSS_HEADER_LENGTH) || (windowBits == 0) || (windowBits > 16) ||
+		(lengthBits == 0) || (lengthBits > LZSS_MAX_LENGTH_BITS))
+	{
+		return 0;
+	}
+
+	head = malloc(COMPRESSOR_HASH_SIZE * sizeof(int32_t));
+	previous = malloc((inputLength + 1) * sizeof(int32_t));
+	if ((head == NULL) || (previous == NULL))
+	{
+		free(head);
+		free(previous);
+		return 0;
+	}
+
+	for (index = 0; index < COMPRESSOR_HASH_SIZE; index++)
+	{
+		head[index] = COMPRESSOR_NO_POSITION;
+	}
+
+	writer.output = output;
+	writer.outputSize = outputSize;
+	writer.outputLength = LZSS_EncodeHeader(inputLength, windowBits, lengthBits, output);
+	writer.bitBuffer = 0;
+	writer.bitCount = 0;
+	writer.overflow = false;
+
+	while ((offset < inputLength) && !writer.overflow)
+	{
+		/* Positions before current one are indexed */
+		for (; (indexed < offset) && (indexed + 1 < inputLength); indexed++)
+		{
+			previous[indexed] = head[hashPosition(&input[indexed])];
+			head[hashPosition(&input[indexed])] = (int32_t)indexed;
+		}
+
+		bestLength = 0;
+
+		if (offset + 1 < inputLength)
+		{
+			position = head[hashPosition(&input[offset])];
+
+			for (candidateCount = 0;
+				 (position != COMPRESSOR_NO_POSITION) && (offset - (uint32_t)position <= windowSize) && (candidateCount < COMPRESSOR_MAX_CANDIDATE_COUNT);
+				 candidateCount++)
+			{
+				/* Match may overlap current position */
+				for (length = 0;
+					 (length < maxLength) && (offset + length < inputLength) && (input[(uint32_t)position + length] == input[offset + length]);
+					 length++);
+
+				if (length > bestLength)
+				{
+					bestLength = length;
+					bestOffset = offset - (uint32_t)position;
+
+					if (length == maxLength)
+					{
+						break;
+					}
+				}
+
+				position = previous[position];
+			}
+		}
+
+		/* A reference must cost less than literals which it replaces */
+		if ((bestLength * 9) > (1U + windowBits + lengthBits))
+		{
+			writeBits(&writer, 0, 1);
+			writeBits(&writer, bestOffset - 1, windowBits);
+			writeBits(&writer, bestLength - 1, lengthBits);
+			offset += bestLength;
+		}
+		else
+		{
+			writeBits(&writer, 1, 1);
+			writeBits(&writer, input[offset], 8);
+			offset++;
+		}
+	}
+
+	/* Last byte is padded with zero bits */
+	if (writer.bitCount > 0)
+	{
+		writeBits(&writer, 0, 8 - writer.bitCount);
+	}
+
+	free(head);
+	free(previous);
+
+	return writer.overflow ? 0 : writer.outputLength;
+}
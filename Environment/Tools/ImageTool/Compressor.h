@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *
+ * @file Compressor.h
+ *
+ * @author MC
+ *
+ * @brief Host side LZSS compressor of firmware images (see LZSS.h).
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __COMPRESSOR_H
+#define __COMPRESSOR_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "LZSS.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Default parameters, window fits into bootloader decoder */
+#define COMPRESSOR_DEFAULT_WINDOW_BITS				(LZSS_WINDOW_BITS)
+#define COMPRESSOR_DEFAULT_LENGTH_BITS				(4)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Compresses data into an LZSS stream.
+ *
+ * @param input Data to be compressed
+ * @param inputLength Length of data
+ * @param windowBits Window bits of stream, decoder window must not be smaller
+ * @param lengthBits Length bits of stream
+ * @param output [out] Compressed stream
+ * @param outputSize Size of output buffer
+ *
+ * @return Length of compressed stream, zero if it does not fit into output
+ *		   buffer
+ */
+uint32_t Compressor_Compress(const uint8_t* input,
+							 uint32_t inputLength,
+							 uint8_t windowBits,
+							 uint8_t lengthBits,
+							 uint8_t* output,
+							 uint32_t outputSize);
+
+#endif	/* __COMPRESSOR_H */
@@ -0,0 +1,270 @@
+/*******************************************************************************
+ *
+ * @file DeltaGenerator.c
+ *
+ * @author MC
+ *
+ * @brief Host side generator of binary deltas.
+ *
+ *		  Greedy matcher. Source positions are indexed by hash of a short
+ *		  seed, longest allowed match is copied. Previous copy alignment is
+ *		  tried first, so code after an insertion or removal continues as a
+ *		  single copy.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+
+#include "DeltaGenerator.h"
+#include "CRC32.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Length of seeds which are indexed */
+#define DELTAGENERATOR_SEED_LENGTH					(4)
+
+/* Number of hash buckets (power of 2) */
+#define DELTAGENERATOR_HASH_SIZE					(1 << 16)
+
+/* Maximum number of candidates which are checked for a position */
+#define DELTAGENERATOR_MAX_CANDIDATE_COUNT			(64)
+
+/* No source position */
+#define DELTAGENERATOR_NO_POSITION					(-1)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Generator state
+ */
+typedef struct
+{
+	const uint8_t* source;
+	uint32_t sourceLength;
+	const uint8_t* target;
+	uint32_t targetLength;
+	/* Generated delta */
+	uint8_t* delta;
+	uint32_t deltaSize;
+	uint32_t deltaLength;
+	/* Last source position of each hash and previous position with same hash */
+	int32_t* head;
+	int32_t* previous;
+} DeltaGenerator;
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Hashes seed at given position
+ */
+PRIVATE uint32_t hashSeed(const uint8_t* data)
+{
+	uint32_t seed = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+
+	return (seed * 2654435761U) >> 16;
+}
+
+/*
+ * Returns length of matching bytes of source and target
+ */
+PRIVATE uint32_t matchLength(DeltaGenerator* generator, uint32_t sourceOffset, uint32_t targetOffset, uint32_t maxLength)
+{
+	uint32_t length = 0;
+
+	maxLength = MATH_MIN(maxLength, generator->sourceLength - sourceOffset);
+
+	while ((length < maxLength) && (generator->source[sourceOffset + length] == generator->target[targetOffset + length]))
+	{
+		length++;
+	}
+
+	return length;
+}
+
+/*
+ * Appends an instruction and its data to delta
+ */
+PRIVATE bool appendInstruction(DeltaGenerator* generator, uint8_t opcode, uint32_t length, uint32_t sourceOffset, const uint8_t* data)
+{
+	uint8_t instruction[DELTA_MAX_INSTRUCTION_LENGTH];
+	uint32_t instructionLength;
+	uint32_t dataLength = (data != NULL) ? length : 0;
+
+	instructionLength = Delta_EncodeInstruction(opcode, length, sourceOffset, instruction);
+
+	if (generator->deltaLength + instructionLength + dataLength > generator->deltaSize)
+	{
+		return false;
+	}
+
+	memcpy(&generator->delta[generator->deltaLength], instruction, instructionLength);
+	generator->deltaLength += instructionLength;
+
+	if (dataLength > 0)
+	{
+		memcpy(&generator->delta[generator->deltaLength], data, dataLength);
+		generator->deltaLength += dataLength;
+	}
+
+	return true;
+}
+
+/*
+ * Generates instructions of target image
+ */
+PRIVATE bool generateInstructions(DeltaGenerator* generator, uint32_t sectorSize)
+{
+	uint32_t targetOffset = 0;
+	uint32_t insertOffset = 0;
+	uint32_t sectorStart;
+	uint32_t maxLength;
+	uint32_t length;
+	uint32_t bestLength;
+	uint32_t bestOffset = 0;
+	uint32_t candidateCount;
+	int64_t alignment = 0;
+	int64_t candidate;
+	int32_t position;
+
+	while (targetOffset < generator->targetLength)
+	{
+		/* Copies must not read sectors which are already overwritten */
+		sectorStart = targetOffset - (targetOffset % sectorSize);
+		maxLength = MATH_MIN(generator->targetLength, sectorStart + sectorSize) - targetOffset;
+		bestLength = 0;
+
+		/* Continue with alignment of previous copy */
+		candidate = (int64_t)targetOffset + alignment;
+		if ((candidate >= sectorStart) && (candidate < generator->sourceLength))
+		{
+			bestOffset = (uint32_t)candidate;
+			bestLength = matchLength(generator, bestOffset, targetOffset, maxLength);
+		}
+
+		if ((bestLength < maxLength) && (targetOffset + DELTAGENERATOR_SEED_LENGTH <= generator->targetLength))
+		{
+			position = generator->head[hashSeed(&generator->target[targetOffset])];
+
+			/* Positions are in descending order, earlier ones are not allowed */
+			for (candidateCount = 0;
+				 (position != DELTAGENERATOR_NO_POSITION) && ((uint32_t)position >= sectorStart) && (candidateCount < DELTAGENERATOR_MAX_CANDIDATE_COUNT);
+				 candidateCount++)
+			{
+				length = matchLength(generator, (uint32_t)position, targetOffset, maxLength);
+				if (length > bestLength)
+				{
+					bestLength = length;
+					bestOffset = (uint32_t)position;
+				}
+
+				position = generator->previous[position];
+			}
+		}
+
+		if (bestLength < DELTAGENERATOR_MIN_COPY_LENGTH)
+		{
+			targetOffset++;
+			continue;
+		}
+
+		if ((insertOffset < targetOffset) &&
+			!appendInstruction(generator, DELTA_OP_INSERT, targetOffset - insertOffset, 0, &generator->target[insertOffset]))
+		{
+			return false;
+		}
+
+		if (!appendInstruction(generator, DELTA_OP_COPY, bestLength, bestOffset, NULL))
+		{
+			return false;
+		}
+
+		alignment = (int64_t)bestOffset - targetOffset;
+		targetOffset += bestLength;
+		insertOffset = targetOffset;
+	}
+
+	if (insertOffset < targetOffset)
+	{
+		return appendInstruction(generator, DELTA_OP_INSERT, targetOffset - insertOffset, 0, &generator->target[insertOffset]);
+	}
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Generates a delta which transforms source image into target image
+ */
+uint32_t DeltaGenerator_Generate(const uint8_t* source,
+								 uint32_t sourceLength,
+								 const uint8_t* target,
+								 uint32_t targetLength,
+								 uint32_t sectorSize,
+								 uint8_t* delta,
+								 uint32_t deltaSize)
+{
+	DeltaGenerator generator;
+	DeltaHeader header;
+	uint32_t offset;
+	uint32_t hash;
+	bool success;
+
+	if ((deltaSize < DELTA_HEADER_LENGTH) || (sectorSize == 0))
+	{
+		return 0;
+	}
+
+	generator.source = source;
+	generator.sourceLength = sourceLength;
+	generator.target = target;
+	generator.targetLength = targetLength;
+	generator.delta = delta;
+	generator.deltaSize = deltaSize;
+
+	header.sourceLength = sourceLength;
+	header.sourceCRC = CRC32_Update(CRC32_INITIAL_VALUE, source, sourceLength);
+	header.targetLength = targetLength;
+
+	generator.deltaLength = Delta_EncodeHeader(&header, delta);
+
+	generator.head = malloc(DELTAGENERATOR_HASH_SIZE * sizeof(int32_t));
+	generator.previous = malloc((sourceLength + 1) * sizeof(int32_t));
+	if ((generator.head == NULL) || (generator.previous == NULL))
+	{
+		free(generator.head);
+		free(generator.previous);
+		return 0;
+	}
+
+	/* Index source positions, latest position is head of its chain */
+	for (offset = 0; offset < DELTAGENERATOR_HASH_SIZE; offset++)
+	{
+		generator.head[offset] = DELTAGENERATOR_NO_POSITION;
+	}
+
+	for (offset = 0; offset + DELTAGENERATOR_SEED_LENGTH <= sourceLength; offset++)
+	{
+		hash = hashSeed(&source[offset]);
+		generator.previous[offset] = generator.head[hash];
+		generator.head[hash] = (int32_t)offset;
+	}
+
+	success = generateInstructions(&generator, sectorSize);
+
+	free(generator.head);
+	free(generator.previous);
+
+	return success ? generator.deltaLength : 0;
+}
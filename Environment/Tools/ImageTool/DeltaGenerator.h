@@ -0,0 +1,66 @@
+/*******************************************************************************
+ *
+ * @file DeltaGenerator.h
+ *
+ * @author MC
+ *
+ * @brief Host side generator of binary deltas (see Delta.h).
+ *
+ *		  Bootloader applies a delta in place: target image is written over
+ *		  source image sector by sector and only the sector which is being
+ *		  written is kept in a scratch sector. So a COPY instruction reads
+ *		  source at or after the start of the sector of its target data and
+ *		  does not cross a target sector boundary. Sectors are counted from
+ *		  start of images (firmware start address).
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __DELTA_GENERATOR_H
+#define __DELTA_GENERATOR_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "Delta.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Shorter matches are inserted, a COPY costs about as much as they save */
+#define DELTAGENERATOR_MIN_COPY_LENGTH				(8)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Generates a delta which transforms source image into target image.
+ *
+ * @param source Source (installed) image
+ * @param sourceLength Length of source image
+ * @param target Target (new) image
+ * @param targetLength Length of target image
+ * @param sectorSize Flash sector size of in place update
+ * @param delta [out] Generated delta
+ * @param deltaSize Size of delta buffer
+ *
+ * @return Length of delta, zero if it does not fit into delta buffer
+ */
+uint32_t DeltaGenerator_Generate(const uint8_t* source,
+								 uint32_t sourceLength,
+								 const uint8_t* target,
+								 uint32_t targetLength,
+								 uint32_t sectorSize,
+								 uint8_t* delta,
+								 uint32_t deltaSize);
+
+#endif	/* __DELTA_GENERATOR_H */
@@ -0,0 +1,428 @@
+/*******************************************************************************
+ *
+ * @file ImageSender.c
+ *
+ * @author MC
+ *
+ * @brief Host side sender of acknowledged (sequenced) image transfers.
+ *
+ *		  Selective repeat : only frames which are reported missing by NAK or
+ *		  not acknowledged before timeout are retransmitted. Link keeps order
+ *		  of bytes, so unacknowledged frames which are sent before an
+ *		  acknowledged frame are lost.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+
+#include "ImageSender.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Number of bits in ACK/NAK bitmap */
+#define IMAGESENDER_BITMAP_BIT_COUNT				(32)
+
+/* Reads a little endian 32 bit field */
+#define IMAGESENDER_GET_UINT32(data)				((data)[0] | ((data)[1] << 8) | ((data)[2] << 16) | ((uint32_t)(data)[3] << 24))
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+
+/* Sender which is processing responses. Frame handler has no context argument */
+PRIVATE ImageSender* activeSender;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Sends a frame to bootloader
+ */
+PRIVATE void sendFrame(ImageSender* sender, uint32_t type, uint32_t address, const uint8_t* payload, uint32_t length)
+{
+	uint8_t frame[BINFRAME_FRAME_LENGTH(BINFRAME_SEQ_PAYLOAD_LENGTH)];
+	uint32_t frameLength;
+
+	frameLength = BinFrame_Encode(type, address, payload, length, frame);
+
+	sender->send(sender->sendArg, frame, frameLength);
+
+	sender->stats.sentFrameCount++;
+	sender->stats.sentByteCount += frameLength;
+}
+
+/*
+ * Sends a sequenced data frame
+ */
+PRIVATE void sendDataFrame(ImageSender* sender, uint32_t seqNo)
+{
+	uint32_t offset = seqNo * BINFRAME_SEQ_PAYLOAD_LENGTH;
+	uint32_t length = MATH_MIN(BINFRAME_SEQ_PAYLOAD_LENGTH, sender->imageLength - offset);
+
+	if (sender->sendIndex[seqNo] != 0)
+	{
+		sender->stats.retransmittedFrameCount++;
+	}
+
+	sendFrame(sender, BINFRAME_TYPE_SEQ_DATA, seqNo, &sender->image[offset], length);
+
+	sender->sendIndex[seqNo] = ++sender->transmitCount;
+	sender->pending[seqNo] = false;
+}
+
+/*
+ * Checks whether all frames are sent at least once
+ */
+PRIVATE ALWAYS_INLINE bool allFramesSent(ImageSender* sender)
+{
+	return (sender->sendIndex[sender->stats.frameCount - 1] != 0);
+}
+
+/*
+ * Returns end of frames which can be in flight. Window of sender starts from
+ * first unacknowledged frame and can not exceed receive window of bootloader.
+ */
+PRIVATE uint32_t getWindowEndSeqNo(ImageSender* sender)
+{
+	uint32_t endSeqNo = sender->baseSeqNo + sender->windowSize;
+
+	endSeqNo = MATH_MIN(endSeqNo, sender->windowSeqNo + sender->receiveWindowSize);
+
+	return MATH_MIN(endSeqNo, sender->stats.frameCount);
+}
+
+/*
+ * Marks sent but unacknowledged frames in range to be retransmitted
+ *
+ * @return Number of marked frames
+ */
+PRIVATE uint32_t markForRetransmit(ImageSender* sender, uint32_t startSeqNo, uint32_t endSeqNo)
+{
+	uint32_t seqNo;
+	uint32_t count = 0;
+
+	endSeqNo = MATH_MIN(endSeqNo, sender->stats.frameCount);
+
+	for (seqNo = startSeqNo; seqNo < endSeqNo; seqNo++)
+	{
+		if ((sender->sendIndex[seqNo] != 0) && !sender->acknowledged[seqNo])
+		{
+			sender->pending[seqNo] = true;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Marks a frame which is received by bootloader
+ */
+PRIVATE void acknowledgeFrame(ImageSender* sender, uint32_t seqNo)
+{
+	sender->acknowledged[seqNo] = true;
+	sender->pending[seqNo] = false;
+
+	sender->highestAckedSendIndex = MATH_MAX(sender->highestAckedSendIndex, sender->sendIndex[seqNo]);
+}
+
+/*
+ * Marks frames which are sent before latest received frame as lost
+ *
+ * @return Number of marked frames
+ */
+PRIVATE uint32_t markLostFrames(ImageSender* sender)
+{
+	uint32_t seqNo;
+	uint32_t count = 0;
+
+	for (seqNo = sender->baseSeqNo; seqNo < sender->stats.frameCount; seqNo++)
+	{
+		if (!sender->acknowledged[seqNo] &&
+			!sender->pending[seqNo] &&
+			(sender->sendIndex[seqNo] != 0) &&
+			(sender->sendIndex[seqNo] < sender->highestAckedSendIndex))
+		{
+			sender->pending[seqNo] = true;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Marks first frame which is sent after latest received frame as lost
+ */
+PRIVATE void markNextFrameLost(ImageSender* sender)
+{
+	uint32_t seqNo;
+	uint32_t nextSeqNo = sender->stats.frameCount;
+
+	for (seqNo = sender->baseSeqNo; seqNo < sender->stats.frameCount; seqNo++)
+	{
+		if (!sender->acknowledged[seqNo] &&
+			!sender->pending[seqNo] &&
+			(sender->sendIndex[seqNo] > sender->highestAckedSendIndex) &&
+			((nextSeqNo == sender->stats.frameCount) || (sender->sendIndex[seqNo] < sender->sendIndex[nextSeqNo])))
+		{
+			nextSeqNo = seqNo;
+		}
+	}
+
+	if (nextSeqNo < sender->stats.frameCount)
+	{
+		sender->pending[nextSeqNo] = true;
+	}
+}
+
+/*
+ * Handles ACK and NAK frames of bootloader
+ */
+PRIVATE bool responseHandler(BinFrameStatusCode status, BinFrame* frame)
+{
+	ImageSender* sender = activeSender;
+	uint32_t frameCount = sender->stats.frameCount;
+	uint32_t bitmap;
+	uint32_t seqNo;
+	uint32_t bitIndex;
+	uint32_t lostFrameCount;
+
+	if ((status != BinFrame_Success) ||
+		((frame->type != BINFRAME_TYPE_ACK) && (frame->type != BINFRAME_TYPE_NAK)) ||
+		(frame->length != BINFRAME_ACK_PAYLOAD_LENGTH))
+	{
+		/* Corrupted responses are ignored, timeout recovers them */
+		return true;
+	}
+
+	sender->retryCount = 0;
+
+	bitmap = IMAGESENDER_GET_UINT32(&frame->payload[0]);
+
+	/* All frames before address are completed */
+	for (seqNo = sender->baseSeqNo; seqNo < MATH_MIN(frame->address, frameCount); seqNo++)
+	{
+		acknowledgeFrame(sender, seqNo);
+	}
+
+	/* Frames in bitmap are received */
+	for (bitIndex = 0; bitIndex < IMAGESENDER_BITMAP_BIT_COUNT; bitIndex++)
+	{
+		seqNo = frame->address + bitIndex;
+		if ((bitmap & (1UL << bitIndex)) && (seqNo < frameCount))
+		{
+			acknowledgeFrame(sender, seqNo);
+		}
+	}
+
+	while ((sender->baseSeqNo < frameCount) && sender->acknowledged[sender->baseSeqNo])
+	{
+		sender->baseSeqNo++;
+	}
+
+	if (frame->address >= sender->windowSeqNo)
+	{
+		sender->windowSeqNo = frame->address;
+		sender->receiveWindowSize = MATH_MAX(IMAGESENDER_GET_UINT32(&frame->payload[4]), 1);
+	}
+
+	if (frame->address >= frameCount)
+	{
+		/* Bootloader wrote all frames */
+		sender->state = ImageSender_Completed;
+		return false;
+	}
+
+	/* Holes are detected by ACKs of later frames too */
+	lostFrameCount = markLostFrames(sender);
+
+	if (frame->type == BINFRAME_TYPE_ACK)
+	{
+		sender->stats.ackCount++;
+		return true;
+	}
+
+	sender->stats.nakCount++;
+
+	/*
+	 * NAK without a hole is sent for a corrupted frame or for END if last
+	 * frames are missing. Frame after latest received one is lost.
+	 */
+	if (lostFrameCount == 0)
+	{
+		markNextFrameLost(sender);
+	}
+
+	/* END may also be lost */
+	sender->endPending = allFramesSent(sender);
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/**
+ * Initializes a sender
+ */
+bool ImageSender_Init(ImageSender* sender, const uint8_t* image, uint32_t imageLength, uint32_t windowSize, ImageSenderSendFunc send, void* sendArg)
+{
+	uint32_t frameCount = (imageLength + BINFRAME_SEQ_PAYLOAD_LENGTH - 1) / BINFRAME_SEQ_PAYLOAD_LENGTH;
+
+	memset(sender, 0, sizeof(ImageSender));
+
+	if ((frameCount == 0) || (windowSize == 0))
+	{
+		return false;
+	}
+
+	sender->image = image;
+	sender->imageLength = imageLength;
+	sender->windowSize = windowSize;
+	sender->maxRetryCount = IMAGESENDER_DEFAULT_MAX_RETRY_COUNT;
+	/* Receive window is not known until first response */
+	sender->receiveWindowSize = windowSize;
+	sender->send = send;
+	sender->sendArg = sendArg;
+	sender->stats.frameCount = frameCount;
+
+	sender->acknowledged = calloc(frameCount, 1);
+	sender->sendIndex = calloc(frameCount, sizeof(uint32_t));
+	sender->pending = malloc(frameCount);
+
+	if ((sender->acknowledged == NULL) || (sender->sendIndex == NULL) || (sender->pending == NULL))
+	{
+		ImageSender_Release(sender);
+		return false;
+	}
+
+	/* All frames are waiting to be sent */
+	memset(sender->pending, true, frameCount);
+
+	BinFrame_InitContext(&sender->responseContext, sender->responsePayload, sizeof(sender->responsePayload));
+
+	return true;
+}
+
+/**
+ * Sets number of successive timeouts before giving up
+ */
+void ImageSender_SetMaxRetryCount(ImageSender* sender, uint32_t maxRetryCount)
+{
+	sender->maxRetryCount = maxRetryCount;
+}
+
+/**
+ * Releases resources of a sender
+ */
+void ImageSender_Release(ImageSender* sender)
+{
+	free(sender->acknowledged);
+	free(sender->sendIndex);
+	free(sender->pending);
+
+	sender->acknowledged = NULL;
+	sender->sendIndex = NULL;
+	sender->pending = NULL;
+}
+
+/**
+ * Sends frames which are allowed by window
+ */
+bool ImageSender_Transmit(ImageSender* sender)
+{
+	uint32_t seqNo;
+	uint32_t endSeqNo;
+	bool transmitted = false;
+
+	if (sender->state != ImageSender_InProgress)
+	{
+		return false;
+	}
+
+	endSeqNo = getWindowEndSeqNo(sender);
+
+	for (seqNo = sender->baseSeqNo; seqNo < endSeqNo; seqNo++)
+	{
+		if (sender->pending[seqNo] && !sender->acknowledged[seqNo])
+		{
+			sendDataFrame(sender, seqNo);
+			transmitted = true;
+
+			if (allFramesSent(sender))
+			{
+				sender->endPending = true;
+			}
+		}
+	}
+
+	if (sender->endPending)
+	{
+		/* END informs bootloader about number of frames to complete last block */
+		sendFrame(sender, BINFRAME_TYPE_END, sender->stats.frameCount, NULL, 0);
+		sender->endPending = false;
+		transmitted = true;
+	}
+
+	return transmitted;
+}
+
+/**
+ * Feeds bytes which are received from bootloader
+ */
+void ImageSender_Feed(ImageSender* sender, const uint8_t* data, uint32_t length)
+{
+	activeSender = sender;
+
+	BinFrame_Feed(&sender->responseContext, data, length, responseHandler);
+
+	activeSender = NULL;
+}
+
+/**
+ * Informs sender about a response timeout
+ */
+void ImageSender_Timeout(ImageSender* sender)
+{
+	if (sender->state != ImageSender_InProgress)
+	{
+		return;
+	}
+
+	sender->stats.timeoutCount++;
+
+	if (++sender->retryCount > sender->maxRetryCount)
+	{
+		sender->state = ImageSender_Failed;
+		return;
+	}
+
+	markForRetransmit(sender, sender->baseSeqNo, getWindowEndSeqNo(sender));
+
+	sender->endPending = allFramesSent(sender);
+}
+
+/**
+ * Returns state of transfer
+ */
+ImageSenderState ImageSender_GetState(ImageSender* sender)
+{
+	return sender->state;
+}
+
+/**
+ * Returns statistics of transfer
+ */
+const ImageSenderStats* ImageSender_GetStats(ImageSender* sender)
+{
+	return &sender->stats;
+}
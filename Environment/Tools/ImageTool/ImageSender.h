@@ -0,0 +1,180 @@
+/*******************************************************************************
+ *
+ * @file ImageSender.h
+ *
+ * @author MC
+ *
+ * @brief Host side sender of acknowledged (sequenced) image transfers.
+ *
+ *		  Image is split into sequenced frames (BINFRAME_TYPE_SEQ_DATA) and
+ *		  up to a window of frames are kept in flight. Frames are never sent
+ *		  beyond receive window of bootloader. Bootloader acknowledges
+ *		  received frames with ACK/NAK frames and sender retransmits only
+ *		  missing frames.
+ *
+ *		  Sender does not block. Caller feeds received bytes, triggers
+ *		  transmissions and informs sender about response timeouts, so it
+ *		  can be driven by a serial port or by a simulated link.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __IMAGE_SENDER_H
+#define __IMAGE_SENDER_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "BinFrame.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Default number of frames in flight (one flash write buffer of bootloader) */
+#define IMAGESENDER_DEFAULT_WINDOW_SIZE				(16)
+
+/* Default number of successive timeouts before giving up */
+#define IMAGESENDER_DEFAULT_MAX_RETRY_COUNT			(10)
+
+/***************************** TYPE DEFINITIONS *******************************/
+/*
+ * Sends bytes to bootloader
+ */
+typedef void (*ImageSenderSendFunc)(void* arg, const uint8_t* data, uint32_t length);
+
+/*
+ * State of transfer
+ */
+typedef enum
+{
+	ImageSender_InProgress = 0,
+	/* All frames are acknowledged */
+	ImageSender_Completed,
+	/* Bootloader does not respond */
+	ImageSender_Failed
+} ImageSenderState;
+
+/*
+ * Transfer statistics
+ */
+typedef struct
+{
+	/* Number of sequenced data frames of image */
+	uint32_t frameCount;
+	/* Number of sent frames including retransmissions */
+	uint32_t sentFrameCount;
+	/* Number of retransmitted frames */
+	uint32_t retransmittedFrameCount;
+	/* Number of sent bytes */
+	uint32_t sentByteCount;
+	/* Number of received ACK and NAK frames */
+	uint32_t ackCount;
+	uint32_t nakCount;
+	/* Number of response timeouts */
+	uint32_t timeoutCount;
+} ImageSenderStats;
+
+/*
+ * Sender context. Fields are private to sender.
+ */
+typedef struct
+{
+	/* Image from firmware start address */
+	const uint8_t* image;
+	uint32_t imageLength;
+	/* Number of frames in flight */
+	uint32_t windowSize;
+	/* Number of successive timeouts before giving up */
+	uint32_t maxRetryCount;
+	/* Output function */
+	ImageSenderSendFunc send;
+	void* sendArg;
+	/* Frame states */
+	uint8_t* acknowledged;
+	uint8_t* pending;
+	/* Order of last transmission of each frame, zero if frame is not sent */
+	uint32_t* sendIndex;
+	uint32_t transmitCount;
+	/* Latest transmission which is known to be received */
+	uint32_t highestAckedSendIndex;
+	/* First frame which is not acknowledged */
+	uint32_t baseSeqNo;
+	/* First frame and size of bootloader receive window (reported by ACK/NAK) */
+	uint32_t windowSeqNo;
+	uint32_t receiveWindowSize;
+	/* END frame must be sent */
+	bool endPending;
+	/* Successive timeouts */
+	uint32_t retryCount;
+	/* Response parser */
+	BinFrameContext responseContext;
+	uint8_t responsePayload[BINFRAME_ACK_PAYLOAD_LENGTH];
+	ImageSenderState state;
+	ImageSenderStats stats;
+} ImageSender;
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Initializes a sender.
+ *
+ * @param sender Sender context
+ * @param image Image data from firmware start address. Must be valid until
+ *		  transfer is finished.
+ * @param imageLength Length of image
+ * @param windowSize Number of frames in flight
+ * @param send Function to send bytes to bootloader
+ * @param sendArg Argument of send function
+ *
+ * @return true if sender is initialized
+ */
+bool ImageSender_Init(ImageSender* sender, const uint8_t* image, uint32_t imageLength, uint32_t windowSize, ImageSenderSendFunc send, void* sendArg);
+
+/*
+ * Sets number of successive timeouts before giving up.
+ *	Default is IMAGESENDER_DEFAULT_MAX_RETRY_COUNT.
+ */
+void ImageSender_SetMaxRetryCount(ImageSender* sender, uint32_t maxRetryCount);
+
+/*
+ * Releases resources of a sender
+ */
+void ImageSender_Release(ImageSender* sender);
+
+/*
+ * Sends frames which are allowed by window.
+ *
+ * @return true if any frame is sent
+ */
+bool ImageSender_Transmit(ImageSender* sender);
+
+/*
+ * Feeds bytes which are received from bootloader.
+ */
+void ImageSender_Feed(ImageSender* sender, const uint8_t* data, uint32_t length);
+
+/*
+ * Informs sender that no response is received in time. Unacknowledged frames
+ * in window are retransmitted with next ImageSender_Transmit call.
+ */
+void ImageSender_Timeout(ImageSender* sender);
+
+/*
+ * Returns state of transfer
+ */
+ImageSenderState ImageSender_GetState(ImageSender* sender);
+
+/*
+ * Returns statistics of transfer
+ */
+const ImageSenderStats* ImageSender_GetStats(ImageSender* sender);
+
+#endif	/* __IMAGE_SENDER_H */
@@ -0,0 +1,955 @@
+/*******************************************************************************
+ *
+ * @file ImageTool.c
+ *
+ * @author MC
+ *
+ * @brief Host side firmware image tool.
+ *
+ *        Prepares firmware images to be uploaded to bootloader.
+ *
+ *        [USAGE] : ImageTool frame <Input File> <Output File> [Base Address]
+ *
+ *          Converts an Intel HEX file (e.g. App.hex, ER_IROM1.signed) or a
+ *          raw binary file into binary frame stream (see BinFrame.h) and
+ *          reports wire byte reduction. Raw binary files are placed to Base
+ *          Address (default is firmware start address).
+ *
+ *          Both commands add a sector manifest into unused part of metadata
+ *          of signed images, so bootloader skips sectors which are not
+ *          changed since previous upgrade.
+ *
+ *        [USAGE] : ImageTool send <Input File> <Serial Device> [Baud Rate] [Window Size]
+ *
+ *          Uploads firmware part of input file to bootloader using sequenced
+ *          frames. Only frames which are reported missing by bootloader are
+ *          retransmitted (see ImageSender.h). Upload time is reported.
+ *          Serial device can be pseudo terminal of simulated bootloader
+ *          (make PROJECT=Bootloader ENV=x86).
+ *
+ *        [USAGE] : ImageTool delta <Installed File> <New File> <Output File>
+ *
+ *          Generates a binary delta (see DeltaGenerator.h) which transforms
+ *          installed firmware into new firmware and writes it as patch
+ *          frames. Patch size is reported against full frame stream.
+ *
+ *        [USAGE] : ImageTool compress <Input File> <Output File>
+ *
+ *          Compresses firmware (see Compressor.h) and writes it as compressed
+ *          frames. Bootloader decompresses it while it is received.
+ *
+ *        [USAGE] : ImageTool key <Key File> <Output File> [Key Name]
+ *
+ *          Writes RSA public key of key file (e.g. rsa_pub.txt) as a C header
+ *          with precomputed R^2 mod N (see KeyGenerator.h). Bootloader uses
+ *          it without parsing the key while booting.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "IntelHex.h"
+#include "BinFrame.h"
+#include "ImageSender.h"
+#include "DeltaGenerator.h"
+#include "Compressor.h"
+#include "KeyGenerator.h"
+
+#include "mbedtls/sha256.h"
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Images are mapped into LPC1768 flash (512K) */
+#define IMAGETOOL_FLASH_SIZE				(0x80000)
+
+/* Default address of raw binary images, same as FIRMWARE_START_ADDRESS */
+#define IMAGETOOL_DEFAULT_BASE_ADDRESS		(0x10000)
+
+/*
+ * Frame payload length. Frames are aligned to flash write buffer of
+ * bootloader so each frame fills a single block.
+ */
+#define IMAGETOOL_FRAME_PAYLOAD_LENGTH		(BINFRAME_MAX_PAYLOAD_LENGTH)
+
+/*
+ * Metadata of signed images at firmware start address, same as FirmwareInfo
+ * and FirmwareSectorManifest of bootloader (see Bootloader_Internal.h)
+ */
+#define IMAGETOOL_METADATA_LENGTH			(512)
+#define IMAGETOOL_MANIFEST_OFFSET			(12)
+#define IMAGETOOL_MANIFEST_MAGIC			(0x4E414D53)
+#define IMAGETOOL_SECTOR_HASH_LENGTH		(16)
+#define IMAGETOOL_MAX_MANIFEST_SECTOR_COUNT	(14)
+#define IMAGETOOL_MANIFEST_LENGTH			(8 + (IMAGETOOL_MAX_MANIFEST_SECTOR_COUNT * IMAGETOOL_SECTOR_HASH_LENGTH))
+
+/* Firmware area of LPC1768 consists of 32K sectors */
+#define IMAGETOOL_SECTOR_SIZE				(32 * 1024)
+
+/* UART frame length in bits for 8N1 */
+#define IMAGETOOL_UART_BITS_PER_BYTE		(10)
+
+/* Reference baud rate to report transfer time */
+#define IMAGETOOL_REFERENCE_BAUD_RATE		(115200)
+
+/* Response timeout in addition to wire time of a window */
+#define IMAGETOOL_RESPONSE_TIMEOUT_IN_MS	(500)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Firmware image which is loaded from input file
+ */
+typedef struct
+{
+	/* Flash content */
+	uint8_t data[IMAGETOOL_FLASH_SIZE];
+	/* Marks bytes which are included in input file */
+	uint8_t used[IMAGETOOL_FLASH_SIZE];
+	/* Current segment address while loading Intel HEX */
+	uint32_t segmentAddress;
+	/* Load status */
+	bool failed;
+} ToolImage;
+
+/******************************** VARIABLES ***********************************/
+
+/* Loaded image */
+PRIVATE ToolImage image;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns monotonic time in microseconds
+ */
+PRIVATE uint64_t getTimeInUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000);
+}
+
+/*
+ * Reads whole file into a newly allocated buffer
+ */
+PRIVATE uint8_t* readFile(const char* fileName, uint32_t* fileSize)
+{
+	FILE* file;
+	long size;
+	uint8_t* content;
+
+	file = fopen(fileName, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	content = malloc((size_t)size + 1);
+	if ((content == NULL) || (fread(content, 1, (size_t)size, file) != (size_t)size))
+	{
+		free(content);
+		fclose(file);
+		return NULL;
+	}
+	fclose(file);
+
+	*fileSize = (uint32_t)size;
+
+	return content;
+}
+
+/*
+ * Places data into image
+ */
+PRIVATE bool storeData(uint32_t address, const uint8_t* data, uint32_t length)
+{
+	if ((address >= IMAGETOOL_FLASH_SIZE) || (length > IMAGETOOL_FLASH_SIZE - address))
+	{
+		printf("Data exceeds flash : 0x%08X (%u bytes)\n", address, length);
+		return false;
+	}
+
+	memcpy(&image.data[address], data, length);
+	memset(&image.used[address], 1, length);
+
+	return true;
+}
+
+/*
+ * Handles Intel HEX lines of input file
+ */
+PRIVATE bool intelHexLineHandler(IntelHexStatusCode status, IntelHexLine* intelHexLine)
+{
+	if (status != IntelHex_Success)
+	{
+		printf("Corrupted Intel HEX line (status : %d)\n", status);
+		image.failed = true;
+		return false;
+	}
+
+	switch (intelHexLine->recordType)
+	{
+		case INTELHEX_RECORDTYPE_DATA:
+			image.failed = !storeData(image.segmentAddress + intelHexLine->address, intelHexLine->data, intelHexLine->lenght);
+			break;
+		case INTELHEX_RECORDTYPE_EXTENDED_SEGMENT_ADDRESS:
+			image.segmentAddress = ((intelHexLine->data[0] << 8) | intelHexLine->data[1]) << 4;
+			break;
+		case INTELHEX_RECORDTYPE_EXTENDED_LINEAR_ADDRESS:
+			image.segmentAddress = ((intelHexLine->data[0] << 8) | intelHexLine->data[1]) * INTELHEX_SEGMENT_SIZE;
+			break;
+		default:
+			/* EOF and start address records do not carry image data */
+			break;
+	}
+
+	return !image.failed;
+}
+
+/*
+ * Loads input file into image. Intel HEX format is detected by its prefix.
+ */
+PRIVATE bool loadImage(const uint8_t* content, uint32_t length, uint32_t baseAddress)
+{
+	IntelHexContext context;
+
+	if ((length > 0) && (content[0] == INTELHEX_PREFIX))
+	{
+		IntelHex_InitContext(&context);
+		IntelHex_Feed(&context, content, length, intelHexLineHandler);
+
+		return !image.failed;
+	}
+
+	return storeData(baseAddress, content, length);
+}
+
+/*
+ * Reads a little endian word of image
+ */
+PRIVATE uint32_t readImageWord(uint32_t address)
+{
+	return image.data[address] | (image.data[address + 1] << 8) | (image.data[address + 2] << 16) | ((uint32_t)image.data[address + 3] << 24);
+}
+
+/*
+ * Writes a little endian word into image
+ */
+PRIVATE void writeImageWord(uint32_t address, uint32_t value)
+{
+	uint8_t data[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+
+	storeData(address, data, sizeof(data));
+}
+
+/*
+ * Adds sector manifest into metadata of image.
+ *
+ *	Hashes cover whole sectors as they are after upgrade, gaps of image are
+ *	erased flash. Manifest is added only if its area is unused (erased) so
+ *	images of other layouts are not modified.
+ *
+ * @return Number of hashed sectors, zero if manifest is not added
+ */
+PRIVATE uint32_t addSectorManifest(void)
+{
+	uint8_t digest[32];
+	uint32_t address = IMAGETOOL_DEFAULT_BASE_ADDRESS + IMAGETOOL_MANIFEST_OFFSET;
+	uint32_t imageEnd;
+	uint32_t sectorCount;
+	uint32_t sectorNo;
+	uint32_t index;
+
+	if (!image.used[IMAGETOOL_DEFAULT_BASE_ADDRESS])
+	{
+		/* Image does not start with metadata */
+		return 0;
+	}
+
+	for (index = 0; index < IMAGETOOL_MANIFEST_LENGTH; index++)
+	{
+		if (image.data[address + index] != 0xFF)
+		{
+			return 0;
+		}
+	}
+
+	/* Header keeps image size and offset */
+	imageEnd = readImageWord(IMAGETOOL_DEFAULT_BASE_ADDRESS) + readImageWord(IMAGETOOL_DEFAULT_BASE_ADDRESS + 4);
+
+	if ((readImageWord(IMAGETOOL_DEFAULT_BASE_ADDRESS + 4) != IMAGETOOL_DEFAULT_BASE_ADDRESS + IMAGETOOL_METADATA_LENGTH) ||
+		(imageEnd > IMAGETOOL_FLASH_SIZE))
+	{
+		return 0;
+	}
+
+	sectorCount = (imageEnd - IMAGETOOL_DEFAULT_BASE_ADDRESS + IMAGETOOL_SECTOR_SIZE - 1) / IMAGETOOL_SECTOR_SIZE;
+	if (sectorCount > IMAGETOOL_MAX_MANIFEST_SECTOR_COUNT)
+	{
+		return 0;
+	}
+
+	writeImageWord(address, IMAGETOOL_MANIFEST_MAGIC);
+	writeImageWord(address + 4, sectorCount);
+
+	/* First sector includes manifest itself and bootloader always writes it */
+	for (sectorNo = 0; sectorNo < sectorCount; sectorNo++)
+	{
+		mbedtls_sha256(&image.data[IMAGETOOL_DEFAULT_BASE_ADDRESS + (sectorNo * IMAGETOOL_SECTOR_SIZE)], IMAGETOOL_SECTOR_SIZE, digest, 0);
+		storeData(address + 8 + (sectorNo * IMAGETOOL_SECTOR_HASH_LENGTH), digest, IMAGETOOL_SECTOR_HASH_LENGTH);
+	}
+
+	return sectorCount;
+}
+
+/*
+ * Loads firmware file as it is placed at firmware start address by bootloader
+ *
+ * @return Length of firmware from firmware start address, zero on failure
+ */
+PRIVATE uint32_t loadFirmware(const char* fileName)
+{
+	uint8_t* content;
+	uint32_t inputLength;
+	uint32_t imageLength = 0;
+	uint32_t index;
+	bool success;
+
+	/* Gaps of image are erased flash */
+	memset(image.data, 0xFF, sizeof(image.data));
+	memset(image.used, 0, sizeof(image.used));
+	image.segmentAddress = 0;
+	image.failed = false;
+
+	content = readFile(fileName, &inputLength);
+	if (content == NULL)
+	{
+		printf("Input file could not be read : %s\n", fileName);
+		return 0;
+	}
+
+	success = loadImage(content, inputLength, IMAGETOOL_DEFAULT_BASE_ADDRESS);
+	free(content);
+
+	if (success)
+	{
+		addSectorManifest();
+	}
+
+	for (index = IMAGETOOL_DEFAULT_BASE_ADDRESS; index < IMAGETOOL_FLASH_SIZE; index++)
+	{
+		if (image.used[index])
+		{
+			imageLength = index + 1 - IMAGETOOL_DEFAULT_BASE_ADDRESS;
+		}
+	}
+
+	if (!success || (imageLength == 0))
+	{
+		printf("Input file could not be loaded : %s\n", fileName);
+		return 0;
+	}
+
+	return imageLength;
+}
+
+/*
+ * Writes a frame into output file
+ */
+PRIVATE bool writeFrame(FILE* file, uint32_t type, uint32_t address, const uint8_t* payload, uint32_t length, uint32_t* outputLength)
+{
+	uint8_t frame[BINFRAME_FRAME_LENGTH(IMAGETOOL_FRAME_PAYLOAD_LENGTH)];
+	uint32_t frameLength;
+
+	frameLength = BinFrame_Encode(type, address, payload, length, frame);
+
+	*outputLength += frameLength;
+
+	return (fwrite(frame, 1, frameLength, file) == frameLength);
+}
+
+/*
+ * Converts loaded image into binary frames.
+ *	Each contiguous part of image is split at payload length boundaries.
+ */
+PRIVATE bool writeFrames(FILE* file, uint32_t* outputLength, uint32_t* frameCount)
+{
+	uint32_t address = 0;
+	uint32_t length;
+	uint32_t limit;
+
+	while (address < IMAGETOOL_FLASH_SIZE)
+	{
+		if (!image.used[address])
+		{
+			address++;
+			continue;
+		}
+
+		/* Frame ends at end of contiguous data or at next aligned boundary */
+		limit = (address - (address % IMAGETOOL_FRAME_PAYLOAD_LENGTH)) + IMAGETOOL_FRAME_PAYLOAD_LENGTH;
+		for (length = 0; (address + length < limit) && image.used[address + length]; length++);
+
+		if (!writeFrame(file, BINFRAME_TYPE_DATA, address, &image.data[address], length, outputLength))
+		{
+			return false;
+		}
+
+		(*frameCount)++;
+		address += length;
+	}
+
+	(*frameCount)++;
+
+	return writeFrame(file, BINFRAME_TYPE_END, 0, NULL, 0, outputLength);
+}
+
+/*
+ * Converts input file into binary frames
+ */
+PRIVATE int frameCommand(const char* inputFileName, const char* outputFileName, uint32_t baseAddress)
+{
+	uint8_t* content;
+	uint32_t inputLength;
+	uint32_t outputLength = 0;
+	uint32_t frameCount = 0;
+	uint32_t index;
+	uint32_t imageLength = 0;
+	uint32_t sectorCount;
+	FILE* file;
+	bool success;
+
+	/* Gaps of image are erased flash for sector hashes */
+	memset(image.data, 0xFF, sizeof(image.data));
+
+	content = readFile(inputFileName, &inputLength);
+	if (content == NULL)
+	{
+		printf("Input file could not be read : %s\n", inputFileName);
+		return RESULT_FAIL;
+	}
+
+	success = loadImage(content, inputLength, baseAddress);
+	free(content);
+
+	if (!success)
+	{
+		printf("Input file could not be loaded : %s\n", inputFileName);
+		return RESULT_FAIL;
+	}
+
+	sectorCount = addSectorManifest();
+
+	file = fopen(outputFileName, "wb");
+	if (file == NULL)
+	{
+		printf("Output file could not be created : %s\n", outputFileName);
+		return RESULT_FAIL;
+	}
+
+	success = writeFrames(file, &outputLength, &frameCount);
+	fclose(file);
+
+	if (!success)
+	{
+		printf("Output file could not be written : %s\n", outputFileName);
+		return RESULT_FAIL;
+	}
+
+	for (index = 0; index < IMAGETOOL_FLASH_SIZE; index++)
+	{
+		imageLength += image.used[index];
+	}
+
+	printf("\nBinary Frame Conversion (%s -> %s)\n", inputFileName, outputFileName);
+	printf("  image data       : %10u bytes\n", imageLength);
+	printf("  input stream     : %10u bytes\n", inputLength);
+	printf("  frame stream     : %10u bytes (%u frames)\n", outputLength, frameCount);
+	printf("  sector manifest  : %10u sectors\n", sectorCount);
+	printf("  wire reduction   : %9.1f %%\n", 100.0 * (1.0 - ((double)outputLength / (double)inputLength)));
+	printf("  transfer time    : %9.3f s -> %.3f s at %u baud\n",
+		   ((double)inputLength * IMAGETOOL_UART_BITS_PER_BYTE) / IMAGETOOL_REFERENCE_BAUD_RATE,
+		   ((double)outputLength * IMAGETOOL_UART_BITS_PER_BYTE) / IMAGETOOL_REFERENCE_BAUD_RATE,
+		   IMAGETOOL_REFERENCE_BAUD_RATE);
+
+	return RESULT_SUCCESS;
+}
+
+/*
+ * Returns length of frame stream which sends data in frames of maximum length
+ */
+PRIVATE uint32_t getFrameStreamLength(uint32_t length)
+{
+	uint32_t frameCount = (length + IMAGETOOL_FRAME_PAYLOAD_LENGTH - 1) / IMAGETOOL_FRAME_PAYLOAD_LENGTH;
+
+	/* END frame is added */
+	return length + ((frameCount + 1) * BINFRAME_OVERHEAD_LENGTH);
+}
+
+/*
+ * Writes data as frames of a type and an END frame
+ */
+PRIVATE bool writeStreamFrames(FILE* file, uint32_t type, const uint8_t* data, uint32_t length, uint32_t* outputLength, uint32_t* frameCount)
+{
+	uint32_t offset;
+	uint32_t frameLength;
+
+	for (offset = 0; offset < length; offset += frameLength)
+	{
+		frameLength = MATH_MIN(IMAGETOOL_FRAME_PAYLOAD_LENGTH, length - offset);
+
+		if (!writeFrame(file, type, offset, &data[offset], frameLength, outputLength))
+		{
+			return false;
+		}
+
+		(*frameCount)++;
+	}
+
+	(*frameCount)++;
+
+	return writeFrame(file, BINFRAME_TYPE_END, 0, NULL, 0, outputLength);
+}
+
+/*
+ * Generates delta of new firmware against installed firmware as patch frames
+ */
+PRIVATE int deltaCommand(const char* sourceFileName, const char* targetFileName, const char* outputFileName)
+{
+	uint8_t* source;
+	uint8_t* delta;
+	uint32_t sourceLength;
+	uint32_t targetLength;
+	uint32_t deltaSize;
+	uint32_t deltaLength;
+	uint32_t outputLength = 0;
+	uint32_t fullLength;
+	uint32_t frameCount = 0;
+	FILE* file;
+	bool success;
+
+	sourceLength = loadFirmware(sourceFileName);
+	if (sourceLength == 0)
+	{
+		return RESULT_FAIL;
+	}
+
+	source = malloc(sourceLength);
+	if (source == NULL)
+	{
+		return RESULT_FAIL;
+	}
+	memcpy(source, &image.data[IMAGETOOL_DEFAULT_BASE_ADDRESS], sourceLength);
+
+	targetLength = loadFirmware(targetFileName);
+
+	/* Worst case is a single insertion of whole image */
+	deltaSize = DELTA_HEADER_LENGTH + DELTA_MAX_INSTRUCTION_LENGTH + targetLength;
+	delta = malloc(deltaSize);
+
+	deltaLength = 0;
+	if ((targetLength > 0) && (delta != NULL))
+	{
+		deltaLength = DeltaGenerator_Generate(source, sourceLength, &image.data[IMAGETOOL_DEFAULT_BASE_ADDRESS], targetLength,
+											  IMAGETOOL_SECTOR_SIZE, delta, deltaSize);
+	}
+	free(source);
+
+	if (deltaLength == 0)
+	{
+		free(delta);
+		printf("Delta could not be generated\n");
+		return RESULT_FAIL;
+	}
+
+	file = fopen(outputFileName, "wb");
+	if (file == NULL)
+	{
+		free(delta);
+		printf("Output file could not be created : %s\n", outputFileName);
+		return RESULT_FAIL;
+	}
+
+	success = writeStreamFrames(file, BINFRAME_TYPE_PATCH, delta, deltaLength, &outputLength, &frameCount);
+	fclose(file);
+	free(delta);
+
+	if (!success)
+	{
+		printf("Output file could not be written : %s\n", outputFileName);
+		return RESULT_FAIL;
+	}
+
+	/* Full upgrade sends whole image as data frames */
+	fullLength = getFrameStreamLength(targetLength);
+
+	printf("\nDelta Generation (%s -> %s, %s)\n", sourceFileName, targetFileName, outputFileName);
+	printf("  installed image  : %10u bytes\n", sourceLength);
+	printf("  new image        : %10u bytes\n", targetLength);
+	printf("  delta            : %10u bytes\n", deltaLength);
+	printf("  patch stream     : %10u bytes (%u frames)\n", outputLength, frameCount);
+	printf("  full stream      : %10u bytes\n", fullLength);
+	printf("  wire reduction   : %9.1f %%\n", 100.0 * (1.0 - ((double)outputLength / (double)fullLength)));
+	printf("  transfer time    : %9.3f s -> %.3f s at %u baud\n",
+		   ((double)fullLength * IMAGETOOL_UART_BITS_PER_BYTE) / IMAGETOOL_REFERENCE_BAUD_RATE,
+		   ((double)outputLength * IMAGETOOL_UART_BITS_PER_BYTE) / IMAGETOOL_REFERENCE_BAUD_RATE,
+		   IMAGETOOL_REFERENCE_BAUD_RATE);
+
+	return RESULT_SUCCESS;
+}
+
+/*
+ * Compresses firmware and writes it as compressed frames
+ */
+PRIVATE int compressCommand(const char* inputFileName, const char* outputFileName)
+{
+	uint8_t* compressed;
+	uint32_t imageLength;
+	uint32_t compressedSize;
+	uint32_t compressedLength = 0;
+	uint32_t outputLength = 0;
+	uint32_t frameCount = 0;
+	uint32_t fullLength;
+	FILE* file;
+	bool success;
+
+	imageLength = loadFirmware(inputFileName);
+	if (imageLength == 0)
+	{
+		return RESULT_FAIL;
+	}
+
+	/* Worst case is a literal for each byte */
+	compressedSize = LZSS_HEADER_LENGTH + ((imageLength * 9) / 8) + 1;
+	compressed = malloc(compressedSize);
+	if (compressed != NULL)
+	{
+		compressedLength = Compressor_Compress(&image.data[IMAGETOOL_DEFAULT_BASE_ADDRESS], imageLength,
+											   COMPRESSOR_DEFAULT_WINDOW_BITS, COMPRESSOR_DEFAULT_LENGTH_BITS,
+											   compressed, compressedSize);
+	}
+
+	if (compressedLength == 0)
+	{
+		free(compressed);
+		printf("Image could not be compressed\n");
+		return RESULT_FAIL;
+	}
+
+	file = fopen(outputFileName, "wb");
+	if (file == NULL)
+	{
+		free(compressed);
+		printf("Output file could not be created : %s\n", outputFileName);
+		return RESULT_FAIL;
+	}
+
+	success = writeStreamFrames(file, BINFRAME_TYPE_COMPRESSED, compressed, compressedLength, &outputLength, &frameCount);
+	fclose(file);
+	free(compressed);
+
+	if (!success)
+	{
+		printf("Output file could not be written : %s\n", outputFileName);
+		return RESULT_FAIL;
+	}
+
+	fullLength = getFrameStreamLength(imageLength);
+
+	printf("\nCompression (%s -> %s, window %u bytes)\n", inputFileName, outputFileName, 1U << COMPRESSOR_DEFAULT_WINDOW_BITS);
+	printf("  image data       : %10u bytes\n", imageLength);
+	printf("  compressed       : %10u bytes (%.1f %%)\n", compressedLength, (100.0 * compressedLength) / imageLength);
+	printf("  compressed stream: %10u bytes (%u frames)\n", outputLength, frameCount);
+	printf("  full stream      : %10u bytes\n", fullLength);
+	printf("  transfer time    : %9.3f s -> %.3f s at %u baud\n",
+		   ((double)fullLength * IMAGETOOL_UART_BITS_PER_BYTE) / IMAGETOOL_REFERENCE_BAUD_RATE,
+		   ((double)outputLength * IMAGETOOL_UART_BITS_PER_BYTE) / IMAGETOOL_REFERENCE_BAUD_RATE,
+		   IMAGETOOL_REFERENCE_BAUD_RATE);
+
+	return RESULT_SUCCESS;
+}
+
+/*
+ * Generates public key header of bootloader
+ */
+PRIVATE int keyCommand(const char* keyFileName, const char* outputFileName, const char* keyName)
+{
+	if (!KeyGenerator_Generate(keyFileName, outputFileName, keyName))
+	{
+		printf("Key header could not be generated\n");
+		return RESULT_FAIL;
+	}
+
+	printf("\nKey Generation (%s -> %s)\n", keyFileName, outputFileName);
+	printf("  key              : RSA-%u (%s_N, %s_E, %s_RN)\n", KEYGENERATOR_KEY_LENGTH * 8, keyName, keyName, keyName);
+
+	return RESULT_SUCCESS;
+}
+
+/*
+ * Prints usage of tool
+ */
+PRIVATE int printUsage(const char* toolName)
+{
+	printf("Usage : %s frame <Input File> <Output File> [Base Address]\n", toolName);
+	printf("        %s send <Input File> <Serial Device> [Baud Rate] [Window Size]\n", toolName);
+	printf("        %s delta <Installed File> <New File> <Output File>\n", toolName);
+	printf("        %s compress <Input File> <Output File>\n", toolName);
+	printf("        %s key <Key File> <Output File> [Key Name]\n", toolName);
+
+	return RESULT_FAIL;
+}
+
+/*
+ * Converts baud rate into termios speed
+ */
+PRIVATE speed_t getSerialSpeed(uint32_t baudRate)
+{
+	switch (baudRate)
+	{
+		case 9600:		return B9600;
+		case 19200:		return B19200;
+		case 38400:		return B38400;
+		case 57600:		return B57600;
+		case 115200:	return B115200;
+		case 230400:	return B230400;
+		case 460800:	return B460800;
+		case 921600:	return B921600;
+		default:		return B0;
+	}
+}
+
+/*
+ * Opens serial device in raw mode (8N1)
+ */
+PRIVATE int openSerialDevice(const char* deviceName, uint32_t baudRate)
+{
+	struct termios options;
+	speed_t speed = getSerialSpeed(baudRate);
+	int fd;
+
+	if (speed == B0)
+	{
+		return -1;
+	}
+
+	fd = open(deviceName, O_RDWR | O_NOCTTY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+
+	if (tcgetattr(fd, &options) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+
+	cfmakeraw(&options);
+	cfsetispeed(&options, speed);
+	cfsetospeed(&options, speed);
+	options.c_cflag |= (CLOCAL | CREAD);
+	options.c_cflag &= ~(CSTOPB | CRTSCTS);
+
+	if (tcsetattr(fd, TCSANOW, &options) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+
+	tcflush(fd, TCIOFLUSH);
+
+	return fd;
+}
+
+/*
+ * Writes frames of sender into serial device
+ */
+PRIVATE void serialSend(void* arg, const uint8_t* data, uint32_t length)
+{
+	int fd = *(int*)arg;
+	ssize_t written;
+
+	while (length > 0)
+	{
+		written = write(fd, data, length);
+		if (written <= 0)
+		{
+			return;
+		}
+
+		data += written;
+		length -= (uint32_t)written;
+	}
+}
+
+/*
+ * Uploads firmware part of input file to bootloader over serial device
+ */
+PRIVATE int sendCommand(const char* inputFileName, const char* deviceName, uint32_t baudRate, uint32_t windowSize)
+{
+	ImageSender sender;
+	const ImageSenderStats* stats;
+	struct pollfd pollFd;
+	uint8_t buffer[256];
+	uint32_t imageLength;
+	uint32_t timeoutInMs;
+	ssize_t readLength;
+	uint64_t startTimeInUs;
+	uint64_t elapsedTimeInUs;
+	int fd;
+	bool success;
+
+	imageLength = loadFirmware(inputFileName);
+	if (imageLength == 0)
+	{
+		return RESULT_FAIL;
+	}
+
+	fd = openSerialDevice(deviceName, baudRate);
+	if (fd < 0)
+	{
+		printf("Serial device could not be opened : %s (%u baud)\n", deviceName, baudRate);
+		return RESULT_FAIL;
+	}
+
+	if (!ImageSender_Init(&sender, &image.data[IMAGETOOL_DEFAULT_BASE_ADDRESS], imageLength, windowSize, serialSend, &fd))
+	{
+		close(fd);
+		printf("Sender could not be initialized\n");
+		return RESULT_FAIL;
+	}
+
+	/* Wait for wire time of a window in both directions before retransmission */
+	timeoutInMs = (uint32_t)((2ULL * windowSize * BINFRAME_FRAME_LENGTH(BINFRAME_SEQ_PAYLOAD_LENGTH) * IMAGETOOL_UART_BITS_PER_BYTE * 1000) / baudRate);
+	timeoutInMs += IMAGETOOL_RESPONSE_TIMEOUT_IN_MS;
+
+	pollFd.fd = fd;
+	pollFd.events = POLLIN;
+
+	startTimeInUs = getTimeInUs();
+
+	while (ImageSender_GetState(&sender) == ImageSender_InProgress)
+	{
+		ImageSender_Transmit(&sender);
+
+		if (poll(&pollFd, 1, (int)timeoutInMs) > 0)
+		{
+			readLength = read(fd, buffer, sizeof(buffer));
+			if (readLength <= 0)
+			{
+				/* Device is hung up (e.g. simulated bootloader exited) */
+				break;
+			}
+
+			ImageSender_Feed(&sender, buffer, (uint32_t)readLength);
+		}
+		else
+		{
+			ImageSender_Timeout(&sender);
+		}
+	}
+
+	elapsedTimeInUs = getTimeInUs() - startTimeInUs;
+
+	tcdrain(fd);
+	close(fd);
+
+	stats = ImageSender_GetStats(&sender);
+
+	printf("\nSequenced Upload (%s -> %s, %u baud, window %u)\n", inputFileName, deviceName, baudRate, windowSize);
+	printf("  image data       : %10u bytes (%u frames)\n", imageLength, stats->frameCount);
+	printf("  sent             : %10u bytes (%u frames)\n", stats->sentByteCount, stats->sentFrameCount);
+	printf("  retransmitted    : %10u frames\n", stats->retransmittedFrameCount);
+	printf("  ACK / NAK        : %10u / %u\n", stats->ackCount, stats->nakCount);
+	printf("  timeouts         : %10u\n", stats->timeoutCount);
+	printf("  elapsed          : %10.1f ms (%.0f bytes/s)\n", elapsedTimeInUs / 1e3, (imageLength * 1e6) / MATH_MAX(elapsedTimeInUs, 1));
+	printf("  result           : %s\n", (ImageSender_GetState(&sender) == ImageSender_Completed) ? "completed" : "failed");
+
+	success = (ImageSender_GetState(&sender) == ImageSender_Completed);
+
+	ImageSender_Release(&sender);
+
+	return success ? RESULT_SUCCESS : RESULT_FAIL;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Tool entry point
+ */
+int main(int argc, char* argv[])
+{
+	uint32_t baseAddress = IMAGETOOL_DEFAULT_BASE_ADDRESS;
+	uint32_t baudRate = IMAGETOOL_REFERENCE_BAUD_RATE;
+	uint32_t windowSize = IMAGESENDER_DEFAULT_WINDOW_SIZE;
+
+	if (argc < 4)
+	{
+		return printUsage(argv[0]);
+	}
+
+	if (strcmp(argv[1], "frame") == 0)
+	{
+		if (argc > 4)
+		{
+			baseAddress = (uint32_t)strtoul(argv[4], NULL, 0);
+		}
+
+		return frameCommand(argv[2], argv[3], baseAddress);
+	}
+
+	if (strcmp(argv[1], "send") == 0)
+	{
+		if (argc > 4)
+		{
+			baudRate = (uint32_t)strtoul(argv[4], NULL, 0);
+		}
+
+		if (argc > 5)
+		{
+			windowSize = (uint32_t)strtoul(argv[5], NULL, 0);
+		}
+
+		return sendCommand(argv[2], argv[3], baudRate, windowSize);
+	}
+
+	if (strcmp(argv[1], "compress") == 0)
+	{
+		return compressCommand(argv[2], argv[3]);
+	}
+
+	if (strcmp(argv[1], "key") == 0)
+	{
+		return keyCommand(argv[2], argv[3], (argc > 4) ? argv[4] : KEYGENERATOR_DEFAULT_KEY_NAME);
+	}
+
+	if ((strcmp(argv[1], "delta") == 0) && (argc > 4))
+	{
+		return deltaCommand(argv[2], argv[3], argv[4]);
+	}
+
+	return printUsage(argv[0]);
+}
@@ -0,0 +1,252 @@
+/*******************************************************************************
+ *
+ * @file KeyGenerator.c
+ *
+ * @author MC
+ *
+ * @brief Host side generator of RSA public key header for bootloader.
+ *
+ *		  Key file is read and R^2 mod N is computed by mbedTLS bignum.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "KeyGenerator.h"
+
+#include "mbedtls/bignum.h"
+#include "mbedtls/platform.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Key length in bits */
+#define KEYGENERATOR_KEY_BIT_LENGTH					(KEYGENERATOR_KEY_LENGTH * 8)
+
+/* Public exponent is written as a word pair */
+#define KEYGENERATOR_EXPONENT_LENGTH				(8)
+
+/* Maximum length of a line of key file */
+#define KEYGENERATOR_MAX_LINE_LENGTH				(1024)
+
+/* Number of word pairs in a line of header */
+#define KEYGENERATOR_PAIRS_PER_LINE					(2)
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/******************************** VARIABLES ***********************************/
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns file name part of a path
+ */
+PRIVATE const char* getBaseName(const char* path)
+{
+	const char* baseName = strrchr(path, '/');
+
+	return (baseName != NULL) ? (baseName + 1) : path;
+}
+
+/*
+ * Reads hexadecimal number at end of next line (e.g. "N = BF52...")
+ */
+PRIVATE bool readNumber(FILE* file, mbedtls_mpi* number)
+{
+	char line[KEYGENERATOR_MAX_LINE_LENGTH];
+	char* digits;
+	size_t length;
+
+	if (fgets(line, sizeof(line), file) == NULL)
+	{
+		return false;
+	}
+
+	length = strcspn(line, "\r\n");
+	line[length] = '\0';
+
+	for (digits = &line[length]; (digits > line) && isxdigit((unsigned char)digits[-1]); digits--);
+
+	return (*digits != '\0') && (mbedtls_mpi_read_string(number, 16, digits) == 0);
+}
+
+/*
+ * Writes a number as initializer of word pairs
+ */
+PRIVATE bool writeInitializer(FILE* file, const char* keyName, const char* partName, const char* comment,
+							  const mbedtls_mpi* number, uint32_t length)
+{
+	uint8_t buffer[KEYGENERATOR_KEY_LENGTH];
+	uint32_t wordCount = length / 4;
+	uint32_t words[2];
+	uint32_t pairNo;
+	uint32_t index;
+
+	if (mbedtls_mpi_write_binary(number, buffer, length) != 0)
+	{
+		return false;
+	}
+
+	fprintf(file, "/* %s */\n", comment);
+	fprintf(file, "#define %s_%s \\\n\t{ \\\n", keyName, partName);
+
+	for (pairNo = 0; pairNo < wordCount / 2; pairNo++)
+	{
+		/* Big endian bytes, least significant word is at the end */
+		for (index = 0; index < 2; index++)
+		{
+			const uint8_t* word = &buffer[length - (((pairNo * 2) + index + 1) * 4)];
+
+			words[index] = ((uint32_t)word[0] << 24) | (word[1] << 16) | (word[2] << 8) | word[3];
+		}
+
+		if ((pairNo % KEYGENERATOR_PAIRS_PER_LINE) == 0)
+		{
+			fprintf(file, "\t\t");
+		}
+
+		fprintf(file, "RSA_KEY_WORDS(0x%08X, 0x%08X)", words[0], words[1]);
+
+		if (pairNo + 1 == wordCount / 2)
+		{
+			fprintf(file, " \\\n");
+		}
+		else if (((pairNo + 1) % KEYGENERATOR_PAIRS_PER_LINE) == 0)
+		{
+			fprintf(file, ", \\\n");
+		}
+		else
+		{
+			fprintf(file, ", ");
+		}
+	}
+
+	fprintf(file, "\t}\n\n");
+
+	return true;
+}
+
+/*
+ * Writes header of key
+ */
+PRIVATE bool writeHeader(FILE* file, const char* headerFileName, const char* keyName,
+						 const mbedtls_mpi* N, const mbedtls_mpi* E, const mbedtls_mpi* RN)
+{
+	fprintf(file,
+			"/*******************************************************************************\n"
+			" *\n"
+			" * @file %s\n"
+			" *\n"
+			" * @author MC\n"
+			" *\n"
+			" * @brief RSA-%u public key of bootloader.\n"
+			" *\n"
+			" *		  Generated by ImageTool (see KeyGenerator.h), do not edit.\n"
+			" *		  Words are little endian, RSA_KEY_WORDS is provided by user.\n"
+			" *\n"
+			" * @see\n"
+			" *\n"
+			" ******************************************************************************\n"
+			" *\n"
+			" * GNU GPLv3\n"
+			" *\n"
+			" * Copyright (c) 2016 SP\n"
+			" *\n"
+			" *  See LICENSE file in Root Directory for license details.\n"
+			" *\n"
+			" ******************************************************************************/\n\n",
+			getBaseName(headerFileName), KEYGENERATOR_KEY_BIT_LENGTH);
+
+	fprintf(file, "#ifndef __%s_H\n#define __%s_H\n\n", keyName, keyName);
+	fprintf(file, "/***************************** MACRO DEFINITIONS ******************************/\n\n");
+
+	if (!writeInitializer(file, keyName, "N", "Modulus", N, KEYGENERATOR_KEY_LENGTH) ||
+		!writeInitializer(file, keyName, "E", "Public exponent", E, KEYGENERATOR_EXPONENT_LENGTH) ||
+		!writeInitializer(file, keyName, "RN", "Montgomery constant R^2 mod N (R = 2^2048)", RN, KEYGENERATOR_KEY_LENGTH))
+	{
+		return false;
+	}
+
+	fprintf(file, "#endif	/* __%s_H */\n", keyName);
+
+	return true;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Generates key header from a key file
+ */
+bool KeyGenerator_Generate(const char* keyFileName, const char* headerFileName, const char* keyName)
+{
+	mbedtls_mpi N;
+	mbedtls_mpi E;
+	mbedtls_mpi RN;
+	FILE* file;
+	bool success = false;
+
+	/* Bootloader configuration does not provide a default allocator */
+	mbedtls_platform_set_calloc_free(calloc, free);
+
+	mbedtls_mpi_init(&N);
+	mbedtls_mpi_init(&E);
+	mbedtls_mpi_init(&RN);
+
+	file = fopen(keyFileName, "r");
+	if (file == NULL)
+	{
+		printf("Key file could not be read : %s\n", keyFileName);
+		goto exit;
+	}
+
+	if (!readNumber(file, &N) || !readNumber(file, &E))
+	{
+		fclose(file);
+		printf("Key could not be parsed : %s\n", keyFileName);
+		goto exit;
+	}
+	fclose(file);
+
+	if ((mbedtls_mpi_bitlen(&N) != KEYGENERATOR_KEY_BIT_LENGTH) || (mbedtls_mpi_get_bit(&N, 0) == 0) ||
+		(mbedtls_mpi_bitlen(&E) > KEYGENERATOR_EXPONENT_LENGTH * 8) || (mbedtls_mpi_cmp_int(&E, 3) < 0))
+	{
+		printf("Key is not an RSA-%u public key : %s\n", KEYGENERATOR_KEY_BIT_LENGTH, keyFileName);
+		goto exit;
+	}
+
+	/* R^2 mod N which mbedtls_mpi_exp_mod computes otherwise */
+	if ((mbedtls_mpi_lset(&RN, 1) != 0) ||
+		(mbedtls_mpi_shift_l(&RN, 2 * KEYGENERATOR_KEY_BIT_LENGTH) != 0) ||
+		(mbedtls_mpi_mod_mpi(&RN, &RN, &N) != 0))
+	{
+		goto exit;
+	}
+
+	file = fopen(headerFileName, "w");
+	if (file == NULL)
+	{
+		printf("Output file could not be created : %s\n", headerFileName);
+		goto exit;
+	}
+
+	success = writeHeader(file, headerFileName, keyName, &N, &E, &RN);
+	fclose(file);
+
+exit:
+	mbedtls_mpi_free(&N);
+	mbedtls_mpi_free(&E);
+	mbedtls_mpi_free(&RN);
+
+	return success;
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+ *
+ * @file KeyGenerator.h
+ *
+ * @author MC
+ *
+ * @brief Host side generator of RSA public key header for bootloader.
+ *
+ *		  Reads N and E of a key file (e.g. rsa_pub.txt or rsa_priv.txt,
+ *		  "N = <hex>" lines) and writes them as C initializers of 32 bit
+ *		  words together with R^2 mod N (R = 2^2048), so bootloader neither
+ *		  parses the key nor computes Montgomery constant while booting.
+ *
+ *		  Words are little endian (least significant word first). Pairs of
+ *		  words are given to RSA_KEY_WORDS(low, high) which is provided by
+ *		  bootloader according to limb size of mbedTLS.
+ *
+ * @see
+ *
+ ******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ ******************************************************************************/
+
+#ifndef __KEYGENERATOR_H
+#define __KEYGENERATOR_H
+
+/********************************* INCLUDES ***********************************/
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Supported key length (RSA-2048) */
+#define KEYGENERATOR_KEY_LENGTH						(256)
+
+/* Default name of generated initializers */
+#define KEYGENERATOR_DEFAULT_KEY_NAME				"TEST_RSA_KEY"
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*************************** FUNCTION DEFINITIONS *****************************/
+/*
+ * Generates key header from a key file.
+ *
+ *	Following initializers are written:
+ *		<keyName>_N		: Modulus
+ *		<keyName>_E		: Public exponent (two words)
+ *		<keyName>_RN	: R^2 mod N
+ *
+ * @param keyFileName Key file, N and E must be its first lines
+ * @param headerFileName Output header file
+ * @param keyName Prefix of initializers
+ *
+ * @return true if key is valid and header is written
+ */
+bool KeyGenerator_Generate(const char* keyFileName, const char* headerFileName, const char* keyName);
+
+#endif	/* __KEYGENERATOR_H */
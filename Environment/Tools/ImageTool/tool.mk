@@ -0,0 +1,46 @@
+################################################################################
+#
+# @file tool.mk
+#
+# @author MC
+#
+# @brief Host tool make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+TOOL_TARGET_NAME = ImageTool
+
+include $(ROOT_PATH)/Environment/Lib/IntelHex/module.mk
+include $(ROOT_PATH)/Environment/Lib/BinFrame/module.mk
+include $(ROOT_PATH)/Environment/Lib/Delta/module.mk
+include $(ROOT_PATH)/Environment/Lib/LZSS/module.mk
+include $(ROOT_PATH)/Environment/ExternalLib/mbedTLS/module.mk
+
+# mbedTLS configuration of bootloader
+MODULE_INC_PATHS += \
+	-I$(ROOT_PATH)/Projects/Bootloader/config \
+	-I$(ROOT_PATH)/Projects/Bootloader/config/mbedtls
+
+# Libraries which are used by tool
+TOOL_SRC_FILES = \
+	$(INTELHEX_SRC_FILES) \
+	$(BINFRAME_SRC_FILES) \
+	$(DELTA_SRC_FILES) \
+	$(LZSS_SRC_FILES) \
+	$(ROOT_PATH)/Environment/ExternalLib/mbedTLS/library/sha256.c \
+	$(ROOT_PATH)/Environment/ExternalLib/mbedTLS/library/bignum.c \
+	$(ROOT_PATH)/Environment/ExternalLib/mbedTLS/library/platform.c \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/ImageSender.c \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/DeltaGenerator.c \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/Compressor.c \
+	$(ROOT_PATH)/Environment/Tools/ImageTool/KeyGenerator.c
@@ -0,0 +1,398 @@
+/*******************************************************************************
+ *
+ * @file SizeReport.c
+ *
+ * @author MC
+ *
+ * @brief Host side footprint report tool.
+ *
+ *        Reports code and data size of each translation unit from a linker
+ *        map file, so modules which fill bootloader area can be found.
+ *
+ *        [USAGE] : SizeReport <Map File> [Flash Limit]
+ *
+ *          Map files of GNU ld (-Wl,-Map) and of armlink (uVision, Image
+ *          component sizes) are supported. Sizes are reported per object:
+ *            - text   : code (including literal pools) of input .text sections
+ *            - rodata : constant data
+ *            - data   : initialized data (takes both flash and RAM)
+ *            - bss    : zero initialized data
+ *          Translation units are sorted by flash usage (text + rodata +
+ *          data). If Flash Limit (e.g. 0xF000) is given, margin is reported
+ *          and tool fails when image does not fit.
+ *
+ * @see
+ *
+ *******************************************************************************
+ *
+ * GNU GPLv3
+ *
+ * Copyright (c) 2016 SP
+ *
+ *  See LICENSE file in Root Directory for license details.
+ *
+ *******************************************************************************/
+
+/********************************* INCLUDES ***********************************/
+
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "postypes.h"
+
+/***************************** MACRO DEFINITIONS ******************************/
+
+/* Maximum number of translation units in a map */
+#define SIZEREPORT_MAX_UNIT_COUNT			(1024)
+
+/* Maximum length of a translation unit name */
+#define SIZEREPORT_MAX_NAME_LENGTH			(64)
+
+/* Maximum length of a map line */
+#define SIZEREPORT_MAX_LINE_LENGTH			(1024)
+
+/* Start of section list in map files */
+#define SIZEREPORT_GNU_MAP_START			"Linker script and memory map"
+#define SIZEREPORT_ARM_MAP_START			"Image component sizes"
+
+/***************************** TYPE DEFINITIONS *******************************/
+
+/*
+ * Kinds of sections which are reported
+ */
+typedef enum
+{
+	SizeReport_Text = 0,
+	SizeReport_ROData,
+	SizeReport_Data,
+	SizeReport_BSS,
+	SizeReport_KindCount,
+	/* Debug information and other sections which are not loaded */
+	SizeReport_Ignored = SizeReport_KindCount
+} SizeReportKind;
+
+/*
+ * Sizes of a translation unit
+ */
+typedef struct
+{
+	char name[SIZEREPORT_MAX_NAME_LENGTH];
+	uint32_t sizes[SizeReport_KindCount];
+} SizeReportUnit;
+
+/******************************** VARIABLES ***********************************/
+
+/* Translation units of map */
+PRIVATE SizeReportUnit units[SIZEREPORT_MAX_UNIT_COUNT];
+PRIVATE uint32_t unitCount;
+
+/**************************** PRIVATE FUNCTIONS ******************************/
+/*
+ * Returns flash usage of a translation unit
+ */
+PRIVATE uint32_t getFlashSize(const SizeReportUnit* unit)
+{
+	return unit->sizes[SizeReport_Text] + unit->sizes[SizeReport_ROData] + unit->sizes[SizeReport_Data];
+}
+
+/*
+ * Adds size of a section to its translation unit. Path of object file is
+ * dropped, archive members are kept as 'archive(member)'.
+ */
+PRIVATE bool addSize(const char* objectName, SizeReportKind kind, uint32_t size)
+{
+	const char* name = objectName;
+	const char* separator;
+	uint32_t index;
+
+	if ((kind == SizeReport_Ignored) || (size == 0))
+	{
+		return true;
+	}
+
+	for (separator = objectName; *separator != '\0' && *separator != '('; separator++)
+	{
+		if ((*separator == '/') || (*separator == '\\'))
+		{
+			name = separator + 1;
+		}
+	}
+
+	for (index = 0; index < unitCount; index++)
+	{
+		if (strncmp(units[index].name, name, SIZEREPORT_MAX_NAME_LENGTH - 1) == 0)
+		{
+			break;
+		}
+	}
+
+	if (index == unitCount)
+	{
+		if (unitCount == SIZEREPORT_MAX_UNIT_COUNT)
+		{
+			return false;
+		}
+
+		strncpy(units[index].name, name, SIZEREPORT_MAX_NAME_LENGTH - 1);
+		unitCount++;
+	}
+
+	units[index].sizes[kind] += size;
+
+	return true;
+}
+
+/*
+ * Returns kind of a GNU ld input section
+ */
+PRIVATE SizeReportKind getSectionKind(const char* sectionName)
+{
+	if ((strncmp(sectionName, ".text", 5) == 0) ||
+		(strcmp(sectionName, ".init") == 0) ||
+		(strcmp(sectionName, ".fini") == 0) ||
+		(strncmp(sectionName, ".glue_7", 7) == 0) ||
+		(strncmp(sectionName, ".ARM.extab", 10) == 0) ||
+		(strncmp(sectionName, ".ARM.exidx", 10) == 0))
+	{
+		return SizeReport_Text;
+	}
+
+	if (strncmp(sectionName, ".rodata", 7) == 0)
+	{
+		return SizeReport_ROData;
+	}
+
+	if (strncmp(sectionName, ".data", 5) == 0)
+	{
+		return SizeReport_Data;
+	}
+
+	if ((strncmp(sectionName, ".bss", 4) == 0) || (strcmp(sectionName, "COMMON") == 0))
+	{
+		return SizeReport_BSS;
+	}
+
+	return SizeReport_Ignored;
+}
+
+/*
+ * Checks whether a token is a hexadecimal number (0x...)
+ */
+PRIVATE bool isHexNumber(const char* token)
+{
+	return (token[0] == '0') && (token[1] == 'x') && isxdigit((unsigned char)token[2]);
+}
+
+/*
+ * Parses input sections of a GNU ld map.
+ *
+ *	An input section is ' <section> <address> <size> <object>'. Long section
+ *	names are followed by address, size and object on next line.
+ */
+PRIVATE bool parseGNUMap(FILE* file)
+{
+	char line[SIZEREPORT_MAX_LINE_LENGTH];
+	char sectionName[SIZEREPORT_MAX_LINE_LENGTH] = "";
+	char tokens[4][SIZEREPORT_MAX_LINE_LENGTH];
+	int tokenCount;
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		tokenCount = sscanf(line, "%1023s %1023s %1023s %1023s", tokens[0], tokens[1], tokens[2], tokens[3]);
+
+		/* Input sections are indented by a single space */
+		if ((line[0] == ' ') && (line[1] != ' ') && (tokenCount > 0))
+		{
+			strcpy(sectionName, tokens[0]);
+
+			if ((tokenCount == 4) && isHexNumber(tokens[1]) && isHexNumber(tokens[2]))
+			{
+				if (!addSize(tokens[3], getSectionKind(sectionName), (uint32_t)strtoul(tokens[2], NULL, 16)))
+				{
+					return false;
+				}
+				sectionName[0] = '\0';
+			}
+		}
+		else if ((sectionName[0] != '\0') && (tokenCount == 3) && isHexNumber(tokens[0]) && isHexNumber(tokens[1]))
+		{
+			if (!addSize(tokens[2], getSectionKind(sectionName), (uint32_t)strtoul(tokens[1], NULL, 16)))
+			{
+				return false;
+			}
+			sectionName[0] = '\0';
+		}
+		else
+		{
+			/* Symbols, fills and output sections end a pending input section */
+			sectionName[0] = '\0';
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Parses object rows of armlink component sizes
+ *
+ *	Code (inc. data) RO Data RW Data ZI Data Debug Object Name. Totals and
+ *	library summaries are not objects (.o), so they are skipped.
+ */
+PRIVATE bool parseARMMap(FILE* file)
+{
+	char line[SIZEREPORT_MAX_LINE_LENGTH];
+	char name[SIZEREPORT_MAX_LINE_LENGTH];
+	uint32_t code;
+	uint32_t inlineData;
+	uint32_t roData;
+	uint32_t rwData;
+	uint32_t ziData;
+	uint32_t debug;
+	size_t nameLength;
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		if (sscanf(line, "%u %u %u %u %u %u %1023s", &code, &inlineData, &roData, &rwData, &ziData, &debug, name) != 7)
+		{
+			continue;
+		}
+
+		nameLength = strlen(name);
+		if ((nameLength < 2) || (strcmp(&name[nameLength - 2], ".o") != 0))
+		{
+			continue;
+		}
+
+		if (!addSize(name, SizeReport_Text, code) ||
+			!addSize(name, SizeReport_ROData, roData) ||
+			!addSize(name, SizeReport_Data, rwData) ||
+			!addSize(name, SizeReport_BSS, ziData))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Orders translation units by flash usage, largest first
+ */
+PRIVATE int compareUnits(const void* first, const void* second)
+{
+	uint32_t firstSize = getFlashSize((const SizeReportUnit*)first);
+	uint32_t secondSize = getFlashSize((const SizeReportUnit*)second);
+
+	return (firstSize < secondSize) ? 1 : ((firstSize > secondSize) ? -1 : 0);
+}
+
+/*
+ * Prints sizes of translation units and totals
+ */
+PRIVATE int printReport(uint32_t flashLimit)
+{
+	uint32_t totals[SizeReport_KindCount] = { 0 };
+	uint32_t flashSize;
+	uint32_t index;
+	uint32_t kind;
+
+	qsort(units, unitCount, sizeof(SizeReportUnit), compareUnits);
+
+	printf("  %-40s %8s %8s %8s %8s %8s\n", "translation unit", "text", "rodata", "data", "bss", "flash");
+
+	for (index = 0; index < unitCount; index++)
+	{
+		printf("  %-40s %8u %8u %8u %8u %8u\n",
+			   units[index].name,
+			   units[index].sizes[SizeReport_Text],
+			   units[index].sizes[SizeReport_ROData],
+			   units[index].sizes[SizeReport_Data],
+			   units[index].sizes[SizeReport_BSS],
+			   getFlashSize(&units[index]));
+
+		for (kind = 0; kind < SizeReport_KindCount; kind++)
+		{
+			totals[kind] += units[index].sizes[kind];
+		}
+	}
+
+	flashSize = totals[SizeReport_Text] + totals[SizeReport_ROData] + totals[SizeReport_Data];
+
+	printf("  %-40s %8u %8u %8u %8u %8u\n", "TOTAL",
+		   totals[SizeReport_Text], totals[SizeReport_ROData], totals[SizeReport_Data], totals[SizeReport_BSS], flashSize);
+	printf("\n  Flash : %u bytes, RAM : %u bytes\n", flashSize, totals[SizeReport_Data] + totals[SizeReport_BSS]);
+
+	if (flashLimit == 0)
+	{
+		return RESULT_SUCCESS;
+	}
+
+	if (flashSize > flashLimit)
+	{
+		printf("  Flash limit 0x%X is exceeded by %u bytes!\n", flashLimit, flashSize - flashLimit);
+		return RESULT_FAIL;
+	}
+
+	printf("  Flash limit 0x%X, margin : %u bytes (%.1f%%)\n",
+		   flashLimit, flashLimit - flashSize, (100.0 * (flashLimit - flashSize)) / flashLimit);
+
+	return RESULT_SUCCESS;
+}
+
+/***************************** PUBLIC FUNCTIONS *******************************/
+/*
+ * Tool entry point
+ */
+int main(int argc, char* argv[])
+{
+	char line[SIZEREPORT_MAX_LINE_LENGTH];
+	uint32_t flashLimit = 0;
+	bool parsed = false;
+	FILE* file;
+
+	if (argc < 2)
+	{
+		printf("Usage : %s <Map File> [Flash Limit]\n", argv[0]);
+		return RESULT_FAIL;
+	}
+
+	if (argc > 2)
+	{
+		flashLimit = (uint32_t)strtoul(argv[2], NULL, 0);
+	}
+
+	file = fopen(argv[1], "r");
+	if (file == NULL)
+	{
+		printf("Map file could not be opened : %s\n", argv[1]);
+		return RESULT_FAIL;
+	}
+
+	/* Format is detected by start of section list */
+	while (!parsed && (fgets(line, sizeof(line), file) != NULL))
+	{
+		if (strncmp(line, SIZEREPORT_GNU_MAP_START, strlen(SIZEREPORT_GNU_MAP_START)) == 0)
+		{
+			parsed = parseGNUMap(file);
+			break;
+		}
+
+		if (strstr(line, SIZEREPORT_ARM_MAP_START) != NULL)
+		{
+			parsed = parseARMMap(file);
+			break;
+		}
+	}
+
+	fclose(file);
+
+	if (!parsed || (unitCount == 0))
+	{
+		printf("Sections of map file could not be parsed : %s\n", argv[1]);
+		return RESULT_FAIL;
+	}
+
+	printf("\nSize Report (%s)\n", argv[1]);
+
+	return printReport(flashLimit);
+}
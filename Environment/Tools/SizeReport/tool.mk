@@ -0,0 +1,21 @@
+################################################################################
+#
+# @file tool.mk
+#
+# @author MC
+#
+# @brief Host tool make file
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+TOOL_TARGET_NAME = SizeReport
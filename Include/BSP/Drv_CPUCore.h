@@ -131,4 +131,38 @@ void Drv_CPUCore_JumpToImage(reg32_t imageAddress);
  */
 uint32_t Drv_CPUCore_GetCPUFrequency(void);
 
+/*
+ * Checks whether last reset is caused by watchdog.
+ *	Reset source is cleared, so it is reported once.
+ *
+ * @param none
+ * @return true if watchdog caused last reset
+ */
+bool Drv_CPUCore_IsWatchdogReset(void);
+
+/*
+ * Increments number of boots which is kept in a retained register.
+ *	Register survives resets (and power loss if battery is available).
+ *
+ * @param none
+ * @return Number of boots including current one
+ */
+uint32_t Drv_CPUCore_IncrementBootCount(void);
+
+/*
+ * Starts free running cycle counter (e.g. DWT) from zero.
+ *
+ * @param none
+ * @return none
+ */
+void Drv_CPUCore_StartCycleCounter(void);
+
+/*
+ * Returns elapsed CPU cycles since cycle counter is started.
+ *
+ * @param none
+ * @return Elapsed cycles, wraps around
+ */
+uint32_t Drv_CPUCore_GetCycleCount(void);
+
 #endif	/* __DRV_CPUCORE_H */
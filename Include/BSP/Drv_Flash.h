@@ -31,6 +31,10 @@
 #define FLASH_STATUS_SUCCESS                (0)
 #define FLASH_STATUS_BUSY                   (1)
 #define FLASH_STATUS_FAILURE                (2)
+#define FLASH_STATUS_NOT_BLANK              (3)
+
+/* Length of unique device serial number in words */
+#define FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT	(4)
 
 /*************************** FUNCTION DEFINITIONS *****************************/
 void Drv_Flash_Init(void);
@@ -41,10 +45,33 @@ int32_t Drv_Flash_PrepareBlockRange(uint32_t startBlockNo, uint32_t endBlockNo);
 int32_t Drv_Flash_EraseBlock(uint32_t blockNo);
 int32_t Drv_Flash_EraseBlockRange(uint32_t startBlockNo, uint32_t endBlockNo);
 
+/*
+ * Checks whether all blocks of range are erased.
+ *  Returns FLASH_STATUS_SUCCESS if blank, FLASH_STATUS_NOT_BLANK otherwise.
+ */
+int32_t Drv_Flash_BlankCheckBlockRange(uint32_t startBlockNo, uint32_t endBlockNo);
+
 int32_t Drv_Flash_Write(uint32_t address, uint8_t* data, uint32_t length);
 int32_t Drv_Flash_WriteBlock(uint32_t blockNo, uint8_t* data, uint32_t length);
 
+/*
+ * Reads flash content
+ */
+int32_t Drv_Flash_Read(uint32_t address, uint8_t* data, uint32_t length);
+
 int32_t Drv_Flash_GetBlockNoOfAddress(uint32_t address);
 
+/*
+ * Returns start address of block. Block size is difference between start
+ * addresses of consecutive blocks.
+ */
+uint32_t Drv_Flash_GetBlockAddress(uint32_t blockNo);
+
 uint32_t Drv_Flash_GetSize(void);
+
+/*
+ * Reads unique serial number of device (FLASH_DEVICE_SERIAL_NUMBER_WORD_COUNT
+ * words). Provided by flash controller (IAP) on LPC17xx.
+ */
+int32_t Drv_Flash_ReadDeviceSerialNumber(uint32_t* serialNumber);
 #endif	/* __DRV_FLASH_H */
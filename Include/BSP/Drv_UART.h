@@ -36,6 +36,10 @@ void Drv_UART_Init(void);
 UartHandle Drv_UART_Get(uint32_t uartNo, uint32_t baudRate, UARTDataReceivedEventHandler dataReceivedEventHandler);
 void Drv_UART_Release(UartHandle uart);
 
+/*
+ * @return Number of sent bytes
+ * @return -1 In case of error
+ */
 int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength);
 /*
  * @return Number of read bytes. Returns zero if there is no unread bytes
@@ -44,4 +48,29 @@ int32_t Drv_UART_Send(UartHandle uart, uint8_t* sendBuffer, uint32_t sendLength)
  */
 int32_t Drv_UART_Receive(UartHandle uart, uint8_t* receiveBuffer, uint32_t receiveLength);
 
+/*
+ * Lends received bytes to client without copying.
+ *	Span is a contiguous part of driver receive buffer and stays valid until
+ *	Drv_UART_Consume is called. Remaining bytes (e.g. after buffer wraps
+ *	around) are returned by next call.
+ *
+ * @param uart UART Handle
+ * @param span [out] Start of received bytes
+ *
+ * @return Number of bytes in span. Returns zero if there is no unread bytes
+ * @return -1 In case of error
+ */
+int32_t Drv_UART_PeekSpan(UartHandle uart, uint8_t** span);
+
+/*
+ * Releases bytes of span which is returned by Drv_UART_PeekSpan.
+ *	Client is informed using data received event if more bytes are waiting.
+ *
+ * @param uart UART Handle
+ * @param length Number of processed bytes. Must not exceed span length.
+ *
+ * @return none
+ */
+void Drv_UART_Consume(UartHandle uart, uint32_t length);
+
 #endif	/* __DRV_UART_H */
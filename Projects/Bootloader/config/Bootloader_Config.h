@@ -38,29 +38,113 @@
 
 #define FIRMWARE_METADATA_LENGTH               	(256 + FIRMWARE_SIGNATURE_LENGTH)
 
+/*
+ * A/B firmware slots (see Bootloader_Slot.c).
+ *	32K sector region is split into two slots of 6 sectors. Slot A starts at
+ *	FIRMWARE_START_ADDRESS, slot B follows it. Next sector keeps upgrade
+ *	journal and last one is scratch block of delta updates. An image is
+ *	linked for the slot it is installed in, upgrades are written into
+ *	inactive slot. Otherwise there is a single image at FIRMWARE_START_ADDRESS.
+ */
+#ifndef BL_AB_SLOTS_ENABLED
+#define BL_AB_SLOTS_ENABLED						(1)
+#endif
+#define FIRMWARE_SLOT_SIZE						(0x30000)
+#define FIRMWARE_SLOT_B_ADDRESS					(FIRMWARE_START_ADDRESS + FIRMWARE_SLOT_SIZE)
+
+/*
+ * Boot control records select active slot. Records are kept in two 4K
+ * sectors before verdict record sector, so one of them always keeps latest
+ * record while the other is erased.
+ */
+#define BL_BOOT_CONTROL_BLOCK_NO				(13)
+#define BL_BOOT_CONTROL_BLOCK_COUNT				(2)
+
+/*
+ * Upgrade journal (see Bootloader_Journal.c).
+ *	Checkpoints of sequenced uploads are recorded as blocks are written, so
+ *	an interrupted upload is resumed after its last written block. All 4K
+ *	sectors are used, so journal is kept in 32K sector after slots.
+ */
+#ifndef BL_UPGRADE_JOURNAL_ENABLED
+#define BL_UPGRADE_JOURNAL_ENABLED				(1)
+#endif
+#define BL_UPGRADE_JOURNAL_BLOCK_NO				(28)
+
+/*
+ * Accepted signature schemes of images (see FIRMWARE_SIGNATURE_TYPE_X).
+ *	ECDSA P-256 verification does not use mbedTLS heap.
+ */
+#define BL_SIGNATURE_RSA2048_ENABLED			(1)
+#define BL_SIGNATURE_ECDSA_P256_ENABLED			(1)
+
+/*
+ * RSA-2048 signatures are verified by fixed width RSA2048 library, which does
+ * not use heap and has bounded stack, otherwise by RSA module of mbedTLS.
+ */
+#ifndef BL_SIGNATURE_RSA2048_FIXED_WIDTH
+#define BL_SIGNATURE_RSA2048_FIXED_WIDTH		(1)
+#endif
+
+/*
+ * mbedTLS heap is an arena of size class free lists (see Arena.h) which is
+ * reset after each verification, otherwise memory_buffer_alloc of mbedTLS.
+ *	Heap is only used by RSA module of mbedTLS, so it is not built otherwise.
+ */
+#define BL_SECURITY_ARENA_ENABLED				(1)
+#define BL_SECURITY_HEAP_ENABLED				(BL_SIGNATURE_RSA2048_ENABLED && !BL_SIGNATURE_RSA2048_FIXED_WIDTH)
+
 
 /* Timer Number of FW Upgrade Timeout */
 #define BL_FW_UPGRADE_TIMEOUT_TIMER_NO			(0)
 
 /* UART */
 #define BL_FW_UPGRADE_UART_NO					(0)
-/* */
+/*
+ * Baud rate of upgrade UART. Rates up to 921600 work with 100 MHz CPU clock.
+ *	3000000 requires a CPU clock which is multiple of 48 MHz (e.g. 96 MHz),
+ *	otherwise UART driver rejects it.
+ */
 #define BL_FW_UPGRADE_UART_BAUD_RATE			(115200)
 
+/*
+ * Verified image record (cached boot verdict).
+ *	Signature check of installed image is skipped when record of its last
+ *	verification matches. Records are kept in last 4K sector before firmware,
+ *	bootloader code must end before this sector (and before boot control
+ *	sectors if A/B slots are enabled).
+ */
+#define BL_VERDICT_RECORD_ENABLED				(1)
+#define BL_VERDICT_RECORD_BLOCK_NO				(15)
+
+/* Image is verified again every Nth boot, 0 disables periodic verification */
+#define BL_VERDICT_REVERIFY_BOOT_INTERVAL		(0)
+
+/* Image is verified again after a watchdog reset */
+#define BL_VERDICT_REVERIFY_ON_WATCHDOG_RESET	(1)
+
+/* Prints CPU cycles from reset to jump (DWT cycle counter) */
+#define BL_BOOT_TIME_MEASUREMENT				(0)
+
+/* Prints high water mark of mbedTLS heap (arena) to size it, if heap is used */
+#define BL_SECURITY_HEAP_REPORT					(0)
+
+/* Enables additional runtime checks */
+#define BL_DEBUG_MODE							(0)
+
 /* TODO Remove Test Mode */
 #define BL_TEST_MODE							(1)
 
+/*
+ * Bootloader runs on simulated CPU (BSP/CPU/x86), flash is not memory mapped.
+ *	Host builds (make PROJECT=Bootloader ENV=x86) define it.
+ */
+#ifndef SIMULATION_MODE
 #ifdef _WIN32
 #define SIMULATION_MODE							(1)
 #else
 #define SIMULATION_MODE							(0)
 #endif
-
-#if BL_TEST_MODE
-
-/* TODO Remove */
-#include "TestData.h"
-
 #endif
 
 #endif	/* __BOOTLOADER_CONFIG_H */
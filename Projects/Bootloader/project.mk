@@ -0,0 +1,39 @@
+################################################################################
+#
+# @file project.mk
+#
+# @author MC
+#
+# @brief Bootloader project make file
+#
+#	[USAGE] : make PROJECT=Bootloader [ENV=x86]
+#
+#	ENV=x86 builds bootloader as a host executable on simulated CPU. Its
+#	UART is a pseudo terminal and its flash is kept in a file (see
+#	BSP/CPU/x86/Drv_CPUCore.c), so images can be uploaded by ImageTool.
+#
+# @see
+#
+#*****************************************************************************
+#
+# GNU GPLv3
+#
+# Copyright (c) 2016 SP
+#
+#  See LICENSE file in Root Directory for license details.
+#
+################################################################################
+
+#
+# Target CPU and Board. Host environments select their own CPU.
+#
+CPU = LPC1768
+BOARD = LandTiger
+
+#
+# Bootloader module and libraries
+#
+include $(ROOT_PATH)/Bootloader/module.mk
+
+PROJECT_MODULE_SRC_FILES = \
+	$(BOOTLOADER_SRC_FILES)